@@ -1,15 +1,21 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 
 namespace vcpkg
 {
     template<class Key, class Value>
     struct Cache
     {
+        Cache() = default;
+        Cache(Cache&& other) : m_cache(std::move(other.m_cache)) { }
+
         template<class F>
         Value const& get_lazy(const Key& k, const F& f) const
         {
+            // recursive so that computing one entry may look up another in the same cache
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
             auto it = m_cache.find(k);
             if (it != m_cache.end()) return it->second;
             return m_cache.emplace(k, f()).first->second;
@@ -17,5 +23,6 @@ namespace vcpkg
 
     private:
         mutable std::map<Key, Value> m_cache;
+        mutable std::recursive_mutex m_mutex;
     };
 }
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/stringview.h>
+
+#include <string>
+
+namespace vcpkg::CacheFile
+{
+    /// <summary>
+    /// The size and last write time of a file, which let a cache notice that the file changed without reading it.
+    /// </summary>
+    struct FileStamp
+    {
+        // -1 for a directory
+        long long size;
+        long long write_time;
+
+        /// <summary>
+        /// Whether the file was written so recently that it may still change without its stamp changing (the write
+        /// time has a coarse resolution on some filesystems). Such a stamp should not be remembered.
+        /// </summary>
+        bool is_recent() const;
+
+        /// <summary>"&lt;size&gt;\t&lt;write time&gt;"</summary>
+        std::string to_string() const;
+        static Optional<FileStamp> parse(const std::string& size, const std::string& write_time);
+    };
+
+    bool operator==(const FileStamp& lhs, const FileStamp& rhs);
+    bool operator!=(const FileStamp& lhs, const FileStamp& rhs);
+
+    /// <summary>Stamps the file or directory at `path`; `nullopt` if it does not exist or cannot be read.</summary>
+    Optional<FileStamp> get_file_stamp(const fs::path& path);
+
+    /// <summary>
+    /// Writes `contents` to a temporary file next to `path`, then renames it over `path`, so that readers see either
+    /// the old or the new contents. Each process writes its own temporary file, so the last rename wins.
+    /// </summary>
+    void write_contents_atomically(Files::Filesystem& fs,
+                                   const fs::path& path,
+                                   const std::string& contents,
+                                   std::error_code& ec);
+
+    /// <summary>
+    /// Reads a cache file saved by `save`, returning everything after its header line. Returns `nullopt` if the file
+    /// does not exist or starts with another header, such as that of an older format.
+    /// </summary>
+    Optional<std::string> load(const Files::Filesystem& fs, const fs::path& cache_file, StringView header);
+
+    /// <summary>
+    /// Atomically writes `header` as a line of its own followed by `body` to `cache_file`. A cache only saves work, so
+    /// failing to save it is not an error; it is only reported with --debug.
+    /// </summary>
+    void save(Files::Filesystem& fs, const fs::path& cache_file, StringView header, StringView body);
+}
@@ -3,6 +3,8 @@
 #include <vcpkg/base/cstringview.h>
 #include <vcpkg/base/strings.h>
 
+#include <functional>
+
 namespace vcpkg::Checks
 {
     void register_global_shutdown_handler(void (*func)());
@@ -36,6 +38,11 @@ namespace vcpkg::Checks
                           Strings::format(error_message_template, error_message_arg1, error_message_args...));
     }
 
+    // Run `f`, such that an exit of the calling thread within it unwinds back here instead of ending the tool. Returns
+    // whether `f` exited, with the exit code in `exit_code`. For worker threads, which must not end the tool while
+    // other threads still use it; the caller is expected to exit with `exit_code` once the other threads are done.
+    bool run_catching_exit(const std::function<void()>& f, int& exit_code);
+
     void check_exit(const LineInfo& line_info, bool expression);
 
     void check_exit(const LineInfo& line_info, bool expression, StringView error_message);
@@ -184,6 +184,9 @@ namespace vcpkg::Files
                                  std::error_code& ec) = 0;
         void write_contents(const fs::path& path, const std::string& data, LineInfo linfo);
         virtual void write_contents(const fs::path& file_path, const std::string& data, std::error_code& ec) = 0;
+        /// <summary>Appends `data` to the end of `file_path`, creating the file if it does not exist.</summary>
+        void append_contents(const fs::path& path, const std::string& data, LineInfo linfo);
+        virtual void append_contents(const fs::path& file_path, const std::string& data, std::error_code& ec) = 0;
         void write_contents_and_dirs(const fs::path& path, const std::string& data, LineInfo linfo);
         virtual void write_contents_and_dirs(const fs::path& file_path,
                                              const std::string& data,
@@ -223,6 +226,10 @@ namespace vcpkg::Files
                                std::error_code& ec) = 0;
         void copy_file(const fs::path& oldpath, const fs::path& newpath, fs::copy_options opts, LineInfo li);
         virtual void copy_symlink(const fs::path& oldpath, const fs::path& newpath, std::error_code& ec) = 0;
+        /// <summary>Creates `newpath` as a copy-on-write clone of the regular file `oldpath`.</summary>
+        /// <remarks>Fails with `not_supported` where the filesystem cannot clone files.</remarks>
+        virtual void clone_file(const fs::path& oldpath, const fs::path& newpath, std::error_code& ec) = 0;
+        virtual void create_hard_link(const fs::path& oldpath, const fs::path& newpath, std::error_code& ec) = 0;
         virtual fs::file_status status(const fs::path& path, std::error_code& ec) const = 0;
         virtual fs::file_status symlink_status(const fs::path& path, std::error_code& ec) const = 0;
         fs::file_status status(LineInfo li, const fs::path& p) const noexcept;
@@ -266,6 +273,13 @@ namespace vcpkg::Files
     constexpr char preferred_separator = '/';
 #endif // _WIN32
 
+    // Separates the directories of PATH and similar environment variables
+#if defined(_WIN32)
+    constexpr const char* path_list_separator = ";";
+#else
+    constexpr const char* path_list_separator = ":";
+#endif // _WIN32
+
 #if defined(_WIN32)
     fs::path win32_fix_path_case(const fs::path& source);
 #endif // _WIN32
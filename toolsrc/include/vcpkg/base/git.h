@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vcpkg/base/fwd/git.h>
+
+#include <vcpkg/base/expected.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/stringview.h>
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vcpkg::Git
+{
+    enum class ObjectType
+    {
+        Commit = 1,
+        Tree = 2,
+        Blob = 3,
+        Tag = 4,
+    };
+
+    struct Object
+    {
+        ObjectType type;
+        std::string data;
+    };
+
+    struct TreeEntry
+    {
+        // As written in the tree: 40000 (tree), 100644, 100755 (executable), 120000 (symlink) or 160000 (submodule).
+        uint32_t mode;
+        std::string name;
+        // 40 lowercase hex digits
+        std::string oid;
+
+        bool is_tree() const { return mode == 040000; }
+    };
+
+    ExpectedS<std::vector<TreeEntry>> parse_tree(StringView data);
+
+    /// <summary>
+    /// Reads the objects of a git repository without running git: loose objects, and version 2 packfiles through
+    /// their version 2 .idx files, including repositories borrowing objects through `objects/info/alternates`.
+    /// Objects are named by their full 40 digit hex id; refs are not resolved. All members may be called from several
+    /// threads at once.
+    /// </summary>
+    struct ObjectStore
+    {
+        /// <param name="dot_git_dir">The `.git` directory, or a `.git` file pointing at one.</param>
+        ObjectStore(const Files::Filesystem& fs, const fs::path& dot_git_dir);
+        ObjectStore(const ObjectStore&) = delete;
+        ObjectStore& operator=(const ObjectStore&) = delete;
+        ~ObjectStore();
+
+        ExpectedS<Object> read_object(StringView oid) const;
+        ExpectedS<std::string> read_blob(StringView oid) const;
+        /// <param name="treeish">A tree, or a commit whose tree is read.</param>
+        ExpectedS<std::vector<TreeEntry>> read_tree(StringView treeish) const;
+
+        /// <summary>Finds the object at the '/' separated `path` below the tree or commit `treeish`.</summary>
+        ExpectedS<std::string> find_path(StringView treeish, StringView path) const;
+
+        /// <summary>
+        /// Writes the files of the tree or commit `treeish` below `destination`, like `git checkout <treeish> .` into
+        /// an empty work tree.
+        /// </summary>
+        /// <returns>The number of files written.</returns>
+        ExpectedS<size_t> checkout_tree(Files::Filesystem& fs, StringView treeish, const fs::path& destination) const;
+
+    private:
+        struct Pack;
+
+        ExpectedS<Object> read_packed(const Pack& pack, uint64_t offset) const;
+
+        const Files::Filesystem& m_fs;
+        std::vector<fs::path> m_object_dirs;
+        std::vector<std::unique_ptr<Pack>> m_packs;
+    };
+}
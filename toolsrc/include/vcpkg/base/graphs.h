@@ -2,10 +2,11 @@
 
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/lineinfo.h>
+#include <vcpkg/base/span.h>
 #include <vcpkg/base/system.print.h>
 
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace vcpkg::Graphs
@@ -22,14 +23,6 @@ namespace vcpkg::Graphs
         FULLY_EXPLORED
     };
 
-    template<class V, class U>
-    struct AdjacencyProvider
-    {
-        virtual std::vector<V> adjacency_list(const U& vertex) const = 0;
-        virtual std::string to_string(const V& vertex) const = 0;
-        virtual U load_vertex_data(const V& vertex) const = 0;
-    };
-
     struct Randomizer
     {
         virtual int random(int max_exclusive) = 0;
@@ -38,6 +31,57 @@ namespace vcpkg::Graphs
         ~Randomizer() { }
     };
 
+    /// <summary>
+    /// A directed graph over the vertices 0 to size() - 1, with the out-edges of every vertex stored contiguously in a
+    /// single array (compressed sparse row form).
+    /// </summary>
+    struct DenseGraph
+    {
+        DenseGraph() = default;
+
+        /// <summary>
+        /// Builds the graph from (from, to) pairs. The out-edges of each vertex keep the order they have in `edges`.
+        /// </summary>
+        DenseGraph(size_t vertex_count, Span<const std::pair<size_t, size_t>> edges)
+            : m_offsets(vertex_count + 1), m_targets(edges.size())
+        {
+            for (auto&& edge : edges)
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, edge.first < vertex_count && edge.second < vertex_count);
+                ++m_offsets[edge.first + 1];
+            }
+
+            for (size_t vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                m_offsets[vertex + 1] += m_offsets[vertex];
+            }
+
+            std::vector<size_t> next(m_offsets.begin(), m_offsets.end() - 1);
+            for (auto&& edge : edges)
+            {
+                m_targets[next[edge.first]++] = edge.second;
+            }
+        }
+
+        size_t size() const { return m_offsets.empty() ? 0 : m_offsets.size() - 1; }
+
+        Span<const size_t> adjacency_list(size_t vertex) const
+        {
+            return {m_targets.data() + m_offsets[vertex], m_targets.data() + m_offsets[vertex + 1]};
+        }
+
+    private:
+        template<class VertexToString>
+        friend std::vector<size_t> topological_sort(std::vector<size_t> starting_vertices,
+                                                    const DenseGraph& graph,
+                                                    Randomizer* randomizer,
+                                                    VertexToString&& to_string);
+
+        // The out-edges of vertex v are m_targets[m_offsets[v]] to m_targets[m_offsets[v + 1] - 1]
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_targets;
+    };
+
     namespace details
     {
         template<class Container>
@@ -53,59 +97,86 @@ namespace vcpkg::Graphs
                 }
             }
         }
+    }
 
-        template<class V, class U>
-        void topological_sort_internal(const V& vertex,
-                                       const AdjacencyProvider<V, U>& f,
-                                       std::unordered_map<V, ExplorationStatus>& exploration_status,
-                                       std::vector<U>& sorted,
-                                       Randomizer* randomizer)
+    /// <summary>
+    /// Orders the vertices reachable from `starting_vertices` so that every vertex comes after all vertices it has
+    /// edges to. Vertices are explored depth first in the order of their out-edges, without recursion, so chains of any
+    /// length can be sorted. Exits with the offending vertices, named by `to_string`, if a cycle is found.
+    /// </summary>
+    template<class VertexToString>
+    std::vector<size_t> topological_sort(std::vector<size_t> starting_vertices,
+                                         const DenseGraph& graph,
+                                         Randomizer* randomizer,
+                                         VertexToString&& to_string)
+    {
+        struct Frame
         {
+            size_t vertex;
+            size_t next_edge;
+            size_t end_edge;
+        };
+
+        std::vector<size_t> sorted;
+        std::vector<ExplorationStatus> exploration_status(graph.size(), ExplorationStatus::NOT_EXPLORED);
+        std::vector<Frame> stack;
+
+        // Out-edges are shuffled as their vertex is reached, so a randomized sort works on a copy
+        std::vector<size_t> shuffled_targets;
+        if (randomizer) shuffled_targets = graph.m_targets;
+        const std::vector<size_t>& targets = randomizer ? shuffled_targets : graph.m_targets;
+
+        auto visit = [&](size_t vertex) {
             ExplorationStatus& status = exploration_status[vertex];
             switch (status)
             {
                 case ExplorationStatus::FULLY_EXPLORED: return;
                 case ExplorationStatus::PARTIALLY_EXPLORED:
                 {
-                    System::print2("Cycle detected within graph at ", f.to_string(vertex), ":\n");
-                    for (auto&& node : exploration_status)
+                    System::print2("Cycle detected within graph at ", to_string(vertex), ":\n");
+                    for (auto&& frame : stack)
                     {
-                        if (node.second == ExplorationStatus::PARTIALLY_EXPLORED)
-                        {
-                            System::print2("    ", f.to_string(node.first), '\n');
-                        }
+                        System::print2("    ", to_string(frame.vertex), '\n');
                     }
                     Checks::exit_fail(VCPKG_LINE_INFO);
                 }
                 case ExplorationStatus::NOT_EXPLORED:
                 {
                     status = ExplorationStatus::PARTIALLY_EXPLORED;
-                    U vertex_data = f.load_vertex_data(vertex);
-                    auto neighbours = f.adjacency_list(vertex_data);
-                    details::shuffle(neighbours, randomizer);
-                    for (const V& neighbour : neighbours)
-                        topological_sort_internal(neighbour, f, exploration_status, sorted, randomizer);
-
-                    sorted.push_back(std::move(vertex_data));
-                    status = ExplorationStatus::FULLY_EXPLORED;
+                    const size_t first = graph.m_offsets[vertex];
+                    const size_t last = graph.m_offsets[vertex + 1];
+                    if (randomizer)
+                    {
+                        Span<size_t> neighbours{shuffled_targets.data() + first, last - first};
+                        details::shuffle(neighbours, randomizer);
+                    }
+
+                    stack.push_back({vertex, first, last});
                     return;
                 }
                 default: Checks::unreachable(VCPKG_LINE_INFO);
             }
-        }
-    }
-
-    template<class Range, class V, class U>
-    std::vector<U> topological_sort(Range starting_vertices, const AdjacencyProvider<V, U>& f, Randomizer* randomizer)
-    {
-        std::vector<U> sorted;
-        std::unordered_map<V, ExplorationStatus> exploration_status;
+        };
 
         details::shuffle(starting_vertices, randomizer);
 
-        for (auto&& vertex : starting_vertices)
+        for (size_t vertex : starting_vertices)
         {
-            details::topological_sort_internal(vertex, f, exploration_status, sorted, randomizer);
+            visit(vertex);
+            while (!stack.empty())
+            {
+                Frame& top = stack.back();
+                if (top.next_edge == top.end_edge)
+                {
+                    sorted.push_back(top.vertex);
+                    exploration_status[top.vertex] = ExplorationStatus::FULLY_EXPLORED;
+                    stack.pop_back();
+                }
+                else
+                {
+                    visit(targets[top.next_edge++]);
+                }
+            }
         }
 
         return sorted;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vcpkg/base/cachefile.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/hash.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vcpkg::Hash
+{
+    /// <summary>
+    /// Remembers the hashes of files by path, size and last write time, so that files which did not change since they
+    /// were last hashed are not read again. The entries are loaded from and saved to `cache_file`. `get_file_hash` may
+    /// be called from several threads at once.
+    /// </summary>
+    struct FileHashCache
+    {
+        FileHashCache(Files::Filesystem& fs, fs::path cache_file);
+        FileHashCache(const FileHashCache&) = delete;
+        FileHashCache& operator=(const FileHashCache&) = delete;
+
+        std::string get_file_hash(const fs::path& path, Algorithm algo, std::error_code& ec);
+        std::string get_file_hash(LineInfo li, const fs::path& path, Algorithm algo);
+
+        /// <summary>Writes the entries back to the cache file if any were added.</summary>
+        void save();
+
+    private:
+        struct Entry
+        {
+            CacheFile::FileStamp stamp;
+            std::string hash;
+        };
+
+        Files::Filesystem& m_fs;
+        fs::path m_cache_file;
+        std::mutex m_mutex;
+        // keyed by "<algorithm>\t<path>"
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+    };
+}
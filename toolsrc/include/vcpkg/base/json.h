@@ -80,6 +80,8 @@ namespace vcpkg::Json
     namespace impl
     {
         struct ValueImpl;
+        struct Parser;
+        struct CursorImpl;
     }
 
     struct Value
@@ -285,6 +287,8 @@ namespace vcpkg::Json
         friend bool operator!=(const Object& lhs, const Object& rhs) { return !(lhs == rhs); }
 
     private:
+        friend struct impl::Parser;
+
         underlying_t underlying_;
     };
 
@@ -294,6 +298,46 @@ namespace vcpkg::Json
         StringView text, const fs::path& filepath = {}) noexcept;
     std::pair<Value, JsonStyle> parse_file(vcpkg::LineInfo linfo, const Files::Filesystem&, const fs::path&) noexcept;
 
+    /// <summary>
+    /// Walks a document while parsing it, for documents which are too large to be worth building as a whole, like the
+    /// baseline and the version database files. Objects and arrays can be entered and walked one member at a time;
+    /// the values of interest are built with `read`, and values which are neither entered nor read are skipped.
+    /// </summary>
+    /// <remarks>
+    /// Keys are views of `text` unless they contain escapes, so `text`, which may be a memory-mapped file, must outlive
+    /// the cursor. Errors are reported as `parse` reports them, including duplicate keys.
+    /// </remarks>
+    struct Cursor
+    {
+        explicit Cursor(StringView text, StringView origin = {});
+        Cursor(const Cursor&) = delete;
+        Cursor& operator=(const Cursor&) = delete;
+        ~Cursor();
+
+        // If the current value is an object (an array), enters it and returns true; otherwise returns false, and the
+        // value can still be read.
+        bool enter_object();
+        bool enter_array();
+
+        // Moves to the next member (element) of the innermost entered object (array). Returns false, leaving it, once
+        // it is closed or on an error.
+        bool next();
+
+        // The key of the current member of the innermost entered object.
+        StringView key() const;
+
+        Value read();
+
+        // Parses the rest of the document, and checks that nothing but whitespace follows it.
+        bool finish();
+
+        const Parse::IParseError* get_error() const;
+        std::unique_ptr<Parse::IParseError> extract_error();
+
+    private:
+        std::unique_ptr<impl::CursorImpl> m_impl;
+    };
+
     std::string stringify(const Value&, JsonStyle style);
     std::string stringify(const Object&, JsonStyle style);
     std::string stringify(const Array&, JsonStyle style);
@@ -132,6 +132,16 @@ namespace vcpkg::Json
             m_path.pop_back();
         }
 
+        // for documents walked with a Json::Cursor, whose containers are not visited as a whole: runs `f`, which
+        // visits the members of the value at `key`
+        template<class F>
+        void within_key(StringView key, F f)
+        {
+            m_path.push_back(key);
+            f();
+            m_path.pop_back();
+        }
+
         // returns whether key \in obj
         template<class Type>
         bool optional_object_field(const Object& obj, StringView key, Type& place, IDeserializer<Type>& visitor)
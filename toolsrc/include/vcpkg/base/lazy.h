@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 namespace vcpkg
 {
     template<typename T>
@@ -11,6 +13,7 @@ namespace vcpkg
         template<class F>
         T const& get_lazy(const F& f) const
         {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
             if (!initialized)
             {
                 value = f();
@@ -22,5 +25,6 @@ namespace vcpkg
     private:
         mutable T value;
         mutable bool initialized;
+        mutable std::recursive_mutex m_mutex;
     };
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/stringview.h>
+
+#include <system_error>
+
+namespace vcpkg::Files
+{
+    /// <summary>
+    /// A read-only memory mapping of a whole file. The mapped pages are only read from disk when they are touched, so
+    /// looking up a few entries of a large file does not read all of it.
+    /// </summary>
+    /// <remarks>
+    /// The mapping must not outlive changes to the file; replace files which may be mapped with a rename, as
+    /// CacheFile::write_contents_atomically does, rather than writing to them in place. On Windows, a mapped file cannot
+    /// be replaced at all, so release the mapping first.
+    /// </remarks>
+    struct MappedFile
+    {
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        static MappedFile open(const fs::path& path, std::error_code& ec);
+
+        StringView contents() const { return {m_data, m_size}; }
+        bool is_open() const { return m_is_open; }
+
+        void close();
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        bool m_is_open = false;
+#if defined(_WIN32)
+        void* m_mapping = nullptr;
+#endif
+    };
+}
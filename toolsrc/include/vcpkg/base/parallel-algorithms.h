@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vcpkg/base/system.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace vcpkg
+{
+    /// <summary>
+    /// Calls `work(i)` for every i in [0, work_count), on at most `max_threads` threads (the calling thread included).
+    /// Each thread claims the next unclaimed index, so uneven work items balance themselves.
+    /// </summary>
+    template<class F>
+    void execute_in_parallel(size_t work_count, size_t max_threads, F&& work)
+    {
+        const size_t thread_count = std::min(work_count, max_threads);
+        if (thread_count <= 1)
+        {
+            for (size_t i = 0; i < work_count; ++i)
+            {
+                work(i);
+            }
+
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < work_count; i = next.fetch_add(1))
+            {
+                work(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+        for (auto&& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    /// <summary>Like the above, on as many threads as there are logical cores.</summary>
+    template<class F>
+    void execute_in_parallel(size_t work_count, F&& work)
+    {
+        execute_in_parallel(
+            work_count, static_cast<size_t>(std::max(1, System::get_num_logical_cores())), std::forward<F>(work));
+    }
+
+    template<class RanIt, class F>
+    void parallel_for_each_n(RanIt first, size_t work_count, F&& cb)
+    {
+        execute_in_parallel(work_count, [&](size_t i) { cb(first[i]); });
+    }
+
+    template<class RanIt, class OutIt, class F>
+    void parallel_transform(RanIt first, size_t work_count, OutIt dest, F&& cb)
+    {
+        execute_in_parallel(work_count, [&](size_t i) { dest[i] = cb(first[i]); });
+    }
+}
@@ -101,6 +101,22 @@ namespace vcpkg::Parse
             return {start, m_it.pointer_to_current()};
         }
 
+        // Like match_zero_or_more, but only matches ASCII characters other than tab and newline; these can be
+        // skipped without decoding each one.
+        template<class Pred>
+        StringView match_ascii_zero_or_more(Pred p)
+        {
+            const char* start = m_it.pointer_to_current();
+            const char* last = start;
+            while (last != m_text.end() && static_cast<unsigned char>(*last) < 0x80 && *last != '\t' &&
+                   *last != '\n' && p(static_cast<char32_t>(*last)))
+            {
+                ++last;
+            }
+            skip_ascii_to(last);
+            return {start, last};
+        }
+
         StringView text() const { return m_text; }
         Unicode::Utf8Decoder it() const { return m_it; }
         char32_t cur() const { return m_it == m_it.end() ? Unicode::end_of_file : *m_it; }
@@ -116,6 +132,8 @@ namespace vcpkg::Parse
         std::unique_ptr<Parse::IParseError> extract_error() { return std::move(m_err); }
 
     private:
+        void skip_ascii_to(const char* position);
+
         Unicode::Utf8Decoder m_it;
         Unicode::Utf8Decoder m_start_of_line;
         int m_row;
@@ -10,7 +10,9 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <string.h>
 
+#include <string>
 #include <vector>
 
 namespace vcpkg::Strings::details
@@ -200,6 +202,56 @@ namespace vcpkg::Strings
 
     std::vector<std::string> split_paths(StringView s);
 
+    /// <summary>
+    /// Splits text which arrives in chunks into lines ending in '\n', which is not part of the line. Lines within one
+    /// chunk are passed on as views into it; only a line spanning chunks is copied, into a buffer which is reused.
+    /// </summary>
+    struct LineSplitter
+    {
+        template<class F>
+        void feed(StringView chunk, F&& per_line)
+        {
+            const char* first = chunk.begin();
+            const char* const last = chunk.end();
+            const char* newline = find_newline(first, last);
+            if (!m_partial.empty())
+            {
+                m_partial.append(first, newline);
+                if (newline == last) return;
+                per_line(StringView{m_partial});
+                m_partial.clear();
+                first = newline + 1;
+                newline = find_newline(first, last);
+            }
+
+            while (newline != last)
+            {
+                per_line(StringView{first, newline});
+                first = newline + 1;
+                newline = find_newline(first, last);
+            }
+
+            m_partial.append(first, last);
+        }
+
+        /// <summary>Passes on the text after the last '\n', which may be empty.</summary>
+        template<class F>
+        void finish(F&& per_line)
+        {
+            per_line(StringView{m_partial});
+            m_partial.clear();
+        }
+
+    private:
+        static const char* find_newline(const char* first, const char* last)
+        {
+            const auto newline = static_cast<const char*>(memchr(first, '\n', static_cast<size_t>(last - first)));
+            return newline ? newline : last;
+        }
+
+        std::string m_partial;
+    };
+
     const char* find_first_of(StringView searched, StringView candidates);
 
     std::vector<StringView> find_all_enclosed(StringView input, StringView left_delim, StringView right_delim);
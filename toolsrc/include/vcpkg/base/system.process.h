@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/span.h>
 #include <vcpkg/base/zstringview.h>
 
 #include <functional>
@@ -20,10 +22,17 @@ namespace vcpkg::System
         std::string s;
     };
 
-    std::string make_basic_cmake_cmd(const fs::path& cmake_tool_path,
-                                     const fs::path& cmake_script,
-                                     const std::vector<CMakeVariable>& pass_variables);
+    struct CmdLineBuilder;
 
+    CmdLineBuilder make_basic_cmake_cmd(const fs::path& cmake_tool_path,
+                                        const fs::path& cmake_script,
+                                        const std::vector<CMakeVariable>& pass_variables);
+
+    /// <summary>
+    /// Builds a command both as a command line, quoted for the platform's shell, and as the list of its arguments. The
+    /// cmd_execute family starts a built command without a shell where the platform allows it, unless `ampersand` made
+    /// it a command list which needs one.
+    /// </summary>
     struct CmdLineBuilder
     {
         CmdLineBuilder& path_arg(const fs::path& p) { return string_arg(fs::u8string(p)); }
@@ -32,14 +41,21 @@ namespace vcpkg::System
         {
             buf.push_back('&');
             buf.push_back('&');
+            m_needs_shell = true;
             return *this;
         }
         std::string extract() noexcept { return std::move(buf); }
 
         operator ZStringView() const { return buf; }
 
+        const std::string& command_line() const { return buf; }
+        const std::vector<std::string>& argv() const { return m_argv; }
+        bool needs_shell() const { return m_needs_shell; }
+
     private:
         std::string buf;
+        std::vector<std::string> m_argv;
+        bool m_needs_shell = false;
     };
 
     fs::path get_exe_path_of_current_process();
@@ -54,6 +70,9 @@ namespace vcpkg::System
     {
 #if defined(_WIN32)
         std::wstring m_env_data;
+#else
+        // "NAME=value" entries; if empty, the new process inherits the current environment.
+        std::vector<std::string> m_env_data;
 #endif
     };
 
@@ -61,8 +80,12 @@ namespace vcpkg::System
     Environment get_modified_clean_environment(const std::unordered_map<std::string, std::string>& extra_env,
                                                const std::string& prepend_to_path = {});
 
+    // The overloads taking a command line string run it through the shell (/bin/sh or cmd.exe); use a CmdLineBuilder
+    // for commands which do not need one.
     int cmd_execute(const ZStringView cmd_line, const Environment& env = {});
+    int cmd_execute(const CmdLineBuilder& cmd_line, const Environment& env = {});
     int cmd_execute_clean(const ZStringView cmd_line);
+    int cmd_execute_clean(const CmdLineBuilder& cmd_line);
 
 #if defined(_WIN32)
     Environment cmd_execute_modify_env(const ZStringView cmd_line, const Environment& env = {});
@@ -71,14 +94,29 @@ namespace vcpkg::System
 #endif
 
     ExitCodeAndOutput cmd_execute_and_capture_output(const ZStringView cmd_line, const Environment& env = {});
+    ExitCodeAndOutput cmd_execute_and_capture_output(const CmdLineBuilder& cmd_line, const Environment& env = {});
 
     int cmd_execute_and_stream_lines(const ZStringView cmd_line,
-                                     std::function<void(const std::string&)> per_line_cb,
+                                     std::function<void(StringView)> per_line_cb,
+                                     const Environment& env = {});
+    int cmd_execute_and_stream_lines(const CmdLineBuilder& cmd_line,
+                                     std::function<void(StringView)> per_line_cb,
                                      const Environment& env = {});
 
     int cmd_execute_and_stream_data(const ZStringView cmd_line,
                                     std::function<void(StringView)> data_cb,
                                     const Environment& env = {});
+    int cmd_execute_and_stream_data(const CmdLineBuilder& cmd_line,
+                                    std::function<void(StringView)> data_cb,
+                                    const Environment& env = {});
+
+    /// <summary>
+    /// Runs all of `cmd_lines`, as many at once as there are logical cores, and captures the output of each. On
+    /// non-Windows, the children's output is multiplexed with poll() on the calling thread instead of a thread each.
+    /// </summary>
+    std::vector<ExitCodeAndOutput> cmd_execute_and_capture_output_parallel(View<CmdLineBuilder> cmd_lines,
+                                                                           const Environment& env = {});
+
     void register_console_ctrl_handler();
 #if defined(_WIN32)
     void initialize_global_job_object();
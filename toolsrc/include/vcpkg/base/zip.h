@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vcpkg/base/expected.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/stringview.h>
+
+#include <stdint.h>
+
+#include <string>
+
+namespace vcpkg::Zip
+{
+    uint32_t crc32(StringView data, uint32_t crc = 0) noexcept;
+
+    /// <summary>Compresses `data` into a raw DEFLATE (RFC 1951) stream.</summary>
+    std::string deflate(StringView data);
+
+    /// <summary>Decompresses the raw DEFLATE (RFC 1951) stream `data`.</summary>
+    /// <param name="size_hint">The expected decompressed size, if known; used to reserve the output.</param>
+    ExpectedS<std::string> inflate(StringView data, size_t size_hint = 0);
+
+    /// <summary>
+    /// Writes every file, directory and symlink under `source` into a new zip archive at `destination`. Entries are
+    /// compressed on all cores and stamped with a fixed time, so archiving identical trees gives identical archives.
+    /// Entries are deflated unless they are already compressed or do not shrink; large files are streamed.
+    /// </summary>
+    /// <returns>The number of entries in the archive.</returns>
+    ExpectedS<size_t> compress_directory(const Files::Filesystem& fs,
+                                         const fs::path& source,
+                                         const fs::path& destination);
+
+    /// <summary>
+    /// Extracts the zip archive `archive` into the directory `destination`, restoring symlinks and (on POSIX)
+    /// permissions. Entries are decompressed on up to `max_threads` threads, or on all cores if it is 0.
+    /// </summary>
+    /// <returns>The number of entries extracted.</returns>
+    ExpectedS<size_t> decompress_archive(Files::Filesystem& fs,
+                                         const fs::path& archive,
+                                         const fs::path& destination,
+                                         size_t max_threads = 0);
+}
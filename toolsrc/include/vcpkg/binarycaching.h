@@ -21,6 +21,10 @@ namespace vcpkg
         build_failed,
     };
 
+    /// <remarks>
+    /// Parallel installs call try_restore() and push_success() for different actions at the same time, once prefetch()
+    /// has returned; implementations lock whatever state those calls share.
+    /// </remarks>
     struct IBinaryProvider
     {
         virtual ~IBinaryProvider() = default;
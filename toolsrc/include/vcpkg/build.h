@@ -4,6 +4,7 @@
 #include <vcpkg/fwd/dependencies.h>
 #include <vcpkg/fwd/portfileprovider.h>
 
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/cstringview.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/optional.h>
@@ -18,7 +19,9 @@
 
 #include <array>
 #include <map>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace vcpkg
@@ -242,6 +245,26 @@ namespace vcpkg::Build
                                       const IBuildLogsRecorder& build_logs_recorder,
                                       const StatusParagraphs& status_db);
 
+    /// <summary>Returns the feature dependencies of `action` which are not installed in `status_db`.</summary>
+    std::vector<FeatureSpec> find_missing_dependencies(const Dependencies::InstallPlanAction& action,
+                                                       const StatusParagraphs& status_db);
+
+    /// <summary>
+    /// Like build_package(), but does not consult the status database. The caller is responsible for checking
+    /// find_missing_dependencies() first. May be called concurrently for different actions.
+    /// </summary>
+    ExtendedBuildResult build_package_with_installed_dependencies(const VcpkgCmdArguments& args,
+                                                                  const VcpkgPaths& paths,
+                                                                  const Dependencies::InstallPlanAction& action,
+                                                                  IBinaryProvider& binaries_provider,
+                                                                  const IBuildLogsRecorder& build_logs_recorder);
+
+    /// <summary>
+    /// Configures builds for running `jobs` packages at once, each of which is told through VCPKG_CONCURRENCY that
+    /// it may use `cores_per_job` cores. When more than one job runs, build output only goes to the log files.
+    /// </summary>
+    void set_parallel_build_jobs(size_t jobs, int cores_per_job);
+
     enum class BuildPolicy
     {
         EMPTY_PACKAGE,
@@ -320,6 +343,8 @@ namespace vcpkg::Build
         std::string id;
         std::string version;
         std::string hash;
+        // The C and C++ compilers the information was detected from
+        std::vector<fs::path> compiler_paths;
     };
 
     struct AbiInfo
@@ -337,6 +362,46 @@ namespace vcpkg::Build
                           const CMakeVars::CMakeVarProvider& var_provider,
                           const StatusParagraphs& status_db);
 
+    /// <summary>
+    /// The environment variables which, besides the triplet and toolchain files, decide the compiler CMake finds, as
+    /// "NAME=value" lines.
+    /// </summary>
+    std::string get_compiler_environment();
+
+    /// <summary>
+    /// Compiler information detected by earlier runs, stored in `cache_file` by a key that describes the triplet file,
+    /// toolchain file and environment it was detected with. An entry is only found while the compilers it was
+    /// detected from are unchanged.
+    /// </summary>
+    /// <remarks>
+    /// Not thread safe; EnvCache serializes access.
+    /// </remarks>
+    struct CompilerInfoStore
+    {
+        CompilerInfoStore(Files::Filesystem& fs, fs::path cache_file);
+        CompilerInfoStore(const CompilerInfoStore&) = delete;
+        CompilerInfoStore& operator=(const CompilerInfoStore&) = delete;
+
+        Optional<CompilerInfo> find(const std::string& key) const;
+
+        /// <summary>
+        /// Stores `info` and writes the cache file, unless a compiler cannot be stamped or a field cannot be stored.
+        /// </summary>
+        void insert(const std::string& key, const CompilerInfo& info);
+
+    private:
+        struct Entry
+        {
+            CompilerInfo info;
+            // the stamps of info.compiler_paths when the information was detected
+            std::vector<CacheFile::FileStamp> stamps;
+        };
+
+        Files::Filesystem& m_fs;
+        fs::path m_cache_file;
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+
     struct EnvCache
     {
         explicit EnvCache(bool compiler_tracking) : m_compiler_tracking(compiler_tracking) { }
@@ -355,6 +420,14 @@ namespace vcpkg::Build
         Cache<fs::path, TripletMapEntry> m_triplet_cache;
         Cache<fs::path, std::string> m_toolchain_cache;
 
+        CompilerInfo detect_compiler_info(const VcpkgPaths& paths,
+                                          const AbiInfo& abi_info,
+                                          const std::string& triplet_hash,
+                                          const std::string& toolchain_hash);
+
+        std::mutex m_stored_mutex;
+        std::unique_ptr<CompilerInfoStore> m_stored_compiler_info;
+
 #if defined(_WIN32)
         struct EnvMapEntry
         {
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vcpkg/fwd/vcpkgpaths.h>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/span.h>
+#include <vcpkg/base/stringliteral.h>
+#include <vcpkg/base/stringview.h>
+
+#include <vcpkg/packagespec.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vcpkg::CMakeVars::details
+{
+    /// <summary>
+    /// Remembers extracted variables by a key describing everything the extraction read, so that later vcpkg
+    /// invocations need not launch cmake again. Unused entries are dropped once there are too many.
+    /// </summary>
+    struct CMakeVarCache
+    {
+        CMakeVarCache(Files::Filesystem& fs, fs::path cache_file);
+        CMakeVarCache(const CMakeVarCache&) = delete;
+        CMakeVarCache& operator=(const CMakeVarCache&) = delete;
+
+        const std::vector<std::pair<std::string, std::string>>* find(const std::string& key);
+        void insert(const std::string& key, const std::vector<std::pair<std::string, std::string>>& vars);
+        void save();
+
+    private:
+        struct Entry
+        {
+            std::vector<std::pair<std::string, std::string>> vars;
+            bool used;
+        };
+
+        Files::Filesystem& m_fs;
+        fs::path m_cache_file;
+        std::map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+    };
+
+    /// <summary>
+    /// Computes the CMakeVarCache keys of extractions. A key covers the contents of the scripts and of the triplet
+    /// and ABI settings files, and the environment variables they read; the contents of a file are read once per
+    /// CMakeVarKeys.
+    /// </summary>
+    /// <remarks>
+    /// An extraction whose triplet or ABI settings file calls include() has no key, because the included files
+    /// are not covered.
+    /// </remarks>
+    struct CMakeVarKeys
+    {
+        explicit CMakeVarKeys(const VcpkgPaths& paths);
+
+        Optional<std::string> get_tag_key(const FullPackageSpec& spec, const std::string& abi_settings_path);
+        Optional<std::string> get_dep_info_key(const PackageSpec& spec);
+
+    private:
+        struct FileKey
+        {
+            std::string hash;
+            bool includes_other_files;
+        };
+
+        const FileKey& get_file_key(const fs::path& path);
+        const std::string& get_prelude_key(Triplet triplet);
+
+        const VcpkgPaths& m_paths;
+        fs::path m_get_tags_path;
+        fs::path m_get_dep_info_path;
+        std::unordered_map<std::string, FileKey> m_file_keys;
+        std::unordered_map<Triplet, std::string> m_prelude_keys;
+    };
+
+    /// <summary>
+    /// Whether the cmake code `text` calls include(). Comments and quoted arguments are skipped; any other mention,
+    /// such as in a bracket argument or a command whose name ends in "include", counts, which only costs a cache
+    /// miss.
+    /// </summary>
+    bool includes_other_files(StringView text);
+
+    /// <summary>
+    /// Splits the output of an extraction script into the variables of each port as the lines arrive. Lines outside
+    /// of a port's variable blocks (for example, cmake errors) are kept for diagnostics.
+    /// </summary>
+    /// <remarks>
+    /// A malformed variable line does not stop the parser; it is recorded in `error` for the caller to report.
+    /// </remarks>
+    struct ExtractionOutputParser
+    {
+        static constexpr StringLiteral PORT_START_GUID = "d8187afd-ea4a-4fc3-9aa4-a6782e1ed9af";
+        static constexpr StringLiteral PORT_END_GUID = "8c504940-be29-4cba-9f8f-6cd83e9d87b7";
+        static constexpr StringLiteral BLOCK_START_GUID = "c35112b6-d1ba-415b-aa5d-81de856ef8eb";
+        static constexpr StringLiteral BLOCK_END_GUID = "e1e74b5c-18cb-4474-a6bd-5c1c8bc81f3f";
+
+        explicit ExtractionOutputParser(Span<std::vector<std::pair<std::string, std::string>>> vars)
+            : vars(vars), current_port(vars.begin())
+        {
+        }
+
+        void operator()(StringView line);
+
+        std::string other_output;
+        // the first malformed variable line, if any
+        Optional<std::string> error;
+
+    private:
+        enum class State
+        {
+            OutsidePort,
+            InPort,
+            InBlock,
+        };
+
+        Span<std::vector<std::pair<std::string, std::string>>> vars;
+        std::vector<std::pair<std::string, std::string>>* current_port;
+        State state = State::OutsidePort;
+    };
+
+    struct ExtractionShard
+    {
+        size_t first;
+        size_t count;
+    };
+
+    /// <summary>
+    /// Splits `item_count` items into at most `max_shards` contiguous shards. Each cmake process has a fixed startup
+    /// cost, so small requests are not split up.
+    /// </summary>
+    std::vector<ExtractionShard> get_extraction_shards(size_t item_count, size_t max_shards);
+
+    /// <summary>
+    /// Runs `run_shard` for every shard concurrently, giving it the elements of `vars` that belong to the shard's
+    /// items, so that the variables of items[i] end up in vars[i] regardless of which shard finishes first.
+    /// `run_shard` returns an error message instead of exiting, because it does not run on the calling thread.
+    /// </summary>
+    /// <returns>The error of the first failing shard in shard order, if any.</returns>
+    Optional<std::string> run_extraction_shards(
+        View<ExtractionShard> shards,
+        std::vector<std::vector<std::pair<std::string, std::string>>>& vars,
+        const std::function<Optional<std::string>(size_t, Span<std::vector<std::pair<std::string, std::string>>>)>&
+            run_shard);
+}
@@ -1,10 +1,24 @@
 #pragma once
 
+#include <vcpkg/base/files.h>
+
 #include <vcpkg/commands.interface.h>
+#include <vcpkg/vcpkgcmdarguments.h>
+
+#include <string>
+#include <unordered_map>
 
 namespace vcpkg::Commands::Env
 {
     extern const CommandStructure COMMAND_STRUCTURE;
+
+    /// <summary>
+    /// The environment variables which the switches of `vcpkg env` add for the installed tree `installed_triplet_dir`.
+    /// </summary>
+    std::unordered_map<std::string, std::string> get_installed_env(const Files::Filesystem& fs,
+                                                                   const fs::path& installed_triplet_dir,
+                                                                   const ParsedArguments& options);
+
     void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths, Triplet default_triplet);
 
     struct EnvCommand : TripletCommand
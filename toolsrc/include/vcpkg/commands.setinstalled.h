@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vcpkg/fwd/install.h>
+
 #include <vcpkg/cmakevars.h>
 #include <vcpkg/commands.interface.h>
 #include <vcpkg/portfileprovider.h>
@@ -14,7 +16,8 @@ namespace vcpkg::Commands::SetInstalled
                              const CMakeVars::CMakeVarProvider& cmake_vars,
                              Dependencies::ActionPlan action_plan,
                              DryRun dry_run,
-                             const Optional<fs::path>& pkgsconfig_path);
+                             const Optional<fs::path>& pkgsconfig_path,
+                             Optional<Install::ManifestFingerprint&> fingerprint);
     void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths, Triplet default_triplet);
 
     struct SetInstalledCommand : TripletCommand
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace vcpkg::Install
+{
+    struct ManifestFingerprint;
+}
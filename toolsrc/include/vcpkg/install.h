@@ -71,18 +71,73 @@ namespace vcpkg::Install
         SUCCESS,
     };
 
+    /// <summary>How the files of a package are placed in the destination directory.</summary>
+    /// <remarks>Whichever way is chosen, files are copied where the filesystems involved do not support it.</remarks>
+    enum class InstallFileMode
+    {
+        // Clone the files, or hard link them where the filesystem cannot clone; for sources which are kept. Hard
+        // linked files are shared with the source, so writing to one changes the other.
+        LINK,
+        // Rename the files into place; for sources which are deleted afterwards.
+        MOVE,
+    };
+
     std::vector<std::string> get_all_port_names(const VcpkgPaths& paths);
 
-    void install_package_and_write_listfile(const VcpkgPaths& paths, const PackageSpec& spec, const InstallDir& dirs);
+    void install_package_and_write_listfile(const VcpkgPaths& paths,
+                                            const PackageSpec& spec,
+                                            const InstallDir& dirs,
+                                            InstallFileMode mode);
 
     void install_files_and_write_listfile(Files::Filesystem& fs,
                                           const fs::path& source_dir,
                                           const std::vector<fs::path>& files,
-                                          const InstallDir& destination_dir);
+                                          const InstallDir& destination_dir,
+                                          InstallFileMode mode);
 
     InstallResult install_package(const VcpkgPaths& paths,
                                   const BinaryControlFile& binary_paragraph,
-                                  StatusParagraphs* status_db);
+                                  StatusParagraphs* status_db,
+                                  InstallFileMode mode);
+
+    /// <summary>The steps of running an install action, see run_install_actions_in_parallel.</summary>
+    struct IInstallActionRunner
+    {
+        virtual ~IInstallActionRunner() = default;
+
+        /// <summary>
+        /// Called once the dependencies of `action` within the plan have finished. Returns the result of an action
+        /// which is done without a build, such as one whose dependencies are missing.
+        /// </summary>
+        virtual Optional<Build::ExtendedBuildResult> start(Dependencies::InstallPlanAction& action) = 0;
+
+        /// <summary>Builds `action`; called on a worker thread, alongside other builds.</summary>
+        virtual Build::ExtendedBuildResult build(const Dependencies::InstallPlanAction& action) = 0;
+
+        /// <summary>Installs what build() produced, and returns the result of `action`.</summary>
+        virtual Build::ExtendedBuildResult install(Dependencies::InstallPlanAction& action,
+                                                   Build::ExtendedBuildResult&& result) = 0;
+
+        /// <summary>Receives the result of `action`, while `builds_running` other builds are still running.</summary>
+        virtual void finish(Dependencies::InstallPlanAction& action,
+                            Build::ExtendedBuildResult&& result,
+                            size_t builds_running) = 0;
+    };
+
+    /// <summary>
+    /// Runs up to `jobs` builds at once, starting each action as soon as its dependencies within `actions` have
+    /// finished, and otherwise in the order of `actions`. Everything but `runner.build()` is called on the calling
+    /// thread. An action which does not succeed stops further actions from starting, unless `keep_going` is YES; then
+    /// its dependents are started anyway, so that `runner.start()` can cascade the failure.
+    /// </summary>
+    /// <remarks>
+    /// A build which tries to exit the tool stops further actions from starting; the calling thread exits with the same
+    /// code once the other running builds are done.
+    /// </remarks>
+    void run_install_actions_in_parallel(std::vector<Dependencies::InstallPlanAction>& actions,
+                                         size_t jobs,
+                                         KeepGoing keep_going,
+                                         IInstallActionRunner& runner);
 
     InstallSummary perform(const VcpkgCmdArguments& args,
                            Dependencies::ActionPlan& action_plan,
@@ -103,6 +158,45 @@ namespace vcpkg::Install
 
     CMakeUsageInfo get_cmake_usage(const BinaryParagraph& bpgh, const VcpkgPaths& paths);
 
+    /// <summary>
+    /// The inputs of a manifest mode install, saved to `installed/vcpkg/manifest-fingerprint` once the install
+    /// succeeds. An install whose inputs and tracked files are unchanged since then has nothing to do, so it can stop
+    /// before planning. The inputs include the command line options and the environment variables which select the
+    /// compilers and binary caches. Tracked files are compared by size and write time; tools other than the compilers
+    /// are not tracked.
+    /// </summary>
+    struct ManifestFingerprint
+    {
+        ManifestFingerprint(const VcpkgPaths& paths,
+                            const VcpkgCmdArguments& args,
+                            const ParsedArguments& options,
+                            Triplet default_triplet,
+                            const std::vector<std::string>& features);
+
+        bool is_up_to_date() const;
+
+        /// <summary>
+        /// Tracks the port directories, toolchain files and compilers used by `plan`, whose ABIs must have been
+        /// computed.
+        /// </summary>
+        void track_plan(const Dependencies::ActionPlan& plan);
+
+        void save() const;
+
+    private:
+        std::string contents(const std::vector<fs::path>& stat_paths, const std::vector<fs::path>& tree_paths) const;
+
+        const VcpkgPaths& m_paths;
+        fs::path m_fingerprint_file;
+        Triplet m_triplet;
+        bool m_versions;
+        std::string m_inputs;
+        // Files and directories tracked by their own size and write time
+        std::vector<fs::path> m_stat_paths;
+        // Directories tracked by the sizes and write times of everything below them
+        std::vector<fs::path> m_tree_paths;
+    };
+
     extern const CommandStructure COMMAND_STRUCTURE;
 
     void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths, Triplet default_triplet);
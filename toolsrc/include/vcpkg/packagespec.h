@@ -15,6 +15,29 @@ namespace vcpkg::Parse
 
 namespace vcpkg
 {
+    ///
+    /// <summary>
+    /// A port or feature name. Names are interned in a process-wide table like triplets, so copies share one string,
+    /// and equality and hashing do not look at the characters.
+    /// </summary>
+    ///
+    struct InternedName
+    {
+        InternedName() noexcept;
+        explicit InternedName(StringView name);
+
+        const std::string& str() const { return m_instance->first; }
+        size_t hash_code() const { return m_instance->second; }
+
+        bool operator==(InternedName other) const { return m_instance == other.m_instance; }
+        bool operator!=(InternedName other) const { return m_instance != other.m_instance; }
+        bool operator<(InternedName other) const { return m_instance != other.m_instance && str() < other.str(); }
+
+    private:
+        // the name and its hash
+        const std::pair<const std::string, size_t>* m_instance;
+    };
+
     ///
     /// <summary>
     /// Full specification of a package. Contains all information to reference
@@ -24,13 +47,15 @@ namespace vcpkg
     struct PackageSpec
     {
         PackageSpec() = default;
-        PackageSpec(std::string name, Triplet triplet) : m_name(std::move(name)), m_triplet(triplet) { }
+        PackageSpec(const std::string& name, Triplet triplet) : m_name(name), m_triplet(triplet) { }
+        PackageSpec(InternedName name, Triplet triplet) : m_name(name), m_triplet(triplet) { }
 
         static std::vector<PackageSpec> to_package_specs(const std::vector<std::string>& ports, Triplet triplet);
 
-        const std::string& name() const;
+        const std::string& name() const { return m_name.str(); }
+        InternedName interned_name() const { return m_name; }
 
-        Triplet triplet() const;
+        Triplet triplet() const { return m_triplet; }
 
         std::string dir() const;
 
@@ -39,17 +64,19 @@ namespace vcpkg
 
         bool operator<(const PackageSpec& other) const
         {
-            if (name() < other.name()) return true;
-            if (name() > other.name()) return false;
+            if (m_name != other.m_name) return m_name < other.m_name;
             return triplet() < other.triplet();
         }
 
     private:
-        std::string m_name;
+        InternedName m_name;
         Triplet m_triplet;
     };
 
-    bool operator==(const PackageSpec& left, const PackageSpec& right);
+    inline bool operator==(const PackageSpec& left, const PackageSpec& right)
+    {
+        return left.interned_name() == right.interned_name() && left.triplet() == right.triplet();
+    }
     inline bool operator!=(const PackageSpec& left, const PackageSpec& right) { return !(left == right); }
 
     ///
@@ -61,9 +88,11 @@ namespace vcpkg
     struct FeatureSpec
     {
         FeatureSpec(const PackageSpec& spec, const std::string& feature) : m_spec(spec), m_feature(feature) { }
+        FeatureSpec(const PackageSpec& spec, InternedName feature) : m_spec(spec), m_feature(feature) { }
 
         const std::string& name() const { return m_spec.name(); }
-        const std::string& feature() const { return m_feature; }
+        const std::string& feature() const { return m_feature.str(); }
+        InternedName interned_feature() const { return m_feature; }
         Triplet triplet() const { return m_spec.triplet(); }
 
         const PackageSpec& spec() const { return m_spec; }
@@ -73,23 +102,25 @@ namespace vcpkg
 
         bool operator<(const FeatureSpec& other) const
         {
-            if (name() < other.name()) return true;
-            if (name() > other.name()) return false;
-            if (feature() < other.feature()) return true;
-            if (feature() > other.feature()) return false;
+            if (m_spec.interned_name() != other.m_spec.interned_name())
+            {
+                return m_spec.interned_name() < other.m_spec.interned_name();
+            }
+
+            if (m_feature != other.m_feature) return m_feature < other.m_feature;
             return triplet() < other.triplet();
         }
 
         bool operator==(const FeatureSpec& other) const
         {
-            return triplet() == other.triplet() && name() == other.name() && feature() == other.feature();
+            return m_spec == other.m_spec && m_feature == other.m_feature;
         }
 
         bool operator!=(const FeatureSpec& other) const { return !(*this == other); }
 
     private:
         PackageSpec m_spec;
-        std::string m_feature;
+        InternedName m_feature;
     };
 
     ///
@@ -195,12 +226,18 @@ namespace std
         size_t operator()(const vcpkg::PackageSpec& value) const
         {
             size_t hash = 17;
-            hash = hash * 31 + std::hash<std::string>()(value.name());
+            hash = hash * 31 + value.interned_name().hash_code();
             hash = hash * 31 + std::hash<vcpkg::Triplet>()(value.triplet());
             return hash;
         }
     };
 
+    template<>
+    struct hash<vcpkg::InternedName>
+    {
+        size_t operator()(vcpkg::InternedName value) const { return value.hash_code(); }
+    };
+
     template<>
     struct equal_to<vcpkg::PackageSpec>
     {
@@ -213,7 +250,7 @@ namespace std
         size_t operator()(const vcpkg::FeatureSpec& value) const
         {
             size_t hash = std::hash<vcpkg::PackageSpec>()(value.spec());
-            hash = hash * 31 + std::hash<std::string>()(value.feature());
+            hash = hash * 31 + value.interned_feature().hash_code();
             return hash;
         }
     };
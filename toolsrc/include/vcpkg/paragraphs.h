@@ -6,6 +6,11 @@
 
 #include <vcpkg/binaryparagraph.h>
 
+namespace vcpkg
+{
+    struct PortCatalog;
+}
+
 namespace vckpg::Parse
 {
     struct ParseControlErrorInfo;
@@ -53,6 +58,11 @@ namespace vcpkg::Paragraphs
         const std::string& operator()(const SourceControlFile& scf) const { return scf.core_paragraph->name; }
     } get_name_of_control_file;
 
+    // Loads the ports in `port_dirs` on several threads; the results keep the order of `port_dirs`.
+    // If `catalog` is given, unchanged ports are answered from it and the others are remembered in it.
+    LoadResults try_load_ports(const Files::Filesystem& fs,
+                               std::vector<fs::path> port_dirs,
+                               PortCatalog* catalog = nullptr);
     LoadResults try_load_all_registry_ports(const VcpkgPaths& paths);
 
     std::vector<SourceControlFileLocation> load_all_registry_ports(const VcpkgPaths& paths);
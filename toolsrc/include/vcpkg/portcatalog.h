@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vcpkg/base/cachefile.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/mappedfile.h>
+#include <vcpkg/base/stringview.h>
+
+#include <vcpkg/paragraphparser.h>
+#include <vcpkg/sourceparagraph.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vcpkg
+{
+    /// <summary>
+    /// Remembers the parsed port files of port directories in `catalog_file`, so that an unchanged port is answered
+    /// without opening or parsing its CONTROL or vcpkg.json. An entry is used only while the write time of the port
+    /// directory (which changes when a port file is added or removed) and the size and write time of its port file are
+    /// unchanged; anything else is loaded with Paragraphs::try_load_port.
+    /// </summary>
+    /// <remarks>
+    /// The catalog file is memory-mapped, and an entry is only decoded when its port is asked for.
+    /// `try_load_port` may be called from several threads at once.
+    /// </remarks>
+    struct PortCatalog
+    {
+        PortCatalog(Files::Filesystem& fs, fs::path catalog_file);
+        PortCatalog(const PortCatalog&) = delete;
+        PortCatalog& operator=(const PortCatalog&) = delete;
+
+        Parse::ParseExpected<SourceControlFile> try_load_port(const fs::path& port_dir);
+
+        /// <summary>
+        /// Writes the entries back to the catalog file if any were added. Entries of port directories which no longer
+        /// exist are dropped.
+        /// </summary>
+        void save();
+
+    private:
+        struct Stamps
+        {
+            CacheFile::FileStamp directory;
+            bool is_manifest;
+            CacheFile::FileStamp port_file;
+        };
+
+        struct Entry
+        {
+            Stamps stamps;
+            // the encoded SourceControlFile, in m_mapping
+            StringView data;
+        };
+
+        void load();
+
+        Files::Filesystem& m_fs;
+        fs::path m_catalog_file;
+        Files::MappedFile m_mapping;
+        // keyed by the port directory; read-only after load()
+        std::unordered_map<std::string, Entry> m_entries;
+
+        std::mutex m_mutex;
+        std::unordered_map<std::string, std::pair<Stamps, std::string>> m_added;
+    };
+}
@@ -3,6 +3,9 @@
 
 #include <iterator>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace vcpkg
 {
@@ -75,7 +78,18 @@ namespace vcpkg
         const_iterator begin() const { return paragraphs.rbegin(); }
 
     private:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /// <returns>The position in `paragraphs` of the last paragraph with the given key, or `npos`.</returns>
+        size_t find_position(const std::string& name, Triplet triplet, const std::string& feature) const;
+
+        template<class F>
+        void for_each_position(const std::string& name, Triplet triplet, F cb) const;
+
         std::vector<std::unique_ptr<StatusParagraph>> paragraphs;
+        // Positions in `paragraphs` of every paragraph of a package name, in increasing order. Paragraphs are only
+        // ever appended or replaced in place, so positions stay valid.
+        std::unordered_map<std::string, std::vector<size_t>> positions_by_name;
     };
 
     void serialize(const StatusParagraphs& pgh, std::string& out_str);
@@ -33,5 +33,9 @@ namespace vcpkg
         virtual const std::string& get_tool_version(const VcpkgPaths& paths, const std::string& tool) const = 0;
     };
 
-    std::unique_ptr<ToolCache> get_tool_cache();
+    /// <summary>
+    /// Tools found by earlier vcpkg invocations are remembered in the tools directory and used again while their
+    /// executables are unchanged. With `revalidate`, every tool is looked for again.
+    /// </summary>
+    std::unique_ptr<ToolCache> get_tool_cache(bool revalidate);
 }
@@ -154,6 +154,11 @@ namespace vcpkg
         constexpr static StringLiteral CMAKE_SCRIPT_ARG = "x-cmake-args";
         std::vector<std::string> cmake_args;
 
+        constexpr static StringLiteral JOBS_ARG = "x-jobs";
+        std::unique_ptr<std::string> jobs;
+        constexpr static StringLiteral CORES_PER_JOB_ARG = "x-cores-per-job";
+        std::unique_ptr<std::string> cores_per_job;
+
         constexpr static StringLiteral DEBUG_SWITCH = "debug";
         Optional<bool> debug = nullopt;
         constexpr static StringLiteral SEND_METRICS_SWITCH = "sendmetrics";
@@ -175,6 +180,9 @@ namespace vcpkg
         constexpr static StringLiteral JSON_SWITCH = "x-json";
         Optional<bool> json = nullopt;
 
+        constexpr static StringLiteral REVALIDATE_TOOLS_SWITCH = "x-revalidate-tools";
+        Optional<bool> revalidate_tools = nullopt;
+
         // feature flags
         constexpr static StringLiteral FEATURE_FLAGS_ENV = "VCPKG_FEATURE_FLAGS";
         constexpr static StringLiteral FEATURE_FLAGS_ARG = "feature-flags";
@@ -2,15 +2,25 @@
 
 #include <vcpkg/fwd/vcpkgpaths.h>
 
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/sortedvector.h>
+#include <vcpkg/base/span.h>
 
 #include <vcpkg/statusparagraphs.h>
 
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace vcpkg
 {
     StatusParagraphs database_load_check(const VcpkgPaths& paths);
 
-    void write_update(const VcpkgPaths& paths, const StatusParagraph& p);
+    /// <summary>
+    /// Records a batch of state transitions in the status database with a single append to its journal.
+    /// </summary>
+    void write_updates(const VcpkgPaths& paths, View<StatusParagraph> pghs);
 
     struct StatusParagraphAndAssociatedFiles
     {
@@ -22,5 +32,54 @@ namespace vcpkg
     std::vector<StatusParagraphAndAssociatedFiles> get_installed_files(const VcpkgPaths& paths,
                                                                        const StatusParagraphs& status_db);
 
+    /// <summary>
+    /// Maps every file in the installed tree to the package that owns it. The index is saved next to the status
+    /// file; when it is loaded, only the listfiles which changed since it was saved are read again.
+    /// </summary>
+    struct InstalledFilesIndex
+    {
+        struct Owner
+        {
+            std::string displayname;
+            // {-1, -1} for a listfile which is missing, or was written too recently to be trusted
+            CacheFile::FileStamp listfile_stamp{-1, -1};
+            // Paths relative to the installed directory, for example "x64-windows/include/zlib.h". Directories are
+            // not included.
+            std::vector<std::string> files;
+        };
+
+        /// <summary>
+        /// Returns the index of the installed tree of `paths`, which is kept by `paths`, brought up to date with
+        /// `status_db`. The first call loads the index and reads the listfiles which changed since it was saved; later
+        /// calls only add and remove the packages which `status_db` installed or removed meanwhile.
+        /// </summary>
+        static InstalledFilesIndex& get(const VcpkgPaths& paths, const StatusParagraphs& status_db);
+
+        /// <returns>The owner of `file`, a path relative to the installed directory; or nullptr.</returns>
+        const Owner* find_owner(const std::string& file) const;
+
+        /// <summary>Records the listfile of the installed package `core_paragraph`.</summary>
+        void add_package(const VcpkgPaths& paths, const BinaryParagraph& core_paragraph);
+
+        void remove_package(const BinaryParagraph& core_paragraph);
+
+        /// <summary>Keyed by listfile name, see BinaryParagraph::fullstem().</summary>
+        const std::map<std::string, Owner>& owners() const { return m_owners; }
+
+        /// <summary>Writes the index to disk, if it changed since it was loaded.</summary>
+        void save(const VcpkgPaths& paths);
+
+    private:
+        void load(const VcpkgPaths& paths, const StatusParagraphs& status_db);
+        void sync(const VcpkgPaths& paths, const StatusParagraphs& status_db);
+        void index_files(const Owner& owner);
+        void unindex_files(const Owner& owner);
+
+        std::map<std::string, Owner> m_owners;
+        std::unordered_map<std::string, const Owner*> m_file_owners;
+        bool m_loaded = false;
+        bool m_dirty = false;
+    };
+
     std::string shorten_text(const std::string& desc, const size_t length);
 } // namespace vcpkg
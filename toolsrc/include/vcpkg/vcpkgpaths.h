@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vcpkg/base/fwd/git.h>
 #include <vcpkg/base/fwd/json.h>
 
 #include <vcpkg/fwd/configuration.h>
@@ -51,7 +52,9 @@ namespace vcpkg
     }
 
     struct BinaryParagraph;
+    struct InstalledFilesIndex;
     struct PackageSpec;
+    struct PortCatalog;
     struct Triplet;
 
     struct VcpkgPaths : Util::MoveOnlyBase
@@ -117,10 +120,18 @@ namespace vcpkg
         const std::string& get_tool_version(const std::string& tool) const;
 
         // Git manipulation
+        // The objects of the git repository at `root`, read without running git
+        const Git::ObjectStore& get_git_objects() const;
         fs::path git_checkout_baseline(Files::Filesystem& filesystem, StringView commit_sha) const;
         fs::path git_checkout_port(Files::Filesystem& filesystem, StringView port_name, StringView git_tree) const;
         ExpectedS<std::string> git_show(const std::string& treeish, const fs::path& dot_git_dir) const;
 
+        // The parsed port files remembered across runs, in buildtrees/port-catalog
+        PortCatalog& get_port_catalog() const;
+
+        // The owners of the files in the installed tree; see InstalledFilesIndex::get, which brings it up to date
+        InstalledFilesIndex& get_installed_files_index() const;
+
         Optional<const Json::Object&> get_manifest() const;
         Optional<const fs::path&> get_manifest_path() const;
         const Configuration& get_configuration() const;
@@ -2,6 +2,8 @@
 
 #include <vcpkg/versiont.h>
 
+#include <unordered_map>
+
 namespace vcpkg::Versions
 {
     using Version = VersionT;
@@ -76,6 +78,24 @@ namespace vcpkg::Versions
     VerComp compare(const SemanticVersion& a, const SemanticVersion& b);
     VerComp compare(const DateVersion& a, const DateVersion& b);
 
+    /// <summary>
+    /// Compares version strings like `compare(a, b, scheme)`, but parses each distinct string only once. Useful when
+    /// the same versions are compared many times, as in version resolution.
+    /// </summary>
+    struct VersionComparer
+    {
+        VerComp compare(const std::string& a, const std::string& b, Scheme scheme);
+
+    private:
+        const RelaxedVersion& parse_relaxed(const std::string& str);
+        const SemanticVersion& parse_semver(const std::string& str);
+        const DateVersion& parse_date(const std::string& str);
+
+        std::unordered_map<std::string, RelaxedVersion> m_relaxed;
+        std::unordered_map<std::string, SemanticVersion> m_semver;
+        std::unordered_map<std::string, DateVersion> m_date;
+    };
+
     struct Constraint
     {
         enum class Type
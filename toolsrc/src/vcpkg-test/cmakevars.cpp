@@ -0,0 +1,312 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+
+#include <vcpkg/cmakevars.private.h>
+#include <vcpkg/vcpkgcmdarguments.h>
+#include <vcpkg/vcpkgpaths.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vcpkg-test/util.h>
+
+using namespace vcpkg;
+using namespace vcpkg::CMakeVars::details;
+
+using VarList = std::vector<std::pair<std::string, std::string>>;
+
+static void feed(ExtractionOutputParser& parser, StringView text)
+{
+    for (auto&& line : Strings::split(text, '\n'))
+    {
+        parser(line);
+    }
+}
+
+static std::string port_output(const VarList& vars)
+{
+    auto result = Strings::concat(ExtractionOutputParser::PORT_START_GUID,
+                                  '\n',
+                                  ExtractionOutputParser::BLOCK_START_GUID,
+                                  '\n');
+    for (auto&& var : vars)
+    {
+        Strings::append(result, var.first, '=', var.second, '\n');
+    }
+
+    Strings::append(result, ExtractionOutputParser::BLOCK_END_GUID, '\n', ExtractionOutputParser::PORT_END_GUID, '\n');
+    return result;
+}
+
+TEST_CASE ("extraction output of several ports", "[cmakevars]")
+{
+    std::vector<VarList> vars(3);
+    ExtractionOutputParser parser(vars);
+    feed(parser,
+         Strings::concat(port_output({{"A", "1"}, {"B", ""}}), port_output({}), port_output({{"C", "3"}, {"D", ""}})));
+
+    CHECK(vars[0] == VarList{{"A", "1"}, {"B", ""}});
+    CHECK(vars[1].empty());
+    CHECK(vars[2] == VarList{{"C", "3"}, {"D", ""}});
+    CHECK(parser.other_output.empty());
+    CHECK(!parser.error);
+}
+
+TEST_CASE ("extraction output of a port without a block", "[cmakevars]")
+{
+    std::vector<VarList> vars(2);
+    ExtractionOutputParser parser(vars);
+    feed(parser,
+         Strings::concat(ExtractionOutputParser::PORT_START_GUID,
+                         '\n',
+                         ExtractionOutputParser::PORT_END_GUID,
+                         '\n',
+                         port_output({{"A", "1"}})));
+
+    CHECK(vars[0].empty());
+    CHECK(vars[1] == VarList{{"A", "1"}});
+    CHECK(!parser.error);
+}
+
+TEST_CASE ("extraction output with more ports than requested", "[cmakevars]")
+{
+    std::vector<VarList> vars(1);
+    ExtractionOutputParser parser(vars);
+    feed(parser, Strings::concat(port_output({{"A", "1"}}), port_output({{"B", "2"}})));
+
+    CHECK(vars[0] == VarList{{"A", "1"}});
+    CHECK(!parser.error);
+}
+
+TEST_CASE ("extraction output with garbage lines", "[cmakevars]")
+{
+    std::vector<VarList> vars(1);
+    ExtractionOutputParser parser(vars);
+    feed(parser,
+         Strings::concat("CMake Warning at triplet.cmake:1\n",
+                         ExtractionOutputParser::PORT_START_GUID,
+                         "\nnot a block\n",
+                         ExtractionOutputParser::BLOCK_START_GUID,
+                         "\nA=1\nB=2=3\nC=4\n",
+                         ExtractionOutputParser::BLOCK_END_GUID,
+                         '\n',
+                         ExtractionOutputParser::PORT_END_GUID,
+                         "\ntrailing\n"));
+
+    CHECK(vars[0] == VarList{{"A", "1"}, {"C", "4"}});
+    CHECK(parser.other_output == "CMake Warning at triplet.cmake:1\nnot a block\ntrailing\n");
+    REQUIRE(parser.error);
+    CHECK(Strings::contains(*parser.error.get(), "[B=2=3]"));
+}
+
+TEST_CASE ("extraction shards", "[cmakevars]")
+{
+    CHECK(get_extraction_shards(0, 8).empty());
+
+    auto shards = get_extraction_shards(10, 8);
+    REQUIRE(shards.size() == 1);
+    CHECK(shards[0].first == 0);
+    CHECK(shards[0].count == 10);
+
+    shards = get_extraction_shards(1000, 4);
+    REQUIRE(shards.size() == 4);
+    size_t next = 0;
+    for (auto&& shard : shards)
+    {
+        CHECK(shard.first == next);
+        CHECK(shard.count == 250);
+        next += shard.count;
+    }
+
+    shards = get_extraction_shards(130, 16);
+    REQUIRE(shards.size() == 3);
+    CHECK(shards[2].first + shards[2].count == 130);
+
+    CHECK(get_extraction_shards(1000, 0).size() == 1);
+}
+
+TEST_CASE ("extraction shards are merged in item order", "[cmakevars]")
+{
+    const size_t item_count = 300;
+    const auto shards = get_extraction_shards(item_count, 4);
+    REQUIRE(shards.size() > 1);
+
+    std::vector<VarList> vars(item_count);
+    const auto error = run_extraction_shards(shards, vars, [&](size_t shard, Span<VarList> shard_vars) {
+        // later shards finish first
+        std::this_thread::sleep_for(std::chrono::milliseconds(10 * (shards.size() - shard)));
+        ExtractionOutputParser parser(shard_vars);
+        for (size_t i = 0; i < shards[shard].count; ++i)
+        {
+            feed(parser, port_output({{"ITEM", std::to_string(shards[shard].first + i)}}));
+        }
+
+        return std::move(parser.error);
+    });
+
+    CHECK(!error);
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        CHECK(vars[i] == VarList{{"ITEM", std::to_string(i)}});
+    }
+}
+
+TEST_CASE ("extraction shard failures are returned to the caller", "[cmakevars]")
+{
+    const auto shards = get_extraction_shards(300, 4);
+    REQUIRE(shards.size() > 2);
+
+    std::vector<VarList> vars(300);
+    const auto error = run_extraction_shards(shards, vars, [&](size_t shard, Span<VarList>) -> Optional<std::string> {
+        if (shard == 0) return nullopt;
+        return "shard " + std::to_string(shard) + " failed";
+    });
+
+    REQUIRE(error);
+    CHECK(*error.get() == "shard 1 failed");
+}
+
+TEST_CASE ("cmake var cache round trip", "[cmakevars]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto cache_file = Test::base_temporary_directory() / "cmake-var-cache";
+    fs.remove(cache_file, VCPKG_LINE_INFO);
+
+    {
+        CMakeVarCache cache(fs, cache_file);
+        CHECK(cache.find("a") == nullptr);
+        cache.insert("a", {{"VCPKG_TARGET_ARCHITECTURE", "x64"}, {"EMPTY", ""}});
+        cache.insert("b", {});
+        cache.save();
+    }
+
+    CMakeVarCache cache(fs, cache_file);
+    const auto a = cache.find("a");
+    REQUIRE(a);
+    CHECK(*a == VarList{{"VCPKG_TARGET_ARCHITECTURE", "x64"}, {"EMPTY", ""}});
+    const auto b = cache.find("b");
+    REQUIRE(b);
+    CHECK(b->empty());
+    CHECK(cache.find("c") == nullptr);
+
+    fs.remove(cache_file, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("corrupt cmake var cache", "[cmakevars]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto cache_file = Test::base_temporary_directory() / "cmake-var-cache-corrupt";
+
+    // entries before the first malformed one are kept
+    fs.write_contents(cache_file, "vcpkg cmake var cache v1\na\t1\nA=1\nb\tmany\nB=2\n", VCPKG_LINE_INFO);
+    {
+        CMakeVarCache cache(fs, cache_file);
+        REQUIRE(cache.find("a"));
+        CHECK(*cache.find("a") == VarList{{"A", "1"}});
+        CHECK(cache.find("b") == nullptr);
+    }
+
+    // a truncated entry is dropped
+    fs.write_contents(cache_file, "vcpkg cmake var cache v1\na\t2\nA=1\n", VCPKG_LINE_INFO);
+    {
+        CMakeVarCache cache(fs, cache_file);
+        CHECK(cache.find("a") == nullptr);
+    }
+
+    // and so is a file with another header
+    fs.write_contents(cache_file, "vcpkg cmake var cache v0\na\t1\nA=1\n", VCPKG_LINE_INFO);
+    {
+        CMakeVarCache cache(fs, cache_file);
+        CHECK(cache.find("a") == nullptr);
+        cache.insert("c", {{"C", "3"}});
+        cache.save();
+    }
+
+    CMakeVarCache cache(fs, cache_file);
+    CHECK(cache.find("a") == nullptr);
+    REQUIRE(cache.find("c"));
+
+    fs.remove(cache_file, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("cmake var keys", "[cmakevars]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto root = Test::base_temporary_directory() / "cmake-var-keys";
+    const auto triplets = root / "triplets";
+    const auto port_dir = root / "ports" / "a";
+    fs.remove_all(root, VCPKG_LINE_INFO);
+    fs.create_directories(triplets, VCPKG_LINE_INFO);
+    fs.create_directories(port_dir, VCPKG_LINE_INFO);
+    const auto triplet_file = triplets / "x64-windows.cmake";
+    const auto abi_settings_file = port_dir / "vcpkg-abi-settings.cmake";
+    fs.write_contents(triplet_file, "set(VCPKG_TARGET_ARCHITECTURE x64)\n", VCPKG_LINE_INFO);
+
+    static const std::string args_raw[] = {"install"};
+    VcpkgCmdArguments args = VcpkgCmdArguments::create_from_arg_sequence(std::begin(args_raw), std::end(args_raw));
+    args.install_root_dir = std::make_unique<std::string>(fs::u8string(root / "installed"));
+    args.overlay_triplets.push_back(fs::u8string(triplets));
+    VcpkgPaths paths(fs, args);
+
+    const FullPackageSpec spec{{"a", Test::X64_WINDOWS}, {"core"}};
+    const auto abi_settings_path = fs::generic_u8string(abi_settings_file);
+    // file contents are read once per CMakeVarKeys, so each key is computed by a new one
+    const auto tag_key = [&] { return CMakeVarKeys(paths).get_tag_key(spec, abi_settings_path); };
+    const auto dep_info_key = [&] { return CMakeVarKeys(paths).get_dep_info_key(spec.package_spec); };
+
+    // a missing ABI settings file is valid
+    const auto initial_tag_key = tag_key();
+    const auto initial_dep_info_key = dep_info_key();
+    REQUIRE(initial_tag_key);
+    REQUIRE(initial_dep_info_key);
+    CHECK(tag_key() == initial_tag_key);
+    CHECK(dep_info_key() == initial_dep_info_key);
+    CHECK_FALSE(CMakeVarKeys(paths).get_tag_key(spec, "") == initial_tag_key);
+
+    fs.write_contents(abi_settings_file, "set(VCPKG_POLICY_EMPTY_PACKAGE enabled)\n", VCPKG_LINE_INFO);
+    const auto abi_settings_tag_key = tag_key();
+    REQUIRE(abi_settings_tag_key);
+    CHECK_FALSE(abi_settings_tag_key == initial_tag_key);
+    CHECK(dep_info_key() == initial_dep_info_key);
+
+    fs.write_contents(triplet_file, "set(VCPKG_TARGET_ARCHITECTURE x86)\n", VCPKG_LINE_INFO);
+    const auto triplet_tag_key = tag_key();
+    const auto triplet_dep_info_key = dep_info_key();
+    REQUIRE(triplet_tag_key);
+    REQUIRE(triplet_dep_info_key);
+    CHECK_FALSE(triplet_tag_key == abi_settings_tag_key);
+    CHECK_FALSE(triplet_dep_info_key == initial_dep_info_key);
+
+    // files which include other files have no key; comments and strings do not count
+    fs.write_contents(abi_settings_file,
+                      "# include(other.cmake)\nmessage(STATUS \"include(other.cmake)\")\n",
+                      VCPKG_LINE_INFO);
+    CHECK(tag_key());
+    fs.write_contents(abi_settings_file, "INCLUDE (other.cmake)\n", VCPKG_LINE_INFO);
+    CHECK_FALSE(tag_key());
+    CHECK(dep_info_key() == triplet_dep_info_key);
+
+    fs.append_contents(triplet_file, "include(${CMAKE_CURRENT_LIST_DIR}/common.cmake)\n", VCPKG_LINE_INFO);
+    CHECK_FALSE(dep_info_key());
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("cmake files which include other files", "[cmakevars]")
+{
+    CHECK(includes_other_files("include(a.cmake)"));
+    CHECK(includes_other_files("  Include \t(a.cmake)"));
+    CHECK(includes_other_files("set(A 1) # include(a.cmake)\ninclude(b.cmake)"));
+    CHECK(includes_other_files("#[[ include(a.cmake) ]]include(b.cmake)"));
+
+    CHECK_FALSE(includes_other_files(""));
+    CHECK_FALSE(includes_other_files("set(VCPKG_TARGET_ARCHITECTURE x64)"));
+    CHECK_FALSE(includes_other_files("# include(a.cmake)"));
+    CHECK_FALSE(includes_other_files("#[==[\ninclude(a.cmake)\n]==]\nset(A 1)"));
+    CHECK_FALSE(includes_other_files("message(\"include(a.cmake) \\\" include(b.cmake)\")"));
+    CHECK_FALSE(includes_other_files("set(INCLUDE_DIRS a)"));
+}
@@ -1,6 +1,8 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
 
 #include <vcpkg/build.h>
 #include <vcpkg/commands.h>
@@ -36,3 +38,109 @@ TEST_CASE ("build smoke test", "[commands-build]")
     REQUIRE(exit_code == 0);
     REQUIRE(paths.get_filesystem().is_directory(paths.buildtrees / fs::u8path("zlib")));
 }
+
+TEST_CASE ("compiler info store", "[commands-build]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto root = Test::base_temporary_directory() / fs::u8path("compiler-info-store");
+    const auto cache_file = root / fs::u8path("compiler-info");
+    const auto cc = root / fs::u8path("cc");
+    const auto cxx = root / fs::u8path("c++");
+    fs.remove_all(root, VCPKG_LINE_INFO);
+    fs.create_directories(root, VCPKG_LINE_INFO);
+    fs.write_contents(cc, "cc", VCPKG_LINE_INFO);
+    fs.write_contents(cxx, "c++", VCPKG_LINE_INFO);
+
+    Build::CompilerInfo info;
+    info.id = "GNU";
+    info.version = "10.2.0";
+    info.hash = "0123456789abcdef";
+    info.compiler_paths = {cc, cxx};
+
+    const auto find = [&](const std::string& key) { return Build::CompilerInfoStore(fs, cache_file).find(key); };
+    const auto check_found = [&](const std::string& key) {
+        auto found = find(key);
+        REQUIRE(found);
+        CHECK(found.get()->id == info.id);
+        CHECK(found.get()->version == info.version);
+        CHECK(found.get()->hash == info.hash);
+        CHECK(found.get()->compiler_paths == info.compiler_paths);
+    };
+
+    // stored information is found by later runs
+    {
+        Build::CompilerInfoStore store(fs, cache_file);
+        CHECK_FALSE(store.find("key"));
+        store.insert("key", info);
+        CHECK(store.find("key"));
+    }
+
+    check_found("key");
+    CHECK_FALSE(find("other key"));
+
+    // until a compiler changes
+    fs.write_contents(cxx, "a new c++", VCPKG_LINE_INFO);
+    CHECK_FALSE(find("key"));
+    Build::CompilerInfoStore(fs, cache_file).insert("key", info);
+    check_found("key");
+    fs.remove(cc, VCPKG_LINE_INFO);
+    CHECK_FALSE(find("key"));
+    fs.write_contents(cc, "cc", VCPKG_LINE_INFO);
+    Build::CompilerInfoStore(fs, cache_file).insert("key", info);
+
+    // information which cannot be stamped or stored is not stored
+    {
+        Build::CompilerInfoStore store(fs, cache_file);
+        auto missing_compiler = info;
+        missing_compiler.compiler_paths.push_back(root / fs::u8path("missing"));
+        store.insert("missing compiler", missing_compiler);
+        auto no_compilers = info;
+        no_compilers.compiler_paths.clear();
+        store.insert("no compilers", no_compilers);
+        auto tab = info;
+        tab.version = "10.2\t0";
+        store.insert("tab", tab);
+    }
+
+    CHECK_FALSE(find("missing compiler"));
+    CHECK_FALSE(find("no compilers"));
+    CHECK_FALSE(find("tab"));
+
+    // malformed lines are skipped; the rest of the file is used
+    const auto cc_stamp = CacheFile::get_file_stamp(cc).value_or_exit(VCPKG_LINE_INFO).to_string();
+    fs.append_contents(cache_file,
+                       Strings::concat("too few fields\tGNU\n",
+                                       "bad stamp\th\tGNU\t10.2.0\t",
+                                       fs::u8string(cc),
+                                       "\tsize\ttime\n",
+                                       "missing stamp field\th\tGNU\t10.2.0\t",
+                                       fs::u8string(cc),
+                                       '\t',
+                                       cc_stamp,
+                                       '\t',
+                                       fs::u8string(cxx),
+                                       "\n",
+                                       "good\th\tGNU\t10.2.0\t",
+                                       fs::u8string(cc),
+                                       '\t',
+                                       cc_stamp,
+                                       '\n'),
+                       VCPKG_LINE_INFO);
+    CHECK_FALSE(find("too few fields"));
+    CHECK_FALSE(find("bad stamp"));
+    CHECK_FALSE(find("missing stamp field"));
+    CHECK(find("good"));
+    check_found("key");
+
+    // a file with another header is ignored
+    fs.write_contents(cache_file,
+                      Strings::concat("vcpkg compiler info cache v0\ngood\th\tGNU\t10.2.0\t",
+                                      fs::u8string(cc),
+                                      '\t',
+                                      cc_stamp,
+                                      '\n'),
+                      VCPKG_LINE_INFO);
+    CHECK_FALSE(find("good"));
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
@@ -1,12 +1,18 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+
 #include <vcpkg/commands.contact.h>
+#include <vcpkg/commands.env.h>
 #include <vcpkg/commands.h>
 #include <vcpkg/commands.upload-metrics.h>
 #include <vcpkg/commands.version.h>
 
 #include <stddef.h>
 
+#include <vcpkg-test/util.h>
+
 using namespace vcpkg;
 
 namespace
@@ -79,3 +85,24 @@ TEST_CASE ("get_available_commands_type_a works", "[commands]")
         });
 }
 // clang-format on
+
+TEST_CASE ("env adds installed directories to PATH", "[commands]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto installed = Test::base_temporary_directory() / "env-installed";
+    fs.remove_all(installed, VCPKG_LINE_INFO);
+    fs.create_directories(installed / "tools" / "tool", VCPKG_LINE_INFO);
+
+    ParsedArguments options;
+    options.switches = {"bin", "debug-bin", "tools", "include"};
+    const auto env = Commands::Env::get_installed_env(fs, installed, options);
+    CHECK(env.at("INCLUDE") == fs::u8string(installed / "include"));
+    CHECK(env.at("PATH") == Strings::join(Files::path_list_separator,
+                                          std::vector<std::string>{fs::u8string(installed / "bin"),
+                                                                   fs::u8string(installed / "debug" / "bin"),
+                                                                   fs::u8string(installed / "tools"),
+                                                                   fs::u8string(installed / "tools" / "tool")}));
+    CHECK(env.count("PYTHONPATH") == 0);
+
+    fs.remove_all(installed, VCPKG_LINE_INFO);
+}
@@ -591,6 +591,18 @@ TEST_CASE ("version parse semver", "[versionplan]")
 
     auto version_invalid_characters = Versions::SemanticVersion::from_string("1.0.0-alpha#2");
     CHECK(!version_invalid_characters.has_value());
+
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0-").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0+").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0-alpha..1").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0+build.").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0.0").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("1.0.0-alpha+build+2").has_value());
+    CHECK(!Versions::SemanticVersion::from_string("").has_value());
+
+    // build identifiers may have leading zeroes
+    auto version_build_leading_zeroes = Versions::SemanticVersion::from_string("1.0.0-0+001.-");
+    check_semver_version(version_build_leading_zeroes, "1.0.0", "0", 1, 0, 0, {"0"});
 }
 
 TEST_CASE ("version parse relaxed", "[versionplan]")
@@ -613,6 +625,12 @@ TEST_CASE ("version parse relaxed", "[versionplan]")
 
     auto version_invalid_leading_zeroes = Versions::RelaxedVersion::from_string("01.002.003");
     CHECK(!version_invalid_leading_zeroes.has_value());
+
+    CHECK(!Versions::RelaxedVersion::from_string("").has_value());
+    CHECK(!Versions::RelaxedVersion::from_string("1.").has_value());
+    CHECK(!Versions::RelaxedVersion::from_string(".1").has_value());
+    CHECK(!Versions::RelaxedVersion::from_string("1..2").has_value());
+    CHECK(!Versions::RelaxedVersion::from_string("1.18446744073709551616").has_value());
 }
 
 TEST_CASE ("version parse date", "[versionplan]")
@@ -634,6 +652,11 @@ TEST_CASE ("version parse date", "[versionplan]")
 
     auto version_invalid_leading_zeroes = Versions::DateVersion::from_string("2020-01-01.01");
     CHECK(!version_invalid_leading_zeroes.has_value());
+
+    CHECK(!Versions::DateVersion::from_string("2020-01-01.").has_value());
+    CHECK(!Versions::DateVersion::from_string("2020-01-011").has_value());
+    CHECK(!Versions::DateVersion::from_string("2020-01-0").has_value());
+    CHECK(!Versions::DateVersion::from_string("2020/01/01").has_value());
 }
 
 TEST_CASE ("version sort semver", "[versionplan]")
@@ -731,6 +754,34 @@ TEST_CASE ("version sort date", "[versionplan]")
     CHECK(versions[8].original_string == "2021-01-01.10");
 }
 
+TEST_CASE ("version comparer agrees with compare", "[versionplan]")
+{
+    using Versions::Scheme;
+    const std::vector<std::pair<std::vector<std::string>, Scheme>> cases{
+        {{"1", "1.0", "1.0.0", "1.0.1", "1.10.1", "2"}, Scheme::Relaxed},
+        {{"1.0.0", "1.0.0-alpha", "1.0.0-alpha.1", "1.0.0-1", "1.0.0+build", "2.0.0"}, Scheme::Semver},
+        {{"2020-12-25", "2021-01-01", "2021-01-01.1", "2021-01-01.1.0", "2021-01-01.10"}, Scheme::Date},
+        {{"vista", "xp", "7"}, Scheme::String},
+    };
+
+    Versions::VersionComparer comparer;
+    for (auto&& c : cases)
+    {
+        // compare every pair twice, so that the second round uses the remembered versions
+        for (int round = 0; round < 2; ++round)
+        {
+            for (auto&& a : c.first)
+            {
+                for (auto&& b : c.first)
+                {
+                    INFO(a << " vs " << b);
+                    CHECK(comparer.compare(a, b, c.second) == Versions::compare(a, b, c.second));
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE ("version install simple semver", "[versionplan]")
 {
     MockBaselineProvider bp;
@@ -1,6 +1,23 @@
 #include <catch2/catch.hpp>
 
 #include <vcpkg/base/downloads.h>
+#include <vcpkg/base/hash.h>
+#include <vcpkg/base/strings.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vcpkg-test/util.h>
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 using namespace vcpkg;
 
@@ -57,3 +74,343 @@ TEST_CASE ("Downloads::details::split_uri_view", "[downloads]")
         REQUIRE(x.get()->path_query_fragment == "/");
     }
 }
+
+#if !defined(_WIN32)
+namespace
+{
+    // An HTTP/1.1 server on the loopback interface for exercising the native HTTP client. It serves `files`, stores
+    // the bodies of PUT requests into them, and counts the connections it accepts.
+    struct LoopbackHttpServer
+    {
+        enum class Mode
+        {
+            KeepAlive,
+            // every response has "Connection: close"
+            Close,
+            // the connection is closed after every response without telling the client, like an idle timeout
+            DropIdle,
+            // GET responses use chunked transfer encoding
+            Chunked,
+        };
+
+        explicit LoopbackHttpServer(Mode mode = Mode::KeepAlive) : mode(mode)
+        {
+            listener = ::socket(AF_INET, SOCK_STREAM, 0);
+            REQUIRE(listener >= 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t address_size = sizeof(address);
+            REQUIRE(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_size) == 0);
+            REQUIRE(::listen(listener, 64) == 0);
+            REQUIRE(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_size) == 0);
+            port = ntohs(address.sin_port);
+            accept_thread = std::thread([this]() { accept_connections(); });
+        }
+
+        ~LoopbackHttpServer()
+        {
+            ::shutdown(listener, SHUT_RDWR);
+            ::close(listener);
+            accept_thread.join();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int fd : open_connections)
+                {
+                    ::shutdown(fd, SHUT_RDWR);
+                }
+            }
+
+            for (auto&& thread : connection_threads)
+            {
+                thread.join();
+            }
+        }
+
+        std::string url(StringView path) const { return Strings::concat("http://127.0.0.1:", port, path); }
+
+        int connection_count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return connections;
+        }
+
+        Mode mode;
+        int port;
+        std::mutex mutex;
+        std::map<std::string, std::string> files;
+
+    private:
+        void accept_connections()
+        {
+            for (;;)
+            {
+                const int fd = ::accept(listener, nullptr, nullptr);
+                if (fd < 0) return;
+                std::lock_guard<std::mutex> lock(mutex);
+                ++connections;
+                open_connections.insert(fd);
+                connection_threads.emplace_back([this, fd]() {
+                    serve(fd);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    open_connections.erase(fd);
+                    ::close(fd);
+                });
+            }
+        }
+
+        void serve(int fd)
+        {
+            std::string received;
+            for (;;)
+            {
+                size_t header_end;
+                while ((header_end = received.find("\r\n\r\n")) == std::string::npos)
+                {
+                    if (!receive(fd, received)) return;
+                }
+
+                const auto header = received.substr(0, header_end);
+                const auto method = header.substr(0, header.find(' '));
+                const auto path_start = method.size() + 1;
+                const auto path = header.substr(path_start, header.find(' ', path_start) - path_start);
+                size_t content_length = 0;
+                const auto length_header = header.find("Content-Length: ");
+                if (length_header != std::string::npos)
+                {
+                    content_length = std::stoul(header.substr(length_header + 16));
+                }
+
+                while (received.size() < header_end + 4 + content_length)
+                {
+                    if (!receive(fd, received)) return;
+                }
+
+                const auto body = received.substr(header_end + 4, content_length);
+                received.erase(0, header_end + 4 + content_length);
+                if (!send_all(fd, respond(method, path, body)) || mode == Mode::Close || mode == Mode::DropIdle) return;
+            }
+        }
+
+        std::string respond(const std::string& method, const std::string& path, const std::string& body)
+        {
+            const char* const connection = mode == Mode::Close ? "Connection: close\r\n" : "";
+            if (path == "/redirect")
+            {
+                return Strings::concat(
+                    "HTTP/1.1 302 Found\r\nLocation: /0\r\nContent-Length: 0\r\n", connection, "\r\n");
+            }
+
+            if (path == "/redirect-absolute")
+            {
+                return Strings::concat("HTTP/1.1 301 Moved\r\nLocation: ",
+                                       url("/redirect"),
+                                       "\r\nContent-Length: 0\r\n",
+                                       connection,
+                                       "\r\n");
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (method == "PUT")
+            {
+                files[path] = body;
+                return Strings::concat("HTTP/1.1 201 Created\r\nContent-Length: 0\r\n", connection, "\r\n");
+            }
+
+            auto it = files.find(path);
+            if (it == files.end())
+            {
+                return Strings::concat("HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n",
+                                       connection,
+                                       "\r\n",
+                                       method == "GET" ? "not found" : "");
+            }
+
+            if (mode == Mode::Chunked && method == "GET")
+            {
+                std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+                for (size_t i = 0; i < it->second.size(); i += 1000)
+                {
+                    const auto chunk = it->second.substr(i, 1000);
+                    char size[32];
+                    snprintf(size, sizeof(size), "%zx;ext=1\r\n", chunk.size());
+                    Strings::append(response, size, chunk, "\r\n");
+                }
+
+                return response + "0\r\nTrailer: x\r\n\r\n";
+            }
+
+            return Strings::concat("HTTP/1.1 200 OK\r\nContent-Length: ",
+                                   it->second.size(),
+                                   "\r\n",
+                                   connection,
+                                   "\r\n",
+                                   method == "GET" ? it->second : "");
+        }
+
+        static bool receive(int fd, std::string& received)
+        {
+            char buffer[4096];
+            const auto count = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (count <= 0) return false;
+            received.append(buffer, static_cast<size_t>(count));
+            return true;
+        }
+
+        static bool send_all(int fd, const std::string& data)
+        {
+            for (size_t sent = 0; sent < data.size();)
+            {
+                const auto count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (count <= 0) return false;
+                sent += static_cast<size_t>(count);
+            }
+
+            return true;
+        }
+
+        int listener;
+        int connections = 0;
+        std::set<int> open_connections;
+        std::thread accept_thread;
+        std::vector<std::thread> connection_threads;
+    };
+
+    std::string file_contents(size_t size, int seed)
+    {
+        std::string result(size, '\0');
+        for (size_t i = 0; i < size; ++i)
+        {
+            result[i] = static_cast<char>((i * 31 + seed) % 251);
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE ("native HTTP client reuses connections", "[downloads]")
+{
+    LoopbackHttpServer server;
+    std::vector<std::string> urls;
+    for (int i = 0; i < 400; ++i)
+    {
+        if (i % 2 == 0) server.files[Strings::concat('/', i)] = "x";
+        urls.push_back(server.url(Strings::concat('/', i)));
+    }
+
+    auto codes = Downloads::url_heads(urls);
+    REQUIRE(codes.size() == urls.size());
+    for (size_t i = 0; i < codes.size(); ++i)
+    {
+        CHECK(codes[i] == (i % 2 == 0 ? 200 : 404));
+    }
+
+    const auto connections = server.connection_count();
+    CHECK(connections >= 1);
+    CHECK(connections <= 8);
+
+    // the connections stay open for later requests
+    CHECK(Downloads::url_heads(urls) == codes);
+    CHECK(server.connection_count() == connections);
+}
+
+TEST_CASE ("native HTTP client follows redirects", "[downloads]")
+{
+    LoopbackHttpServer server;
+    server.files["/0"] = "zero";
+    const std::vector<std::string> urls{server.url("/redirect"), server.url("/redirect-absolute")};
+    CHECK(Downloads::url_heads(urls) == std::vector<int>{200, 200});
+
+    auto& fs = Files::get_real_filesystem();
+    const auto dir = Test::base_temporary_directory() / "http-redirect";
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+    fs.create_directories(dir, VCPKG_LINE_INFO);
+    const std::vector<std::pair<std::string, fs::path>> url_pairs{{urls[1], dir / "0"}};
+    CHECK(Downloads::download_files(fs, url_pairs) == std::vector<int>{200});
+    CHECK(fs.read_contents(dir / "0", VCPKG_LINE_INFO) == "zero");
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("native HTTP client downloads and uploads files", "[downloads]")
+{
+    auto mode = GENERATE(LoopbackHttpServer::Mode::KeepAlive,
+                         LoopbackHttpServer::Mode::Close,
+                         LoopbackHttpServer::Mode::DropIdle,
+                         LoopbackHttpServer::Mode::Chunked);
+    LoopbackHttpServer server(mode);
+    auto& fs = Files::get_real_filesystem();
+    const auto dir = Test::base_temporary_directory() / "http-files";
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+    fs.create_directories(dir, VCPKG_LINE_INFO);
+
+    std::vector<std::pair<std::string, fs::path>> url_pairs;
+    for (int i = 0; i < 20; ++i)
+    {
+        const auto name = Strings::concat(i);
+        server.files['/' + name] = file_contents(static_cast<size_t>(i) * 10007, i);
+        url_pairs.emplace_back(server.url('/' + name), dir / name);
+    }
+
+    url_pairs.emplace_back(server.url("/missing"), dir / "missing");
+    server.files["/empty"] = "";
+    url_pairs.emplace_back(server.url("/empty"), dir / "empty");
+
+    auto codes = Downloads::download_files(fs, url_pairs);
+    REQUIRE(codes.size() == url_pairs.size());
+    for (int i = 0; i < 20; ++i)
+    {
+        CHECK(codes[i] == 200);
+        CHECK(fs.read_contents(url_pairs[i].second, VCPKG_LINE_INFO) ==
+              file_contents(static_cast<size_t>(i) * 10007, i));
+    }
+
+    CHECK(codes[20] == 404);
+    CHECK(codes[21] == 200);
+    CHECK(fs.read_contents(dir / "empty", VCPKG_LINE_INFO) == "");
+
+    const auto upload = file_contents(1 << 20, 7);
+    fs.write_contents(dir / "upload", upload, VCPKG_LINE_INFO);
+    CHECK(Downloads::put_file(fs, server.url("/uploaded"), dir / "upload") == 201);
+    CHECK(Downloads::url_heads(std::vector<std::string>{server.url("/uploaded"), server.url("/missing")}) ==
+          std::vector<int>{200, 404});
+    {
+        std::lock_guard<std::mutex> lock(server.mutex);
+        CHECK(server.files["/uploaded"] == upload);
+    }
+
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("native HTTP client verifies downloads as they arrive", "[downloads]")
+{
+    auto mode = GENERATE(LoopbackHttpServer::Mode::KeepAlive, LoopbackHttpServer::Mode::Chunked);
+    LoopbackHttpServer server(mode);
+    const auto contents = file_contents(300000, 3);
+    server.files["/archive.tar.gz"] = contents;
+
+    auto& fs = Files::get_real_filesystem();
+    const auto dir = Test::base_temporary_directory() / "http-verified";
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+    const auto download_path = dir / "nested" / "archive.tar.gz";
+
+    // the first mirror does not have the file
+    const std::vector<std::string> urls{server.url("/missing"), server.url("/archive.tar.gz")};
+    const auto sha512 = Hash::get_string_hash(contents, Hash::Algorithm::Sha512);
+    CHECK(Downloads::download_file(fs, urls, download_path, sha512) == urls[1]);
+    CHECK(fs.read_contents(download_path, VCPKG_LINE_INFO) == contents);
+    CHECK_FALSE(fs.exists(fs::path(download_path).concat(".part")));
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("native HTTP client reports unreachable servers", "[downloads]")
+{
+    int port;
+    {
+        LoopbackHttpServer server;
+        port = server.port;
+    }
+
+    const auto url = Strings::concat("http://127.0.0.1:", port, "/0");
+    CHECK(Downloads::url_heads(std::vector<std::string>{url}) == std::vector<int>{0});
+}
+#endif
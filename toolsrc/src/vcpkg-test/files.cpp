@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/strings.h>
 
@@ -194,6 +195,32 @@ TEST_CASE ("remove all", "[files]")
     CHECK_EC_ON_FILE(temp_dir, ec);
 }
 
+TEST_CASE ("cache files", "[files]")
+{
+    namespace CacheFile = vcpkg::CacheFile;
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto base = base_temporary_directory() / "cache-files";
+    const auto cache_file = base / "nested" / "cache";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+
+    CHECK_FALSE(CacheFile::load(fs, cache_file, "header v1").has_value());
+    CacheFile::save(fs, cache_file, "header v1", "a\tb\n");
+    CHECK(fs.read_contents(cache_file, VCPKG_LINE_INFO) == "header v1\na\tb\n");
+    CHECK(CacheFile::load(fs, cache_file, "header v1").value_or_exit(VCPKG_LINE_INFO) == "a\tb\n");
+    CHECK_FALSE(CacheFile::load(fs, cache_file, "header v2").has_value());
+    // no temporary file is left behind
+    CHECK(fs.get_files_non_recursive(base / "nested") == std::vector<fs::path>{cache_file});
+
+    auto stamp = CacheFile::get_file_stamp(cache_file).value_or_exit(VCPKG_LINE_INFO);
+    CHECK(stamp.size == 14);
+    CHECK(stamp.is_recent());
+    CHECK(CacheFile::FileStamp::parse("14", std::to_string(stamp.write_time)) == stamp);
+    CHECK(CacheFile::get_file_stamp(base).value_or_exit(VCPKG_LINE_INFO).size == -1);
+    CHECK_FALSE(CacheFile::get_file_stamp(base / "missing").has_value());
+
+    fs.remove_all(base, VCPKG_LINE_INFO);
+}
+
 TEST_CASE ("lexically_normal", "[files]")
 {
     const auto lexically_normal = [](const char* s) { return fs::lexically_normal(fs::u8path(s)); };
@@ -0,0 +1,276 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/git.h>
+#include <vcpkg/base/hash.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/zip.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <vcpkg-test/util.h>
+
+using vcpkg::StringView;
+using vcpkg::Test::base_temporary_directory;
+namespace Git = vcpkg::Git;
+namespace Hash = vcpkg::Hash;
+namespace Strings = vcpkg::Strings;
+namespace Zip = vcpkg::Zip;
+
+namespace
+{
+    void append_be32(std::string& out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    std::string raw_oid(const std::string& hex)
+    {
+        std::string raw;
+        for (size_t i = 0; i < hex.size(); i += 2)
+        {
+            raw.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+        }
+
+        return raw;
+    }
+
+    std::string raw_sha1(StringView data) { return raw_oid(Hash::get_string_hash(data, Hash::Algorithm::Sha1)); }
+
+    std::string zlib(StringView data)
+    {
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (unsigned char c : data)
+        {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+
+        std::string result = "\x78\x01";
+        result += Zip::deflate(data);
+        append_be32(result, (b << 16) | a);
+        return result;
+    }
+
+    std::string object_id(StringView type, StringView data)
+    {
+        return Hash::get_string_hash(Strings::concat(type, ' ', data.size(), '\0', data), Hash::Algorithm::Sha1);
+    }
+
+    std::string write_loose(const fs::path& objects, StringView type, StringView data)
+    {
+        auto& fs = vcpkg::Files::get_real_filesystem();
+        const auto oid = object_id(type, data);
+        fs.create_directories(objects / oid.substr(0, 2), VCPKG_LINE_INFO);
+        fs.write_contents(
+            objects / oid.substr(0, 2) / oid.substr(2), zlib(Strings::concat(type, ' ', data.size(), '\0', data)),
+            VCPKG_LINE_INFO);
+        return oid;
+    }
+
+    std::string tree_entry(StringView mode, StringView name, const std::string& oid)
+    {
+        return Strings::concat(mode, ' ', name, '\0', raw_oid(oid));
+    }
+
+    // A copy of all of `base` followed by `suffix`, as a git delta
+    std::string append_delta(const std::string& base, const std::string& suffix)
+    {
+        REQUIRE(base.size() < 128);
+        REQUIRE(base.size() + suffix.size() < 128);
+        REQUIRE(suffix.size() < 128);
+        std::string delta;
+        delta.push_back(static_cast<char>(base.size()));
+        delta.push_back(static_cast<char>(base.size() + suffix.size()));
+        delta.push_back(static_cast<char>(0x90));
+        delta.push_back(static_cast<char>(base.size()));
+        delta.push_back(static_cast<char>(suffix.size()));
+        delta += suffix;
+        return delta;
+    }
+
+    struct PackWriter
+    {
+        struct Entry
+        {
+            std::string oid;
+            uint32_t crc;
+            uint64_t offset;
+        };
+
+        std::string pack;
+        std::vector<Entry> entries;
+
+        // `type` is the pack entry type; `base_offset` or `base_oid` name the base of delta entries.
+        uint64_t add(const std::string& oid,
+                     int type,
+                     const std::string& data,
+                     uint64_t base_offset = 0,
+                     const std::string& base_oid = {})
+        {
+            const uint64_t offset = pack.size();
+            std::string entry;
+            uint64_t size = data.size();
+            unsigned char byte = static_cast<unsigned char>((type << 4) | (size & 0x0F));
+            size >>= 4;
+            while (size != 0)
+            {
+                entry.push_back(static_cast<char>(byte | 0x80));
+                byte = size & 0x7F;
+                size >>= 7;
+            }
+
+            entry.push_back(static_cast<char>(byte));
+            if (type == 6)
+            {
+                uint64_t distance = offset - base_offset;
+                std::string encoded(1, static_cast<char>(distance & 0x7F));
+                while (distance >>= 7)
+                {
+                    --distance;
+                    encoded.insert(encoded.begin(), static_cast<char>(0x80 | (distance & 0x7F)));
+                }
+
+                entry += encoded;
+            }
+            else if (type == 7)
+            {
+                entry += raw_oid(base_oid);
+            }
+
+            entry += zlib(data);
+            pack += entry;
+            entries.push_back({oid, Zip::crc32(entry), offset});
+            return offset;
+        }
+
+        void write(const fs::path& pack_dir)
+        {
+            std::string header = "PACK";
+            append_be32(header, 2);
+            append_be32(header, static_cast<uint32_t>(entries.size()));
+            for (auto&& entry : entries)
+            {
+                entry.offset += header.size();
+            }
+
+            pack.insert(0, header);
+            const auto pack_checksum = raw_sha1(pack);
+            pack += pack_checksum;
+
+            std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+                return lhs.oid < rhs.oid;
+            });
+
+            std::string index = "\xFFtOc";
+            append_be32(index, 2);
+            for (int first_byte = 0; first_byte < 256; ++first_byte)
+            {
+                const auto below = std::count_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+                    return std::stoi(entry.oid.substr(0, 2), nullptr, 16) <= first_byte;
+                });
+                append_be32(index, static_cast<uint32_t>(below));
+            }
+
+            for (auto&& entry : entries)
+                index += raw_oid(entry.oid);
+            for (auto&& entry : entries)
+                append_be32(index, entry.crc);
+            for (auto&& entry : entries)
+                append_be32(index, static_cast<uint32_t>(entry.offset));
+            index += pack_checksum;
+            index += raw_sha1(index);
+
+            auto& fs = vcpkg::Files::get_real_filesystem();
+            fs.create_directories(pack_dir, VCPKG_LINE_INFO);
+            fs.write_contents(pack_dir / "pack-test.pack", pack, VCPKG_LINE_INFO);
+            fs.write_contents(pack_dir / "pack-test.idx", index, VCPKG_LINE_INFO);
+        }
+    };
+}
+
+TEST_CASE ("git object store reads loose and packed objects", "[git]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto base = base_temporary_directory() / "git-objects";
+    const auto dot_git = base / "repo.git";
+    const auto objects = dot_git / "objects";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+    fs.create_directories(objects, VCPKG_LINE_INFO);
+
+    std::string text_a;
+    for (int i = 0; i < 5; ++i)
+        text_a += "vcpkg port file\n";
+    const auto text_b = text_a + "extra line\n";
+    const auto text_d = text_b + "more\n";
+
+    const auto oid_a = object_id("blob", text_a);
+    const auto oid_b = object_id("blob", text_b);
+    const auto oid_d = object_id("blob", text_d);
+    const auto oid_control = write_loose(objects, "blob", "Source: zlib\nVersion: 1.2.11\n");
+    const auto oid_link = write_loose(objects, "blob", "a.txt");
+    const auto oid_sub = write_loose(
+        objects, "tree", tree_entry("100644", "a.txt", oid_a) + tree_entry("120000", "link", oid_link));
+    const auto tree_data = tree_entry("100644", "CONTROL", oid_control) + tree_entry("100755", "b.txt", oid_b) +
+                           tree_entry("100644", "d.txt", oid_d) + tree_entry("40000", "sub", oid_sub);
+    const auto oid_tree = object_id("tree", tree_data);
+    const auto oid_commit =
+        write_loose(objects, "commit", Strings::concat("tree ", oid_tree, "\nauthor a <a> 0 +0000\n\nmessage\n"));
+
+    PackWriter pack;
+    const auto offset_a = pack.add(oid_a, 3, text_a);
+    pack.add(oid_b, 6, append_delta(text_a, "extra line\n"), offset_a);
+    pack.add(oid_d, 7, append_delta(text_b, "more\n"), 0, oid_b);
+    pack.add(oid_tree, 2, tree_data);
+    pack.write(objects / "pack");
+
+    Git::ObjectStore store(fs, dot_git);
+
+    auto blob_a = store.read_object(oid_a);
+    REQUIRE(blob_a.has_value());
+    CHECK(blob_a.get()->type == Git::ObjectType::Blob);
+    CHECK(blob_a.get()->data == text_a);
+    CHECK(store.read_blob(oid_b).value_or_exit(VCPKG_LINE_INFO) == text_b);
+    CHECK(store.read_blob(oid_d).value_or_exit(VCPKG_LINE_INFO) == text_d);
+    CHECK(store.read_blob(Strings::ascii_to_lowercase(std::string(oid_control))).has_value());
+    CHECK(!store.read_blob(oid_tree).has_value());
+    CHECK(!store.read_object("0123456789012345678901234567890123456789").has_value());
+    CHECK(!store.read_object("HEAD").has_value());
+
+    auto entries = store.read_tree(oid_commit);
+    REQUIRE(entries.has_value());
+    REQUIRE(entries.get()->size() == 4);
+    CHECK(entries.get()->at(1).name == "b.txt");
+    CHECK(entries.get()->at(1).mode == 0100755);
+    CHECK(entries.get()->at(1).oid == oid_b);
+    CHECK(entries.get()->at(3).is_tree());
+
+    CHECK(store.find_path(oid_commit, "sub/a.txt").value_or_exit(VCPKG_LINE_INFO) == oid_a);
+    CHECK(store.find_path(oid_tree, "sub").value_or_exit(VCPKG_LINE_INFO) == oid_sub);
+    CHECK(!store.find_path(oid_commit, "sub/missing").has_value());
+
+    const auto destination = base / "checkout";
+    auto files = store.checkout_tree(fs, oid_commit, destination);
+    REQUIRE(files.has_value());
+    CHECK(*files.get() == 5);
+    CHECK(fs.read_contents(destination / "CONTROL", VCPKG_LINE_INFO) == "Source: zlib\nVersion: 1.2.11\n");
+    CHECK(fs.read_contents(destination / "d.txt", VCPKG_LINE_INFO) == text_d);
+    CHECK(fs.read_contents(destination / "sub" / "a.txt", VCPKG_LINE_INFO) == text_a);
+#if !defined(_WIN32)
+    CHECK(fs::is_symlink(fs.symlink_status(VCPKG_LINE_INFO, destination / "sub" / "link")));
+    CHECK(fs.read_contents(destination / "sub" / "link", VCPKG_LINE_INFO) == text_a);
+    const auto perms = fs::stdfs::status(destination / "b.txt").permissions();
+    CHECK((perms & fs::stdfs::perms::owner_exec) != fs::stdfs::perms::none);
+#endif
+
+    // a `.git` file refers to the real git directory
+    fs.write_contents(base / ".git", "gitdir: repo.git\n", VCPKG_LINE_INFO);
+    Git::ObjectStore through_file(fs, base / ".git");
+    CHECK(through_file.read_blob(oid_d).value_or_exit(VCPKG_LINE_INFO) == text_d);
+}
@@ -1,12 +1,16 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/hashcache.h>
 
 #include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <map>
 
+#include <vcpkg-test/util.h>
+
 namespace Hash = vcpkg::Hash;
 using vcpkg::StringView;
 
@@ -177,9 +181,66 @@ TEST_CASE ("SHA512: NIST test cases (large)", "[.][hash-expensive][sha512-expens
                      "70a0f3bd577eea326aed40ab7dd58b1");
 }
 
+TEST_CASE ("file hash cache", "[hash]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto base = vcpkg::Test::base_temporary_directory() / "file-hash-cache";
+    const auto file = base / "file.txt";
+    const auto cache_file = base / "cache" / "file-hashes";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+    fs.create_directories(base, VCPKG_LINE_INFO);
+
+    // files written within the last moments are not cached, as they may still change unnoticed
+    const auto write_file = [&](const std::string& contents, std::chrono::hours age) {
+        fs.write_contents(file, contents, VCPKG_LINE_INFO);
+        fs::stdfs::last_write_time(file, fs::stdfs::file_time_type::clock::now() - age);
+    };
+
+    const auto hash_of = [](StringView contents) { return Hash::get_string_hash(contents, Hash::Algorithm::Sha1); };
+
+    write_file("first", std::chrono::hours(1));
+    {
+        Hash::FileHashCache cache(fs, cache_file);
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha1) == hash_of("first"));
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha256) ==
+              Hash::get_string_hash("first", Hash::Algorithm::Sha256));
+        cache.save();
+    }
+
+    // same size and write time: the remembered hash is used without reading the file
+    const auto time = fs::stdfs::last_write_time(file);
+    fs.write_contents(file, "FIRST", VCPKG_LINE_INFO);
+    fs::stdfs::last_write_time(file, time);
+    {
+        Hash::FileHashCache cache(fs, cache_file);
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha1) == hash_of("first"));
+    }
+
+    write_file("second", std::chrono::hours(2));
+    {
+        Hash::FileHashCache cache(fs, cache_file);
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha1) == hash_of("second"));
+    }
+
+    write_file("third", std::chrono::hours(0));
+    {
+        Hash::FileHashCache cache(fs, cache_file);
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha1) == hash_of("third"));
+        cache.save();
+    }
+
+    fs.write_contents(file, "THIRD", VCPKG_LINE_INFO);
+    {
+        Hash::FileHashCache cache(fs, cache_file);
+        CHECK(cache.get_file_hash(VCPKG_LINE_INFO, file, Hash::Algorithm::Sha1) == hash_of("THIRD"));
+    }
+
+    fs.remove_all(base, VCPKG_LINE_INFO);
+}
+
 #if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
 using Catch::Benchmark::Chronometer;
-void benchmark_hasher(Chronometer& meter, Hash::Hasher& hasher, std::uint64_t size, unsigned char byte) noexcept
+static void benchmark_hasher(Chronometer& meter, Hash::Hasher& hasher, std::uint64_t size, unsigned char byte) noexcept
 {
     unsigned char buffer[1024];
     std::fill(std::begin(buffer), std::end(buffer), byte);
@@ -0,0 +1,348 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+
+#include <vcpkg/install.h>
+
+#include <vcpkg-test/util.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace vcpkg;
+using Build::BuildResult;
+using Build::ExtendedBuildResult;
+using Dependencies::InstallPlanAction;
+using Install::InstallDir;
+using Install::InstallFileMode;
+using Install::KeepGoing;
+using Test::base_temporary_directory;
+
+namespace
+{
+    struct InstallFixture
+    {
+        Files::Filesystem& fs = Files::get_real_filesystem();
+        fs::path root = base_temporary_directory() / "install-files";
+        fs::path package_dir = root / "packages" / "pkg_x64-linux";
+        fs::path installed = root / "installed";
+        fs::path listfile = installed / "vcpkg" / "info" / "pkg_1.0_x64-linux.list";
+
+        InstallFixture()
+        {
+            fs.remove_all(root, VCPKG_LINE_INFO);
+            fs.create_directories(package_dir / "include" / "sub", VCPKG_LINE_INFO);
+            fs.write_contents(package_dir / "CONTROL", "Package: pkg\n", VCPKG_LINE_INFO);
+            fs.write_contents(package_dir / "include" / "a.h", "a", VCPKG_LINE_INFO);
+            fs.write_contents(package_dir / "include" / "sub" / "b.h", "b", VCPKG_LINE_INFO);
+
+            // a leftover from some other package, which is overwritten
+            fs.create_directories(installed / "x64-linux" / "include", VCPKG_LINE_INFO);
+            fs.write_contents(installed / "x64-linux" / "include" / "a.h", "old", VCPKG_LINE_INFO);
+        }
+
+        ~InstallFixture() { fs.remove_all(root, VCPKG_LINE_INFO); }
+
+        void install(InstallFileMode mode)
+        {
+            const auto dirs = InstallDir::from_destination_root(installed, "x64-linux", listfile);
+            Install::install_files_and_write_listfile(fs, package_dir, fs.get_files_recursive(package_dir), dirs, mode);
+        }
+
+        void check_installed()
+        {
+            CHECK(fs.read_contents(installed / "x64-linux" / "include" / "a.h", VCPKG_LINE_INFO) == "a");
+            CHECK(fs.read_contents(installed / "x64-linux" / "include" / "sub" / "b.h", VCPKG_LINE_INFO) == "b");
+            CHECK_FALSE(fs.exists(installed / "x64-linux" / "CONTROL"));
+            CHECK(fs.read_lines(listfile).value_or_exit(VCPKG_LINE_INFO) ==
+                  std::vector<std::string>{"x64-linux/",
+                                           "x64-linux/include/",
+                                           "x64-linux/include/a.h",
+                                           "x64-linux/include/sub/",
+                                           "x64-linux/include/sub/b.h"});
+        }
+    };
+}
+
+TEST_CASE ("install files by linking", "[install]")
+{
+    InstallFixture fixture;
+    fixture.install(InstallFileMode::LINK);
+    fixture.check_installed();
+
+    auto& fs = fixture.fs;
+    const auto source = fixture.package_dir / "include" / "a.h";
+    const auto target = fixture.installed / "x64-linux" / "include" / "a.h";
+    CHECK(fs.read_contents(source, VCPKG_LINE_INFO) == "a");
+    CHECK(fs.read_contents(fixture.package_dir / "include" / "sub" / "b.h", VCPKG_LINE_INFO) == "b");
+
+    // Files are cloned where the filesystem can, and otherwise hard linked; both are on the same filesystem here, so
+    // they are never copied.
+    std::error_code ec;
+    const auto probe = fixture.root / "clone-probe";
+    fs.clone_file(source, probe, ec);
+    if (ec)
+    {
+        CHECK(fs::stdfs::equivalent(source, target));
+        CHECK(fs::stdfs::hard_link_count(source) == 2);
+    }
+    else
+    {
+        CHECK_FALSE(fs::stdfs::equivalent(source, target));
+        CHECK(fs::stdfs::hard_link_count(target) == 1);
+    }
+}
+
+TEST_CASE ("install files by moving", "[install]")
+{
+    InstallFixture fixture;
+    fixture.install(InstallFileMode::MOVE);
+    fixture.check_installed();
+
+    auto& fs = fixture.fs;
+    CHECK_FALSE(fs.exists(fixture.package_dir / "include" / "a.h"));
+    CHECK_FALSE(fs.exists(fixture.package_dir / "include" / "sub" / "b.h"));
+    CHECK(fs.exists(fixture.package_dir / "CONTROL"));
+}
+
+namespace
+{
+    // Builds by sleeping for a moment, failing the ports in `failing`. start() cascades failed dependencies, as the
+    // installer does through the status database.
+    struct FakeActionRunner final : Install::IInstallActionRunner
+    {
+        std::set<std::string> failing;
+        std::vector<std::string> started;
+        std::map<std::string, BuildResult> results;
+
+        std::mutex running_mutex;
+        int running = 0;
+        int max_running = 0;
+
+        Optional<ExtendedBuildResult> start(InstallPlanAction& action) override
+        {
+            started.push_back(action.spec.name());
+            for (auto&& dependency : action.package_dependencies)
+            {
+                const auto it = results.find(dependency.name());
+                REQUIRE(it != results.end());
+                if (it->second != BuildResult::SUCCEEDED)
+                {
+                    return ExtendedBuildResult{BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES,
+                                               {FeatureSpec{dependency, "core"}}};
+                }
+            }
+
+            return nullopt;
+        }
+
+        ExtendedBuildResult build(const InstallPlanAction& action) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(running_mutex);
+                max_running = std::max(max_running, ++running);
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            {
+                std::lock_guard<std::mutex> lock(running_mutex);
+                --running;
+            }
+
+            return Util::Sets::contains(failing, action.spec.name()) ? BuildResult::BUILD_FAILED
+                                                                      : BuildResult::SUCCEEDED;
+        }
+
+        ExtendedBuildResult install(InstallPlanAction&, ExtendedBuildResult&& result) override
+        {
+            return std::move(result);
+        }
+
+        void finish(InstallPlanAction& action, ExtendedBuildResult&& result, size_t) override
+        {
+            CHECK(results.emplace(action.spec.name(), result.code).second);
+        }
+    };
+
+    std::vector<InstallPlanAction> make_actions(
+        const std::vector<std::pair<std::string, std::vector<std::string>>>& ports)
+    {
+        std::vector<InstallPlanAction> actions(ports.size());
+        for (size_t i = 0; i < ports.size(); ++i)
+        {
+            actions[i].spec = PackageSpec{ports[i].first, Test::X64_WINDOWS};
+            for (auto&& dependency : ports[i].second)
+            {
+                actions[i].package_dependencies.emplace_back(dependency, Test::X64_WINDOWS);
+            }
+        }
+
+        return actions;
+    }
+}
+
+TEST_CASE ("run install actions in parallel", "[install]")
+{
+    auto actions = make_actions({{"a", {}}, {"b", {"a"}}, {"c", {"a"}}, {"d", {"b", "c"}}, {"e", {}}});
+    FakeActionRunner runner;
+    Install::run_install_actions_in_parallel(actions, 2, KeepGoing::NO, runner);
+
+    // independent actions start in plan order; dependents once their dependencies are done
+    REQUIRE(runner.started.size() == 5);
+    CHECK(runner.started[0] == "a");
+    CHECK(runner.started[1] == "e");
+    CHECK(runner.started.back() == "d");
+    CHECK(runner.max_running <= 2);
+    for (auto&& result : runner.results)
+    {
+        CHECK(result.second == BuildResult::SUCCEEDED);
+    }
+}
+
+TEST_CASE ("run install actions in parallel with failures", "[install]")
+{
+    auto actions = make_actions({{"a", {}}, {"b", {"a"}}, {"c", {"b"}}, {"d", {}}});
+    FakeActionRunner runner;
+    runner.failing.insert("a");
+
+    SECTION ("keep going")
+    {
+        Install::run_install_actions_in_parallel(actions, 2, KeepGoing::YES, runner);
+        CHECK(runner.results == std::map<std::string, BuildResult>{
+                                    {"a", BuildResult::BUILD_FAILED},
+                                    {"b", BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES},
+                                    {"c", BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES},
+                                    {"d", BuildResult::SUCCEEDED},
+                                });
+    }
+
+    SECTION ("stop at the first failure")
+    {
+        Install::run_install_actions_in_parallel(actions, 1, KeepGoing::NO, runner);
+        CHECK(runner.started == std::vector<std::string>{"a"});
+        CHECK(runner.results == std::map<std::string, BuildResult>{{"a", BuildResult::BUILD_FAILED}});
+    }
+}
+
+TEST_CASE ("exits of builds on worker threads are caught", "[install]")
+{
+    int exit_code = 0;
+    CHECK_FALSE(Checks::run_catching_exit([] {}, exit_code));
+    CHECK(exit_code == 0);
+
+    std::thread worker([&] {
+        CHECK(Checks::run_catching_exit([] { Checks::exit_with_code(VCPKG_LINE_INFO, 3); }, exit_code));
+    });
+    worker.join();
+    CHECK(exit_code == 3);
+}
+
+TEST_CASE ("manifest install fingerprint", "[install]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto root = base_temporary_directory() / "manifest-fingerprint";
+    const auto port_dir = root / "ports" / "a";
+    const auto triplets = root / "triplets";
+    fs.remove_all(root, VCPKG_LINE_INFO);
+    fs.create_directories(port_dir, VCPKG_LINE_INFO);
+    fs.create_directories(triplets, VCPKG_LINE_INFO);
+    fs.write_contents(root / "vcpkg.json",
+                      R"json({"name": "app", "version-string": "1.0", "dependencies": ["a"]})json",
+                      VCPKG_LINE_INFO);
+    fs.write_contents(port_dir / "vcpkg.json", R"json({"name": "a", "version-string": "1.0"})json", VCPKG_LINE_INFO);
+    fs.write_contents(port_dir / "portfile.cmake", "", VCPKG_LINE_INFO);
+    fs.write_contents(triplets / "x64-windows.cmake", "set(VCPKG_TARGET_ARCHITECTURE x64)\n", VCPKG_LINE_INFO);
+
+    static const std::string args_raw[] = {"install"};
+    VcpkgCmdArguments args = VcpkgCmdArguments::create_from_arg_sequence(std::begin(args_raw), std::end(args_raw));
+    args.manifest_root_dir = std::make_unique<std::string>(fs::u8string(root));
+    args.install_root_dir = std::make_unique<std::string>(fs::u8string(root / "installed"));
+    args.overlay_triplets.push_back(fs::u8string(triplets));
+    VcpkgPaths paths(fs, args);
+    fs.create_directories(paths.vcpkg_dir_updates, VCPKG_LINE_INFO);
+
+    const SourceControlFileLocation scfl{std::make_unique<SourceControlFile>(), port_dir};
+    Dependencies::ActionPlan plan;
+    plan.install_actions.emplace_back(PackageSpec{"a", Test::X64_WINDOWS},
+                                      scfl,
+                                      Dependencies::RequestType::USER_REQUESTED,
+                                      std::map<std::string, std::vector<FeatureSpec>>{});
+
+    const std::vector<std::string> features{"default"};
+    ParsedArguments options;
+    const auto make_fingerprint = [&](Triplet triplet) {
+        Install::ManifestFingerprint fingerprint(paths, args, options, triplet, features);
+        fingerprint.track_plan(plan);
+        return fingerprint;
+    };
+
+    CHECK_FALSE(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+    make_fingerprint(Test::X64_WINDOWS).save();
+    CHECK(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+
+    // a different triplet, or a build option, is a different install; a dry run is not
+    CHECK_FALSE(make_fingerprint(Test::X86_WINDOWS).is_up_to_date());
+    options.switches.insert("clean-after-build");
+    CHECK_FALSE(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+    options.switches = {"dry-run"};
+    CHECK(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+    options.switches.clear();
+
+    // so is any change to a port file or to the triplet file
+    fs.write_contents(port_dir / "portfile.cmake", "message(STATUS a)\n", VCPKG_LINE_INFO);
+    CHECK_FALSE(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+    make_fingerprint(Test::X64_WINDOWS).save();
+    CHECK(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+
+    fs.append_contents(triplets / "x64-windows.cmake", "set(VCPKG_CRT_LINKAGE dynamic)\n", VCPKG_LINE_INFO);
+    CHECK_FALSE(make_fingerprint(Test::X64_WINDOWS).is_up_to_date());
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("install files -- benchmarks", "[install][!benchmark]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const fs::path root = base_temporary_directory() / "install-files-benchmark";
+    const fs::path package_dir = root / "packages" / "pkg_x64-linux";
+    fs.remove_all(root, VCPKG_LINE_INFO);
+
+    // 50,000 small headers in 500 directories, like an SDK-style port
+    const std::string contents(2048, 'x');
+    for (int dir = 0; dir < 500; ++dir)
+    {
+        const fs::path include_dir = package_dir / "include" / fs::u8path("module" + std::to_string(dir));
+        fs.create_directories(include_dir, VCPKG_LINE_INFO);
+        for (int file = 0; file < 100; ++file)
+        {
+            fs.write_contents(
+                include_dir / fs::u8path("header" + std::to_string(file) + ".h"), contents, VCPKG_LINE_INFO);
+        }
+    }
+
+    const auto files = fs.get_files_recursive(package_dir);
+    BENCHMARK_ADVANCED("install 50k files")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<InstallDir> dirs;
+        for (int run = 0; run < meter.runs(); ++run)
+        {
+            const fs::path installed = root / fs::u8path("installed" + std::to_string(run));
+            dirs.push_back(InstallDir::from_destination_root(installed, "x64-linux", installed / "pkg.list"));
+        }
+
+        meter.measure([&](int run) {
+            Install::install_files_and_write_listfile(fs, package_dir, files, dirs[run], InstallFileMode::LINK);
+        });
+
+        for (auto&& dir : dirs)
+        {
+            fs.remove_all(dir.listfile().parent_path(), VCPKG_LINE_INFO);
+        }
+    };
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+#endif
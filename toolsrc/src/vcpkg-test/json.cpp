@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include <vcpkg/base/json.h>
+#include <vcpkg/base/strings.h>
 #include <vcpkg/base/unicode.h>
 
 #include <iostream>
@@ -121,6 +122,11 @@ TEST_CASE ("JSON parse strings with escapes", "[json]")
     REQUIRE(res);
     REQUIRE(res.get()->first.is_string());
     REQUIRE(res.get()->first.string() == R"(This is a "test", hopefully it worked)");
+
+    res = Json::parse(R"("\ud800literal")"); // unpaired surrogate followed by literal characters
+    REQUIRE(res);
+    REQUIRE(res.get()->first.is_string());
+    REQUIRE(res.get()->first.string() == "\xED\xA0\x80literal");
 }
 
 TEST_CASE ("JSON parse integers", "[json]")
@@ -229,6 +235,131 @@ TEST_CASE ("JSON parse full file", "[json]")
     REQUIRE(res);
 }
 
+TEST_CASE ("JSON parse duplicate keys", "[json]")
+{
+    auto res = Json::parse(R"({"b": 1, "a": 2, "c": 3, "a": 4})", fs::u8path("filename"));
+    REQUIRE(!res);
+    REQUIRE(res.error()->format() ==
+            R"(Error: filename:1:26: Duplicated key "a" in an object
+   on expression: {"b": 1, "a": 2, "c": 3, "a": 4}
+                                           ^
+)");
+
+    res = Json::parse(R"({"a": {"a": 1}, "b": {"a": 2}})");
+    REQUIRE(res);
+}
+
+TEST_CASE ("JSON cursor", "[json]")
+{
+    Json::Cursor cursor(R"({
+  "skipped": {"a": [1, 2, {"b": null}]},
+  "default": {
+    "zlib": {"baseline": "1.2.11", "port-version": 9},
+    "esc\u0061ped": "x",
+    "empty": {}
+  },
+  "array": [1, "two", [3]]
+})");
+    REQUIRE(cursor.enter_object());
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "skipped");
+    // not entered or read, so skipped
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "default");
+    CHECK_FALSE(cursor.enter_array());
+    REQUIRE(cursor.enter_object());
+
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "zlib");
+    const auto zlib = cursor.read();
+    REQUIRE(zlib.is_object());
+    CHECK(zlib.object().get("baseline")->string() == "1.2.11");
+    CHECK(zlib.object().get("port-version")->integer() == 9);
+
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "escaped");
+    CHECK(cursor.read().string() == "x");
+
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "empty");
+    REQUIRE(cursor.enter_object());
+    CHECK_FALSE(cursor.next());
+    CHECK(cursor.key() == "empty");
+    CHECK_FALSE(cursor.next());
+
+    REQUIRE(cursor.next());
+    CHECK(cursor.key() == "array");
+    REQUIRE(cursor.enter_array());
+    REQUIRE(cursor.next());
+    CHECK(cursor.read().integer() == 1);
+    REQUIRE(cursor.next());
+    CHECK(cursor.read().string() == "two");
+    REQUIRE(cursor.next());
+    CHECK(cursor.read().array().size() == 1);
+    CHECK_FALSE(cursor.next());
+
+    CHECK_FALSE(cursor.next());
+    CHECK(cursor.finish());
+    CHECK(cursor.get_error() == nullptr);
+
+    // the rest of the document is parsed, and checked, by finish
+    Json::Cursor partial(R"({"a": [1, 2], "b": {"c": 3}} {})", "filename");
+    REQUIRE(partial.enter_object());
+    REQUIRE(partial.next());
+    CHECK_FALSE(partial.finish());
+    REQUIRE(partial.get_error());
+    CHECK(partial.get_error()->format() ==
+          R"(Error: filename:1:30: Unexpected character; expected EOF
+   on expression: {"a": [1, 2], "b": {"c": 3}} {}
+                                               ^
+)");
+}
+
+TEST_CASE ("JSON cursor errors", "[json]")
+{
+    Json::Cursor duplicate(R"({"b": 1, "a": {"x": 1, "x": 2}, "a": 4})", "filename");
+    REQUIRE(duplicate.enter_object());
+    while (duplicate.next())
+    {
+        if (duplicate.enter_object())
+        {
+            while (duplicate.next())
+            {
+            }
+        }
+    }
+    CHECK_FALSE(duplicate.finish());
+    REQUIRE(duplicate.get_error());
+    CHECK(duplicate.get_error()->format() ==
+          R"(Error: filename:1:24: Duplicated key "x" in an object
+   on expression: {"b": 1, "a": {"x": 1, "x": 2}, "a": 4}
+                                         ^
+)");
+
+    Json::Cursor trailing_comma(R"({"a": [1, 2,]})", "filename");
+    REQUIRE(trailing_comma.enter_object());
+    REQUIRE(trailing_comma.next());
+    REQUIRE(trailing_comma.enter_array());
+    CHECK(trailing_comma.next());
+    CHECK(trailing_comma.next());
+    CHECK_FALSE(trailing_comma.next());
+    CHECK_FALSE(trailing_comma.next());
+    CHECK_FALSE(trailing_comma.finish());
+    REQUIRE(trailing_comma.get_error());
+    CHECK(trailing_comma.get_error()->get_message() == "Trailing comma in array");
+
+    Json::Cursor not_an_object("[1]");
+    CHECK_FALSE(not_an_object.enter_object());
+    CHECK(not_an_object.read().is_array());
+    CHECK(not_an_object.finish());
+
+    Json::Cursor empty("");
+    CHECK_FALSE(empty.enter_object());
+    CHECK_FALSE(empty.finish());
+    REQUIRE(empty.get_error());
+    CHECK(empty.get_error()->get_message() == "Unexpected EOF; expected value");
+}
+
 TEST_CASE ("JSON track newlines", "[json]")
 {
     auto res = Json::parse("{\n,", fs::u8path("filename"));
@@ -239,3 +370,47 @@ TEST_CASE ("JSON track newlines", "[json]")
                   ^
 )");
 }
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("JSON parse benchmarks", "[json][!benchmark]")
+{
+    vcpkg::StringView large_document =
+#include "large-json-document.json.inc"
+        ;
+
+    // shaped like port_versions/baseline.json
+    std::string baseline = "{\n  \"default\": {\n";
+    for (int i = 0; i < 2000; ++i)
+    {
+        vcpkg::Strings::append(baseline,
+                               i == 0 ? "" : ",\n",
+                               "    \"port-",
+                               i,
+                               "\": {\n      \"baseline\": \"2020-10-",
+                               i % 28 + 1,
+                               "\",\n      \"port-version\": ",
+                               i % 5,
+                               "\n    }");
+    }
+    baseline.append("\n  }\n}\n");
+
+    BENCHMARK("large document") { return Json::parse(large_document); };
+    BENCHMARK("baseline document") { return Json::parse(baseline); };
+    BENCHMARK("baseline document with a cursor")
+    {
+        Json::Cursor cursor(baseline);
+        std::vector<Value> values;
+        cursor.enter_object();
+        while (cursor.next())
+        {
+            if (!cursor.enter_object()) continue;
+            while (cursor.next())
+            {
+                values.push_back(cursor.read());
+            }
+        }
+        cursor.finish();
+        return values;
+    };
+}
+#endif
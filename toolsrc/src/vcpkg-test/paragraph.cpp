@@ -3,9 +3,12 @@
 #include <vcpkg/base/strings.h>
 
 #include <vcpkg/paragraphs.h>
+#include <vcpkg/portcatalog.h>
 
 #include <vcpkg-test/util.h>
 
+#include <chrono>
+
 namespace Strings = vcpkg::Strings;
 using vcpkg::Parse::Paragraph;
 
@@ -502,3 +505,174 @@ TEST_CASE ("BinaryParagraph serialize abi", "[paragraph]")
     REQUIRE(pghs.size() == 1);
     REQUIRE(pghs[0]["Abi"].first == "123abc");
 }
+
+TEST_CASE ("try_load_ports keeps the order of the port directories", "[paragraph]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto ports_dir = vcpkg::Test::base_temporary_directory() / "try-load-ports";
+    fs.remove_all(ports_dir, VCPKG_LINE_INFO);
+
+    std::vector<fs::path> port_dirs;
+    for (int i = 0; i < 40; ++i)
+    {
+        const auto name = Strings::concat("port-", i);
+        port_dirs.push_back(ports_dir / name);
+        if (i % 10 == 3)
+        {
+            fs.write_contents_and_dirs(port_dirs.back() / "CONTROL", "Version: 1.0\n", VCPKG_LINE_INFO);
+        }
+        else if (i % 2 == 0)
+        {
+            fs.write_contents_and_dirs(
+                port_dirs.back() / "CONTROL", Strings::concat("Source: ", name, "\nVersion: 1.0\n"), VCPKG_LINE_INFO);
+        }
+        else
+        {
+            fs.write_contents_and_dirs(port_dirs.back() / "vcpkg.json",
+                                       Strings::concat(R"({"name": ")", name, R"(", "version-string": "1.0"})"),
+                                       VCPKG_LINE_INFO);
+        }
+    }
+
+    auto results = vcpkg::Paragraphs::try_load_ports(fs, port_dirs);
+    REQUIRE(results.errors.size() == 4);
+    REQUIRE(results.paragraphs.size() == 36);
+
+    std::vector<fs::path> expected_dirs;
+    for (int i = 0; i < 40; ++i)
+    {
+        if (i % 10 != 3)
+        {
+            expected_dirs.push_back(port_dirs[i]);
+        }
+    }
+
+    for (size_t i = 0; i < expected_dirs.size(); ++i)
+    {
+        REQUIRE(results.paragraphs[i].source_location == expected_dirs[i]);
+        REQUIRE(results.paragraphs[i].source_control_file->core_paragraph->name ==
+                fs::u8string(expected_dirs[i].filename()));
+    }
+
+    fs.remove_all(ports_dir, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("port catalog", "[paragraph]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto base = vcpkg::Test::base_temporary_directory() / "port-catalog";
+    const auto catalog_file = base / "catalog";
+    const auto manifest_port = base / "ports" / "manifest-port";
+    const auto control_port = base / "ports" / "control-port";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(manifest_port / "vcpkg.json",
+                               R"json({
+  "name": "manifest-port",
+  "version-semver": "1.2.3",
+  "port-version": 2,
+  "description": ["first line", "second line"],
+  "maintainers": "someone",
+  "homepage": "https://example.com",
+  "license": "MIT OR Apache-2.0",
+  "supports": "!uwp & (windows | linux)",
+  "$comment": "kept as extra information",
+  "dependencies": [
+    "zlib",
+    { "name": "curl", "features": ["ssl"], "platform": "!osx", "version>=": "7.0.0", "port-version": 1 }
+  ],
+  "overrides": [ { "name": "zlib", "version-string": "1.2.11", "port-version": 3 } ],
+  "default-features": ["extra"],
+  "features": { "extra": { "description": "more", "dependencies": [ "fmt" ] } }
+})json",
+                               VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(control_port / "CONTROL",
+                               "Source: control-port\nVersion: 1.0\nBuild-Depends: zlib (windows&&arm)\n\n"
+                               "Feature: tools\nDescription: the tools\n",
+                               VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(base / "ports" / "broken" / "CONTROL", "Version: 1.0\n", VCPKG_LINE_INFO);
+
+    // entries for files written within the last moments are not remembered
+    const auto old_time = fs::stdfs::file_time_type::clock::now() - std::chrono::hours(1);
+    const auto backdate = [&]() {
+        for (auto&& path : fs.get_files_recursive(base / "ports"))
+        {
+            fs::stdfs::last_write_time(path, old_time);
+        }
+    };
+    backdate();
+
+    const std::vector<fs::path> port_dirs = {manifest_port, control_port, base / "ports" / "broken"};
+    const auto fresh = vcpkg::Paragraphs::try_load_ports(fs, port_dirs);
+    REQUIRE(fresh.paragraphs.size() == 2);
+    const auto check_same = [&](const vcpkg::Paragraphs::LoadResults& results) {
+        REQUIRE(results.paragraphs.size() == 2);
+        CHECK(results.errors.size() == 1);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const auto& expected = *fresh.paragraphs[i].source_control_file;
+            const auto& actual = *results.paragraphs[i].source_control_file;
+            CHECK(actual == expected);
+            CHECK(actual.core_paragraph->overrides == expected.core_paragraph->overrides);
+        }
+    };
+
+    {
+        vcpkg::PortCatalog catalog(fs, catalog_file);
+        check_same(vcpkg::Paragraphs::try_load_ports(fs, port_dirs, &catalog));
+    }
+
+    // An unchanged port is answered from the catalog, without reading its port file: overwrite the port file with
+    // something else of the same size, and put back the stamps of the file and its directory.
+    const auto control_text = fs.read_contents(control_port / "CONTROL", VCPKG_LINE_INFO);
+    auto replaced_text = control_text;
+    replaced_text.replace(replaced_text.find("1.0"), 3, "9.9");
+    fs.write_contents(control_port / "CONTROL", replaced_text, VCPKG_LINE_INFO);
+    backdate();
+    {
+        vcpkg::PortCatalog catalog(fs, catalog_file);
+        check_same(vcpkg::Paragraphs::try_load_ports(fs, port_dirs, &catalog));
+
+        // a changed stamp is noticed
+        fs::stdfs::last_write_time(control_port / "CONTROL", old_time + std::chrono::minutes(1));
+        auto scf = catalog.try_load_port(control_port).value_or_exit(VCPKG_LINE_INFO);
+        CHECK(scf->core_paragraph->version == "9.9");
+    }
+
+    // adding a file changes the write time of the directory, even when the port file's stamp is put back
+    fs.write_contents(control_port / "CONTROL", control_text, VCPKG_LINE_INFO);
+    fs::stdfs::last_write_time(control_port / "CONTROL", old_time);
+    fs.write_contents(control_port / "portfile.cmake", "", VCPKG_LINE_INFO);
+    {
+        vcpkg::PortCatalog catalog(fs, catalog_file);
+        auto scf = catalog.try_load_port(control_port).value_or_exit(VCPKG_LINE_INFO);
+        CHECK(scf->core_paragraph->version == "1.0");
+    }
+
+    backdate();
+    // a corrupt catalog is ignored
+    auto catalog_contents = fs.read_contents(catalog_file, VCPKG_LINE_INFO);
+    for (size_t i = catalog_contents.find('\n') + 1; i < catalog_contents.size(); i += 7)
+    {
+        catalog_contents[i] = static_cast<char>(~catalog_contents[i]);
+    }
+    fs.write_contents(catalog_file, catalog_contents, VCPKG_LINE_INFO);
+    {
+        vcpkg::PortCatalog catalog(fs, catalog_file);
+        check_same(vcpkg::Paragraphs::try_load_ports(fs, port_dirs, &catalog));
+    }
+
+    fs.remove_all(base, VCPKG_LINE_INFO);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("try_load_ports benchmark", "[paragraph][!benchmark]")
+{
+    // the ports tree of the vcpkg checkout this test was built from
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto ports_dir = fs::u8path(__FILE__).parent_path().parent_path().parent_path().parent_path() / "ports";
+    if (!fs.exists(ports_dir)) return;
+
+    auto port_dirs = fs.get_files_non_recursive(ports_dir);
+    BENCHMARK("all ports") { return vcpkg::Paragraphs::try_load_ports(fs, port_dirs); };
+}
+#endif
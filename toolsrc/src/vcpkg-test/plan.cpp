@@ -66,8 +66,8 @@ TEST_CASE ("basic install scheme", "[plan]")
 
     PackageSpecMap spec_map;
     auto spec_a = spec_map.emplace("a", "b");
-    auto spec_b = spec_map.emplace("b", "c");
-    auto spec_c = spec_map.emplace("c");
+    spec_map.emplace("b", "c");
+    spec_map.emplace("c");
 
     PortFileProvider::MapPortFileProvider map_port(spec_map.map);
     MockCMakeVarProvider var_provider;
@@ -188,15 +188,15 @@ TEST_CASE ("long install scheme", "[plan]")
     PackageSpecMap spec_map;
 
     auto spec_a = spec_map.emplace("a", "b, c, d, e, f, g, h, j, k");
-    auto spec_b = spec_map.emplace("b", "c, d, e, f, g, h, j, k");
-    auto spec_c = spec_map.emplace("c", "d, e, f, g, h, j, k");
-    auto spec_d = spec_map.emplace("d", "e, f, g, h, j, k");
-    auto spec_e = spec_map.emplace("e", "f, g, h, j, k");
-    auto spec_f = spec_map.emplace("f", "g, h, j, k");
-    auto spec_g = spec_map.emplace("g", "h, j, k");
-    auto spec_h = spec_map.emplace("h", "j, k");
-    auto spec_j = spec_map.emplace("j", "k");
-    auto spec_k = spec_map.emplace("k");
+    spec_map.emplace("b", "c, d, e, f, g, h, j, k");
+    spec_map.emplace("c", "d, e, f, g, h, j, k");
+    spec_map.emplace("d", "e, f, g, h, j, k");
+    spec_map.emplace("e", "f, g, h, j, k");
+    spec_map.emplace("f", "g, h, j, k");
+    spec_map.emplace("g", "h, j, k");
+    spec_map.emplace("h", "j, k");
+    spec_map.emplace("j", "k");
+    spec_map.emplace("k");
 
     PortFileProvider::MapPortFileProvider map_port(spec_map.map);
     MockCMakeVarProvider var_provider;
@@ -689,8 +689,8 @@ TEST_CASE ("install plan action dependencies", "[plan]")
     // Add a port "a" which depends on the core of "b", which was already
     // installed explicitly
     PackageSpecMap spec_map(Test::X64_WINDOWS);
-    auto spec_c = spec_map.emplace("c");
-    auto spec_b = spec_map.emplace("b", "c");
+    spec_map.emplace("c");
+    spec_map.emplace("b", "c");
     spec_map.emplace("a", "b");
 
     // Install "a" (without explicit feature specification)
@@ -721,8 +721,8 @@ TEST_CASE ("install plan action dependencies 2", "[plan]")
     // Add a port "a" which depends on the core of "b", which was already
     // installed explicitly
     PackageSpecMap spec_map(Test::X64_WINDOWS);
-    auto spec_c = spec_map.emplace("c");
-    auto spec_b = spec_map.emplace("b", "c");
+    spec_map.emplace("c");
+    spec_map.emplace("b", "c");
     spec_map.emplace("a", "c, b");
 
     // Install "a" (without explicit feature specification)
@@ -1229,7 +1229,7 @@ TEST_CASE ("basic export scheme with recurse", "[plan]")
     StatusParagraphs status_db(std::move(pghs));
 
     PackageSpecMap spec_map;
-    auto spec_a = spec_map.emplace("a");
+    spec_map.emplace("a");
     auto spec_b = spec_map.emplace("b", "a");
 
     auto plan = Dependencies::create_export_plan({spec_b}, status_db);
@@ -1251,7 +1251,7 @@ TEST_CASE ("basic export scheme with bystander", "[plan]")
 
     PackageSpecMap spec_map;
     auto spec_a = spec_map.emplace("a");
-    auto spec_b = spec_map.emplace("b", "a");
+    spec_map.emplace("b", "a");
 
     auto plan = Dependencies::create_export_plan({spec_a}, status_db);
 
@@ -1295,3 +1295,62 @@ TEST_CASE ("basic export scheme with features", "[plan]")
     REQUIRE(plan.at(1).spec.name() == "a");
     REQUIRE(plan.at(1).plan_type == Dependencies::ExportPlanType::ALREADY_BUILT);
 }
+
+TEST_CASE ("dense graph topological sort", "[plan]")
+{
+    // 0 -> 2, 0 -> 1, 1 -> 3, 2 -> 3, 4 is unreachable
+    const std::vector<std::pair<size_t, size_t>> edges{{0, 2}, {1, 3}, {0, 1}, {2, 3}};
+    Graphs::DenseGraph graph(5, edges);
+    REQUIRE(graph.size() == 5);
+    CHECK(graph.adjacency_list(0).size() == 2);
+    CHECK(graph.adjacency_list(0)[0] == 2);
+    CHECK(graph.adjacency_list(0)[1] == 1);
+    CHECK(graph.adjacency_list(4).size() == 0);
+
+    auto to_string = [](size_t vertex) { return std::to_string(vertex); };
+    CHECK(Graphs::topological_sort({0}, graph, nullptr, to_string) == std::vector<size_t>{3, 2, 1, 0});
+    CHECK(Graphs::topological_sort({1, 0}, graph, nullptr, to_string) == std::vector<size_t>{3, 1, 2, 0});
+
+    // a chain far deeper than a recursive sort could handle
+    static constexpr size_t CHAIN_LENGTH = 1000000;
+    std::vector<std::pair<size_t, size_t>> chain;
+    for (size_t vertex = 0; vertex + 1 < CHAIN_LENGTH; ++vertex)
+    {
+        chain.emplace_back(vertex, vertex + 1);
+    }
+
+    auto sorted = Graphs::topological_sort({0}, Graphs::DenseGraph(CHAIN_LENGTH, chain), nullptr, to_string);
+    REQUIRE(sorted.size() == CHAIN_LENGTH);
+    CHECK(sorted.front() == CHAIN_LENGTH - 1);
+    CHECK(sorted.back() == 0);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("install plan benchmark", "[plan][!benchmark]")
+{
+    // 2000 ports sharing a long name prefix; each depends on up to three earlier ports
+    static constexpr int PORT_COUNT = 2000;
+    PackageSpecMap spec_map;
+    std::vector<FullPackageSpec> requested;
+    for (int i = 0; i < PORT_COUNT; ++i)
+    {
+        std::vector<std::string> depends;
+        for (int distance : {1, 7, 131})
+        {
+            if (i >= distance) depends.push_back(Strings::format("benchmark-port-%04d", i - distance));
+        }
+
+        const auto name = Strings::format("benchmark-port-%04d", i);
+        auto spec = spec_map.emplace(name.c_str(), Strings::join(", ", depends).c_str());
+        if (i % 10 == 0) requested.emplace_back(spec);
+    }
+
+    PortFileProvider::MapPortFileProvider map_port(spec_map.map);
+    MockCMakeVarProvider var_provider;
+    BENCHMARK("create_feature_install_plan")
+    {
+        auto plan = Dependencies::create_feature_install_plan(map_port, var_provider, requested, StatusParagraphs{});
+        return plan.install_actions.size();
+    };
+}
+#endif
@@ -35,6 +35,29 @@ TEST_CASE ("specifier conversion", "[specifier]")
     }
 }
 
+TEST_CASE ("interned names", "[specifier]")
+{
+    const std::string zlib = "zlib";
+    InternedName first(zlib);
+    InternedName second(std::string("zl") + "ib");
+    CHECK(first == second);
+    CHECK(&first.str() == &second.str());
+    CHECK(first.hash_code() == std::hash<std::string>()(zlib));
+    CHECK(InternedName() == InternedName(""));
+    CHECK(InternedName().str().empty());
+
+    CHECK(InternedName("abseil") < first);
+    CHECK_FALSE(first < InternedName("abseil"));
+    CHECK_FALSE(first < second);
+
+    PackageSpec spec(zlib, Test::X64_WINDOWS);
+    CHECK(spec == PackageSpec(first, Test::X64_WINDOWS));
+    CHECK(spec != PackageSpec(zlib, Test::X86_WINDOWS));
+    CHECK(std::hash<PackageSpec>()(spec) == std::hash<PackageSpec>()(PackageSpec("zlib", Test::X64_WINDOWS)));
+    CHECK(FeatureSpec(spec, "core") == FeatureSpec(spec, InternedName("core")));
+    CHECK(FeatureSpec(spec, "a") < FeatureSpec(spec, "core"));
+}
+
 TEST_CASE ("specifier parsing", "[specifier]")
 {
     SECTION ("parsed specifier from string")
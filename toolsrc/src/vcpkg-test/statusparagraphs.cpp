@@ -1,10 +1,21 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/util.h>
 
+#include <vcpkg/dependencies.h>
 #include <vcpkg/paragraphs.h>
+#include <vcpkg/portfileprovider.h>
 #include <vcpkg/statusparagraphs.h>
+#include <vcpkg/vcpkgcmdarguments.h>
+#include <vcpkg/vcpkglib.h>
+#include <vcpkg/vcpkgpaths.h>
 
+#include <chrono>
+#include <iterator>
+#include <string>
+
+#include <vcpkg-test/mockcmakevarprovider.h>
 #include <vcpkg-test/util.h>
 
 using namespace vcpkg;
@@ -114,3 +125,214 @@ Status: install ok installed
     auto it = status_db.find_installed({{"ffmpeg", Test::X64_WINDOWS}, "openssl"});
     REQUIRE(it != status_db.end());
 }
+
+TEST_CASE ("insert keeps lookups consistent", "[statusparagraphs]")
+{
+    StatusParagraphs status_db;
+    status_db.insert(make_status_pgh("a"));
+    status_db.insert(make_status_pgh("b"));
+    status_db.insert(make_status_feature_pgh("a", "f1"));
+    status_db.insert(make_status_pgh("a", "", "", "x64-windows"));
+
+    REQUIRE(status_db.find_installed({{"a", Test::X86_WINDOWS}, "f1"}) != status_db.end());
+    REQUIRE(status_db.find_installed({{"a", Test::X64_WINDOWS}, "f1"}) == status_db.end());
+    REQUIRE(status_db.find_all("a", Test::X86_WINDOWS).size() == 2);
+    REQUIRE(status_db.find_all("a", Test::X64_WINDOWS).size() == 1);
+
+    // replacing a paragraph updates it in place
+    auto removed = make_status_pgh("a");
+    removed->state = InstallState::NOT_INSTALLED;
+    status_db.insert(std::move(removed));
+    REQUIRE_FALSE(status_db.is_installed(PackageSpec{"a", Test::X86_WINDOWS}));
+    REQUIRE(status_db.find(PackageSpec{"a", Test::X86_WINDOWS}) != status_db.end());
+    REQUIRE(status_db.find_all("a", Test::X86_WINDOWS).size() == 2);
+    REQUIRE_FALSE(status_db.get_installed_package_view({"a", Test::X86_WINDOWS}).has_value());
+    REQUIRE(status_db.get_installed_package_view({"a", Test::X64_WINDOWS}).has_value());
+    REQUIRE(status_db.is_installed(PackageSpec{"b", Test::X86_WINDOWS}));
+}
+
+TEST_CASE ("status database journal", "[statusparagraphs]")
+{
+    static const std::string args_raw[] = {"install"};
+    auto& fs = Files::get_real_filesystem();
+    VcpkgCmdArguments args = VcpkgCmdArguments::create_from_arg_sequence(std::begin(args_raw), std::end(args_raw));
+    args.install_root_dir =
+        std::make_unique<std::string>(fs::u8string(base_temporary_directory() / fs::u8path("journal-installed")));
+    VcpkgPaths paths(fs, args);
+    fs.remove_all(paths.installed, VCPKG_LINE_INFO);
+
+    REQUIRE(database_load_check(paths).find_installed({"a", Test::X86_WINDOWS}) == StatusParagraphs().end());
+
+    auto a = make_status_pgh("a");
+    auto a_feature = make_status_feature_pgh("a", "f1");
+    a->state = InstallState::HALF_INSTALLED;
+    a_feature->state = InstallState::HALF_INSTALLED;
+    write_updates(paths, std::vector<StatusParagraph>{*a, *a_feature});
+    a->state = InstallState::INSTALLED;
+    a_feature->state = InstallState::INSTALLED;
+    write_updates(paths, std::vector<StatusParagraph>{*a, *a_feature});
+    write_updates(paths, std::vector<StatusParagraph>{*make_status_pgh("b", "a")});
+
+    // a small journal is replayed without rewriting the status file
+    const auto journal = paths.vcpkg_dir_updates / fs::u8path("journal");
+    auto status_db = database_load_check(paths);
+    CHECK(status_db.is_installed({{"a", Test::X86_WINDOWS}, "f1"}));
+    CHECK(status_db.is_installed(PackageSpec{"b", Test::X86_WINDOWS}));
+    CHECK(fs.exists(journal));
+    CHECK(!fs.exists(paths.vcpkg_dir_status_file));
+
+    // a crash in the middle of an append leaves a partial paragraph, which is discarded; the rest is compacted
+    auto b_removed = make_status_pgh("b", "a");
+    b_removed->state = InstallState::HALF_INSTALLED;
+    b_removed->want = Want::PURGE;
+    const auto b_removed_text = Strings::serialize(*b_removed);
+    fs.append_contents(journal, b_removed_text.substr(0, b_removed_text.size() - 5), VCPKG_LINE_INFO);
+    status_db = database_load_check(paths);
+    CHECK(status_db.is_installed(PackageSpec{"b", Test::X86_WINDOWS}));
+    CHECK(!fs.exists(journal));
+    CHECK(fs.exists(paths.vcpkg_dir_status_file));
+
+    // numbered update files written by earlier versions are replayed before the journal
+    b_removed->state = InstallState::NOT_INSTALLED;
+    fs.write_contents(paths.vcpkg_dir_updates / fs::u8path("0000000000"), b_removed_text, VCPKG_LINE_INFO);
+    fs.write_contents(paths.vcpkg_dir_updates / fs::u8path("0000000001"),
+                      Strings::serialize(*b_removed),
+                      VCPKG_LINE_INFO);
+    write_updates(paths, std::vector<StatusParagraph>{*make_status_pgh("b", "a")});
+    status_db = database_load_check(paths);
+    CHECK(status_db.is_installed(PackageSpec{"b", Test::X86_WINDOWS}));
+    CHECK(fs.get_files_non_recursive(paths.vcpkg_dir_updates).empty());
+    CHECK(database_load_check(paths).is_installed(PackageSpec{"a", Test::X86_WINDOWS}));
+}
+
+TEST_CASE ("installed files index", "[statusparagraphs]")
+{
+    static const std::string args_raw[] = {"install"};
+    auto& fs = Files::get_real_filesystem();
+    VcpkgCmdArguments args = VcpkgCmdArguments::create_from_arg_sequence(std::begin(args_raw), std::end(args_raw));
+    args.install_root_dir =
+        std::make_unique<std::string>(fs::u8string(base_temporary_directory() / fs::u8path("files-index-installed")));
+    const auto make_paths = [&] { return std::make_unique<VcpkgPaths>(fs, args); };
+    auto paths = make_paths();
+    fs.remove_all(paths->installed, VCPKG_LINE_INFO);
+    fs.create_directories(paths->vcpkg_dir_info, VCPKG_LINE_INFO);
+
+    // listfiles written a while ago, so that their stamps can be trusted
+    const auto write_listfile = [&](const StatusParagraph& pgh, const std::string& header) {
+        const auto listfile = paths->listfile_path(pgh.package);
+        fs.write_contents(listfile,
+                          Strings::concat("x86-windows/\nx86-windows/include/\nx86-windows/include/", header, '\n'),
+                          VCPKG_LINE_INFO);
+        fs::stdfs::last_write_time(listfile, fs::stdfs::file_time_type::clock::now() - std::chrono::hours(1));
+    };
+
+    const auto owner_of = [](const InstalledFilesIndex& index, const std::string& header) -> std::string {
+        auto owner = index.find_owner("x86-windows/include/" + header);
+        return owner ? owner->displayname : "";
+    };
+
+    std::vector<std::unique_ptr<StatusParagraph>> pghs;
+    pghs.push_back(make_status_pgh("a"));
+    pghs.push_back(make_status_pgh("b"));
+    write_listfile(*pghs[0], "a.h");
+    write_listfile(*pghs[1], "b.h");
+    StatusParagraphs status_db(std::move(pghs));
+
+    auto* index = &InstalledFilesIndex::get(*paths, status_db);
+    CHECK(owner_of(*index, "a.h") == "a:x86-windows");
+    CHECK(owner_of(*index, "b.h") == "b:x86-windows");
+    CHECK(owner_of(*index, "c.h").empty());
+    // directories are not owned
+    CHECK(index->find_owner("x86-windows/include/") == nullptr);
+    index->save(*paths);
+
+    // another run answers from the saved index while the listfiles are unchanged...
+    const auto a_listfile = paths->listfile_path(status_db.find_installed({"a", X86_WINDOWS})->get()->package);
+    const auto a_stamp = fs::stdfs::last_write_time(a_listfile);
+    fs.write_contents(a_listfile, "x86-windows/\nx86-windows/include/\nx86-windows/include/x.h\n", VCPKG_LINE_INFO);
+    fs::stdfs::last_write_time(a_listfile, a_stamp);
+    paths = make_paths();
+    CHECK(owner_of(InstalledFilesIndex::get(*paths, status_db), "a.h") == "a:x86-windows");
+
+    // ...and reads a listfile again once it changed
+    write_listfile(*status_db.find_installed({"a", X86_WINDOWS})->get(), "a2.h");
+    paths = make_paths();
+    index = &InstalledFilesIndex::get(*paths, status_db);
+    CHECK(owner_of(*index, "a.h").empty());
+    CHECK(owner_of(*index, "a2.h") == "a:x86-windows");
+    CHECK(owner_of(*index, "b.h") == "b:x86-windows");
+    index->save(*paths);
+
+    // later calls follow the packages which the status database installed and removed
+    auto c = make_status_pgh("c");
+    write_listfile(*c, "c.h");
+    auto b_removed = make_status_pgh("b");
+    b_removed->state = InstallState::NOT_INSTALLED;
+    status_db.insert(std::move(c));
+    status_db.insert(std::move(b_removed));
+    index = &InstalledFilesIndex::get(*paths, status_db);
+    CHECK(owner_of(*index, "b.h").empty());
+    CHECK(owner_of(*index, "c.h") == "c:x86-windows");
+    CHECK(index->owners().size() == 2);
+
+    // a corrupt index is rebuilt from the listfiles
+    fs.write_contents(paths->vcpkg_dir / fs::u8path("files-index"),
+                      "vcpkg installed files index v1\n\tnot a stamp\n",
+                      VCPKG_LINE_INFO);
+    paths = make_paths();
+    index = &InstalledFilesIndex::get(*paths, status_db);
+    CHECK(owner_of(*index, "a2.h") == "a:x86-windows");
+    CHECK(owner_of(*index, "c.h") == "c:x86-windows");
+
+    fs.remove_all(paths->installed, VCPKG_LINE_INFO);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("status database benchmarks", "[statusparagraphs][!benchmark]")
+{
+    // 1000 ports, each installed with 4 features: 5000 paragraphs. Each port depends on the previous one.
+    static constexpr int port_count = 1000;
+    static constexpr const char* features[] = {"f1", "f2", "f3", "f4"};
+
+    PackageSpecMap spec_map;
+    std::vector<std::unique_ptr<StatusParagraph>> pghs;
+    for (int i = 0; i < port_count; ++i)
+    {
+        const std::string name = Strings::concat("port", i);
+        const std::string depends = i == 0 ? std::string() : Strings::concat("port", i - 1);
+        spec_map.emplace(name.c_str(), depends.c_str(), {{"f1", ""}, {"f2", ""}, {"f3", ""}, {"f4", ""}});
+        pghs.push_back(make_status_pgh(name.c_str(), depends.c_str()));
+        for (auto&& feature : features)
+        {
+            pghs.push_back(make_status_feature_pgh(name.c_str(), feature));
+        }
+    }
+
+    const StatusParagraphs status_db(std::move(pghs));
+    PortFileProvider::MapPortFileProvider provider(spec_map.map);
+    Test::MockCMakeVarProvider var_provider;
+
+    BENCHMARK("find_installed for every paragraph")
+    {
+        size_t found = 0;
+        for (int i = 0; i < port_count; ++i)
+        {
+            const PackageSpec spec{Strings::concat("port", i), Test::X86_WINDOWS};
+            found += status_db.find_installed(spec) != status_db.end();
+            for (auto&& feature : features)
+            {
+                found += status_db.find_installed(FeatureSpec{spec, feature}) != status_db.end();
+            }
+        }
+
+        return found;
+    };
+
+    BENCHMARK("plan an already installed dependency chain")
+    {
+        return Dependencies::create_feature_install_plan(
+                   provider, var_provider, {FullPackageSpec{{"port999", Test::X86_WINDOWS}, {"f1"}}}, status_db)
+            .size();
+    };
+}
+#endif
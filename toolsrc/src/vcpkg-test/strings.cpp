@@ -71,3 +71,62 @@ TEST_CASE ("edit distance", "[strings]")
     REQUIRE(byte_edit_distance("", "hello") == 5);
     REQUIRE(byte_edit_distance("world", "") == 5);
 }
+
+TEST_CASE ("line splitter", "[strings]")
+{
+    using vcpkg::StringView;
+
+    const std::string text = "first\n\nthird line\r\nlong fourth line\nlast";
+    const std::vector<std::string> expected = {"first", "", "third line\r", "long fourth line", "last"};
+    for (size_t chunk_size = 1; chunk_size <= text.size(); ++chunk_size)
+    {
+        vcpkg::Strings::LineSplitter splitter;
+        std::vector<std::string> lines;
+        const auto add_line = [&](StringView line) { lines.push_back(line.to_string()); };
+        for (size_t i = 0; i < text.size(); i += chunk_size)
+        {
+            splitter.feed(StringView{text}.substr(i, chunk_size), add_line);
+        }
+
+        splitter.finish(add_line);
+        REQUIRE(lines == expected);
+    }
+
+    vcpkg::Strings::LineSplitter splitter;
+    std::vector<std::string> lines;
+    const auto add_line = [&](StringView line) { lines.push_back(line.to_string()); };
+    splitter.feed("a\n", add_line);
+    splitter.finish(add_line);
+    CHECK(lines == std::vector<std::string>{"a", ""});
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("line splitter: benchmark", "[.][strings][!benchmark]")
+{
+    using vcpkg::StringView;
+
+    // About 200 MB of build output, read in the 64 KiB chunks the process layer uses
+    std::string log;
+    for (int i = 0; log.size() < 200'000'000; ++i)
+    {
+        log += "[" + std::to_string(i) + "/1000000] /usr/bin/c++ -DBUILDING_LIBRARY -I/vcpkg/buildtrees/port/include";
+        log.append(static_cast<size_t>(i % 97), 'x');
+        log += " -O2 -g -c /vcpkg/buildtrees/port/src/file" + std::to_string(i) + ".cpp\n";
+    }
+
+    constexpr size_t chunk_size = 1024 * 64;
+    BENCHMARK("200 MB in 64 KiB chunks")
+    {
+        vcpkg::Strings::LineSplitter splitter;
+        size_t line_count = 0;
+        const auto count_line = [&](StringView line) { line_count += line.size() != 0; };
+        for (size_t i = 0; i < log.size(); i += chunk_size)
+        {
+            splitter.feed(StringView{log}.substr(i, chunk_size), count_line);
+        }
+
+        splitter.finish(count_line);
+        return line_count;
+    };
+}
+#endif
@@ -10,6 +10,7 @@
 #include <vcpkg/base/zstringview.h>
 
 #include <string>
+#include <vector>
 
 #if defined(_MSC_VER)
 #pragma warning(disable : 6237)
@@ -145,3 +146,53 @@ TEST_CASE ("cmdlinebuilder", "[system]")
     REQUIRE(cmd.extract() == "\"trailing\\\\slash\\\\\" \"inner\\\"quotes\"");
 #endif
 }
+
+#if !defined(_WIN32)
+TEST_CASE ("cmd_execute_and_capture_output_parallel", "[system]")
+{
+    using vcpkg::System::CmdLineBuilder;
+    using vcpkg::System::cmd_execute;
+    using vcpkg::System::cmd_execute_and_capture_output;
+    using vcpkg::System::cmd_execute_and_capture_output_parallel;
+
+    std::vector<CmdLineBuilder> cmd_lines(4);
+    cmd_lines[0].string_arg("echo").string_arg("hello");
+    cmd_lines[1].string_arg("sh").string_arg("-c").string_arg("echo out; echo err 1>&2; exit 3");
+    cmd_lines[2].string_arg("echo").string_arg("a").ampersand().string_arg("echo").string_arg("b");
+    cmd_lines[3].string_arg("vcpkg-test-no-such-program");
+    for (int i = 0; i < 20; ++i)
+    {
+        cmd_lines.emplace_back();
+        cmd_lines.back().string_arg("head").string_arg("-c").string_arg(std::to_string(100000 + i)).string_arg(
+            "/dev/zero");
+    }
+
+    const auto results = cmd_execute_and_capture_output_parallel(cmd_lines);
+    REQUIRE(results.size() == cmd_lines.size());
+    CHECK(results[0].exit_code == 0);
+    CHECK(results[0].output == "hello\n");
+    CHECK(results[1].exit_code == 3);
+    CHECK(results[1].output == "out\nerr\n");
+    CHECK(results[2].output == "a\nb\n");
+    CHECK(results[3].exit_code == 127);
+    for (int i = 0; i < 20; ++i)
+    {
+        CHECK(results[4 + i].exit_code == 0);
+        CHECK(results[4 + i].output.size() == static_cast<size_t>(100000 + i));
+    }
+
+    // a builder's arguments reach the program as they are, without a shell interpreting them
+    CmdLineBuilder printf_cmd;
+    printf_cmd.string_arg("printf").string_arg("%s|").string_arg("$HOME").string_arg("a b").string_arg("it's;*");
+    CHECK(cmd_execute_and_capture_output(printf_cmd).output == "$HOME|a b|it's;*|");
+
+    // command line strings go through the shell
+    CHECK(cmd_execute_and_capture_output("echo a && echo b").output == "a\nb\n");
+    CHECK(cmd_execute_and_capture_output("vcpkg-test-no-such-program").exit_code == 127);
+    CHECK(cmd_execute("sh -c 'exit 5'") == 5);
+
+    const auto env = vcpkg::System::get_modified_clean_environment({{"VCPKG_TEST_VARIABLE", "some value"}});
+    CHECK(cmd_execute_and_capture_output("sh -c 'echo $VCPKG_TEST_VARIABLE'", env).output == "some value\n");
+    CHECK(cmd_execute_and_capture_output("sh -c 'echo $VCPKG_TEST_VARIABLE'").output == "\n");
+}
+#endif
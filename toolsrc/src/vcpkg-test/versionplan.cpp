@@ -1,9 +1,13 @@
 #include <catch2/catch.hpp>
 
+#include <vcpkg/base/strings.h>
+
 #include <vcpkg/dependencies.h>
 #include <vcpkg/paragraphparser.h>
 #include <vcpkg/portfileprovider.h>
 #include <vcpkg/sourceparagraph.h>
+#include <vcpkg/versiondeserializers.h>
+#include <vcpkg/versions.h>
 
 #include <vcpkg-test/mockcmakevarprovider.h>
 #include <vcpkg-test/util.h>
@@ -150,3 +154,120 @@ TEST_CASE ("resolve_deps_as_top_level", "[dependencies]")
         REQUIRE(deps.at(0) == spec_c);
     }
 }
+
+TEST_CASE ("parse baseline and versions files", "[versionplan]")
+{
+    auto& fs = Files::get_real_filesystem();
+    const auto dir = Test::base_temporary_directory() / fs::u8path("version-database");
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+    fs.create_directories(dir, VCPKG_LINE_INFO);
+
+    const auto baseline_file = dir / fs::u8path("baseline.json");
+    fs.write_contents(baseline_file,
+                      R"({
+  "other": {"zlib": {"version-string": "0.1"}},
+  "default": {
+    "zlib": {"version-string": "1.2.11", "port-version": 9},
+    "fmt": {"version-string": "7.1.3"}
+  }
+})",
+                      VCPKG_LINE_INFO);
+    auto baseline = parse_baseline_file(fs, "default", baseline_file);
+    REQUIRE(baseline.has_value());
+    CHECK(*baseline.get() ==
+          std::map<std::string, VersionT, std::less<>>{{"fmt", VersionT{"7.1.3", 0}}, {"zlib", VersionT{"1.2.11", 9}}});
+    CHECK(parse_baseline_file(fs, "other", baseline_file).value_or_exit(VCPKG_LINE_INFO).at("zlib") ==
+          VersionT{"0.1", 0});
+    CHECK(Strings::contains(parse_baseline_file(fs, "missing", baseline_file).error(),
+                            "does not contain the baseline \"missing\""));
+
+    fs.write_contents(baseline_file, R"({"default": {"zlib": {"version-string": 1}}})", VCPKG_LINE_INFO);
+    CHECK(Strings::contains(parse_baseline_file(fs, "default", baseline_file).error(),
+                            "$.default.zlib.version-string"));
+
+    fs.write_contents(baseline_file, R"({"default": {"zlib": {}, "zlib": {}}})", VCPKG_LINE_INFO);
+    CHECK(Strings::contains(parse_baseline_file(fs, "default", baseline_file).error(), "Duplicated key \"zlib\""));
+
+    const auto versions_file = dir / fs::u8path("zlib.json");
+    fs.write_contents(versions_file,
+                      R"({
+  "versions": [
+    {"git-tree": "1111111111111111111111111111111111111111", "version-string": "1.2.11", "port-version": 9},
+    {"git-tree": "2222222222222222222222222222222222222222", "version-semver": "1.2.10"},
+    "not an entry"
+  ]
+})",
+                      VCPKG_LINE_INFO);
+    const auto entries = parse_versions_file(fs, "zlib", versions_file).value_or_exit(VCPKG_LINE_INFO);
+    REQUIRE(entries.size() == 2);
+    CHECK(entries[0].version == VersionT{"1.2.11", 9});
+    CHECK(entries[0].scheme == Versions::Scheme::String);
+    CHECK(entries[0].git_tree == "1111111111111111111111111111111111111111");
+    CHECK(entries[1].version == VersionT{"1.2.10", 0});
+    CHECK(entries[1].scheme == Versions::Scheme::Semver);
+
+    fs.write_contents(versions_file, R"({"versions": {}})", VCPKG_LINE_INFO);
+    CHECK(Strings::contains(parse_versions_file(fs, "zlib", versions_file).error(),
+                            "does not contain a versions array"));
+
+    fs.write_contents(versions_file, R"({"versions": [)", VCPKG_LINE_INFO);
+    CHECK(Strings::contains(parse_versions_file(fs, "zlib", versions_file).error(), "Unexpected EOF"));
+
+    fs.remove_all(dir, VCPKG_LINE_INFO);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("version parse benchmarks", "[versionplan][!benchmark]")
+{
+    std::vector<std::string> relaxed;
+    std::vector<std::string> semver;
+    std::vector<std::string> date;
+    for (int i = 0; i < 100; ++i)
+    {
+        relaxed.push_back(Strings::concat(i / 10, '.', i % 10, '.', i, ".20"));
+        semver.push_back(Strings::concat("1.", i, ".0-beta.", i % 7, "+build.", i));
+        date.push_back(Strings::concat("2021-01-", 10 + i % 20, '.', i));
+    }
+
+    BENCHMARK("parse relaxed")
+    {
+        size_t n = 0;
+        for (auto&& v : relaxed)
+            n += Versions::RelaxedVersion::from_string(v).get()->version.size();
+        return n;
+    };
+
+    BENCHMARK("parse semver")
+    {
+        size_t n = 0;
+        for (auto&& v : semver)
+            n += Versions::SemanticVersion::from_string(v).get()->identifiers.size();
+        return n;
+    };
+
+    BENCHMARK("parse date")
+    {
+        size_t n = 0;
+        for (auto&& v : date)
+            n += Versions::DateVersion::from_string(v).get()->identifiers.size();
+        return n;
+    };
+
+    BENCHMARK("compare semver")
+    {
+        int lt = 0;
+        for (auto&& v : semver)
+            lt += Versions::compare(v, semver.front(), Versions::Scheme::Semver) == Versions::VerComp::lt;
+        return lt;
+    };
+
+    Versions::VersionComparer comparer;
+    BENCHMARK("compare semver with comparer")
+    {
+        int lt = 0;
+        for (auto&& v : semver)
+            lt += comparer.compare(v, semver.front(), Versions::Scheme::Semver) == Versions::VerComp::lt;
+        return lt;
+    };
+}
+#endif
@@ -0,0 +1,272 @@
+#include <catch2/catch.hpp>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/zip.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <vcpkg-test/util.h>
+
+using vcpkg::StringView;
+using vcpkg::Test::base_temporary_directory;
+using vcpkg::Test::can_create_symlinks;
+namespace Zip = vcpkg::Zip;
+
+namespace
+{
+    std::string random_bytes(size_t size, std::uint64_t seed)
+    {
+        std::mt19937_64 urbg{seed};
+        std::uniform_int_distribution<int> byte{0, 255};
+        std::string result(size, '\0');
+        for (auto&& c : result)
+        {
+            c = static_cast<char>(byte(urbg));
+        }
+
+        return result;
+    }
+
+    std::string text_like(size_t size)
+    {
+        static constexpr StringView words[] = {"vcpkg ", "port ", "triplet ", "x64-linux ", "\n", "feature ", "zlib "};
+        std::mt19937_64 urbg{42};
+        std::uniform_int_distribution<size_t> pick{0, sizeof(words) / sizeof(words[0]) - 1};
+        std::string result;
+        while (result.size() < size)
+        {
+            const auto word = words[pick(urbg)];
+            result.append(word.data(), word.size());
+        }
+
+        result.resize(size);
+        return result;
+    }
+
+    struct RawEntry
+    {
+        std::string name;
+        std::string data;
+        bool symlink;
+    };
+
+    void put_le(std::string& out, uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    // Writes a stored archive whose entries can be anything, including ones compress_directory never produces.
+    std::string make_raw_archive(const std::vector<RawEntry>& entries)
+    {
+        std::string archive;
+        std::string central_directory;
+        for (auto&& entry : entries)
+        {
+            const uint32_t offset = static_cast<uint32_t>(archive.size());
+            const uint32_t crc = Zip::crc32(entry.data);
+            const uint32_t size = static_cast<uint32_t>(entry.data.size());
+            const uint32_t name_size = static_cast<uint32_t>(entry.name.size());
+            put_le(archive, 0x04034b50, 4);
+            put_le(archive, 20, 2);
+            put_le(archive, 0, 2);
+            put_le(archive, 0, 2);
+            put_le(archive, 0, 4);
+            put_le(archive, crc, 4);
+            put_le(archive, size, 4);
+            put_le(archive, size, 4);
+            put_le(archive, name_size, 2);
+            put_le(archive, 0, 2);
+            archive += entry.name;
+            archive += entry.data;
+
+            put_le(central_directory, 0x02014b50, 4);
+            put_le(central_directory, 0x031E, 2);
+            put_le(central_directory, 20, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, 0, 4);
+            put_le(central_directory, crc, 4);
+            put_le(central_directory, size, 4);
+            put_le(central_directory, size, 4);
+            put_le(central_directory, name_size, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, 0, 2);
+            put_le(central_directory, (entry.symlink ? 0120777u : 0100644u) << 16, 4);
+            put_le(central_directory, offset, 4);
+            central_directory += entry.name;
+        }
+
+        const uint32_t central_directory_offset = static_cast<uint32_t>(archive.size());
+        archive += central_directory;
+        put_le(archive, 0x06054b50, 4);
+        put_le(archive, 0, 4);
+        put_le(archive, static_cast<uint32_t>(entries.size()), 2);
+        put_le(archive, static_cast<uint32_t>(entries.size()), 2);
+        put_le(archive, static_cast<uint32_t>(central_directory.size()), 4);
+        put_le(archive, central_directory_offset, 4);
+        put_le(archive, 0, 2);
+        return archive;
+    }
+
+    void check_round_trip(const std::string& data)
+    {
+        const auto compressed = Zip::deflate(data);
+        const auto decompressed = Zip::inflate(compressed, data.size());
+        REQUIRE(decompressed.has_value());
+        CHECK(*decompressed.get() == data);
+    }
+}
+
+TEST_CASE ("crc32", "[zip]")
+{
+    CHECK(Zip::crc32("") == 0);
+    CHECK(Zip::crc32("123456789") == 0xCBF43926);
+    CHECK(Zip::crc32("6789", Zip::crc32("12345")) == 0xCBF43926);
+}
+
+TEST_CASE ("deflate round trip", "[zip]")
+{
+    check_round_trip("");
+    check_round_trip("a");
+    check_round_trip(std::string(100000, 'a'));
+    check_round_trip(text_like(300000));
+    check_round_trip(random_bytes(200000, 1));
+    check_round_trip(text_like(50000) + random_bytes(70000, 2) + text_like(50000));
+
+    CHECK(Zip::deflate(text_like(100000)).size() < 100000 / 4);
+    CHECK(Zip::deflate(random_bytes(100000, 3)).size() < 100000 + 100);
+}
+
+TEST_CASE ("inflate known streams", "[zip]")
+{
+    // fixed Huffman block, as produced by zlib for "hello hello hello"
+    const unsigned char fixed[] = {0xcb, 0x48, 0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0x40, 0x90, 0x00};
+    auto fixed_result = Zip::inflate(StringView{reinterpret_cast<const char*>(fixed), sizeof(fixed)});
+    REQUIRE(fixed_result.has_value());
+    CHECK(*fixed_result.get() == "hello hello hello");
+
+    // stored block containing "abc"
+    const unsigned char stored[] = {0x01, 0x03, 0x00, 0xfc, 0xff, 'a', 'b', 'c'};
+    auto stored_result = Zip::inflate(StringView{reinterpret_cast<const char*>(stored), sizeof(stored)});
+    REQUIRE(stored_result.has_value());
+    CHECK(*stored_result.get() == "abc");
+}
+
+TEST_CASE ("inflate rejects corrupt streams", "[zip]")
+{
+    const auto compressed = Zip::deflate(text_like(10000));
+    CHECK_FALSE(Zip::inflate(StringView{compressed.data(), compressed.size() / 2}).has_value());
+    CHECK_FALSE(Zip::inflate("\x07").has_value()); // reserved block type
+    CHECK_FALSE(Zip::inflate(StringView{"\x01\x03\x00\x00\x00", 5}).has_value());
+}
+
+TEST_CASE ("compress and decompress a directory", "[zip]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    std::error_code ec;
+    const auto base = base_temporary_directory() / "zip";
+    const auto source = base / "source";
+    const auto archive = base / "archive.zip";
+    const auto destination = base / "destination";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+    fs.create_directories(source / "include" / "nested", ec);
+    fs.create_directories(source / "empty", ec);
+    REQUIRE_FALSE(ec);
+
+    const auto header = text_like(20000);
+    const auto binary = random_bytes(5000, 4);
+    // larger than what is held in memory, so these are streamed through temporary files
+    const auto large_text = text_like(3 << 20);
+    const auto large_binary = random_bytes(2 << 20, 5);
+    fs.write_contents(source / "include" / "nested" / "header.h", header, VCPKG_LINE_INFO);
+    fs.write_contents(source / "lib.a", binary, VCPKG_LINE_INFO);
+    fs.write_contents(source / "large.txt", large_text, VCPKG_LINE_INFO);
+    fs.write_contents(source / "large.bin", large_binary, VCPKG_LINE_INFO);
+    fs.write_contents(source / "empty.txt", "", VCPKG_LINE_INFO);
+    const bool symlinks = can_create_symlinks();
+    if (symlinks)
+    {
+        vcpkg::Test::create_symlink(fs::u8path("lib.a"), source / "lib-link.a", ec);
+        REQUIRE_FALSE(ec);
+    }
+
+    auto entries = Zip::compress_directory(fs, source, archive);
+    REQUIRE(entries.has_value());
+    CHECK(*entries.get() == (symlinks ? 9 : 8));
+    CHECK(fs.get_files_non_recursive(base).size() == 2); // no temporary files are left behind
+    CHECK(fs.read_contents(archive, VCPKG_LINE_INFO).size() < large_text.size() / 2 + large_binary.size() + 30000);
+
+    auto extracted = Zip::decompress_archive(fs, archive, destination);
+    REQUIRE(extracted.has_value());
+    CHECK(*extracted.get() == *entries.get());
+    CHECK(fs.read_contents(destination / "include" / "nested" / "header.h", VCPKG_LINE_INFO) == header);
+    CHECK(fs.read_contents(destination / "lib.a", VCPKG_LINE_INFO) == binary);
+    CHECK(fs.read_contents(destination / "large.txt", VCPKG_LINE_INFO) == large_text);
+    CHECK(fs.read_contents(destination / "large.bin", VCPKG_LINE_INFO) == large_binary);
+    CHECK(fs.read_contents(destination / "empty.txt", VCPKG_LINE_INFO) == "");
+    CHECK(fs.is_directory(destination / "empty"));
+    if (symlinks)
+    {
+        CHECK(fs::is_symlink(fs.symlink_status(destination / "lib-link.a", ec)));
+        CHECK(fs::stdfs::read_symlink(destination / "lib-link.a", ec) == fs::u8path("lib.a"));
+    }
+
+    // archives of the same tree are identical
+    const auto first = fs.read_contents(archive, VCPKG_LINE_INFO);
+    REQUIRE(Zip::compress_directory(fs, source, archive).has_value());
+    CHECK(fs.read_contents(archive, VCPKG_LINE_INFO) == first);
+
+    fs.remove_all(base, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("decompress refuses to write outside of the destination", "[zip]")
+{
+    auto& fs = vcpkg::Files::get_real_filesystem();
+    const auto base = base_temporary_directory() / "zip-escape";
+    const auto archive = base / "archive.zip";
+    const auto destination = base / "destination";
+    const auto outside = base / "outside";
+    fs.remove_all(base, VCPKG_LINE_INFO);
+    fs.create_directories(outside, VCPKG_LINE_INFO);
+
+    const auto check_refused = [&](const std::vector<RawEntry>& entries) {
+        fs.remove_all(destination, VCPKG_LINE_INFO);
+        fs.write_contents(archive, make_raw_archive(entries), VCPKG_LINE_INFO);
+        CHECK_FALSE(Zip::decompress_archive(fs, archive, destination).has_value());
+        CHECK(fs.is_empty(outside));
+    };
+
+    // a link to somewhere else, followed by a file written through it
+    check_refused({{"a", fs::generic_u8string(outside), true}, {"a/evil", "evil", false}});
+    check_refused({{"a", "../outside", true}, {"a/evil", "evil", false}});
+    // links which lead outside on their own
+    check_refused({{"a", fs::generic_u8string(outside), true}});
+    check_refused({{"sub/a", "../../outside", true}});
+    // a link which only leads outside by way of another link
+    check_refused({{"sub/up", "..", true}, {"b", "sub/up/../outside", true}});
+
+    const std::vector<RawEntry> safe = {
+        {"sub/file", "contents", false},
+        {"sub/link", "file", true},
+        {"up", "sub/../sub/file", true},
+    };
+    fs.remove_all(destination, VCPKG_LINE_INFO);
+    fs.write_contents(archive, make_raw_archive(safe), VCPKG_LINE_INFO);
+    auto extracted = Zip::decompress_archive(fs, archive, destination);
+    REQUIRE(extracted.has_value());
+    if (can_create_symlinks())
+    {
+        CHECK(fs.read_contents(destination / "sub" / "link", VCPKG_LINE_INFO) == "contents");
+        CHECK(fs.read_contents(destination / "up", VCPKG_LINE_INFO) == "contents");
+    }
+
+    fs.remove_all(base, VCPKG_LINE_INFO);
+}
@@ -0,0 +1,97 @@
+#include <vcpkg/base/system_headers.h>
+
+#include <vcpkg/base/cachefile.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
+
+#include <chrono>
+
+namespace vcpkg::CacheFile
+{
+    static constexpr std::chrono::seconds RECENT_WRITE_WINDOW{2};
+
+    bool FileStamp::is_recent() const
+    {
+        const auto time = fs::stdfs::file_time_type(fs::stdfs::file_time_type::duration(write_time));
+        return time > fs::stdfs::file_time_type::clock::now() - RECENT_WRITE_WINDOW;
+    }
+
+    std::string FileStamp::to_string() const { return Strings::concat(size, '\t', write_time); }
+
+    Optional<FileStamp> FileStamp::parse(const std::string& size, const std::string& write_time)
+    {
+        auto parsed_size = Strings::strto<long long>(size);
+        auto parsed_write_time = Strings::strto<long long>(write_time);
+        if (!parsed_size || !parsed_write_time) return nullopt;
+        return FileStamp{*parsed_size.get(), *parsed_write_time.get()};
+    }
+
+    bool operator==(const FileStamp& lhs, const FileStamp& rhs)
+    {
+        return lhs.size == rhs.size && lhs.write_time == rhs.write_time;
+    }
+
+    bool operator!=(const FileStamp& lhs, const FileStamp& rhs) { return !(lhs == rhs); }
+
+    Optional<FileStamp> get_file_stamp(const fs::path& path)
+    {
+        std::error_code ec;
+        const auto status = fs::stdfs::status(path, ec);
+        if (ec || !fs::stdfs::exists(status)) return nullopt;
+        const auto write_time = fs::stdfs::last_write_time(path, ec);
+        if (ec) return nullopt;
+
+        long long size = -1;
+        if (!fs::stdfs::is_directory(status))
+        {
+            const auto file_size = fs::stdfs::file_size(path, ec);
+            if (ec) return nullopt;
+            size = static_cast<long long>(file_size);
+        }
+
+        return FileStamp{size, static_cast<long long>(write_time.time_since_epoch().count())};
+    }
+
+    void write_contents_atomically(Files::Filesystem& fs,
+                                   const fs::path& path,
+                                   const std::string& contents,
+                                   std::error_code& ec)
+    {
+#if defined(_WIN32)
+        const auto process_id = GetCurrentProcessId();
+#else
+        const auto process_id = getpid();
+#endif
+        const auto path_new = fs::path(path).concat(Strings::concat(".", process_id, ".new"));
+        fs.create_directories(path.parent_path(), ec);
+        fs.write_contents(path_new, contents, ec);
+        if (!ec) fs.rename(path_new, path, ec);
+        if (ec) fs.remove(path_new, ignore_errors);
+    }
+
+    Optional<std::string> load(const Files::Filesystem& fs, const fs::path& cache_file, StringView header)
+    {
+        auto maybe_contents = fs.read_contents(cache_file);
+        auto contents = maybe_contents.get();
+        if (!contents) return nullopt;
+
+        const auto newline = contents->find('\n');
+        if (newline == std::string::npos || StringView{contents->data(), newline} != header) return nullopt;
+        contents->erase(0, newline + 1);
+        return std::move(*contents);
+    }
+
+    void save(Files::Filesystem& fs, const fs::path& cache_file, StringView header, StringView body)
+    {
+        std::string contents;
+        contents.reserve(header.size() + 1 + body.size());
+        Strings::append(contents, header, '\n', body);
+
+        std::error_code ec;
+        write_contents_atomically(fs, cache_file, contents, ec);
+        if (ec)
+        {
+            Debug::print("Failed to save ", fs::u8string(cache_file), ": ", ec.message(), '\n');
+        }
+    }
+}
@@ -2,6 +2,8 @@
 #include <vcpkg/base/stringview.h>
 #include <vcpkg/base/system.debug.h>
 
+#include <utility>
+
 namespace vcpkg
 {
     static void (*g_shutdown_handler)() = nullptr;
@@ -13,8 +15,20 @@ namespace vcpkg
         g_shutdown_handler = func;
     }
 
+    namespace
+    {
+        struct CaughtExit
+        {
+            int exit_code;
+        };
+
+        thread_local bool t_catching_exits = false;
+    }
+
     [[noreturn]] void Checks::final_cleanup_and_exit(const int exit_code)
     {
+        if (t_catching_exits) throw CaughtExit{exit_code};
+
         static std::atomic<bool> have_entered{false};
         if (have_entered.exchange(true))
         {
@@ -35,6 +49,29 @@ namespace vcpkg
         std::exit(exit_code);
     }
 
+    bool Checks::run_catching_exit(const std::function<void()>& f, int& exit_code)
+    {
+        const bool was_catching = std::exchange(t_catching_exits, true);
+        try
+        {
+            f();
+        }
+        catch (const CaughtExit& caught)
+        {
+            t_catching_exits = was_catching;
+            exit_code = caught.exit_code;
+            return true;
+        }
+        catch (...)
+        {
+            t_catching_exits = was_catching;
+            throw;
+        }
+
+        t_catching_exits = was_catching;
+        return false;
+    }
+
     [[noreturn]] void Checks::unreachable(const LineInfo& line_info)
     {
         System::print2(System::Color::error, "Error: Unreachable code was reached\n");
@@ -2,6 +2,7 @@
 #include <vcpkg/base/downloads.h>
 #include <vcpkg/base/hash.h>
 #include <vcpkg/base/lockguarded.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
@@ -10,6 +11,17 @@
 
 #if defined(_WIN32)
 #include <VersionHelpers.h>
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#if !defined(MSG_NOSIGNAL)
+// SO_NOSIGPIPE is set on the socket instead
+#define MSG_NOSIGNAL 0
+#endif
 #endif
 
 namespace vcpkg::Downloads
@@ -170,6 +182,638 @@ namespace vcpkg::Downloads
 
         std::unique_ptr<void, WinHttpHandleDeleter> m_hConnect;
     };
+#else
+    namespace
+    {
+        // A small HTTP/1.1 client for plain http:// URLs, used instead of spawning curl for every batch of requests.
+        // Connections are kept alive and reused for the whole process. Everything it does not handle (https, proxies,
+        // credentials in the URL) is left to curl.
+
+        // The most connections opened to serve one batch of requests.
+        constexpr size_t MAX_HTTP_CONNECTIONS = 8;
+        // The most HEAD requests sent on a connection before reading their responses.
+        constexpr size_t HTTP_PIPELINE_DEPTH = 32;
+        constexpr int MAX_HTTP_REDIRECTS = 10;
+
+        struct HttpTarget
+        {
+            std::string host;
+            std::string port;
+            // the authority as written in the URL, for the Host header
+            std::string authority;
+            std::string path;
+
+            std::string connection_key() const { return Strings::concat(host, '\t', port); }
+        };
+
+        static bool http_proxy_configured()
+        {
+            static const bool configured = []() {
+                static constexpr StringLiteral proxy_vars[] = {"http_proxy", "HTTP_PROXY", "all_proxy", "ALL_PROXY"};
+                for (auto&& var : proxy_vars)
+                {
+                    if (System::get_environment_variable(var).has_value()) return true;
+                }
+                return false;
+            }();
+            return configured;
+        }
+
+        static Optional<HttpTarget> parse_http_url(StringView url)
+        {
+            if (http_proxy_configured()) return nullopt;
+
+            auto maybe_split = details::split_uri_view(url);
+            auto split = maybe_split.get();
+            if (!split || split->scheme != "http") return nullopt;
+            auto maybe_authority = split->authority.get();
+            if (!maybe_authority || maybe_authority->size() <= 2) return nullopt;
+            const auto authority = maybe_authority->substr(2);
+            if (Strings::find_first_of(authority, "@") != authority.end()) return nullopt;
+
+            HttpTarget target;
+            target.authority = authority.to_string();
+            auto host_end = authority.begin();
+            if (*host_end == '[')
+            {
+                host_end = std::find(authority.begin(), authority.end(), ']');
+                if (host_end == authority.end()) return nullopt;
+                target.host.assign(authority.begin() + 1, host_end);
+                ++host_end;
+            }
+            else
+            {
+                host_end = std::find(authority.begin(), authority.end(), ':');
+                target.host.assign(authority.begin(), host_end);
+            }
+
+            if (host_end == authority.end())
+            {
+                target.port = "80";
+            }
+            else if (*host_end == ':' && host_end + 1 != authority.end())
+            {
+                target.port.assign(host_end + 1, authority.end());
+            }
+            else
+            {
+                return nullopt;
+            }
+
+            const auto path = split->path_query_fragment;
+            target.path.assign(path.begin(), std::find(path.begin(), path.end(), '#'));
+            if (target.path.empty()) target.path = "/";
+            return target;
+        }
+
+        struct HttpConnection
+        {
+            explicit HttpConnection(int fd) : fd(fd) { }
+            HttpConnection(const HttpConnection&) = delete;
+            HttpConnection& operator=(const HttpConnection&) = delete;
+            ~HttpConnection() { ::close(fd); }
+
+            bool send_all(StringView data)
+            {
+                const char* first = data.data();
+                size_t remaining = data.size();
+                while (remaining != 0)
+                {
+                    const auto sent = ::send(fd, first, remaining, MSG_NOSIGNAL);
+                    if (sent < 0)
+                    {
+                        if (errno == EINTR) continue;
+                        return false;
+                    }
+
+                    first += sent;
+                    remaining -= static_cast<size_t>(sent);
+                }
+
+                return true;
+            }
+
+            // Appends more bytes from the socket to `received`; false at the end of the stream or on errors.
+            bool receive()
+            {
+                if (consumed == received.size())
+                {
+                    received.clear();
+                    consumed = 0;
+                }
+
+                char buffer[64 * 1024];
+                for (;;)
+                {
+                    const auto count = ::recv(fd, buffer, sizeof(buffer), 0);
+                    if (count < 0 && errno == EINTR) continue;
+                    if (count <= 0) return false;
+                    received.append(buffer, static_cast<size_t>(count));
+                    total_received += static_cast<size_t>(count);
+                    return true;
+                }
+            }
+
+            bool read_line(std::string& line)
+            {
+                for (;;)
+                {
+                    const auto eol = received.find("\r\n", consumed);
+                    if (eol != std::string::npos)
+                    {
+                        line.assign(received, consumed, eol - consumed);
+                        consumed = eol + 2;
+                        return true;
+                    }
+
+                    if (!receive()) return false;
+                }
+            }
+
+            // Passes the next `size` bytes, or everything until the end of the stream if `size` is negative, to
+            // `on_data`.
+            template<class F>
+            bool read_bytes(long long size, F& on_data)
+            {
+                for (;;)
+                {
+                    auto available = received.size() - consumed;
+                    if (size >= 0) available = std::min(available, static_cast<size_t>(size));
+                    if (available != 0)
+                    {
+                        on_data(received.data() + consumed, available);
+                        consumed += available;
+                        if (size >= 0) size -= static_cast<long long>(available);
+                    }
+
+                    if (size == 0) return true;
+                    if (!receive()) return size < 0;
+                }
+            }
+
+            int fd;
+            std::string received;
+            size_t consumed = 0;
+            size_t total_received = 0;
+            // whether this connection has been used before, so the server may have closed it while it sat idle
+            bool reused = false;
+        };
+
+        static std::unique_ptr<HttpConnection> http_connect(const HttpTarget& target)
+        {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* addresses = nullptr;
+            if (::getaddrinfo(target.host.c_str(), target.port.c_str(), &hints, &addresses) != 0)
+            {
+                Debug::print("Failed to resolve ", target.host, '\n');
+                return nullptr;
+            }
+
+            std::unique_ptr<HttpConnection> result;
+            for (auto address = addresses; address && !result; address = address->ai_next)
+            {
+                const int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+                if (fd < 0) continue;
+                // the connection must not leak into the processes vcpkg launches
+                ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                const int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if defined(SO_NOSIGPIPE)
+                ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+                int rc;
+                do
+                {
+                    rc = ::connect(fd, address->ai_addr, address->ai_addrlen);
+                } while (rc != 0 && errno == EINTR);
+
+                if (rc == 0)
+                {
+                    result = std::make_unique<HttpConnection>(fd);
+                }
+                else
+                {
+                    ::close(fd);
+                }
+            }
+
+            ::freeaddrinfo(addresses);
+            if (!result) Debug::print("Failed to connect to ", target.authority, '\n');
+            return result;
+        }
+
+        struct HttpConnectionPool
+        {
+            std::unique_ptr<HttpConnection> take(const HttpTarget& target)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_idle.find(target.connection_key());
+                    if (it != m_idle.end())
+                    {
+                        auto connection = std::move(it->second);
+                        m_idle.erase(it);
+                        return connection;
+                    }
+                }
+
+                return http_connect(target);
+            }
+
+            void give_back(const HttpTarget& target, std::unique_ptr<HttpConnection> connection)
+            {
+                connection->reused = true;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_idle.emplace(target.connection_key(), std::move(connection));
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::multimap<std::string, std::unique_ptr<HttpConnection>> m_idle;
+        };
+
+        static HttpConnectionPool g_http_connections;
+
+        struct HttpResponse
+        {
+            int status = 0;
+            bool keep_alive = false;
+            std::string location;
+        };
+
+        static std::string format_http_request(StringLiteral method, const HttpTarget& target, StringView headers = {})
+        {
+            return Strings::concat(method,
+                                   ' ',
+                                   target.path,
+                                   " HTTP/1.1\r\nHost: ",
+                                   target.authority,
+                                   "\r\nUser-Agent: vcpkg\r\nAccept: */*\r\n",
+                                   headers,
+                                   "\r\n");
+        }
+
+        // Reads one response from `connection`, passing its body to `on_data`. Returns false if the connection failed
+        // before the whole response arrived.
+        template<class F>
+        static bool read_http_response(HttpConnection& connection, bool head_request, HttpResponse& response, F on_data)
+        {
+            std::string line;
+            long long content_length;
+            bool chunked;
+            do
+            {
+                // e.g. "HTTP/1.1 200 OK"
+                if (!connection.read_line(line)) return false;
+                if (!Strings::starts_with(line, "HTTP/1.") || line.size() < 12) return false;
+                response.status = std::atoi(line.c_str() + 9);
+                response.keep_alive = line[7] != '0';
+                response.location.clear();
+                content_length = -1;
+                chunked = false;
+                for (;;)
+                {
+                    if (!connection.read_line(line)) return false;
+                    if (line.empty()) break;
+                    const auto colon = line.find(':');
+                    if (colon == std::string::npos) continue;
+                    const auto name = Strings::ascii_to_lowercase(line.substr(0, colon));
+                    auto value = Strings::trim(line.substr(colon + 1));
+                    if (name == "content-length")
+                    {
+                        auto maybe_length = Strings::strto<long long>(value);
+                        if (!maybe_length || *maybe_length.get() < 0) return false;
+                        content_length = *maybe_length.get();
+                    }
+                    else if (name == "transfer-encoding")
+                    {
+                        chunked = Strings::contains(Strings::ascii_to_lowercase(std::move(value)), "chunked");
+                    }
+                    else if (name == "connection")
+                    {
+                        value = Strings::ascii_to_lowercase(std::move(value));
+                        if (value == "close") response.keep_alive = false;
+                        if (value == "keep-alive") response.keep_alive = true;
+                    }
+                    else if (name == "location")
+                    {
+                        response.location = std::move(value);
+                    }
+                }
+            } while (response.status >= 100 && response.status < 200);
+
+            if (head_request || response.status == 204 || response.status == 304) return true;
+
+            if (chunked)
+            {
+                for (;;)
+                {
+                    if (!connection.read_line(line)) return false;
+                    char* end;
+                    const auto chunk_size = std::strtoll(line.c_str(), &end, 16);
+                    if (end == line.c_str() || chunk_size < 0) return false;
+                    if (chunk_size == 0) break;
+                    if (!connection.read_bytes(chunk_size, on_data) || !connection.read_line(line)) return false;
+                }
+
+                // trailers
+                do
+                {
+                    if (!connection.read_line(line)) return false;
+                } while (!line.empty());
+                return true;
+            }
+
+            if (content_length >= 0) return connection.read_bytes(content_length, on_data);
+
+            response.keep_alive = false;
+            return connection.read_bytes(-1, on_data);
+        }
+
+        static void ignore_http_body(const char*, size_t) { }
+
+        // Sends one request with `send` and reads the response. A pooled connection which the server closed while it
+        // was idle only shows when nothing comes back, in which case the request is sent once more on a new connection.
+        template<class Send, class F>
+        static bool http_exchange(
+            const HttpTarget& target, bool head_request, const Send& send, HttpResponse& response, F on_data)
+        {
+            for (;;)
+            {
+                auto connection = g_http_connections.take(target);
+                if (!connection) return false;
+                const auto received_before = connection->total_received;
+                if (send(*connection) && read_http_response(*connection, head_request, response, on_data))
+                {
+                    if (response.keep_alive) g_http_connections.give_back(target, std::move(connection));
+                    return true;
+                }
+
+                if (!connection->reused || connection->total_received != received_before) return false;
+            }
+        }
+
+        // Sends a request to `target`, following redirects to other http:// URLs like `curl --location`. `request`
+        // performs one exchange. Returns nullopt if a redirect leads somewhere only curl can go, and 0 if the server
+        // could not be reached.
+        template<class Request>
+        static Optional<int> http_request_following_redirects(HttpTarget target, const Request& request)
+        {
+            HttpResponse response;
+            for (int redirects = 0;; ++redirects)
+            {
+                if (!request(target, response)) return 0;
+                if (response.status < 300 || response.status >= 400 || response.status == 304 ||
+                    response.location.empty() || redirects == MAX_HTTP_REDIRECTS)
+                {
+                    return response.status;
+                }
+
+                if (response.location[0] == '/')
+                {
+                    target.path = response.location;
+                }
+                else
+                {
+                    auto next = parse_http_url(response.location);
+                    if (!next) return nullopt;
+                    target = std::move(*next.get());
+                }
+            }
+        }
+
+        static Optional<int> http_head(const HttpTarget& target)
+        {
+            return http_request_following_redirects(target, [](const HttpTarget& t, HttpResponse& response) {
+                const auto request = format_http_request("HEAD", t);
+                return http_exchange(
+                    t,
+                    true,
+                    [&](HttpConnection& connection) { return connection.send_all(request); },
+                    response,
+                    ignore_http_body);
+            });
+        }
+
+        // Checks `targets` (all on one host) by sending the HEAD requests back to back on one connection before
+        // reading the responses in order. Redirects are followed afterwards, one at a time.
+        static void http_heads_pipelined(const std::vector<HttpTarget>& targets,
+                                         const size_t* indices,
+                                         size_t count,
+                                         std::vector<Optional<int>>& codes)
+        {
+            std::vector<HttpResponse> responses(count);
+            size_t next = 0;
+            bool retried = false;
+            while (next < count)
+            {
+                auto connection = g_http_connections.take(targets[indices[next]]);
+                if (!connection) break;
+
+                const size_t batch_end = std::min(count, next + HTTP_PIPELINE_DEPTH);
+                std::string requests;
+                for (size_t i = next; i < batch_end; ++i)
+                {
+                    requests += format_http_request("HEAD", targets[indices[i]]);
+                }
+
+                size_t answered = next;
+                if (connection->send_all(requests))
+                {
+                    while (answered < batch_end &&
+                           read_http_response(*connection, true, responses[answered], ignore_http_body))
+                    {
+                        if (!responses[answered++].keep_alive) break;
+                    }
+                }
+
+                if (answered == batch_end && responses[answered - 1].keep_alive)
+                {
+                    g_http_connections.give_back(targets[indices[next]], std::move(connection));
+                }
+
+                if (answered == next)
+                {
+                    // Nothing came back. A pooled connection may have been closed while idle, so try once more on a
+                    // new one before giving up on this request.
+                    if (retried)
+                    {
+                        codes[indices[next++]] = 0;
+                        retried = false;
+                    }
+                    else
+                    {
+                        retried = true;
+                    }
+
+                    continue;
+                }
+
+                retried = false;
+                next = answered;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto& code = codes[indices[i]];
+                if (i >= next)
+                {
+                    code = 0;
+                }
+                else if (responses[i].status >= 300 && responses[i].status < 400 && responses[i].status != 304 &&
+                         !responses[i].location.empty())
+                {
+                    auto target = targets[indices[i]];
+                    if (responses[i].location[0] == '/')
+                    {
+                        target.path = responses[i].location;
+                        code = http_head(target);
+                    }
+                    else if (auto next_target = parse_http_url(responses[i].location))
+                    {
+                        code = http_head(*next_target.get());
+                    }
+                }
+                else
+                {
+                    code = responses[i].status;
+                }
+            }
+        }
+
+        // Fills in the results for every URL the native client handles and leaves the others nullopt.
+        static void http_heads(View<std::string> urls, std::vector<Optional<int>>& codes)
+        {
+            std::vector<HttpTarget> targets(urls.size());
+            std::map<std::string, std::vector<size_t>> by_host;
+            for (size_t i = 0; i < urls.size(); ++i)
+            {
+                if (auto target = parse_http_url(urls[i]))
+                {
+                    targets[i] = std::move(*target.get());
+                    by_host[targets[i].connection_key()].push_back(i);
+                }
+            }
+
+            // spread the URLs of each host over up to MAX_HTTP_CONNECTIONS pipelined connections
+            struct Slice
+            {
+                const size_t* indices;
+                size_t count;
+            };
+            std::vector<Slice> slices;
+            for (auto&& host : by_host)
+            {
+                const auto& indices = host.second;
+                const size_t slice_size = std::max(HTTP_PIPELINE_DEPTH,
+                                                   (indices.size() + MAX_HTTP_CONNECTIONS - 1) / MAX_HTTP_CONNECTIONS);
+                for (size_t i = 0; i < indices.size(); i += slice_size)
+                {
+                    slices.push_back({indices.data() + i, std::min(slice_size, indices.size() - i)});
+                }
+            }
+
+            execute_in_parallel(slices.size(), MAX_HTTP_CONNECTIONS, [&](size_t i) {
+                http_heads_pipelined(targets, slices[i].indices, slices[i].count, codes);
+            });
+        }
+
+        struct FileCloser
+        {
+            void operator()(FILE* f) const { fclose(f); }
+        };
+
+        // Downloads `target` to `file`. If `hasher` is given, the body is also added to it as it arrives.
+        static Optional<int> http_get(const HttpTarget& target, const fs::path& file, Hash::Hasher* hasher = nullptr)
+        {
+            std::unique_ptr<FILE, FileCloser> output;
+            bool write_failed = false;
+            auto result = http_request_following_redirects(target, [&](const HttpTarget& t, HttpResponse& response) {
+                const auto request = format_http_request("GET", t);
+                return http_exchange(
+                    t,
+                    false,
+                    [&](HttpConnection& connection) { return connection.send_all(request); },
+                    response,
+                    [&](const char* data, size_t size) {
+                        if (response.status != 200) return;
+                        if (!output) output.reset(fopen(file.c_str(), "wb"));
+                        if (!output || fwrite(data, 1, size, output.get()) != size) write_failed = true;
+                        if (hasher) hasher->add_bytes(data, data + size);
+                    });
+            });
+
+            if (auto code = result.get())
+            {
+                if (*code == 200 && !output) output.reset(fopen(file.c_str(), "wb"));
+                if (*code == 200 && (!output || write_failed || fflush(output.get()) != 0))
+                {
+                    Debug::print("Failed to write ", fs::u8string(file), '\n');
+                    return 0;
+                }
+            }
+
+            return result;
+        }
+
+        // Fills in the results for every URL the native client handles and leaves the others nullopt.
+        static void http_gets(View<std::pair<std::string, fs::path>> url_pairs, std::vector<Optional<int>>& codes)
+        {
+            std::vector<size_t> indices;
+            std::vector<HttpTarget> targets(url_pairs.size());
+            for (size_t i = 0; i < url_pairs.size(); ++i)
+            {
+                if (auto target = parse_http_url(url_pairs[i].first))
+                {
+                    targets[i] = std::move(*target.get());
+                    indices.push_back(i);
+                }
+            }
+
+            execute_in_parallel(indices.size(), MAX_HTTP_CONNECTIONS, [&](size_t i) {
+                codes[indices[i]] = http_get(targets[indices[i]], url_pairs[indices[i]].second);
+            });
+        }
+
+        // Uploads `file`, reading it from disk as it is sent.
+        static Optional<int> http_put(StringView url, const fs::path& file)
+        {
+            auto maybe_target = parse_http_url(url);
+            auto target = maybe_target.get();
+            if (!target) return nullopt;
+
+            std::error_code ec;
+            const auto size = fs::stdfs::file_size(file, ec);
+            if (ec)
+            {
+                System::print2(System::Color::warning, "Failed to read ", fs::u8string(file), ": ", ec.message(), '\n');
+                return 0;
+            }
+
+            // Redirects are not followed, like curl without --location.
+            const auto headers = Strings::concat("Content-Length: ", size, "\r\nx-ms-blob-type: BlockBlob\r\n");
+            const auto request = format_http_request("PUT", *target, headers);
+            auto send = [&](HttpConnection& connection) {
+                std::unique_ptr<FILE, FileCloser> input(fopen(file.c_str(), "rb"));
+                if (!input || !connection.send_all(request)) return false;
+                char buffer[64 * 1024];
+                for (auto remaining = static_cast<size_t>(size); remaining != 0;)
+                {
+                    const auto count = fread(buffer, 1, std::min(remaining, sizeof(buffer)), input.get());
+                    if (count == 0 || !connection.send_all({buffer, count})) return false;
+                    remaining -= count;
+                }
+
+                return true;
+            };
+
+            HttpResponse response;
+            if (!http_exchange(*target, false, send, response, ignore_http_body)) return 0;
+            return response.status;
+        }
+    }
 #endif
 
     Optional<details::SplitURIView> details::split_uri_view(StringView uri)
@@ -187,13 +831,11 @@ namespace vcpkg::Downloads
         return details::SplitURIView{scheme, {}, {sep + 1, uri.end()}};
     }
 
-    void verify_downloaded_file_hash(const Files::Filesystem& fs,
-                                     const std::string& url,
-                                     const fs::path& path,
-                                     const std::string& sha512)
+    static void check_downloaded_file_hash(const std::string& url,
+                                           const fs::path& path,
+                                           const std::string& sha512,
+                                           std::string actual_hash)
     {
-        std::string actual_hash = vcpkg::Hash::get_file_hash(VCPKG_LINE_INFO, fs, path, Hash::Algorithm::Sha512);
-
         // <HACK to handle NuGet.org changing nupkg hashes.>
         // This is the NEW hash for 7zip
         if (actual_hash == "a9dfaaafd15d98a2ac83682867ec5766720acf6e99d40d1a00d480692752603bf3f3742623f0ea85647a92374df"
@@ -216,6 +858,15 @@ namespace vcpkg::Downloads
                            actual_hash);
     }
 
+    void verify_downloaded_file_hash(const Files::Filesystem& fs,
+                                     const std::string& url,
+                                     const fs::path& path,
+                                     const std::string& sha512)
+    {
+        check_downloaded_file_hash(
+            url, path, sha512, Hash::get_file_hash(VCPKG_LINE_INFO, fs, path, Hash::Algorithm::Sha512));
+    }
+
     static void url_heads_inner(View<std::string> urls, std::vector<int>* out)
     {
         static constexpr StringLiteral guid_marker = "8a1db05f-a65d-419b-aa72-037fb4d0672e";
@@ -230,15 +881,16 @@ namespace vcpkg::Downloads
         {
             cmd.string_arg(url);
         }
-        auto res = System::cmd_execute_and_stream_lines(cmd, [out](const std::string& line) {
+        auto res = System::cmd_execute_and_stream_lines(cmd, [out](StringView line) {
             if (Strings::starts_with(line, guid_marker))
             {
-                out->push_back(std::strtol(line.data() + guid_marker.size(), nullptr, 10));
+                const std::string status(line.begin() + guid_marker.size(), line.end());
+                out->push_back(std::strtol(status.c_str(), nullptr, 10));
             }
         });
         Checks::check_exit(VCPKG_LINE_INFO, res == 0, "curl failed to execute with exit code: %d", res);
     }
-    std::vector<int> url_heads(View<std::string> urls)
+    static std::vector<int> curl_url_heads(View<std::string> urls)
     {
         static constexpr size_t batch_size = 100;
 
@@ -254,6 +906,25 @@ namespace vcpkg::Downloads
         return ret;
     }
 
+    std::vector<int> url_heads(View<std::string> urls)
+    {
+        std::vector<Optional<int>> codes(urls.size());
+#if !defined(_WIN32)
+        http_heads(urls, codes);
+#endif
+
+        std::vector<std::string> curl_urls;
+        for (size_t i = 0; i < urls.size(); ++i)
+        {
+            if (!codes[i]) curl_urls.push_back(urls[i]);
+        }
+
+        auto curl_codes = curl_url_heads(curl_urls);
+        Checks::check_exit(VCPKG_LINE_INFO, curl_codes.size() == curl_urls.size());
+        auto curl_code = curl_codes.begin();
+        return Util::fmap(codes, [&](const Optional<int>& code) { return code ? *code.get() : *curl_code++; });
+    }
+
     static void download_files_inner(Files::Filesystem&,
                                      View<std::pair<std::string, fs::path>> url_pairs,
                                      std::vector<int>* out)
@@ -269,15 +940,17 @@ namespace vcpkg::Downloads
         {
             cmd.string_arg(url.first).string_arg("-o").path_arg(url.second);
         }
-        auto res = System::cmd_execute_and_stream_lines(cmd, [out](const std::string& line) {
+        auto res = System::cmd_execute_and_stream_lines(cmd, [out](StringView line) {
             if (Strings::starts_with(line, guid_marker))
             {
-                out->push_back(std::strtol(line.data() + guid_marker.size(), nullptr, 10));
+                const std::string status(line.begin() + guid_marker.size(), line.end());
+                out->push_back(std::strtol(status.c_str(), nullptr, 10));
             }
         });
         Checks::check_exit(VCPKG_LINE_INFO, res == 0, "curl failed to execute with exit code: %d", res);
     }
-    std::vector<int> download_files(Files::Filesystem& fs, View<std::pair<std::string, fs::path>> url_pairs)
+    static std::vector<int> curl_download_files(Files::Filesystem& fs,
+                                                View<std::pair<std::string, fs::path>> url_pairs)
     {
         static constexpr size_t batch_size = 50;
 
@@ -294,8 +967,33 @@ namespace vcpkg::Downloads
         return ret;
     }
 
+    std::vector<int> download_files(Files::Filesystem& fs, View<std::pair<std::string, fs::path>> url_pairs)
+    {
+        std::vector<Optional<int>> codes(url_pairs.size());
+#if !defined(_WIN32)
+        http_gets(url_pairs, codes);
+#endif
+
+        std::vector<std::pair<std::string, fs::path>> curl_pairs;
+        for (size_t i = 0; i < url_pairs.size(); ++i)
+        {
+            if (!codes[i]) curl_pairs.push_back(url_pairs[i]);
+        }
+
+        auto curl_codes = curl_download_files(fs, curl_pairs);
+        auto curl_code = curl_codes.begin();
+        return Util::fmap(codes, [&](const Optional<int>& code) { return code ? *code.get() : *curl_code++; });
+    }
+
     int put_file(const Files::Filesystem&, StringView url, const fs::path& file)
     {
+#if !defined(_WIN32)
+        if (auto code = http_put(url, file))
+        {
+            return *code.get();
+        }
+#endif
+
         static constexpr StringLiteral guid_marker = "9a1db05f-a65d-419b-aa72-037fb4d0672e";
 
         System::CmdLineBuilder cmd;
@@ -305,10 +1003,11 @@ namespace vcpkg::Downloads
         cmd.string_arg("-T").path_arg(file);
         cmd.string_arg("-H").string_arg("x-ms-blob-type: BlockBlob");
         int code = 0;
-        auto res = System::cmd_execute_and_stream_lines(cmd, [&code](const std::string& line) {
+        auto res = System::cmd_execute_and_stream_lines(cmd, [&code](StringView line) {
             if (Strings::starts_with(line, guid_marker))
             {
-                code = std::strtol(line.data() + guid_marker.size(), nullptr, 10);
+                const std::string status(line.begin() + guid_marker.size(), line.end());
+                code = std::strtol(status.c_str(), nullptr, 10);
             }
         });
         if (res != 0)
@@ -353,12 +1052,14 @@ namespace vcpkg::Downloads
         };
 
         /// <summary>
-        /// Download a file using WinHTTP -- only supports HTTP and HTTPS
+        /// Download a file using WinHTTP -- only supports HTTP and HTTPS. The data is also added to `hasher` as it
+        /// arrives.
         /// </summary>
         static bool download_winhttp(Files::Filesystem& fs,
                                      const fs::path& download_path_part_path,
                                      details::SplitURIView split_uri,
                                      const std::string& url,
+                                     Hash::Hasher& hasher,
                                      std::string& errors)
         {
             // `download_winhttp` does not support user or port syntax in authorities
@@ -397,8 +1098,10 @@ namespace vcpkg::Downloads
                 Strings::append(errors, url, ": ", req.error(), '\n');
                 return false;
             }
-            auto forall_data =
-                req.get()->forall_data([&](Span<char> span) { fwrite(span.data(), 1, span.size(), f.f); });
+            auto forall_data = req.get()->forall_data([&](Span<char> span) {
+                fwrite(span.data(), 1, span.size(), f.f);
+                hasher.add_bytes(span.data(), span.data() + span.size());
+            });
             if (!forall_data)
             {
                 Strings::append(errors, url, ": ", forall_data.error(), '\n');
@@ -421,9 +1124,12 @@ namespace vcpkg::Downloads
         fs.remove(download_path, ignore_errors);
         fs.remove(download_path_part_path, ignore_errors);
 
+        // The hash is computed as the data arrives, unless curl does the download.
+        auto hasher = Hash::get_hasher_for(Hash::Algorithm::Sha512);
         std::string errors;
         for (const std::string& url : urls)
         {
+            hasher->clear();
 #if defined(_WIN32)
             auto split_uri = details::split_uri_view(url).value_or_exit(VCPKG_LINE_INFO);
             auto authority = split_uri.authority.value_or_exit(VCPKG_LINE_INFO).substr(2);
@@ -432,12 +1138,36 @@ namespace vcpkg::Downloads
                 // This check causes complex URLs (non-default port, embedded basic auth) to be passed down to curl.exe
                 if (Strings::find_first_of(authority, ":@") == authority.end())
                 {
-                    if (download_winhttp(fs, download_path_part_path, split_uri, url, errors))
+                    if (download_winhttp(fs, download_path_part_path, split_uri, url, *hasher, errors))
+                    {
+                        check_downloaded_file_hash(url, download_path_part_path, sha512, hasher->get_hash());
+                        fs.rename(download_path_part_path, download_path, VCPKG_LINE_INFO);
+                        return url;
+                    }
+                    continue;
+                }
+            }
+#else
+            if (auto target = parse_http_url(url))
+            {
+                fs.create_directories(download_path_part_path.parent_path(), VCPKG_LINE_INFO);
+                auto maybe_code = http_get(*target.get(), download_path_part_path, hasher.get());
+                if (auto code = maybe_code.get())
+                {
+                    if (*code == 200)
                     {
-                        verify_downloaded_file_hash(fs, url, download_path_part_path, sha512);
+                        check_downloaded_file_hash(url, download_path_part_path, sha512, hasher->get_hash());
                         fs.rename(download_path_part_path, download_path, VCPKG_LINE_INFO);
                         return url;
                     }
+
+                    fs.remove(download_path_part_path, ignore_errors);
+                    Strings::append(errors,
+                                    url,
+                                    ": ",
+                                    *code == 0 ? std::string("Failed to download")
+                                               : Strings::concat("The requested URL returned error: ", *code),
+                                    '\n');
                     continue;
                 }
             }
@@ -15,9 +15,14 @@
 #endif // _WIN32
 
 #if defined(__linux__)
+#include <linux/fs.h>
+
+#include <sys/ioctl.h>
 #include <sys/sendfile.h>
 #elif defined(__APPLE__)
 #include <copyfile.h>
+
+#include <sys/clonefile.h>
 #endif // ^^^ defined(__APPLE__)
 
 #include <algorithm>
@@ -465,6 +470,12 @@ namespace vcpkg::Files
         this->write_contents(path, data, ec);
         if (ec) Checks::exit_with_message(linfo, "error writing file: %s: %s", fs::u8string(path), ec.message());
     }
+    void Filesystem::append_contents(const fs::path& path, const std::string& data, LineInfo linfo)
+    {
+        std::error_code ec;
+        this->append_contents(path, data, ec);
+        if (ec) Checks::exit_with_message(linfo, "error appending to file: %s: %s", fs::u8string(path), ec.message());
+    }
     void Filesystem::write_contents_and_dirs(const fs::path& path, const std::string& data, LineInfo linfo)
     {
         std::error_code ec;
@@ -1119,6 +1130,64 @@ namespace vcpkg::Files
         {
             return Files::copy_symlink_implementation(oldpath, newpath, ec);
         }
+        virtual void clone_file(const fs::path& oldpath, const fs::path& newpath, std::error_code& ec) override
+        {
+            ec.clear();
+#if defined(__linux__) && defined(FICLONE)
+            const int i_fd = open(oldpath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (i_fd == -1)
+            {
+                ec.assign(errno, std::generic_category());
+                return;
+            }
+
+            struct stat info = {0};
+            if (fstat(i_fd, &info) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+                close(i_fd);
+                return;
+            }
+
+            const int o_fd = open(newpath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 07777);
+            if (o_fd == -1)
+            {
+                ec.assign(errno, std::generic_category());
+                close(i_fd);
+                return;
+            }
+
+            if (ioctl(o_fd, FICLONE, i_fd) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+            }
+            else if (fchmod(o_fd, info.st_mode & 07777) != 0)
+            {
+                // the file mode creation mask applies to open()
+                ec.assign(errno, std::generic_category());
+            }
+
+            close(o_fd);
+            close(i_fd);
+            if (ec)
+            {
+                unlink(newpath.c_str());
+            }
+#elif defined(__APPLE__)
+            if (clonefile(oldpath.c_str(), newpath.c_str(), 0) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+            }
+#else  // ^^^ defined(__APPLE__) // !(defined(__APPLE__) || defined(__linux__)) vvv
+            (void)oldpath;
+            (void)newpath;
+            ec = std::make_error_code(std::errc::not_supported);
+#endif // ^^^ !(defined(__APPLE__) || defined(__linux__))
+        }
+        virtual void create_hard_link(const fs::path& oldpath, const fs::path& newpath, std::error_code& ec) override
+        {
+            fs::stdfs::create_hard_link(oldpath, newpath, ec);
+        }
 
         virtual fs::file_status status(const fs::path& path, std::error_code& ec) const override
         {
@@ -1128,15 +1197,15 @@ namespace vcpkg::Files
         {
             return Files::symlink_status(path, ec);
         }
-        virtual void write_contents(const fs::path& file_path, const std::string& data, std::error_code& ec) override
+        static void write_file(const fs::path& file_path, const std::string& data, bool append, std::error_code& ec)
         {
             ec.clear();
 
             FILE* f = nullptr;
 #if defined(_WIN32)
-            auto err = _wfopen_s(&f, file_path.native().c_str(), L"wb");
+            auto err = _wfopen_s(&f, file_path.native().c_str(), append ? L"ab" : L"wb");
 #else  // ^^^ defined(_WIN32) // !defined(_WIN32) vvv
-            f = fopen(file_path.native().c_str(), "wb");
+            f = fopen(file_path.native().c_str(), append ? "ab" : "wb");
             int err = f != nullptr ? 0 : 1;
 #endif // ^^^ !defined(_WIN32)
             if (err != 0)
@@ -1157,6 +1226,16 @@ namespace vcpkg::Files
             }
         }
 
+        virtual void write_contents(const fs::path& file_path, const std::string& data, std::error_code& ec) override
+        {
+            write_file(file_path, data, false, ec);
+        }
+
+        virtual void append_contents(const fs::path& file_path, const std::string& data, std::error_code& ec) override
+        {
+            write_file(file_path, data, true, ec);
+        }
+
         virtual void write_contents_and_dirs(const fs::path& file_path,
                                              const std::string& data,
                                              std::error_code& ec) override
@@ -0,0 +1,727 @@
+#include <vcpkg/base/checks.h>
+#include <vcpkg/base/git.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/util.h>
+#include <vcpkg/base/zip.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace vcpkg::Git
+{
+    namespace
+    {
+        constexpr size_t OID_SIZE = 20;
+        constexpr size_t IDX_HEADER_SIZE = 8;
+        constexpr size_t IDX_FANOUT_SIZE = 256 * 4;
+        constexpr size_t PACK_TRAILER_SIZE = OID_SIZE;
+
+        constexpr int PACK_OFS_DELTA = 6;
+        constexpr int PACK_REF_DELTA = 7;
+
+        // Delta bases are decompressed once and shared by every object deltified against them, up to this many bytes
+        // per pack.
+        constexpr size_t MAX_CACHED_BASE_BYTES = 64 * 1024 * 1024;
+        // git itself limits delta chains to 4095 links
+        constexpr size_t MAX_DELTA_CHAIN = 4096;
+
+        uint32_t be32(const char* p)
+        {
+            auto u = reinterpret_cast<const unsigned char*>(p);
+            return (uint32_t(u[0]) << 24) | (uint32_t(u[1]) << 16) | (uint32_t(u[2]) << 8) | uint32_t(u[3]);
+        }
+
+        uint64_t be64(const char* p) { return (uint64_t(be32(p)) << 32) | be32(p + 4); }
+
+        int hex_digit(char ch)
+        {
+            if (ch >= '0' && ch <= '9') return ch - '0';
+            if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+            if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+            return -1;
+        }
+
+        bool oid_from_hex(StringView hex, unsigned char (&out)[OID_SIZE])
+        {
+            if (hex.size() != OID_SIZE * 2) return false;
+            for (size_t i = 0; i < OID_SIZE; ++i)
+            {
+                const int hi = hex_digit(hex.data()[2 * i]);
+                const int lo = hex_digit(hex.data()[2 * i + 1]);
+                if (hi < 0 || lo < 0) return false;
+                out[i] = static_cast<unsigned char>((hi << 4) | lo);
+            }
+
+            return true;
+        }
+
+        std::string oid_to_hex(const char* bytes)
+        {
+            static constexpr char DIGITS[] = "0123456789abcdef";
+            std::string result(OID_SIZE * 2, '\0');
+            for (size_t i = 0; i < OID_SIZE; ++i)
+            {
+                const auto byte = static_cast<unsigned char>(bytes[i]);
+                result[2 * i] = DIGITS[byte >> 4];
+                result[2 * i + 1] = DIGITS[byte & 0xF];
+            }
+
+            return result;
+        }
+
+        // Both loose objects and packfile entries are zlib (RFC 1950) streams.
+        ExpectedS<std::string> inflate_zlib(StringView data, size_t size_hint)
+        {
+            if (data.size() < 2) return {"truncated zlib stream", expected_right_tag};
+            const auto cmf = static_cast<unsigned char>(data.data()[0]);
+            const auto flg = static_cast<unsigned char>(data.data()[1]);
+            if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0)
+            {
+                return {"invalid zlib header", expected_right_tag};
+            }
+
+            return Zip::inflate(StringView{data.data() + 2, data.size() - 2}, size_hint);
+        }
+
+        Optional<ObjectType> object_type_from_name(StringView name)
+        {
+            if (name == "commit") return ObjectType::Commit;
+            if (name == "tree") return ObjectType::Tree;
+            if (name == "blob") return ObjectType::Blob;
+            if (name == "tag") return ObjectType::Tag;
+            return nullopt;
+        }
+
+        StringLiteral object_type_name(ObjectType type)
+        {
+            switch (type)
+            {
+                case ObjectType::Commit: return "commit";
+                case ObjectType::Tree: return "tree";
+                case ObjectType::Blob: return "blob";
+                case ObjectType::Tag: return "tag";
+                default: Checks::unreachable(VCPKG_LINE_INFO);
+            }
+        }
+
+        // Reads the little-endian base-128 sizes at the start of a delta.
+        bool read_delta_size(const char*& first, const char* last, uint64_t& size)
+        {
+            size = 0;
+            for (int shift = 0; first != last && shift < 64; shift += 7)
+            {
+                const auto byte = static_cast<unsigned char>(*first++);
+                size |= uint64_t(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return true;
+            }
+
+            return false;
+        }
+
+        // See "Deltified representation" in git's Documentation/technical/pack-format.txt
+        ExpectedS<std::string> apply_delta(const std::string& base, StringView delta)
+        {
+            const char* first = delta.data();
+            const char* const last = first + delta.size();
+            uint64_t base_size;
+            uint64_t result_size;
+            if (!read_delta_size(first, last, base_size) || !read_delta_size(first, last, result_size))
+            {
+                return {"truncated delta", expected_right_tag};
+            }
+
+            if (base_size != base.size()) return {"delta does not match the size of its base", expected_right_tag};
+
+            std::string result;
+            result.reserve(result_size);
+            while (first != last)
+            {
+                const auto op = static_cast<unsigned char>(*first++);
+                if (op & 0x80)
+                {
+                    uint64_t copy_offset = 0;
+                    uint64_t copy_size = 0;
+                    for (int i = 0; i < 7; ++i)
+                    {
+                        if ((op & (1 << i)) == 0) continue;
+                        if (first == last) return {"truncated delta", expected_right_tag};
+                        const uint64_t byte = static_cast<unsigned char>(*first++);
+                        if (i < 4)
+                            copy_offset |= byte << (8 * i);
+                        else
+                            copy_size |= byte << (8 * (i - 4));
+                    }
+
+                    if (copy_size == 0) copy_size = 0x10000;
+                    if (copy_offset > base.size() || copy_size > base.size() - copy_offset)
+                    {
+                        return {"delta copies past the end of its base", expected_right_tag};
+                    }
+
+                    result.append(base, static_cast<size_t>(copy_offset), static_cast<size_t>(copy_size));
+                }
+                else if (op != 0)
+                {
+                    if (static_cast<size_t>(last - first) < op) return {"truncated delta", expected_right_tag};
+                    result.append(first, op);
+                    first += op;
+                }
+                else
+                {
+                    return {"invalid delta instruction", expected_right_tag};
+                }
+            }
+
+            if (result.size() != result_size) return {"delta result has the wrong size", expected_right_tag};
+            return {std::move(result), expected_left_tag};
+        }
+
+        struct PackEntry
+        {
+            int type;
+            uint64_t base_offset;
+            std::string base_oid;
+            std::string data;
+        };
+    }
+
+    struct ObjectStore::Pack
+    {
+        fs::path pack_file;
+        // The whole .idx file, format version 2
+        std::string index;
+        uint32_t count;
+        uint64_t pack_size;
+        // every entry offset in the pack, sorted, to find where each entry ends
+        std::vector<uint64_t> sorted_offsets;
+
+        mutable std::mutex mutex;
+        mutable std::ifstream file;
+        mutable std::unordered_map<uint64_t, Object> bases;
+        mutable size_t bases_size = 0;
+
+        const char* names() const { return index.data() + IDX_HEADER_SIZE + IDX_FANOUT_SIZE; }
+        const char* offsets() const { return names() + size_t(count) * (OID_SIZE + 4); }
+        const char* large_offsets() const { return offsets() + size_t(count) * 4; }
+
+        Optional<uint64_t> offset_at(uint32_t i) const
+        {
+            const uint32_t offset = be32(offsets() + size_t(i) * 4);
+            if ((offset & 0x80000000u) == 0) return offset;
+
+            const size_t large = offset & 0x7FFFFFFFu;
+            if (large_offsets() + (large + 1) * 8 > index.data() + index.size() - 2 * OID_SIZE) return nullopt;
+            return be64(large_offsets() + large * 8);
+        }
+
+        Optional<uint64_t> find(const unsigned char (&oid)[OID_SIZE]) const
+        {
+            const char* fanout = index.data() + IDX_HEADER_SIZE;
+            uint32_t first = oid[0] == 0 ? 0 : be32(fanout + (oid[0] - 1) * 4);
+            uint32_t last = be32(fanout + oid[0] * 4);
+            while (first < last)
+            {
+                const uint32_t mid = first + (last - first) / 2;
+                const int cmp = memcmp(names() + size_t(mid) * OID_SIZE, oid, OID_SIZE);
+                if (cmp == 0) return offset_at(mid);
+                if (cmp < 0)
+                    first = mid + 1;
+                else
+                    last = mid;
+            }
+
+            return nullopt;
+        }
+
+        ExpectedS<std::string> read_bytes(uint64_t offset, uint64_t size) const
+        {
+            std::string bytes(static_cast<size_t>(size), '\0');
+            std::lock_guard<std::mutex> lock(mutex);
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(&bytes[0], static_cast<std::streamsize>(size));
+            if (!file || static_cast<uint64_t>(file.gcount()) != size)
+            {
+                return {Strings::concat("failed to read ", fs::u8string(pack_file)), expected_right_tag};
+            }
+
+            return {std::move(bytes), expected_left_tag};
+        }
+
+        ExpectedS<PackEntry> read_entry(uint64_t offset) const
+        {
+            const auto next = std::upper_bound(sorted_offsets.begin(), sorted_offsets.end(), offset);
+            const uint64_t end = next == sorted_offsets.end() ? pack_size - PACK_TRAILER_SIZE : *next;
+            if (end <= offset) return {"invalid pack entry offset", expected_right_tag};
+
+            auto maybe_bytes = read_bytes(offset, end - offset);
+            auto bytes = maybe_bytes.get();
+            if (!bytes) return std::move(maybe_bytes).error();
+
+            const char* first = bytes->data();
+            const char* const last = first + bytes->size();
+            const auto truncated = [&]() -> ExpectedS<PackEntry> {
+                return {Strings::format("truncated entry at offset %llu of %s",
+                                        static_cast<unsigned long long>(offset),
+                                        fs::u8string(pack_file)),
+                        expected_right_tag};
+            };
+
+            PackEntry entry{0, 0, {}, {}};
+            auto byte = static_cast<unsigned char>(*first++);
+            entry.type = (byte >> 4) & 7;
+            uint64_t size = byte & 0x0F;
+            for (int shift = 4; byte & 0x80; shift += 7)
+            {
+                if (first == last || shift >= 64) return truncated();
+                byte = static_cast<unsigned char>(*first++);
+                size |= uint64_t(byte & 0x7F) << shift;
+            }
+
+            if (entry.type == PACK_OFS_DELTA)
+            {
+                if (first == last) return truncated();
+                byte = static_cast<unsigned char>(*first++);
+                uint64_t distance = byte & 0x7F;
+                while (byte & 0x80)
+                {
+                    if (first == last) return truncated();
+                    byte = static_cast<unsigned char>(*first++);
+                    distance = ((distance + 1) << 7) | (byte & 0x7F);
+                }
+
+                if (distance == 0 || distance > offset) return {"invalid delta base offset", expected_right_tag};
+                entry.base_offset = offset - distance;
+            }
+            else if (entry.type == PACK_REF_DELTA)
+            {
+                if (static_cast<size_t>(last - first) < OID_SIZE) return truncated();
+                entry.base_oid = oid_to_hex(first);
+                first += OID_SIZE;
+            }
+
+            auto maybe_data = inflate_zlib(StringView{first, last}, static_cast<size_t>(size));
+            if (auto data = maybe_data.get())
+            {
+                if (data->size() != size) return {"pack entry has the wrong size", expected_right_tag};
+                entry.data = std::move(*data);
+                return entry;
+            }
+
+            return std::move(maybe_data).error();
+        }
+
+        // Returns an error message if the pack cannot be used.
+        Optional<std::string> load(const Files::Filesystem& fs, const fs::path& idx_file)
+        {
+            pack_file = fs::path(idx_file).replace_extension(".pack");
+            auto maybe_index = fs.read_contents(idx_file);
+            if (auto contents = maybe_index.get())
+            {
+                index = std::move(*contents);
+            }
+            else
+            {
+                return maybe_index.error().message();
+            }
+
+            const size_t fixed_size = IDX_HEADER_SIZE + IDX_FANOUT_SIZE + 2 * OID_SIZE;
+            if (index.size() < fixed_size || index.compare(0, 4, "\xFFtOc") != 0 || be32(index.data() + 4) != 2)
+            {
+                return std::string("unsupported pack index format");
+            }
+
+            count = be32(index.data() + IDX_HEADER_SIZE + IDX_FANOUT_SIZE - 4);
+            if (index.size() < fixed_size + size_t(count) * (OID_SIZE + 8))
+            {
+                return std::string("truncated pack index");
+            }
+
+            std::error_code ec;
+            pack_size = fs::stdfs::file_size(pack_file, ec);
+            if (ec) return ec.message();
+
+            file.open(pack_file, std::ios_base::in | std::ios_base::binary);
+            char header[12];
+            if (!file.read(header, sizeof(header)) || memcmp(header, "PACK", 4) != 0 ||
+                (be32(header + 4) != 2 && be32(header + 4) != 3) || be32(header + 8) != count ||
+                pack_size < sizeof(header) + PACK_TRAILER_SIZE)
+            {
+                return std::string("unsupported pack format");
+            }
+
+            sorted_offsets.reserve(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                auto offset = offset_at(i);
+                if (!offset || *offset.get() >= pack_size - PACK_TRAILER_SIZE)
+                {
+                    return std::string("invalid pack index offset");
+                }
+
+                sorted_offsets.push_back(*offset.get());
+            }
+
+            std::sort(sorted_offsets.begin(), sorted_offsets.end());
+            return nullopt;
+        }
+
+        Optional<Object> find_base(uint64_t offset) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = bases.find(offset);
+            if (it == bases.end()) return nullopt;
+            return it->second;
+        }
+
+        void remember_base(uint64_t offset, const Object& base) const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (bases_size + base.data.size() > MAX_CACHED_BASE_BYTES)
+            {
+                bases.clear();
+                bases_size = 0;
+            }
+
+            if (bases.emplace(offset, base).second) bases_size += base.data.size();
+        }
+    };
+
+    ExpectedS<std::vector<TreeEntry>> parse_tree(StringView data)
+    {
+        std::vector<TreeEntry> entries;
+        const char* first = data.data();
+        const char* const last = first + data.size();
+        while (first != last)
+        {
+            TreeEntry entry{0, {}, {}};
+            for (; first != last && *first != ' '; ++first)
+            {
+                if (*first < '0' || *first > '7' || entry.mode > 0777777) return {"invalid tree", expected_right_tag};
+                entry.mode = entry.mode * 8 + (*first - '0');
+            }
+
+            const auto name_first = first == last ? last : first + 1;
+            const auto name_last = std::find(name_first, last, '\0');
+            if (name_first == name_last || static_cast<size_t>(last - name_last) <= OID_SIZE)
+            {
+                return {"invalid tree", expected_right_tag};
+            }
+
+            entry.name.assign(name_first, name_last);
+            entry.oid = oid_to_hex(name_last + 1);
+            entries.push_back(std::move(entry));
+            first = name_last + 1 + OID_SIZE;
+        }
+
+        return entries;
+    }
+
+    ObjectStore::ObjectStore(const Files::Filesystem& fs, const fs::path& dot_git_dir) : m_fs(fs)
+    {
+        fs::path git_dir = dot_git_dir;
+        if (fs.is_regular_file(git_dir))
+        {
+            // worktrees and submodules have a `.git` file containing "gitdir: <path>"
+            auto maybe_contents = fs.read_contents(git_dir);
+            auto contents = maybe_contents.get();
+            if (contents && Strings::starts_with(*contents, "gitdir:"))
+            {
+                git_dir = dot_git_dir.parent_path() / fs::u8path(Strings::trim(contents->substr(7)));
+            }
+        }
+
+        fs::path common_dir = git_dir;
+        auto maybe_commondir = fs.read_contents(git_dir / fs::u8path("commondir"));
+        if (auto commondir = maybe_commondir.get())
+        {
+            common_dir = git_dir / fs::u8path(Strings::trim(std::string(*commondir)));
+        }
+
+        std::vector<fs::path> pending{common_dir / fs::u8path("objects")};
+        while (!pending.empty())
+        {
+            auto objects = std::move(pending.back());
+            pending.pop_back();
+            if (Util::Vectors::contains(m_object_dirs, objects) || !fs.exists(objects)) continue;
+
+            auto maybe_alternates = fs.read_contents(objects / fs::u8path("info") / fs::u8path("alternates"));
+            if (auto alternates = maybe_alternates.get())
+            {
+                for (auto&& line : Strings::split(*alternates, '\n'))
+                {
+                    auto alternate = Strings::trim(std::string(line));
+                    if (!alternate.empty() && alternate[0] != '#') pending.push_back(objects / fs::u8path(alternate));
+                }
+            }
+
+            for (auto&& file : fs.get_files_non_recursive(objects / fs::u8path("pack")))
+            {
+                if (file.extension() != ".idx") continue;
+                auto pack = std::make_unique<Pack>();
+                auto maybe_error = pack->load(fs, file);
+                if (auto error = maybe_error.get())
+                {
+                    // The objects of this pack will not be found; callers fall back to running git.
+                    Debug::print("Skipping git pack ", fs::u8string(file), ": ", *error, '\n');
+                    continue;
+                }
+
+                m_packs.push_back(std::move(pack));
+            }
+
+            m_object_dirs.push_back(std::move(objects));
+        }
+    }
+
+    ObjectStore::~ObjectStore() = default;
+
+    ExpectedS<Object> ObjectStore::read_packed(const Pack& pack, uint64_t offset) const
+    {
+        // Walk down the delta chain to an object stored whole, then apply the deltas back up.
+        std::vector<std::string> deltas;
+        uint64_t position = offset;
+        Object result{ObjectType::Blob, {}};
+        for (;;)
+        {
+            auto maybe_base = pack.find_base(position);
+            if (auto base = maybe_base.get())
+            {
+                result = std::move(*base);
+                break;
+            }
+
+            if (deltas.size() >= MAX_DELTA_CHAIN) return {"delta chain is too long", expected_right_tag};
+
+            auto maybe_entry = pack.read_entry(position);
+            auto entry = maybe_entry.get();
+            if (!entry) return std::move(maybe_entry).error();
+
+            if (entry->type == PACK_OFS_DELTA)
+            {
+                deltas.push_back(std::move(entry->data));
+                position = entry->base_offset;
+            }
+            else if (entry->type == PACK_REF_DELTA)
+            {
+                deltas.push_back(std::move(entry->data));
+                auto maybe_ref_base = read_object(entry->base_oid);
+                if (auto base = maybe_ref_base.get())
+                {
+                    result = std::move(*base);
+                    break;
+                }
+
+                return std::move(maybe_ref_base).error();
+            }
+            else if (entry->type >= 1 && entry->type <= 4)
+            {
+                result = Object{static_cast<ObjectType>(entry->type), std::move(entry->data)};
+                if (!deltas.empty()) pack.remember_base(position, result);
+                break;
+            }
+            else
+            {
+                return {Strings::format("unknown pack entry type %d", entry->type), expected_right_tag};
+            }
+        }
+
+        for (auto it = deltas.rbegin(); it != deltas.rend(); ++it)
+        {
+            auto maybe_data = apply_delta(result.data, *it);
+            if (auto data = maybe_data.get())
+            {
+                result.data = std::move(*data);
+            }
+            else
+            {
+                return std::move(maybe_data).error();
+            }
+        }
+
+        return result;
+    }
+
+    ExpectedS<Object> ObjectStore::read_object(StringView oid) const
+    {
+        unsigned char raw[OID_SIZE];
+        if (!oid_from_hex(oid, raw))
+        {
+            return {Strings::concat("'", oid, "' is not a full git object id"), expected_right_tag};
+        }
+
+        for (auto&& pack : m_packs)
+        {
+            auto maybe_offset = pack->find(raw);
+            if (auto offset = maybe_offset.get())
+            {
+                auto maybe_object = read_packed(*pack, *offset);
+                if (!maybe_object.has_value())
+                {
+                    return Strings::concat("error reading git object ", oid, ": ", maybe_object.error());
+                }
+
+                return maybe_object;
+            }
+        }
+
+        const auto hex = Strings::ascii_to_lowercase(oid.to_string());
+        for (auto&& objects : m_object_dirs)
+        {
+            const auto path = objects / fs::u8path(hex.substr(0, 2)) / fs::u8path(hex.substr(2));
+            auto maybe_contents = m_fs.read_contents(path);
+            auto contents = maybe_contents.get();
+            if (!contents) continue;
+
+            auto maybe_data = inflate_zlib(*contents, contents->size() * 2);
+            auto data = maybe_data.get();
+            const auto header_end = data ? data->find('\0') : std::string::npos;
+            const auto space = data ? data->find(' ') : std::string::npos;
+            if (header_end == std::string::npos || space > header_end)
+            {
+                return {Strings::concat("error reading git object ", oid, ": invalid loose object"),
+                        expected_right_tag};
+            }
+
+            auto type = object_type_from_name(StringView{data->data(), space});
+            if (!type) return {Strings::concat("error reading git object ", oid, ": unknown type"), expected_right_tag};
+            return Object{*type.get(), data->substr(header_end + 1)};
+        }
+
+        return {Strings::concat("git object ", oid, " was not found"), expected_right_tag};
+    }
+
+    static ExpectedS<std::string> expect_type(ExpectedS<Object>&& maybe_object, StringView oid, ObjectType type)
+    {
+        if (auto object = maybe_object.get())
+        {
+            if (object->type == type) return {std::move(object->data), expected_left_tag};
+            return {Strings::concat("git object ", oid, " is a ", object_type_name(object->type), ", not a ",
+                                    object_type_name(type)),
+                    expected_right_tag};
+        }
+
+        return {std::move(maybe_object).error(), expected_right_tag};
+    }
+
+    ExpectedS<std::string> ObjectStore::read_blob(StringView oid) const
+    {
+        return expect_type(read_object(oid), oid, ObjectType::Blob);
+    }
+
+    ExpectedS<std::vector<TreeEntry>> ObjectStore::read_tree(StringView treeish) const
+    {
+        auto maybe_object = read_object(treeish);
+        auto object = maybe_object.get();
+        if (object && object->type == ObjectType::Commit)
+        {
+            // a commit starts with "tree <oid>\n"
+            if (!Strings::starts_with(object->data, "tree ") || object->data.size() < 5 + 2 * OID_SIZE)
+            {
+                return {Strings::concat("git commit ", treeish, " has no tree"), expected_right_tag};
+            }
+
+            return read_tree(object->data.substr(5, 2 * OID_SIZE));
+        }
+
+        auto maybe_data = expect_type(std::move(maybe_object), treeish, ObjectType::Tree);
+        if (auto data = maybe_data.get()) return parse_tree(*data);
+        return std::move(maybe_data).error();
+    }
+
+    ExpectedS<std::string> ObjectStore::find_path(StringView treeish, StringView path) const
+    {
+        std::string current = treeish.to_string();
+        for (auto&& component : Strings::split(path, '/'))
+        {
+            auto maybe_entries = read_tree(current);
+            auto entries = maybe_entries.get();
+            if (!entries) return {std::move(maybe_entries).error(), expected_right_tag};
+
+            auto it = std::find_if(
+                entries->begin(), entries->end(), [&](const TreeEntry& entry) { return entry.name == component; });
+            if (it == entries->end())
+            {
+                return {Strings::concat("path '", path, "' does not exist in '", treeish, "'"), expected_right_tag};
+            }
+
+            current = std::move(it->oid);
+        }
+
+        return {std::move(current), expected_left_tag};
+    }
+
+    ExpectedS<size_t> ObjectStore::checkout_tree(Files::Filesystem& fs,
+                                                 StringView treeish,
+                                                 const fs::path& destination) const
+    {
+        size_t files = 0;
+        std::vector<std::pair<std::string, fs::path>> pending{{treeish.to_string(), destination}};
+        while (!pending.empty())
+        {
+            auto tree = std::move(pending.back());
+            pending.pop_back();
+
+            auto maybe_entries = read_tree(tree.first);
+            auto entries = maybe_entries.get();
+            if (!entries) return std::move(maybe_entries).error();
+
+            std::error_code ec;
+            fs.create_directories(tree.second, ec);
+            if (ec) return Strings::concat(fs::u8string(tree.second), ": ", ec.message());
+
+            for (auto&& entry : *entries)
+            {
+                if (entry.name == "." || entry.name == ".." || entry.name.find_first_of("/\\") != std::string::npos)
+                {
+                    return Strings::concat("git tree ", tree.first, " has an invalid entry '", entry.name, "'");
+                }
+
+                const auto target = tree.second / fs::u8path(entry.name);
+                if (entry.is_tree())
+                {
+                    pending.emplace_back(std::move(entry.oid), target);
+                    continue;
+                }
+
+                if (entry.mode == 0160000)
+                {
+                    // submodules are checked out as empty directories
+                    fs.create_directories(target, ec);
+                }
+                else
+                {
+                    auto maybe_blob = read_blob(entry.oid);
+                    auto blob = maybe_blob.get();
+                    if (!blob) return std::move(maybe_blob).error();
+
+#if defined(_WIN32)
+                    // like git with core.symlinks=false, symlinks are written as files containing the link target
+                    fs.write_contents(target, *blob, ec);
+#else
+                    if (entry.mode == 0120000)
+                    {
+                        fs::stdfs::create_symlink(fs::u8path(*blob), target, ec);
+                    }
+                    else
+                    {
+                        fs.write_contents(target, *blob, ec);
+                        if (!ec && entry.mode == 0100755)
+                        {
+                            fs::stdfs::permissions(target, static_cast<fs::perms>(0755), ec);
+                        }
+                    }
+#endif
+                    ++files;
+                }
+
+                if (ec) return Strings::concat(fs::u8string(target), ": ", ec.message());
+            }
+        }
+
+        return files;
+    }
+}
@@ -0,0 +1,100 @@
+#include <vcpkg/base/cachefile.h>
+#include <vcpkg/base/checks.h>
+#include <vcpkg/base/hashcache.h>
+#include <vcpkg/base/strings.h>
+
+namespace vcpkg::Hash
+{
+    static constexpr StringLiteral FILE_HASH_CACHE_HEADER = "vcpkg file hash cache v1";
+
+    static std::string cache_key(const fs::path& path, Algorithm algo)
+    {
+        return Strings::concat(to_string(algo), '\t', fs::u8string(path));
+    }
+
+    // Format: a header line, then one line "<size>\t<time>\t<algorithm>\t<hash>\t<path>" per entry. Malformed lines
+    // are skipped.
+    FileHashCache::FileHashCache(Files::Filesystem& fs, fs::path cache_file)
+        : m_fs(fs), m_cache_file(std::move(cache_file))
+    {
+        auto maybe_contents = CacheFile::load(m_fs, m_cache_file, FILE_HASH_CACHE_HEADER);
+        const auto contents = maybe_contents.get();
+        if (!contents) return;
+
+        const char* const end = contents->data() + contents->size();
+        for (const char* first = contents->data(); first != end;)
+        {
+            const char* const last = std::find(first, end, '\n');
+            const auto fields = Strings::split(StringView{first, last}, '\t');
+            first = last == end ? end : last + 1;
+            if (fields.size() != 5) continue;
+            auto stamp = CacheFile::FileStamp::parse(fields[0], fields[1]);
+            if (!stamp) continue;
+
+            m_entries[Strings::concat(fields[2], '\t', fields[4])] = Entry{*stamp.get(), fields[3]};
+        }
+    }
+
+    std::string FileHashCache::get_file_hash(const fs::path& path, Algorithm algo, std::error_code& ec)
+    {
+        auto maybe_stamp = CacheFile::get_file_stamp(path);
+        const auto stamp = maybe_stamp.get();
+        if (!stamp)
+        {
+            return Hash::get_file_hash(m_fs, path, algo, ec);
+        }
+
+        auto key = cache_key(path, algo);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if (it != m_entries.end() && it->second.stamp == *stamp)
+            {
+                ec.clear();
+                return it->second.hash;
+            }
+        }
+
+        auto hash = Hash::get_file_hash(m_fs, path, algo, ec);
+        if (ec || stamp->is_recent() || key.find('\n') != std::string::npos) return hash;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries[std::move(key)] = Entry{*stamp, hash};
+        m_dirty = true;
+        return hash;
+    }
+
+    std::string FileHashCache::get_file_hash(LineInfo li, const fs::path& path, Algorithm algo)
+    {
+        std::error_code ec;
+        auto result = get_file_hash(path, algo, ec);
+        if (ec)
+        {
+            Checks::exit_with_message(
+                li, "Failure to read file '%s' for hashing: %s", fs::u8string(path), ec.message());
+        }
+
+        return result;
+    }
+
+    void FileHashCache::save()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty) return;
+
+        std::string contents;
+        for (auto&& entry : m_entries)
+        {
+            // the key is "<algorithm>\t<path>"
+            const auto tab = entry.first.find('\t');
+            Strings::append(contents, entry.second.stamp.to_string(), '\t');
+            contents.append(entry.first, 0, tab + 1);
+            Strings::append(contents, entry.second.hash);
+            contents.append(entry.first, tab);
+            contents.push_back('\n');
+        }
+
+        CacheFile::save(m_fs, m_cache_file, FILE_HASH_CACHE_HEADER, contents);
+        m_dirty = false;
+    }
+}
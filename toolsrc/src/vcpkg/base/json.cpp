@@ -3,9 +3,12 @@
 #include <vcpkg/base/jsonreader.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/unicode.h>
+#include <vcpkg/base/util.h>
 
 #include <inttypes.h>
 
+#include <deque>
+#include <numeric>
 #include <regex>
 
 namespace vcpkg::Json
@@ -464,7 +467,7 @@ namespace vcpkg::Json
     // } struct Object
 
     // auto parse() {
-    namespace
+    namespace impl
     {
         struct Parser : private Parse::ParserBase
         {
@@ -478,6 +481,18 @@ namespace vcpkg::Json
                 return Parse::ParserBase::next();
             }
 
+            // Documents are mostly indentation; skip spaces without decoding each one.
+            void skip_whitespace() noexcept
+            {
+                for (;;)
+                {
+                    match_ascii_zero_or_more([](char32_t ch) { return ch == ' ' || ch == '\r'; });
+                    const auto ch = cur();
+                    if (ch != '\n' && ch != '\t') return;
+                    Parse::ParserBase::next();
+                }
+            }
+
             static constexpr bool is_digit(char32_t code_point) noexcept
             {
                 return code_point >= '0' && code_point <= '9';
@@ -512,6 +527,11 @@ namespace vcpkg::Json
                 }
             }
 
+            static constexpr bool is_literal_string_code_point(char32_t code_point) noexcept
+            {
+                return code_point > 0x001F && code_point != '"' && code_point != '\\';
+            }
+
             // parses a _single_ code point of a string -- either a literal code point, or an escape sequence
             // returns end_of_file if it reaches an unescaped '"'
             // _does not_ pair escaped surrogates -- returns the literal surrogate.
@@ -584,15 +604,45 @@ namespace vcpkg::Json
                 }
             }
 
-            std::string parse_string() noexcept
+            // Returns a view of the text if the string has no escapes; otherwise unescapes it into `buffer` and returns
+            // a view of that.
+            StringView parse_string_view(std::string& buffer) noexcept
             {
                 Checks::check_exit(VCPKG_LINE_INFO, cur() == '"');
                 next();
 
-                std::string res;
+                // most strings have no escapes at all
+                const char* const start = it().pointer_to_current();
+                match_ascii_zero_or_more(is_literal_string_code_point);
+                match_zero_or_more(is_literal_string_code_point);
+                if (cur() == '"')
+                {
+                    StringView result{start, it().pointer_to_current()};
+                    next();
+                    return result;
+                }
+
+                buffer.assign(start, it().pointer_to_current());
                 char32_t previous_leading_surrogate = Unicode::end_of_file;
                 while (!at_eof())
                 {
+                    // copy runs of literal characters in one piece
+                    auto literal = match_ascii_zero_or_more(is_literal_string_code_point);
+                    if (literal.size() == 0)
+                    {
+                        literal = match_zero_or_more(is_literal_string_code_point);
+                    }
+                    if (literal.size() != 0)
+                    {
+                        if (previous_leading_surrogate != Unicode::end_of_file)
+                        {
+                            Unicode::utf8_append_code_point(buffer, previous_leading_surrogate);
+                            previous_leading_surrogate = Unicode::end_of_file;
+                        }
+                        buffer.append(literal.data(), literal.size());
+                        continue;
+                    }
+
                     auto code_point = parse_string_code_point();
 
                     if (previous_leading_surrogate != Unicode::end_of_file)
@@ -601,13 +651,13 @@ namespace vcpkg::Json
                         {
                             const auto full_code_point =
                                 Unicode::utf16_surrogates_to_code_point(previous_leading_surrogate, code_point);
-                            Unicode::utf8_append_code_point(res, full_code_point);
+                            Unicode::utf8_append_code_point(buffer, full_code_point);
                             previous_leading_surrogate = Unicode::end_of_file;
                             continue;
                         }
                         else
                         {
-                            Unicode::utf8_append_code_point(res, previous_leading_surrogate);
+                            Unicode::utf8_append_code_point(buffer, previous_leading_surrogate);
                         }
                     }
                     previous_leading_surrogate = Unicode::end_of_file;
@@ -618,16 +668,29 @@ namespace vcpkg::Json
                     }
                     else if (code_point == Unicode::end_of_file)
                     {
-                        return res;
+                        return buffer;
                     }
                     else
                     {
-                        Unicode::utf8_append_code_point(res, code_point);
+                        Unicode::utf8_append_code_point(buffer, code_point);
                     }
                 }
 
                 add_error("Unexpected EOF in middle of string");
-                return res;
+                return buffer;
+            }
+
+            // Takes the result of parse_string_view, moving from `buffer` if that is where it is.
+            static std::string to_owned_string(StringView sv, std::string& buffer)
+            {
+                return sv.data() == buffer.data() ? std::move(buffer) : sv.to_string();
+            }
+
+            std::string parse_string() noexcept
+            {
+                std::string buffer;
+                const auto sv = parse_string_view(buffer);
+                return to_owned_string(sv, buffer);
             }
 
             Value parse_number() noexcept
@@ -776,79 +839,132 @@ namespace vcpkg::Json
                 return val;
             }
 
-            Value parse_array() noexcept
+            // Moves past the comma before the next element of an array whose '[' has been parsed. Returns false once
+            // the array is closed, or on an error.
+            bool next_array_element(bool& first) noexcept
             {
-                Checks::check_exit(VCPKG_LINE_INFO, cur() == '[');
-                next();
+                skip_whitespace();
+                char32_t current = cur();
+                if (current == Unicode::end_of_file)
+                {
+                    add_error("Unexpected EOF in middle of array");
+                    return false;
+                }
+                if (current == ']')
+                {
+                    next();
+                    return false;
+                }
 
-                Array arr;
-                bool first = true;
-                for (;;)
+                if (first)
+                {
+                    first = false;
+                }
+                else if (current == ',')
                 {
+                    auto comma_loc = cur_loc();
+                    next();
                     skip_whitespace();
-
-                    char32_t current = cur();
+                    current = cur();
                     if (current == Unicode::end_of_file)
                     {
                         add_error("Unexpected EOF in middle of array");
-                        return Value();
+                        return false;
                     }
                     if (current == ']')
                     {
-                        next();
-                        return Value::array(std::move(arr));
+                        add_error("Trailing comma in array", comma_loc);
+                        return false;
                     }
+                }
+                else
+                {
+                    add_error("Unexpected character in middle of array");
+                    return false;
+                }
 
-                    if (first)
-                    {
-                        first = false;
-                    }
-                    else if (current == ',')
-                    {
-                        auto comma_loc = cur_loc();
-                        next();
-                        skip_whitespace();
-                        current = cur();
-                        if (current == Unicode::end_of_file)
-                        {
-                            add_error("Unexpected EOF in middle of array");
-                            return Value();
-                        }
-                        if (current == ']')
-                        {
-                            add_error("Trailing comma in array", comma_loc);
-                            return Value::array(std::move(arr));
-                        }
-                    }
-                    else
-                    {
-                        add_error("Unexpected character in middle of array");
-                        return Value();
-                    }
+                return true;
+            }
+
+            Value parse_array() noexcept
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '[');
+                next();
 
+                Array arr;
+                bool first = true;
+                while (next_array_element(first))
+                {
                     arr.push_back(parse_value());
                 }
+
+                if (get_error()) return Value();
+                return Value::array(std::move(arr));
             }
 
-            std::pair<std::string, Value> parse_kv_pair() noexcept
+            // Moves past the comma before the next member of an object whose '{' has been parsed. Returns false once
+            // the object is closed, or on an error.
+            bool next_object_member(bool& first) noexcept
             {
                 skip_whitespace();
+                char32_t current = cur();
+                if (current == Unicode::end_of_file)
+                {
+                    add_error("Unexpected EOF; expected property or close brace");
+                    return false;
+                }
+                if (current == '}')
+                {
+                    next();
+                    return false;
+                }
 
-                auto current = cur();
+                if (first)
+                {
+                    first = false;
+                }
+                else if (current == ',')
+                {
+                    auto comma_loc = cur_loc();
+                    next();
+                    skip_whitespace();
+                    current = cur();
+                    if (current == Unicode::end_of_file)
+                    {
+                        add_error("Unexpected EOF; expected property");
+                        return false;
+                    }
+                    if (current == '}')
+                    {
+                        add_error("Trailing comma in an object", comma_loc);
+                        return false;
+                    }
+                }
+                else
+                {
+                    add_error("Unexpected character; expected comma or close brace");
+                    return false;
+                }
 
-                std::pair<std::string, Value> res = {std::string(""), Value()};
+                return true;
+            }
 
+            // Parses a property name and the colon after it; see parse_string_view for `buffer`.
+            StringView parse_key(std::string& buffer) noexcept
+            {
+                skip_whitespace();
+                auto current = cur();
                 if (current == Unicode::end_of_file)
                 {
                     add_error("Unexpected EOF; expected property name");
-                    return res;
+                    return {};
                 }
                 if (current != '"')
                 {
                     add_error("Unexpected character; expected property name");
-                    return res;
+                    return {};
                 }
-                res.first = parse_string();
+                const auto key = parse_string_view(buffer);
 
                 skip_whitespace();
                 current = cur();
@@ -859,72 +975,63 @@ namespace vcpkg::Json
                 else if (current == Unicode::end_of_file)
                 {
                     add_error("Unexpected EOF; expected colon");
-                    return res;
                 }
                 else
                 {
                     add_error("Unexpected character; expected colon");
-                    return res;
                 }
 
-                res.second = parse_value();
+                return key;
+            }
+
+            // Reports the first key which repeats an earlier one, at its location. Duplicates are looked for once an
+            // object is complete; checking every key on insertion would make large objects, like the baseline,
+            // quadratic to parse.
+            void check_duplicate_keys(const std::vector<StringView>& keys, const std::vector<SourceLoc>& key_locs)
+            {
+                std::vector<size_t> order(keys.size());
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::stable_sort(
+                    order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
 
-                return res;
+                size_t duplicate = keys.size();
+                for (size_t i = 1; i < order.size(); ++i)
+                {
+                    if (keys[order[i]] == keys[order[i - 1]]) duplicate = std::min(duplicate, order[i]);
+                }
+
+                if (duplicate != keys.size())
+                {
+                    add_error(Strings::concat("Duplicated key \"", keys[duplicate], "\" in an object"),
+                              key_locs[duplicate]);
+                }
             }
 
             Value parse_object() noexcept
             {
-                char32_t current = cur();
-
-                Checks::check_exit(VCPKG_LINE_INFO, current == '{');
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '{');
                 next();
 
                 Object obj;
+                std::vector<SourceLoc> key_locs;
+                std::string buffer;
                 bool first = true;
-                for (;;)
+                while (next_object_member(first))
                 {
-                    skip_whitespace();
-                    current = cur();
-                    if (current == Unicode::end_of_file)
-                    {
-                        add_error("Unexpected EOF; expected property or close brace");
-                        return Value();
-                    }
-                    else if (current == '}')
-                    {
-                        next();
-                        return Value::object(std::move(obj));
-                    }
-
-                    if (first)
-                    {
-                        first = false;
-                    }
-                    else if (current == ',')
-                    {
-                        auto comma_loc = cur_loc();
-                        next();
-                        skip_whitespace();
-                        current = cur();
-                        if (current == Unicode::end_of_file)
-                        {
-                            add_error("Unexpected EOF; expected property");
-                            return Value();
-                        }
-                        else if (current == '}')
-                        {
-                            add_error("Trailing comma in an object", comma_loc);
-                            return Value();
-                        }
-                    }
-                    else
-                    {
-                        add_error("Unexpected character; expected comma or close brace");
-                    }
-
-                    auto val = parse_kv_pair();
-                    obj.insert(std::move(val.first), std::move(val.second));
+                    key_locs.push_back(cur_loc());
+                    const auto key = parse_key(buffer);
+                    auto owned_key = to_owned_string(key, buffer);
+                    obj.underlying_.emplace_back(std::move(owned_key), parse_value());
                 }
+
+                if (get_error()) return Value();
+                const auto keys =
+                    Util::fmap(obj.underlying_, [](const std::pair<std::string, Value>& member) -> StringView {
+                        return member.first;
+                    });
+                check_duplicate_keys(keys, key_locs);
+                if (get_error()) return Value();
+                return Value::object(std::move(obj));
             }
 
             Value parse_value() noexcept
@@ -984,9 +1091,128 @@ namespace vcpkg::Json
             JsonStyle style() const noexcept { return style_; }
 
         private:
+            friend struct CursorImpl;
+
             JsonStyle style_;
         };
+
+        struct CursorImpl
+        {
+            struct Level
+            {
+                bool is_object;
+                bool first = true;
+                StringView key;
+                std::vector<StringView> keys;
+                std::vector<Parse::ParserBase::SourceLoc> key_locs;
+                // the keys which had escapes, which `keys` refers to
+                std::deque<std::string> unescaped_keys;
+            };
+
+            CursorImpl(StringView text, StringView origin) : parser(text, origin) { }
+
+            bool enter(char32_t open, bool is_object)
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, value_pending, "Json::Cursor: there is no value to enter");
+                parser.skip_whitespace();
+                if (parser.cur() != open) return false;
+
+                parser.next();
+                value_pending = false;
+                levels.emplace_back();
+                levels.back().is_object = is_object;
+                return true;
+            }
+
+            bool next()
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, !levels.empty(), "Json::Cursor: no object or array was entered");
+                if (value_pending)
+                {
+                    parser.parse_value();
+                    value_pending = false;
+                }
+
+                auto& level = levels.back();
+                if (level.is_object)
+                {
+                    if (parser.next_object_member(level.first))
+                    {
+                        level.key_locs.push_back(parser.cur_loc());
+                        level.key = parser.parse_key(buffer);
+                        if (level.key.data() == buffer.data())
+                        {
+                            level.unescaped_keys.push_back(std::move(buffer));
+                            level.key = level.unescaped_keys.back();
+                        }
+
+                        level.keys.push_back(level.key);
+                        value_pending = true;
+                        return true;
+                    }
+
+                    if (!parser.get_error()) parser.check_duplicate_keys(level.keys, level.key_locs);
+                }
+                else if (parser.next_array_element(level.first))
+                {
+                    value_pending = true;
+                    return true;
+                }
+
+                levels.pop_back();
+                return false;
+            }
+
+            Value read()
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, value_pending, "Json::Cursor: there is no value to read");
+                value_pending = false;
+                return parser.parse_value();
+            }
+
+            bool finish()
+            {
+                if (value_pending && levels.empty()) read();
+                while (!levels.empty())
+                {
+                    next();
+                }
+
+                parser.skip_whitespace();
+                if (!parser.at_eof())
+                {
+                    parser.add_error("Unexpected character; expected EOF");
+                }
+
+                return !parser.get_error();
+            }
+
+            const Parse::IParseError* get_error() const { return parser.get_error(); }
+            std::unique_ptr<Parse::IParseError> extract_error() { return parser.extract_error(); }
+
+            Parser parser;
+            std::vector<Level> levels;
+            // whether the current value is yet to be entered or read; the document itself is the first value
+            bool value_pending = true;
+            std::string buffer;
+        };
+    }
+
+    Cursor::Cursor(StringView text, StringView origin) : m_impl(std::make_unique<impl::CursorImpl>(text, origin)) { }
+    Cursor::~Cursor() = default;
+
+    bool Cursor::enter_object() { return m_impl->enter('{', true); }
+    bool Cursor::enter_array() { return m_impl->enter('[', false); }
+    bool Cursor::next() { return m_impl->next(); }
+    StringView Cursor::key() const
+    {
+        if (m_impl->levels.empty()) return {};
+        return m_impl->levels.back().key;
     }
+    Value Cursor::read() { return m_impl->read(); }
+    bool Cursor::finish() { return m_impl->finish(); }
+    const Parse::IParseError* Cursor::get_error() const { return m_impl->get_error(); }
+    std::unique_ptr<Parse::IParseError> Cursor::extract_error() { return m_impl->extract_error(); }
 
     NaturalNumberDeserializer NaturalNumberDeserializer::instance;
     BooleanDeserializer BooleanDeserializer::instance;
@@ -1062,7 +1288,7 @@ namespace vcpkg::Json
     ExpectedT<std::pair<Value, JsonStyle>, std::unique_ptr<Parse::IParseError>> parse(StringView json,
                                                                                       const fs::path& filepath) noexcept
     {
-        return Parser::parse(json, fs::generic_u8string(filepath));
+        return impl::Parser::parse(json, fs::generic_u8string(filepath));
     }
     // } auto parse()
 
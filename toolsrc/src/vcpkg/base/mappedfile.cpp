@@ -0,0 +1,133 @@
+#include <vcpkg/base/system_headers.h>
+
+#include <vcpkg/base/mappedfile.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // ^^^ !_WIN32
+
+#include <utility>
+
+namespace vcpkg::Files
+{
+    MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_is_open = std::exchange(other.m_is_open, false);
+#if defined(_WIN32)
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile() { close(); }
+
+    MappedFile MappedFile::open(const fs::path& path, std::error_code& ec)
+    {
+        ec.clear();
+        MappedFile result;
+#if defined(_WIN32)
+        const HANDLE file = CreateFileW(path.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            ec.assign(static_cast<int>(GetLastError()), std::system_category());
+            return result;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            ec.assign(static_cast<int>(GetLastError()), std::system_category());
+            CloseHandle(file);
+            return result;
+        }
+
+        result.m_is_open = true;
+        result.m_size = static_cast<size_t>(size.QuadPart);
+        if (result.m_size != 0)
+        {
+            // the mapping keeps the file open, so the handle can be closed right away
+            result.m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (result.m_mapping)
+            {
+                result.m_data =
+                    static_cast<const char*>(MapViewOfFile(result.m_mapping, FILE_MAP_READ, 0, 0, result.m_size));
+            }
+
+            if (!result.m_data)
+            {
+                ec.assign(static_cast<int>(GetLastError()), std::system_category());
+                result.close();
+            }
+        }
+
+        CloseHandle(file);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            ec.assign(errno, std::generic_category());
+            return result;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ec.assign(errno, std::generic_category());
+            ::close(fd);
+            return result;
+        }
+
+        result.m_is_open = true;
+        result.m_size = static_cast<size_t>(info.st_size);
+        if (result.m_size != 0)
+        {
+            // the mapping keeps the file open, so the descriptor can be closed right away
+            void* const data = mmap(nullptr, result.m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ec.assign(errno, std::generic_category());
+                result.close();
+            }
+            else
+            {
+                result.m_data = static_cast<const char*>(data);
+            }
+        }
+
+        ::close(fd);
+#endif // ^^^ !_WIN32
+        return result;
+    }
+
+    void MappedFile::close()
+    {
+#if defined(_WIN32)
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        m_mapping = nullptr;
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        if (m_data) munmap(const_cast<char*>(m_data), m_size);
+#endif // ^^^ !_WIN32
+        m_data = nullptr;
+        m_size = 0;
+        m_is_open = false;
+    }
+}
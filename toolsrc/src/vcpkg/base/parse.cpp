@@ -85,6 +85,23 @@ namespace vcpkg::Parse
         return cur();
     }
 
+    void ParserBase::skip_ascii_to(const char* position)
+    {
+        const auto current = m_it.pointer_to_current();
+        if (position == current)
+        {
+            return;
+        }
+
+        // every skipped character is one column wide
+        m_column += static_cast<int>(position - current);
+        m_it = Unicode::Utf8Decoder(position, m_text.end());
+        if (m_it != m_it.end() && Unicode::utf16_is_surrogate_code_point(*m_it))
+        {
+            m_it = m_it.end();
+        }
+    }
+
     void ParserBase::add_error(std::string message, const SourceLoc& loc)
     {
         // avoid cascading errors by only saving the first
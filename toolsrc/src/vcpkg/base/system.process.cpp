@@ -1,12 +1,23 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/chrono.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
+#include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
 
 #include <ctime>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
 #if defined(__APPLE__)
 #include <mach-o/dyld.h>
 #endif
@@ -184,9 +195,9 @@ namespace vcpkg
     }
     System::CMakeVariable::CMakeVariable(std::string var) : s(std::move(var)) { }
 
-    std::string System::make_basic_cmake_cmd(const fs::path& cmake_tool_path,
-                                             const fs::path& cmake_script,
-                                             const std::vector<CMakeVariable>& pass_variables)
+    System::CmdLineBuilder System::make_basic_cmake_cmd(const fs::path& cmake_tool_path,
+                                                        const fs::path& cmake_script,
+                                                        const std::vector<CMakeVariable>& pass_variables)
     {
         System::CmdLineBuilder cmd;
         cmd.path_arg(cmake_tool_path);
@@ -195,11 +206,12 @@ namespace vcpkg
             cmd.string_arg(var.s);
         }
         cmd.string_arg("-P").path_arg(cmake_script);
-        return cmd.extract();
+        return cmd;
     }
 
     System::CmdLineBuilder& System::CmdLineBuilder::string_arg(StringView s)
     {
+        m_argv.push_back(s.to_string());
         if (!buf.empty()) buf.push_back(' ');
         if (Strings::find_first_of(s, " \t\n\r\"\\,;&`^|'") != s.end())
         {
@@ -372,10 +384,33 @@ namespace vcpkg
         return {env_cstr};
     }
 #else
-    Environment System::get_modified_clean_environment(const std::unordered_map<std::string, std::string>&,
-                                                       const std::string&)
+    Environment System::get_modified_clean_environment(const std::unordered_map<std::string, std::string>& extra_env,
+                                                       const std::string& prepend_to_path)
     {
-        return {};
+        // Unlike on Windows, child processes see all of vcpkg's environment, with only the requested changes applied.
+        Environment env;
+        if (extra_env.empty() && prepend_to_path.empty()) return env;
+
+        std::string new_path = Strings::concat("PATH=", prepend_to_path, get_environment_variable("PATH").value_or(""));
+        const auto extra_path = extra_env.find("PATH");
+        if (extra_path != extra_env.end()) Strings::append(new_path, Files::path_list_separator, extra_path->second);
+
+        for (char** var = environ; *var; ++var)
+        {
+            const StringView entry(*var, strlen(*var));
+            const auto name = std::string(entry.begin(), std::find(entry.begin(), entry.end(), '='));
+            if (name == "PATH" || extra_env.find(name) != extra_env.end()) continue;
+            env.m_env_data.emplace_back(entry.begin(), entry.end());
+        }
+
+        env.m_env_data.push_back(std::move(new_path));
+        for (const auto& item : extra_env)
+        {
+            if (item.first == "PATH") continue;
+            env.m_env_data.push_back(Strings::concat(item.first, '=', item.second));
+        }
+
+        return env;
     }
 #endif
     const Environment& System::get_clean_environment()
@@ -385,6 +420,10 @@ namespace vcpkg
     }
 
     int System::cmd_execute_clean(const ZStringView cmd_line) { return cmd_execute(cmd_line, get_clean_environment()); }
+    int System::cmd_execute_clean(const CmdLineBuilder& cmd_line)
+    {
+        return cmd_execute(cmd_line, get_clean_environment());
+    }
 
 #if defined(_WIN32)
     struct ProcessInfo
@@ -600,7 +639,175 @@ namespace vcpkg
     }
 #endif
 
-    int System::cmd_execute(const ZStringView cmd_line, const Environment& env)
+#if !defined(_WIN32)
+    // The program and arguments to start; the program is looked up in PATH if it contains no slash.
+    using SpawnArgs = std::vector<std::string>;
+
+    static SpawnArgs get_spawn_args(const ZStringView cmd_line) { return {"/bin/sh", "-c", cmd_line.to_string()}; }
+    static SpawnArgs get_spawn_args(const System::CmdLineBuilder& cmd_line)
+    {
+        if (cmd_line.needs_shell() || cmd_line.argv().empty()) return get_spawn_args(cmd_line.command_line());
+        return cmd_line.argv();
+    }
+
+    static std::string to_string(const SpawnArgs& args) { return Strings::join(" ", args); }
+
+    /// <summary>
+    /// Starts `args` with posix_spawn. If `output_fd` is non-null, the child reads its stdin from /dev/null and writes
+    /// its stdout and stderr to a pipe whose non-blocking read end is returned there.
+    /// </summary>
+    /// <returns>0, or the error number if the process could not be started.</returns>
+    static int posix_spawn_args(SpawnArgs args, const Environment& env, pid_t& pid, int* output_fd)
+    {
+        std::vector<char*> argv = Util::fmap(args, [](std::string& arg) { return &arg[0]; });
+        argv.push_back(nullptr);
+        std::vector<char*> envp;
+        if (!env.m_env_data.empty())
+        {
+            envp = Util::fmap(env.m_env_data,
+                              [](const std::string& entry) { return const_cast<char*>(entry.c_str()); });
+            envp.push_back(nullptr);
+        }
+
+        // Both ends are close-on-exec so that children started concurrently do not hold on to them; dup2 clears the
+        // flag on the child's copies.
+        int pipe_fds[2] = {-1, -1};
+        if (output_fd)
+        {
+#if defined(__linux__)
+            if (pipe2(pipe_fds, O_CLOEXEC) != 0) return errno;
+#else
+            if (pipe(pipe_fds) != 0) return errno;
+            fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (output_fd)
+        {
+            posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+            posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], 1);
+            posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], 2);
+        }
+
+        Debug::print("posix_spawn(", to_string(args), ")\n");
+        // Flush stdout before launching external process
+        fflush(nullptr);
+
+        const int error =
+            posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), envp.empty() ? environ : envp.data());
+        posix_spawn_file_actions_destroy(&actions);
+        if (output_fd)
+        {
+            close(pipe_fds[1]);
+            if (error != 0)
+            {
+                close(pipe_fds[0]);
+            }
+            else
+            {
+                fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
+                *output_fd = pipe_fds[0];
+            }
+        }
+
+        return error;
+    }
+
+    static int posix_wait_for_child(pid_t pid)
+    {
+        int status;
+        while (waitpid(pid, &status, 0) == -1)
+        {
+            if (errno != EINTR) return 1;
+        }
+
+        // Report signals like the shell does
+        if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+        return WEXITSTATUS(status);
+    }
+
+    /// <summary>
+    /// Runs `cmd_lines` with at most `max_concurrency` children at once, passing output of the i-th one to
+    /// `data_cb(i, data)` as it arrives. The children's pipes are multiplexed with poll() on the calling thread.
+    /// </summary>
+    /// <returns>The exit code of each command, 127 if it could not be started.</returns>
+    static std::vector<int> posix_execute_and_stream_data(View<SpawnArgs> cmd_lines,
+                                                          const Environment& env,
+                                                          size_t max_concurrency,
+                                                          const std::function<void(size_t, StringView)>& data_cb)
+    {
+        static constexpr size_t buffer_size = 1024 * 64;
+        auto buf = std::make_unique<char[]>(buffer_size);
+        std::vector<int> exit_codes(cmd_lines.size(), 127);
+        std::vector<std::pair<size_t, pid_t>> running;
+        std::vector<pollfd> pipes;
+        size_t next = 0;
+        for (;;)
+        {
+            while (running.size() < max_concurrency && next < cmd_lines.size())
+            {
+                pid_t pid;
+                int fd;
+                const int error = posix_spawn_args(cmd_lines[next], env, pid, &fd);
+                if (error == 0)
+                {
+                    running.emplace_back(next, pid);
+                    pipes.push_back({fd, POLLIN, 0});
+                }
+                else
+                {
+                    data_cb(
+                        next,
+                        Strings::concat("Failed to start ", to_string(cmd_lines[next]), ": ", strerror(error), '\n'));
+                }
+
+                ++next;
+            }
+
+            if (running.empty()) return exit_codes;
+
+            if (poll(pipes.data(), static_cast<nfds_t>(pipes.size()), -1) == -1)
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, errno == EINTR, "poll() failed: %s", strerror(errno));
+                continue;
+            }
+
+            for (size_t i = 0; i < pipes.size();)
+            {
+                if (pipes[i].revents != 0)
+                {
+                    const auto bytes = read(pipes[i].fd, buf.get(), buffer_size);
+                    if (bytes > 0)
+                    {
+                        data_cb(running[i].first, StringView{buf.get(), static_cast<size_t>(bytes)});
+                    }
+                    else if (bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                    {
+                        // The child closed its output, so it is done or about to be.
+                        close(pipes[i].fd);
+                        exit_codes[running[i].first] = posix_wait_for_child(running[i].second);
+                        running.erase(running.begin() + i);
+                        pipes.erase(pipes.begin() + i);
+                        continue;
+                    }
+                }
+
+                ++i;
+            }
+        }
+    }
+#else
+    // The command line to start
+    using SpawnArgs = std::string;
+
+    static SpawnArgs get_spawn_args(const ZStringView cmd_line) { return cmd_line.to_string(); }
+    static SpawnArgs get_spawn_args(const System::CmdLineBuilder& cmd_line) { return cmd_line.command_line(); }
+#endif
+
+    static int execute(const SpawnArgs& cmd_line, const Environment& env)
     {
         auto timer = Chrono::ElapsedTimer::create_started();
 #if defined(_WIN32)
@@ -616,51 +823,27 @@ namespace vcpkg
         if (long_exit_code > INT_MAX) long_exit_code = INT_MAX;
         int exit_code = static_cast<int>(long_exit_code);
         g_ctrl_c_state.transition_from_spawn_process();
-
-        Debug::print(
-            "cmd_execute() returned ", exit_code, " after ", static_cast<unsigned int>(timer.microseconds()), " us\n");
 #else
-        (void)env;
-        Debug::print("system(", cmd_line, ")\n");
-        fflush(nullptr);
-
-        int exit_code = system(cmd_line.c_str());
-        Debug::print(
-            "system() returned ", exit_code, " after ", static_cast<unsigned int>(timer.microseconds()), " us\n");
+        pid_t pid;
+        const int error = posix_spawn_args(cmd_line, env, pid, nullptr);
+        int exit_code = 127;
+        if (error == 0)
+        {
+            exit_code = posix_wait_for_child(pid);
+        }
+        else
+        {
+            System::print2("Failed to start ", to_string(cmd_line), ": ", strerror(error), '\n');
+        }
 #endif
+        Debug::print(
+            "cmd_execute() returned ", exit_code, " after ", static_cast<unsigned int>(timer.microseconds()), " us\n");
         return exit_code;
     }
 
-    int System::cmd_execute_and_stream_lines(const ZStringView cmd_line,
-                                             std::function<void(const std::string&)> per_line_cb,
-                                             const Environment& env)
-    {
-        std::string buf;
-
-        auto rc = cmd_execute_and_stream_data(
-            cmd_line,
-            [&](StringView sv) {
-                auto prev_size = buf.size();
-                Strings::append(buf, sv);
-
-                auto it = std::find(buf.begin() + prev_size, buf.end(), '\n');
-                while (it != buf.end())
-                {
-                    std::string s(buf.begin(), it);
-                    per_line_cb(s);
-                    buf.erase(buf.begin(), it + 1);
-                    it = std::find(buf.begin(), buf.end(), '\n');
-                }
-            },
-            env);
-
-        per_line_cb(buf);
-        return rc;
-    }
-
-    int System::cmd_execute_and_stream_data(const ZStringView cmd_line,
-                                            std::function<void(StringView)> data_cb,
-                                            const Environment& env)
+    static int execute_and_stream_data(const SpawnArgs& cmd_line,
+                                       const std::function<void(StringView)>& data_cb,
+                                       const Environment& env)
     {
         auto timer = Chrono::ElapsedTimer::create_started();
 
@@ -677,30 +860,8 @@ namespace vcpkg
         }();
         g_ctrl_c_state.transition_from_spawn_process();
 #else
-        (void)env;
-        const auto actual_cmd_line = Strings::format(R"###(%s 2>&1)###", cmd_line);
-
-        Debug::print("popen(", actual_cmd_line, ")\n");
-        // Flush stdout before launching external process
-        fflush(stdout);
-
-        const auto pipe = popen(actual_cmd_line.c_str(), "r");
-        if (pipe == nullptr)
-        {
-            return 1;
-        }
-        char buf[1024];
-        while (fgets(buf, 1024, pipe))
-        {
-            data_cb(StringView{buf, strlen(buf)});
-        }
-
-        if (!feof(pipe))
-        {
-            return 1;
-        }
-
-        const auto exit_code = pclose(pipe);
+        const auto exit_code = posix_execute_and_stream_data(
+            {&cmd_line, 1}, env, 1, [&](size_t, StringView sv) { data_cb(sv); })[0];
 #endif
         Debug::print("cmd_execute_and_stream_data() returned ",
                      exit_code,
@@ -711,14 +872,96 @@ namespace vcpkg
         return exit_code;
     }
 
-    ExitCodeAndOutput System::cmd_execute_and_capture_output(const ZStringView cmd_line, const Environment& env)
+    static int execute_and_stream_lines(const SpawnArgs& cmd_line,
+                                        const std::function<void(StringView)>& per_line_cb,
+                                        const Environment& env)
+    {
+        Strings::LineSplitter lines;
+        auto rc = execute_and_stream_data(
+            cmd_line, [&](StringView sv) { lines.feed(sv, per_line_cb); }, env);
+
+        lines.finish(per_line_cb);
+        return rc;
+    }
+
+    static ExitCodeAndOutput execute_and_capture_output(const SpawnArgs& cmd_line, const Environment& env)
     {
         std::string output;
-        auto rc = cmd_execute_and_stream_data(
+        auto rc = execute_and_stream_data(
             cmd_line, [&](StringView sv) { Strings::append(output, sv); }, env);
         return {rc, std::move(output)};
     }
 
+    int System::cmd_execute(const ZStringView cmd_line, const Environment& env)
+    {
+        return execute(get_spawn_args(cmd_line), env);
+    }
+
+    int System::cmd_execute(const CmdLineBuilder& cmd_line, const Environment& env)
+    {
+        return execute(get_spawn_args(cmd_line), env);
+    }
+
+    int System::cmd_execute_and_stream_lines(const ZStringView cmd_line,
+                                             std::function<void(StringView)> per_line_cb,
+                                             const Environment& env)
+    {
+        return execute_and_stream_lines(get_spawn_args(cmd_line), per_line_cb, env);
+    }
+
+    int System::cmd_execute_and_stream_lines(const CmdLineBuilder& cmd_line,
+                                             std::function<void(StringView)> per_line_cb,
+                                             const Environment& env)
+    {
+        return execute_and_stream_lines(get_spawn_args(cmd_line), per_line_cb, env);
+    }
+
+    int System::cmd_execute_and_stream_data(const ZStringView cmd_line,
+                                            std::function<void(StringView)> data_cb,
+                                            const Environment& env)
+    {
+        return execute_and_stream_data(get_spawn_args(cmd_line), data_cb, env);
+    }
+
+    int System::cmd_execute_and_stream_data(const CmdLineBuilder& cmd_line,
+                                            std::function<void(StringView)> data_cb,
+                                            const Environment& env)
+    {
+        return execute_and_stream_data(get_spawn_args(cmd_line), data_cb, env);
+    }
+
+    ExitCodeAndOutput System::cmd_execute_and_capture_output(const ZStringView cmd_line, const Environment& env)
+    {
+        return execute_and_capture_output(get_spawn_args(cmd_line), env);
+    }
+
+    ExitCodeAndOutput System::cmd_execute_and_capture_output(const CmdLineBuilder& cmd_line, const Environment& env)
+    {
+        return execute_and_capture_output(get_spawn_args(cmd_line), env);
+    }
+
+    std::vector<ExitCodeAndOutput> System::cmd_execute_and_capture_output_parallel(View<CmdLineBuilder> cmd_lines,
+                                                                                   const Environment& env)
+    {
+        std::vector<ExitCodeAndOutput> results(cmd_lines.size());
+        const auto max_concurrency = static_cast<size_t>(std::max(1, get_num_logical_cores()));
+#if defined(_WIN32)
+        execute_in_parallel(cmd_lines.size(), max_concurrency, [&](size_t i) {
+            results[i] = cmd_execute_and_capture_output(cmd_lines[i], env);
+        });
+#else
+        const auto args =
+            Util::fmap(cmd_lines, [](const System::CmdLineBuilder& cmd_line) { return get_spawn_args(cmd_line); });
+        const auto exit_codes = posix_execute_and_stream_data(
+            args, env, max_concurrency, [&](size_t i, StringView sv) { Strings::append(results[i].output, sv); });
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            results[i].exit_code = exit_codes[i];
+        }
+#endif
+        return results;
+    }
+
 #if defined(_WIN32)
     static BOOL ctrl_handler(DWORD fdw_ctrl_type)
     {
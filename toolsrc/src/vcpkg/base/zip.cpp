@@ -0,0 +1,2125 @@
+#include <vcpkg/base/checks.h>
+#include <vcpkg/base/parallel-algorithms.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/util.h>
+#include <vcpkg/base/zip.h>
+
+#include <fstream>
+#include <functional>
+#include <set>
+
+namespace vcpkg::Zip
+{
+    namespace
+    {
+        constexpr uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                              31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                              2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        constexpr uint16_t DISTANCE_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,    25,
+                                                33,   49,   65,   97,   129,  193,   257,   385,   513,   769,
+                                                1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577};
+        constexpr uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        constexpr uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        constexpr size_t LITERAL_LENGTH_CODES = 286;
+        constexpr size_t DISTANCE_CODES = 30;
+        constexpr size_t CODE_LENGTH_CODES = 19;
+        constexpr int MAX_CODE_BITS = 15;
+        constexpr int MAX_CODE_LENGTH_BITS = 7;
+        constexpr uint32_t END_OF_BLOCK = 256;
+
+        const uint32_t* get_crc32_table()
+        {
+            static const auto table = [] {
+                std::array<uint32_t, 256> entries;
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    }
+
+                    entries[i] = c;
+                }
+
+                return entries;
+            }();
+
+            return table.data();
+        }
+
+        uint32_t reverse_bits(uint32_t code, int length)
+        {
+            uint32_t result = 0;
+            for (int i = 0; i < length; ++i)
+            {
+                result = (result << 1) | (code & 1);
+                code >>= 1;
+            }
+
+            return result;
+        }
+
+        // Computes the canonical code of each symbol from the code lengths, bit reversed for LSB-first output.
+        void build_codes(const uint8_t* lengths, size_t count, uint16_t* codes)
+        {
+            uint16_t bl_count[MAX_CODE_BITS + 1] = {};
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++bl_count[lengths[i]];
+            }
+
+            bl_count[0] = 0;
+            uint16_t next_code[MAX_CODE_BITS + 1] = {};
+            uint16_t code = 0;
+            for (int bits = 1; bits <= MAX_CODE_BITS; ++bits)
+            {
+                code = static_cast<uint16_t>((code + bl_count[bits - 1]) << 1);
+                next_code[bits] = code;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (lengths[i] != 0)
+                {
+                    codes[i] = static_cast<uint16_t>(reverse_bits(next_code[lengths[i]]++, lengths[i]));
+                }
+                else
+                {
+                    codes[i] = 0;
+                }
+            }
+        }
+
+        // ===== Decompression =====
+
+        struct HuffmanTable
+        {
+            // indexed by the next `max_length` bits of input; (symbol << 4) | code length, or 0 if invalid
+            std::vector<uint16_t> entries;
+            uint32_t mask = 0;
+        };
+
+        bool build_decode_table(const uint8_t* lengths, size_t count, HuffmanTable& table)
+        {
+            uint16_t bl_count[MAX_CODE_BITS + 1] = {};
+            int max_length = 1;
+            for (size_t i = 0; i < count; ++i)
+            {
+                ++bl_count[lengths[i]];
+                max_length = std::max<int>(max_length, lengths[i]);
+            }
+
+            bl_count[0] = 0;
+            int left = 1;
+            for (int bits = 1; bits <= MAX_CODE_BITS; ++bits)
+            {
+                left <<= 1;
+                left -= bl_count[bits];
+                if (left < 0)
+                {
+                    // over-subscribed
+                    return false;
+                }
+            }
+
+            std::vector<uint16_t> codes(count);
+            build_codes(lengths, count, codes.data());
+
+            const uint32_t size = 1u << max_length;
+            table.entries.assign(size, 0);
+            table.mask = size - 1;
+            for (size_t symbol = 0; symbol < count; ++symbol)
+            {
+                const uint32_t length = lengths[symbol];
+                if (length == 0) continue;
+                for (uint32_t k = codes[symbol]; k < size; k += 1u << length)
+                {
+                    table.entries[k] = static_cast<uint16_t>((symbol << 4) | length);
+                }
+            }
+
+            return true;
+        }
+
+        struct BitReader
+        {
+            explicit BitReader(StringView data)
+                : next(reinterpret_cast<const unsigned char*>(data.data()))
+                , end(reinterpret_cast<const unsigned char*>(data.data() + data.size()))
+            {
+            }
+
+            // Reads the input in pieces from `more`, which returns an empty view at the end of the input.
+            explicit BitReader(std::function<StringView()> more) : more(std::move(more)) { }
+
+            void refill()
+            {
+                while (count <= 56)
+                {
+                    uint64_t byte = 0;
+                    if (next == end) pull();
+                    if (next != end)
+                    {
+                        byte = *next++;
+                    }
+                    else
+                    {
+                        ++overrun;
+                    }
+
+                    buffer |= byte << count;
+                    count += 8;
+                }
+            }
+
+            uint32_t bits(int n)
+            {
+                if (count < n) refill();
+                const uint32_t value = static_cast<uint32_t>(buffer & ((uint64_t(1) << n) - 1));
+                buffer >>= n;
+                count -= n;
+                return value;
+            }
+
+            // Returns -1 for codes not in the table.
+            int decode(const HuffmanTable& table)
+            {
+                if (count < MAX_CODE_BITS) refill();
+                const uint16_t entry = table.entries[buffer & table.mask];
+                const int length = entry & 15;
+                if (length == 0) return -1;
+                buffer >>= length;
+                count -= length;
+                return entry >> 4;
+            }
+
+            // Discards the rest of the current byte.
+            void align()
+            {
+                const int partial = count % 8;
+                buffer >>= partial;
+                count -= partial;
+            }
+
+            // Appends the next `n` bytes of the byte-aligned input to `out`; false if the input ends first.
+            bool copy_bytes(size_t n, std::string& out)
+            {
+                for (; n > 0 && count >= 8; --n)
+                {
+                    out.push_back(static_cast<char>(buffer & 0xFF));
+                    buffer >>= 8;
+                    count -= 8;
+                }
+
+                while (n > 0)
+                {
+                    if (next == end) pull();
+                    if (next == end) return false;
+                    const size_t chunk = std::min(n, static_cast<size_t>(end - next));
+                    out.append(reinterpret_cast<const char*>(next), chunk);
+                    next += chunk;
+                    n -= chunk;
+                }
+
+                return true;
+            }
+
+            // true if bits past the end of the input have been consumed
+            bool truncated() const { return static_cast<size_t>(count) < overrun * 8; }
+
+        private:
+            void pull()
+            {
+                if (!more) return;
+                const StringView piece = more();
+                if (piece.size() == 0)
+                {
+                    more = nullptr;
+                    return;
+                }
+
+                next = reinterpret_cast<const unsigned char*>(piece.data());
+                end = next + piece.size();
+            }
+
+            const unsigned char* next = nullptr;
+            const unsigned char* end = nullptr;
+            std::function<StringView()> more;
+            uint64_t buffer = 0;
+            int count = 0;
+            size_t overrun = 0;
+        };
+
+        const std::pair<HuffmanTable, HuffmanTable>& get_fixed_tables()
+        {
+            static const auto tables = [] {
+                uint8_t lengths[288 + 32];
+                std::fill(lengths, lengths + 144, uint8_t(8));
+                std::fill(lengths + 144, lengths + 256, uint8_t(9));
+                std::fill(lengths + 256, lengths + 280, uint8_t(7));
+                std::fill(lengths + 280, lengths + 288, uint8_t(8));
+                std::fill(lengths + 288, lengths + 320, uint8_t(5));
+                std::pair<HuffmanTable, HuffmanTable> result;
+                build_decode_table(lengths, 288, result.first);
+                build_decode_table(lengths + 288, 32, result.second);
+                return result;
+            }();
+
+            return tables;
+        }
+
+        Optional<std::string> read_dynamic_tables(BitReader& reader, HuffmanTable& literals, HuffmanTable& distances)
+        {
+            const size_t hlit = reader.bits(5) + 257;
+            const size_t hdist = reader.bits(5) + 1;
+            const size_t hclen = reader.bits(4) + 4;
+            if (hlit > LITERAL_LENGTH_CODES || hdist > DISTANCE_CODES)
+            {
+                return std::string("invalid dynamic block header");
+            }
+
+            uint8_t code_length_lengths[CODE_LENGTH_CODES] = {};
+            for (size_t i = 0; i < hclen; ++i)
+            {
+                code_length_lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(reader.bits(3));
+            }
+
+            HuffmanTable code_lengths;
+            if (!build_decode_table(code_length_lengths, CODE_LENGTH_CODES, code_lengths))
+            {
+                return std::string("invalid code length code");
+            }
+
+            uint8_t lengths[LITERAL_LENGTH_CODES + DISTANCE_CODES] = {};
+            size_t index = 0;
+            while (index < hlit + hdist)
+            {
+                const int symbol = reader.decode(code_lengths);
+                if (symbol < 0) return std::string("invalid code length");
+                if (symbol < 16)
+                {
+                    lengths[index++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t value = 0;
+                size_t repeat;
+                if (symbol == 16)
+                {
+                    if (index == 0) return std::string("repeated code length without a previous length");
+                    value = lengths[index - 1];
+                    repeat = 3 + reader.bits(2);
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + reader.bits(3);
+                }
+                else
+                {
+                    repeat = 11 + reader.bits(7);
+                }
+
+                if (index + repeat > hlit + hdist) return std::string("too many code lengths");
+                std::fill(lengths + index, lengths + index + repeat, value);
+                index += repeat;
+            }
+
+            if (lengths[END_OF_BLOCK] == 0) return std::string("missing end of block code");
+            if (!build_decode_table(lengths, hlit, literals)) return std::string("invalid literal/length code");
+            if (!build_decode_table(lengths + hlit, hdist, distances)) return std::string("invalid distance code");
+            if (reader.truncated()) return std::string("unexpected end of data");
+            return nullopt;
+        }
+
+        // Decompresses the raw DEFLATE stream read by `reader`, handing the output to `sink` in pieces. Only the last
+        // 32 KiB of output, which later matches may refer back to, are kept between pieces.
+        Optional<std::string> inflate_stream(BitReader& reader,
+                                             uint64_t max_size,
+                                             const std::function<void(StringView)>& sink)
+        {
+            constexpr size_t WINDOW_SIZE = 32768;
+            constexpr size_t FLUSH_SIZE = 1 << 20;
+
+            std::string out;
+            out.reserve(FLUSH_SIZE + 258);
+            uint64_t flushed = 0;
+            const auto flush = [&](size_t keep) {
+                if (out.size() <= keep) return;
+                const size_t count = out.size() - keep;
+                sink(StringView{out.data(), count});
+                flushed += count;
+                out.erase(0, count);
+            };
+
+            HuffmanTable dynamic_literals;
+            HuffmanTable dynamic_distances;
+            bool last_block;
+            do
+            {
+                last_block = reader.bits(1) != 0;
+                const uint32_t type = reader.bits(2);
+                if (type == 0)
+                {
+                    reader.align();
+                    const uint32_t length = reader.bits(16);
+                    if ((~reader.bits(16) & 0xFFFF) != length)
+                    {
+                        return std::string("stored block length does not match its complement");
+                    }
+
+                    if (flushed + out.size() + length > max_size) return std::string("data is larger than expected");
+                    if (reader.truncated() || !reader.copy_bytes(length, out))
+                    {
+                        return std::string("unexpected end of data");
+                    }
+
+                    if (out.size() >= FLUSH_SIZE) flush(WINDOW_SIZE);
+                    continue;
+                }
+
+                const HuffmanTable* literals;
+                const HuffmanTable* distances;
+                if (type == 1)
+                {
+                    const auto& fixed = get_fixed_tables();
+                    literals = &fixed.first;
+                    distances = &fixed.second;
+                }
+                else if (type == 2)
+                {
+                    if (auto error = read_dynamic_tables(reader, dynamic_literals, dynamic_distances))
+                    {
+                        return error;
+                    }
+
+                    literals = &dynamic_literals;
+                    distances = &dynamic_distances;
+                }
+                else
+                {
+                    return std::string("invalid block type");
+                }
+
+                for (;;)
+                {
+                    const int symbol = reader.decode(*literals);
+                    if (symbol < 0) return std::string("invalid literal/length code");
+                    if (symbol < 256)
+                    {
+                        out.push_back(static_cast<char>(symbol));
+                    }
+                    else if (symbol == END_OF_BLOCK)
+                    {
+                        break;
+                    }
+                    else
+                    {
+                        const int length_code = symbol - 257;
+                        if (length_code >= 29) return std::string("invalid length code");
+                        const size_t length = LENGTH_BASE[length_code] + reader.bits(LENGTH_EXTRA[length_code]);
+                        const int distance_code = reader.decode(*distances);
+                        if (distance_code < 0 || distance_code >= 30) return std::string("invalid distance code");
+                        const size_t distance =
+                            DISTANCE_BASE[distance_code] + reader.bits(DISTANCE_EXTRA[distance_code]);
+                        if (distance > out.size()) return std::string("distance is too far back");
+
+                        const size_t start = out.size() - distance;
+                        out.resize(out.size() + length);
+                        char* const buffer = &out[0];
+                        char* const target = buffer + out.size() - length;
+                        for (size_t i = 0; i < length; ++i)
+                        {
+                            target[i] = buffer[start + i];
+                        }
+                    }
+
+                    if (reader.truncated()) return std::string("unexpected end of data");
+                    if (out.size() >= FLUSH_SIZE)
+                    {
+                        if (flushed + out.size() > max_size) return std::string("data is larger than expected");
+                        flush(WINDOW_SIZE);
+                    }
+                }
+            } while (!last_block);
+
+            if (reader.truncated()) return std::string("unexpected end of data");
+            if (flushed + out.size() > max_size) return std::string("data is larger than expected");
+            flush(0);
+            return nullopt;
+        }
+
+        // ===== Compression =====
+
+        struct BitWriter
+        {
+            explicit BitWriter(std::string& out) : out(out) { }
+
+            void put(uint32_t value, int n)
+            {
+                buffer |= uint64_t(value) << count;
+                count += n;
+                while (count >= 8)
+                {
+                    out.push_back(static_cast<char>(buffer & 0xFF));
+                    buffer >>= 8;
+                    count -= 8;
+                }
+            }
+
+            void align()
+            {
+                if (count > 0)
+                {
+                    out.push_back(static_cast<char>(buffer & 0xFF));
+                    buffer = 0;
+                    count = 0;
+                }
+            }
+
+            std::string& out;
+            uint64_t buffer = 0;
+            int count = 0;
+        };
+
+        struct LzSymbol
+        {
+            // a literal byte if distance is 0, otherwise the match length
+            uint16_t literal_or_length;
+            uint16_t distance;
+        };
+
+        struct SymbolCodeTables
+        {
+            uint8_t length_code[259];
+            uint8_t distance_code[32769];
+        };
+
+        const SymbolCodeTables& get_symbol_code_tables()
+        {
+            static const auto tables = [] {
+                auto result = std::make_unique<SymbolCodeTables>();
+                for (uint8_t code = 0; code < 29; ++code)
+                {
+                    const size_t last = code == 28 ? 258 : LENGTH_BASE[code + 1];
+                    for (size_t length = LENGTH_BASE[code]; length < last; ++length)
+                    {
+                        result->length_code[length] = code;
+                    }
+                }
+
+                result->length_code[258] = 28;
+                for (uint8_t code = 0; code < 30; ++code)
+                {
+                    const size_t last = code == 29 ? 32769 : DISTANCE_BASE[code + 1];
+                    for (size_t distance = DISTANCE_BASE[code]; distance < last; ++distance)
+                    {
+                        result->distance_code[distance] = code;
+                    }
+                }
+
+                return result;
+            }();
+
+            return *tables;
+        }
+
+        // Computes code lengths no longer than `max_bits` for a Huffman code over `freqs`.
+        void build_code_lengths(const uint32_t* freqs, size_t count, int max_bits, uint8_t* lengths)
+        {
+            std::fill(lengths, lengths + count, uint8_t(0));
+            std::vector<size_t> used;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (freqs[i] != 0) used.push_back(i);
+            }
+
+            if (used.empty()) return;
+            if (used.size() == 1)
+            {
+                lengths[used[0]] = 1;
+                return;
+            }
+
+            std::sort(used.begin(), used.end(), [&](size_t lhs, size_t rhs) {
+                return freqs[lhs] < freqs[rhs] || (freqs[lhs] == freqs[rhs] && lhs < rhs);
+            });
+
+            // Two-queue Huffman construction: leaves are [0, leaves), internal nodes are created in weight order.
+            const size_t leaves = used.size();
+            const size_t nodes = 2 * leaves - 1;
+            std::vector<uint64_t> weight(nodes);
+            std::vector<size_t> parent(nodes, 0);
+            for (size_t i = 0; i < leaves; ++i)
+            {
+                weight[i] = freqs[used[i]];
+            }
+
+            size_t next_leaf = 0;
+            size_t next_node = leaves;
+            for (size_t created = leaves; created < nodes; ++created)
+            {
+                auto take = [&]() {
+                    if (next_leaf < leaves && (next_node >= created || weight[next_leaf] <= weight[next_node]))
+                        return next_leaf++;
+                    return next_node++;
+                };
+                const size_t first = take();
+                const size_t second = take();
+                weight[created] = weight[first] + weight[second];
+                parent[first] = created;
+                parent[second] = created;
+            }
+
+            std::vector<size_t> depth(nodes, 0);
+            size_t max_depth = 0;
+            for (size_t i = nodes - 1; i-- > 0;)
+            {
+                depth[i] = depth[parent[i]] + 1;
+                max_depth = std::max(max_depth, depth[i]);
+            }
+
+            std::vector<size_t> bl_count(max_depth + 1, 0);
+            for (size_t i = 0; i < leaves; ++i)
+            {
+                ++bl_count[depth[i]];
+            }
+
+            // Limit the code length as described in the JPEG specification, Annex K.3.
+            for (size_t bits = max_depth; bits > static_cast<size_t>(max_bits); --bits)
+            {
+                while (bl_count[bits] > 0)
+                {
+                    size_t shorter = bits - 2;
+                    while (bl_count[shorter] == 0)
+                        --shorter;
+                    bl_count[bits] -= 2;
+                    bl_count[bits - 1] += 1;
+                    bl_count[shorter + 1] += 2;
+                    bl_count[shorter] -= 1;
+                }
+            }
+
+            // The most frequent symbols get the shortest codes.
+            size_t remaining = leaves;
+            for (size_t bits = 1; bits < bl_count.size(); ++bits)
+            {
+                for (size_t k = 0; k < bl_count[bits]; ++k)
+                {
+                    lengths[used[--remaining]] = static_cast<uint8_t>(bits);
+                }
+            }
+        }
+
+        // Ensures at least two codes exist, which some decoders require even if fewer symbols occur.
+        void ensure_two_codes(uint32_t* freqs, size_t count)
+        {
+            size_t nonzero = std::count_if(freqs, freqs + count, [](uint32_t f) { return f != 0; });
+            for (size_t i = 0; nonzero < 2 && i < count; ++i)
+            {
+                if (freqs[i] == 0)
+                {
+                    freqs[i] = 1;
+                    ++nonzero;
+                }
+            }
+        }
+
+        void write_stored_blocks(BitWriter& writer, StringView raw, bool last)
+        {
+            size_t offset = 0;
+            do
+            {
+                const size_t chunk = std::min<size_t>(raw.size() - offset, 65535);
+                const bool final_chunk = offset + chunk == raw.size();
+                writer.put(last && final_chunk ? 1 : 0, 1);
+                writer.put(0, 2);
+                writer.align();
+                writer.put(static_cast<uint32_t>(chunk), 16);
+                writer.put(static_cast<uint32_t>(~chunk & 0xFFFF), 16);
+                writer.out.append(raw.data() + offset, chunk);
+                offset += chunk;
+            } while (offset < raw.size());
+        }
+
+        void write_block(BitWriter& writer, const std::vector<LzSymbol>& symbols, StringView raw, bool last)
+        {
+            const auto& code_tables = get_symbol_code_tables();
+            uint32_t literal_freqs[LITERAL_LENGTH_CODES] = {};
+            uint32_t distance_freqs[DISTANCE_CODES] = {};
+            uint64_t extra_bits = 0;
+            for (auto&& symbol : symbols)
+            {
+                if (symbol.distance == 0)
+                {
+                    ++literal_freqs[symbol.literal_or_length];
+                }
+                else
+                {
+                    const uint8_t length_code = code_tables.length_code[symbol.literal_or_length];
+                    const uint8_t distance_code = code_tables.distance_code[symbol.distance];
+                    ++literal_freqs[257 + length_code];
+                    ++distance_freqs[distance_code];
+                    extra_bits += LENGTH_EXTRA[length_code] + DISTANCE_EXTRA[distance_code];
+                }
+            }
+
+            literal_freqs[END_OF_BLOCK] = 1;
+
+            // fixed Huffman block size
+            uint64_t fixed_bits = 3 + extra_bits;
+            for (size_t i = 0; i < LITERAL_LENGTH_CODES; ++i)
+            {
+                fixed_bits += uint64_t(literal_freqs[i]) * (i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+            }
+
+            for (size_t i = 0; i < DISTANCE_CODES; ++i)
+            {
+                fixed_bits += uint64_t(distance_freqs[i]) * 5;
+            }
+
+            // dynamic Huffman block size
+            ensure_two_codes(literal_freqs, LITERAL_LENGTH_CODES);
+            ensure_two_codes(distance_freqs, DISTANCE_CODES);
+            uint8_t lengths[LITERAL_LENGTH_CODES + DISTANCE_CODES];
+            build_code_lengths(literal_freqs, LITERAL_LENGTH_CODES, MAX_CODE_BITS, lengths);
+            size_t hlit = LITERAL_LENGTH_CODES;
+            while (hlit > 257 && lengths[hlit - 1] == 0)
+                --hlit;
+            uint8_t* const distance_lengths = lengths + hlit;
+            build_code_lengths(distance_freqs, DISTANCE_CODES, MAX_CODE_BITS, distance_lengths);
+            size_t hdist = DISTANCE_CODES;
+            while (hdist > 1 && distance_lengths[hdist - 1] == 0)
+                --hdist;
+
+            // run-length encode the code lengths: (symbol, extra bits value)
+            std::vector<std::pair<uint8_t, uint8_t>> rle;
+            const size_t total_lengths = hlit + hdist;
+            for (size_t i = 0; i < total_lengths;)
+            {
+                const uint8_t value = lengths[i];
+                size_t run = 1;
+                while (i + run < total_lengths && lengths[i + run] == value)
+                    ++run;
+                i += run;
+                if (value == 0)
+                {
+                    while (run >= 11)
+                    {
+                        const size_t n = std::min<size_t>(run, 138);
+                        rle.emplace_back(uint8_t(18), static_cast<uint8_t>(n - 11));
+                        run -= n;
+                    }
+
+                    if (run >= 3)
+                    {
+                        rle.emplace_back(uint8_t(17), static_cast<uint8_t>(run - 3));
+                        run = 0;
+                    }
+                }
+                else
+                {
+                    rle.emplace_back(value, uint8_t(0));
+                    --run;
+                    while (run >= 3)
+                    {
+                        const size_t n = std::min<size_t>(run, 6);
+                        rle.emplace_back(uint8_t(16), static_cast<uint8_t>(n - 3));
+                        run -= n;
+                    }
+                }
+
+                for (; run > 0; --run)
+                {
+                    rle.emplace_back(value, uint8_t(0));
+                }
+            }
+
+            uint32_t code_length_freqs[CODE_LENGTH_CODES] = {};
+            for (auto&& entry : rle)
+            {
+                ++code_length_freqs[entry.first];
+            }
+
+            uint8_t code_length_lengths[CODE_LENGTH_CODES];
+            build_code_lengths(code_length_freqs, CODE_LENGTH_CODES, MAX_CODE_LENGTH_BITS, code_length_lengths);
+            size_t hclen = CODE_LENGTH_CODES;
+            while (hclen > 4 && code_length_lengths[CODE_LENGTH_ORDER[hclen - 1]] == 0)
+                --hclen;
+
+            uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * hclen + extra_bits;
+            for (auto&& entry : rle)
+            {
+                dynamic_bits += code_length_lengths[entry.first];
+                dynamic_bits += entry.first == 16 ? 2 : entry.first == 17 ? 3 : entry.first == 18 ? 7 : 0;
+            }
+
+            for (size_t i = 0; i < hlit; ++i)
+            {
+                dynamic_bits += uint64_t(literal_freqs[i]) * lengths[i];
+            }
+
+            for (size_t i = 0; i < hdist; ++i)
+            {
+                dynamic_bits += uint64_t(distance_freqs[i]) * distance_lengths[i];
+            }
+
+            const uint64_t stored_bits = (raw.size() + 5 * (raw.size() / 65535 + 1)) * 8 + 7;
+            if (stored_bits <= fixed_bits && stored_bits <= dynamic_bits)
+            {
+                write_stored_blocks(writer, raw, last);
+                return;
+            }
+
+            uint16_t literal_codes[288];
+            uint16_t distance_codes[32];
+            uint8_t literal_code_lengths[288];
+            uint8_t distance_code_lengths[32];
+            writer.put(last ? 1 : 0, 1);
+            if (fixed_bits <= dynamic_bits)
+            {
+                writer.put(1, 2);
+                std::fill(literal_code_lengths, literal_code_lengths + 144, uint8_t(8));
+                std::fill(literal_code_lengths + 144, literal_code_lengths + 256, uint8_t(9));
+                std::fill(literal_code_lengths + 256, literal_code_lengths + 280, uint8_t(7));
+                std::fill(literal_code_lengths + 280, literal_code_lengths + 288, uint8_t(8));
+                std::fill(distance_code_lengths, distance_code_lengths + 32, uint8_t(5));
+                build_codes(literal_code_lengths, 288, literal_codes);
+                build_codes(distance_code_lengths, 32, distance_codes);
+            }
+            else
+            {
+                writer.put(2, 2);
+                writer.put(static_cast<uint32_t>(hlit - 257), 5);
+                writer.put(static_cast<uint32_t>(hdist - 1), 5);
+                writer.put(static_cast<uint32_t>(hclen - 4), 4);
+                for (size_t i = 0; i < hclen; ++i)
+                {
+                    writer.put(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+                }
+
+                uint16_t code_length_codes[CODE_LENGTH_CODES];
+                build_codes(code_length_lengths, CODE_LENGTH_CODES, code_length_codes);
+                for (auto&& entry : rle)
+                {
+                    writer.put(code_length_codes[entry.first], code_length_lengths[entry.first]);
+                    if (entry.first == 16)
+                        writer.put(entry.second, 2);
+                    else if (entry.first == 17)
+                        writer.put(entry.second, 3);
+                    else if (entry.first == 18)
+                        writer.put(entry.second, 7);
+                }
+
+                std::fill(literal_code_lengths, literal_code_lengths + 288, uint8_t(0));
+                std::fill(distance_code_lengths, distance_code_lengths + 32, uint8_t(0));
+                std::copy(lengths, lengths + hlit, literal_code_lengths);
+                std::copy(distance_lengths, distance_lengths + hdist, distance_code_lengths);
+                build_codes(literal_code_lengths, 288, literal_codes);
+                build_codes(distance_code_lengths, 32, distance_codes);
+            }
+
+            for (auto&& symbol : symbols)
+            {
+                if (symbol.distance == 0)
+                {
+                    writer.put(literal_codes[symbol.literal_or_length], literal_code_lengths[symbol.literal_or_length]);
+                    continue;
+                }
+
+                const uint8_t length_code = code_tables.length_code[symbol.literal_or_length];
+                writer.put(literal_codes[257 + length_code], literal_code_lengths[257 + length_code]);
+                writer.put(symbol.literal_or_length - LENGTH_BASE[length_code], LENGTH_EXTRA[length_code]);
+                const uint8_t distance_code = code_tables.distance_code[symbol.distance];
+                writer.put(distance_codes[distance_code], distance_code_lengths[distance_code]);
+                writer.put(symbol.distance - DISTANCE_BASE[distance_code], DISTANCE_EXTRA[distance_code]);
+            }
+
+            writer.put(literal_codes[END_OF_BLOCK], literal_code_lengths[END_OF_BLOCK]);
+        }
+
+        // Compresses a stream into raw DEFLATE, handing the output to a sink in pieces. Input is kept in a buffer of
+        // bounded size, which slides forward once full, so positions in the hash chains never grow past its size.
+        struct Deflater
+        {
+            explicit Deflater(std::function<void(StringView)> sink)
+                : sink(std::move(sink))
+                , writer(out)
+                , window(BUFFER_SIZE)
+                , head(size_t(1) << HASH_BITS, -1)
+                , prev(WINDOW_SIZE, -1)
+            {
+                symbols.reserve(BLOCK_SYMBOLS);
+            }
+
+            Deflater(const Deflater&) = delete;
+            Deflater& operator=(const Deflater&) = delete;
+
+            void write(StringView data)
+            {
+                const char* first = data.data();
+                size_t remaining = data.size();
+                while (remaining != 0)
+                {
+                    if (size == BUFFER_SIZE) slide();
+                    const size_t count = std::min(remaining, BUFFER_SIZE - size);
+                    std::copy(first, first + count, window.begin() + size);
+                    size += count;
+                    first += count;
+                    remaining -= count;
+                    compress(false);
+                }
+            }
+
+            void finish()
+            {
+                compress(true);
+                flush_block(true);
+                writer.align();
+                drain();
+            }
+
+        private:
+            static constexpr size_t WINDOW_SIZE = 32768;
+            static constexpr size_t WINDOW_MASK = WINDOW_SIZE - 1;
+            static constexpr size_t BUFFER_SIZE = 8 * WINDOW_SIZE;
+            static constexpr int HASH_BITS = 15;
+            static constexpr size_t MIN_MATCH = 3;
+            static constexpr size_t MAX_MATCH = 258;
+            // a match at the next position is looked for before taking one, so that much input must be available
+            static constexpr size_t LOOKAHEAD = MAX_MATCH + 1;
+            static constexpr int MAX_CHAIN = 64;
+            // matches at least this long are taken without looking for a longer one at the next position
+            static constexpr size_t LAZY_LIMIT = 32;
+            // short matches far away cost more bits than the literals they replace
+            static constexpr size_t TOO_FAR = 4096;
+            static constexpr size_t BLOCK_SYMBOLS = 1 << 15;
+
+            uint32_t hash_at(size_t pos) const
+            {
+                const uint32_t value =
+                    window[pos] | (uint32_t(window[pos + 1]) << 8) | (uint32_t(window[pos + 2]) << 16);
+                return (value * 2654435761u) >> (32 - HASH_BITS);
+            }
+
+            // inserts every position before `pos` which can start a match into the hash chains
+            void insert_until(size_t pos)
+            {
+                const size_t limit = std::min(pos, size >= MIN_MATCH ? size - MIN_MATCH + 1 : 0);
+                for (; inserted < limit; ++inserted)
+                {
+                    const auto hash = hash_at(inserted);
+                    prev[inserted & WINDOW_MASK] = head[hash];
+                    head[hash] = static_cast<int32_t>(inserted);
+                }
+
+                inserted = std::max(inserted, pos);
+            }
+
+            size_t longest_match(size_t pos, size_t& best_distance)
+            {
+                if (pos + MIN_MATCH > size) return 0;
+                insert_until(pos);
+                const size_t max_length = std::min(MAX_MATCH, size - pos);
+                const unsigned char* const current = window.data() + pos;
+                size_t best_length = 0;
+                int32_t candidate = head[hash_at(pos)];
+                for (int chain = MAX_CHAIN; candidate >= 0 && pos - size_t(candidate) <= WINDOW_SIZE && chain > 0;
+                     --chain)
+                {
+                    const unsigned char* const previous = window.data() + candidate;
+                    if (previous[best_length] == current[best_length])
+                    {
+                        size_t length = 0;
+                        while (length < max_length && previous[length] == current[length])
+                            ++length;
+                        if (length > best_length)
+                        {
+                            best_length = length;
+                            best_distance = pos - size_t(candidate);
+                            if (length == max_length) break;
+                        }
+                    }
+
+                    candidate = prev[candidate & WINDOW_MASK];
+                }
+
+                if (best_length < MIN_MATCH || (best_length == MIN_MATCH && best_distance > TOO_FAR)) return 0;
+                return best_length;
+            }
+
+            void compress(bool final)
+            {
+                while (pos < size && (final || size - pos >= LOOKAHEAD))
+                {
+                    size_t distance = 0;
+                    size_t length = longest_match(pos, distance);
+                    if (length != 0 && length < LAZY_LIMIT)
+                    {
+                        size_t next_distance = 0;
+                        const size_t next_length = longest_match(pos + 1, next_distance);
+                        if (next_length > length)
+                        {
+                            symbols.push_back({window[pos], 0});
+                            ++pos;
+                            length = next_length;
+                            distance = next_distance;
+                        }
+                    }
+
+                    if (length != 0)
+                    {
+                        symbols.push_back({static_cast<uint16_t>(length), static_cast<uint16_t>(distance)});
+                        pos += length;
+                    }
+                    else
+                    {
+                        symbols.push_back({window[pos], 0});
+                        ++pos;
+                    }
+
+                    if (symbols.size() >= BLOCK_SYMBOLS) flush_block(false);
+                }
+            }
+
+            void flush_block(bool last)
+            {
+                const auto raw = reinterpret_cast<const char*>(window.data());
+                write_block(writer, symbols, StringView{raw + block_start, raw + pos}, last);
+                symbols.clear();
+                block_start = pos;
+                drain();
+            }
+
+            void drain()
+            {
+                if (out.empty()) return;
+                sink(out);
+                out.clear();
+            }
+
+            // Discards input that matches can no longer refer to. The shift is a multiple of the window size, so
+            // that positions keep their slots in `prev`.
+            void slide()
+            {
+                if (pos != block_start) flush_block(false);
+                const size_t shift = (pos - WINDOW_SIZE) & ~WINDOW_MASK;
+                std::copy(window.begin() + shift, window.begin() + size, window.begin());
+                size -= shift;
+                pos -= shift;
+                block_start = pos;
+                inserted = std::max(inserted, shift) - shift;
+                const auto rebase = [shift](int32_t& position) {
+                    position = position >= static_cast<int32_t>(shift) ? position - static_cast<int32_t>(shift) : -1;
+                };
+
+                std::for_each(head.begin(), head.end(), rebase);
+                std::for_each(prev.begin(), prev.end(), rebase);
+            }
+
+            std::function<void(StringView)> sink;
+            std::string out;
+            BitWriter writer;
+            std::vector<unsigned char> window;
+            std::vector<int32_t> head;
+            std::vector<int32_t> prev;
+            std::vector<LzSymbol> symbols;
+            size_t size = 0;
+            size_t pos = 0;
+            size_t block_start = 0;
+            size_t inserted = 0;
+        };
+
+        // ===== Zip container =====
+
+        constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+        constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+        constexpr uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+        constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+        constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+        constexpr uint16_t ZIP64_EXTRA_ID = 0x0001;
+        constexpr uint16_t METHOD_STORE = 0;
+        constexpr uint16_t METHOD_DEFLATE = 8;
+        constexpr uint16_t FLAG_UTF8 = 0x0800;
+        // Unix host, specification version 3.0, as written by Info-ZIP
+        constexpr uint16_t VERSION_MADE_BY = 0x031E;
+        constexpr uint16_t HOST_UNIX = 3;
+        // 1980-01-01 00:00:00, the earliest representable time
+        constexpr uint16_t DOS_TIME = 0;
+        constexpr uint16_t DOS_DATE = 0x0021;
+        constexpr uint32_t UNIX_TYPE_MASK = 0170000;
+        constexpr uint32_t UNIX_DIRECTORY = 0040000;
+        constexpr uint32_t UNIX_REGULAR = 0100000;
+        constexpr uint32_t UNIX_SYMLINK = 0120000;
+        constexpr uint32_t DOS_DIRECTORY_ATTRIBUTE = 0x10;
+        constexpr uint32_t SATURATED_32 = 0xFFFFFFFF;
+        constexpr size_t ENTRIES_PER_BATCH = 128;
+        // files and entries larger than this are streamed instead of being held in memory
+        constexpr uint64_t IN_MEMORY_LIMIT = 1 << 20;
+
+        void put_u16(std::string& out, uint16_t value)
+        {
+            out.push_back(static_cast<char>(value & 0xFF));
+            out.push_back(static_cast<char>(value >> 8));
+        }
+
+        void put_u32(std::string& out, uint32_t value)
+        {
+            put_u16(out, static_cast<uint16_t>(value & 0xFFFF));
+            put_u16(out, static_cast<uint16_t>(value >> 16));
+        }
+
+        void put_u64(std::string& out, uint64_t value)
+        {
+            put_u32(out, static_cast<uint32_t>(value & 0xFFFFFFFF));
+            put_u32(out, static_cast<uint32_t>(value >> 32));
+        }
+
+        uint32_t saturate_32(uint64_t value) { return value >= SATURATED_32 ? SATURATED_32 : uint32_t(value); }
+
+        enum class EntryKind
+        {
+            File,
+            Directory,
+            Symlink,
+        };
+
+        struct WriteEntry
+        {
+            std::string name;
+            EntryKind kind = EntryKind::File;
+            uint32_t mode = 0;
+            uint16_t method = METHOD_STORE;
+            uint32_t crc = 0;
+            uint64_t uncompressed_size = 0;
+            uint64_t compressed_size = 0;
+            uint64_t local_header_offset = 0;
+            std::string data;
+            // for large files, the file holding the data instead of `data`; removed after writing if `is_temporary`
+            fs::path data_file;
+            bool is_temporary = false;
+            std::string error;
+
+            bool needs_zip64() const
+            {
+                return uncompressed_size >= SATURATED_32 || compressed_size >= SATURATED_32 ||
+                       local_header_offset >= SATURATED_32;
+            }
+
+            uint32_t external_attributes() const
+            {
+                switch (kind)
+                {
+                    case EntryKind::Directory: return ((UNIX_DIRECTORY | mode) << 16) | DOS_DIRECTORY_ATTRIBUTE;
+                    case EntryKind::Symlink: return (UNIX_SYMLINK | mode) << 16;
+                    case EntryKind::File: return (UNIX_REGULAR | mode) << 16;
+                    default: Checks::unreachable(VCPKG_LINE_INFO);
+                }
+            }
+        };
+
+        bool is_already_compressed(StringView name)
+        {
+            static constexpr StringLiteral extensions[] = {
+                ".zip", ".gz",   ".tgz",  ".bz2", ".xz",   ".7z",   ".zst",  ".lz4",   ".jar", ".nupkg",
+                ".png", ".jpg", ".jpeg", ".gif", ".webp", ".mp3", ".mp4", ".woff2", ".br",
+            };
+
+            const auto lowercase = Strings::ascii_to_lowercase(name.to_string());
+            for (auto&& extension : extensions)
+            {
+                if (Strings::ends_with(lowercase, extension)) return true;
+            }
+
+            return false;
+        }
+
+        // Reads a large file in pieces, deflating it into `temporary` unless that does not make it smaller.
+        void prepare_streamed_entry(const fs::path& path, const fs::path& temporary, WriteEntry& entry)
+        {
+            std::ifstream in(path.native().c_str(), std::ios::in | std::ios::binary);
+            if (!in)
+            {
+                entry.error = Strings::concat("could not open ", fs::u8string(path), " for reading");
+                return;
+            }
+
+            const bool try_deflate = !is_already_compressed(entry.name);
+            std::ofstream out;
+            if (try_deflate)
+            {
+                out.open(temporary.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!out)
+                {
+                    entry.error = Strings::concat("could not open ", fs::u8string(temporary), " for writing");
+                    return;
+                }
+
+                entry.data_file = temporary;
+                entry.is_temporary = true;
+            }
+
+            Deflater deflater([&](StringView piece) {
+                out.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+                entry.compressed_size += piece.size();
+            });
+
+            std::string chunk(static_cast<size_t>(IN_MEMORY_LIMIT), '\0');
+            for (;;)
+            {
+                in.read(&chunk[0], static_cast<std::streamsize>(chunk.size()));
+                const auto count = static_cast<size_t>(in.gcount());
+                if (count == 0) break;
+                const StringView piece{chunk.data(), count};
+                entry.crc = crc32(piece, entry.crc);
+                entry.uncompressed_size += count;
+                if (try_deflate) deflater.write(piece);
+            }
+
+            if (in.bad())
+            {
+                entry.error = Strings::concat("could not read ", fs::u8string(path));
+                return;
+            }
+
+            if (try_deflate)
+            {
+                deflater.finish();
+                out.close();
+                if (!out)
+                {
+                    entry.error = Strings::concat("could not write ", fs::u8string(temporary));
+                    return;
+                }
+            }
+
+            if (try_deflate && entry.compressed_size < entry.uncompressed_size)
+            {
+                entry.method = METHOD_DEFLATE;
+                return;
+            }
+
+            // stored entries are copied straight from the file when the archive is written
+            if (entry.is_temporary)
+            {
+                std::error_code ec;
+                fs::stdfs::remove(temporary, ec);
+            }
+
+            entry.data_file = path;
+            entry.is_temporary = false;
+            entry.compressed_size = entry.uncompressed_size;
+        }
+
+        void prepare_entry(const Files::Filesystem& fs,
+                           const fs::path& path,
+                           const fs::path& temporary,
+                           WriteEntry& entry)
+        {
+            std::error_code ec;
+            const auto status = fs.symlink_status(path, ec);
+            if (ec)
+            {
+                entry.error = Strings::concat(fs::u8string(path), ": ", ec.message());
+                return;
+            }
+
+            entry.mode = static_cast<uint32_t>(status.permissions()) & 0777;
+            std::string payload;
+            if (fs::is_directory(status))
+            {
+                entry.kind = EntryKind::Directory;
+                entry.name.push_back('/');
+            }
+            else if (fs::is_symlink(status))
+            {
+                entry.kind = EntryKind::Symlink;
+                entry.mode = 0777;
+                payload = fs::generic_u8string(fs::stdfs::read_symlink(path, ec));
+                if (ec)
+                {
+                    entry.error = Strings::concat(fs::u8string(path), ": ", ec.message());
+                    return;
+                }
+            }
+            else if (fs::is_regular_file(status))
+            {
+                const auto size = fs::stdfs::file_size(path, ec);
+                if (!ec && size > IN_MEMORY_LIMIT)
+                {
+                    prepare_streamed_entry(path, temporary, entry);
+                    return;
+                }
+
+                auto maybe_contents = fs.read_contents(path);
+                if (auto contents = maybe_contents.get())
+                {
+                    payload = std::move(*contents);
+                }
+                else
+                {
+                    entry.error = Strings::concat(fs::u8string(path), ": ", maybe_contents.error().message());
+                    return;
+                }
+            }
+            else
+            {
+                entry.error = Strings::concat(fs::u8string(path), ": cannot archive this type of file");
+                return;
+            }
+
+            entry.crc = crc32(payload);
+            entry.uncompressed_size = payload.size();
+            if (entry.kind == EntryKind::File && !payload.empty() && !is_already_compressed(entry.name))
+            {
+                auto deflated = deflate(payload);
+                if (deflated.size() < payload.size())
+                {
+                    entry.method = METHOD_DEFLATE;
+                    entry.data = std::move(deflated);
+                }
+            }
+
+            if (entry.method == METHOD_STORE)
+            {
+                entry.data = std::move(payload);
+            }
+
+            entry.compressed_size = entry.data.size();
+        }
+
+        // Appends the data of `entry` to `out`, copying it from its data file in pieces if it has one.
+        bool write_entry_data(std::ofstream& out, WriteEntry& entry)
+        {
+            if (entry.data_file.empty())
+            {
+                out.write(entry.data.data(), static_cast<std::streamsize>(entry.data.size()));
+                std::string().swap(entry.data);
+                return static_cast<bool>(out);
+            }
+
+            std::ifstream in(entry.data_file.native().c_str(), std::ios::in | std::ios::binary);
+            std::string chunk(static_cast<size_t>(IN_MEMORY_LIMIT), '\0');
+            uint64_t remaining = entry.compressed_size;
+            while (in && remaining != 0)
+            {
+                in.read(&chunk[0], static_cast<std::streamsize>(std::min(remaining, IN_MEMORY_LIMIT)));
+                const auto count = static_cast<uint64_t>(in.gcount());
+                out.write(chunk.data(), static_cast<std::streamsize>(count));
+                remaining -= count;
+            }
+
+            if (entry.is_temporary)
+            {
+                in.close();
+                std::error_code ec;
+                fs::stdfs::remove(entry.data_file, ec);
+                entry.is_temporary = false;
+            }
+
+            if (remaining != 0)
+            {
+                entry.error = Strings::concat("could not read ", fs::u8string(entry.data_file));
+                return false;
+            }
+
+            return static_cast<bool>(out);
+        }
+
+        void remove_temporaries(std::vector<WriteEntry>& entries)
+        {
+            for (auto&& entry : entries)
+            {
+                if (entry.is_temporary)
+                {
+                    std::error_code ec;
+                    fs::stdfs::remove(entry.data_file, ec);
+                }
+            }
+        }
+
+        std::string local_header(const WriteEntry& entry)
+        {
+            const bool zip64 = entry.uncompressed_size >= SATURATED_32 || entry.compressed_size >= SATURATED_32;
+            std::string header;
+            put_u32(header, LOCAL_HEADER_SIGNATURE);
+            put_u16(header, zip64 ? 45 : 20);
+            put_u16(header, FLAG_UTF8);
+            put_u16(header, entry.method);
+            put_u16(header, DOS_TIME);
+            put_u16(header, DOS_DATE);
+            put_u32(header, entry.crc);
+            put_u32(header, zip64 ? SATURATED_32 : uint32_t(entry.compressed_size));
+            put_u32(header, zip64 ? SATURATED_32 : uint32_t(entry.uncompressed_size));
+            put_u16(header, static_cast<uint16_t>(entry.name.size()));
+            put_u16(header, zip64 ? 20 : 0);
+            header.append(entry.name);
+            if (zip64)
+            {
+                put_u16(header, ZIP64_EXTRA_ID);
+                put_u16(header, 16);
+                put_u64(header, entry.uncompressed_size);
+                put_u64(header, entry.compressed_size);
+            }
+
+            return header;
+        }
+
+        void append_central_header(std::string& out, const WriteEntry& entry)
+        {
+            std::string extra;
+            if (entry.uncompressed_size >= SATURATED_32) put_u64(extra, entry.uncompressed_size);
+            if (entry.compressed_size >= SATURATED_32) put_u64(extra, entry.compressed_size);
+            if (entry.local_header_offset >= SATURATED_32) put_u64(extra, entry.local_header_offset);
+
+            put_u32(out, CENTRAL_HEADER_SIGNATURE);
+            put_u16(out, VERSION_MADE_BY);
+            put_u16(out, entry.needs_zip64() ? 45 : 20);
+            put_u16(out, FLAG_UTF8);
+            put_u16(out, entry.method);
+            put_u16(out, DOS_TIME);
+            put_u16(out, DOS_DATE);
+            put_u32(out, entry.crc);
+            put_u32(out, saturate_32(entry.compressed_size));
+            put_u32(out, saturate_32(entry.uncompressed_size));
+            put_u16(out, static_cast<uint16_t>(entry.name.size()));
+            put_u16(out, static_cast<uint16_t>(extra.empty() ? 0 : extra.size() + 4));
+            put_u16(out, 0); // comment length
+            put_u16(out, 0); // disk number
+            put_u16(out, 0); // internal attributes
+            put_u32(out, entry.external_attributes());
+            put_u32(out, saturate_32(entry.local_header_offset));
+            out.append(entry.name);
+            if (!extra.empty())
+            {
+                put_u16(out, ZIP64_EXTRA_ID);
+                put_u16(out, static_cast<uint16_t>(extra.size()));
+                out.append(extra);
+            }
+        }
+
+        void append_end_of_central_directory(std::string& out,
+                                             uint64_t entry_count,
+                                             uint64_t central_directory_offset,
+                                             uint64_t central_directory_size)
+        {
+            const uint64_t end_offset = central_directory_offset + central_directory_size;
+            const bool zip64 = entry_count >= 0xFFFF || central_directory_offset >= SATURATED_32 ||
+                               central_directory_size >= SATURATED_32;
+            if (zip64)
+            {
+                put_u32(out, ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+                put_u64(out, 44);
+                put_u16(out, VERSION_MADE_BY);
+                put_u16(out, 45);
+                put_u32(out, 0);
+                put_u32(out, 0);
+                put_u64(out, entry_count);
+                put_u64(out, entry_count);
+                put_u64(out, central_directory_size);
+                put_u64(out, central_directory_offset);
+
+                put_u32(out, ZIP64_LOCATOR_SIGNATURE);
+                put_u32(out, 0);
+                put_u64(out, end_offset);
+                put_u32(out, 1);
+            }
+
+            put_u32(out, END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+            put_u16(out, 0);
+            put_u16(out, 0);
+            put_u16(out, static_cast<uint16_t>(std::min<uint64_t>(entry_count, 0xFFFF)));
+            put_u16(out, static_cast<uint16_t>(std::min<uint64_t>(entry_count, 0xFFFF)));
+            put_u32(out, saturate_32(central_directory_size));
+            put_u32(out, saturate_32(central_directory_offset));
+            put_u16(out, 0);
+        }
+
+        struct ReadEntry
+        {
+            std::string name;
+            EntryKind kind = EntryKind::File;
+            Optional<uint32_t> mode;
+            uint16_t method = METHOD_STORE;
+            uint32_t crc = 0;
+            uint64_t uncompressed_size = 0;
+            uint64_t compressed_size = 0;
+            uint64_t local_header_offset = 0;
+            // the compressed data, for entries which are extracted from memory
+            std::string data;
+            std::string error;
+        };
+
+        // Reads pieces of an archive, which is never held in memory as a whole.
+        struct ArchiveReader
+        {
+            explicit ArchiveReader(const fs::path& path)
+                : stream(path.native().c_str(), std::ios::in | std::ios::binary)
+            {
+                if (stream)
+                {
+                    stream.seekg(0, std::ios::end);
+                    size = static_cast<uint64_t>(stream.tellg());
+                }
+            }
+
+            bool read(uint64_t offset, uint64_t count, std::string& out)
+            {
+                if (!stream || offset > size || count > size - offset) return false;
+                out.resize(static_cast<size_t>(count));
+                stream.seekg(static_cast<std::streamoff>(offset));
+                stream.read(&out[0], static_cast<std::streamsize>(count));
+                return static_cast<bool>(stream);
+            }
+
+            std::ifstream stream;
+            uint64_t size = 0;
+        };
+
+        struct ByteCursor
+        {
+            StringView bytes;
+
+            bool has(uint64_t offset, uint64_t size) const
+            {
+                return offset <= bytes.size() && size <= bytes.size() - offset;
+            }
+
+            uint16_t u16(uint64_t offset) const
+            {
+                auto p = reinterpret_cast<const unsigned char*>(bytes.data() + offset);
+                return static_cast<uint16_t>(p[0] | (p[1] << 8));
+            }
+
+            uint32_t u32(uint64_t offset) const { return u16(offset) | (uint32_t(u16(offset + 2)) << 16); }
+            uint64_t u64(uint64_t offset) const { return u32(offset) | (uint64_t(u32(offset + 4)) << 32); }
+        };
+
+        bool is_safe_entry_name(StringView name)
+        {
+            if (name.size() == 0 || name.data()[0] == '/') return false;
+            for (auto&& component : Strings::split(name, '/'))
+            {
+                if (component == ".." || component.find(':') != std::string::npos) return false;
+            }
+
+            return true;
+        }
+
+        // A link target may only lead to a path within the destination. It also may not pass through another symlink
+        // of the archive, since the target of that link would change where the rest of the path leads.
+        bool is_safe_link_target(StringView link_name, StringView target, const std::set<std::string>& symlinks)
+        {
+            std::string normalized = target.to_string();
+            std::replace(normalized.begin(), normalized.end(), '\\', '/');
+            if (normalized.empty() || normalized[0] == '/') return false;
+
+            // links are resolved relative to the directory containing them
+            std::vector<std::string> resolved = Strings::split(link_name, '/');
+            resolved.pop_back();
+            const auto components = Strings::split(normalized, '/');
+            for (size_t i = 0; i < components.size(); ++i)
+            {
+                const auto& component = components[i];
+                if (component.find(':') != std::string::npos) return false;
+                if (component == ".") continue;
+                if (component == "..")
+                {
+                    if (resolved.empty()) return false;
+                    resolved.pop_back();
+                    continue;
+                }
+
+                resolved.push_back(component);
+                if (i + 1 != components.size() && symlinks.count(Strings::join("/", resolved)) != 0) return false;
+            }
+
+            return true;
+        }
+
+        ExpectedS<std::vector<ReadEntry>> read_central_directory(ArchiveReader& archive)
+        {
+            if (archive.size < 22) return std::string("not a zip archive");
+
+            // the end of central directory record, its comment, and the zip64 locator in front of it
+            std::string tail;
+            const uint64_t tail_size = std::min<uint64_t>(archive.size, 20 + 22 + 0xFFFF);
+            if (!archive.read(archive.size - tail_size, tail_size, tail)) return std::string("could not read archive");
+            const ByteCursor tail_cursor{tail};
+            uint64_t eocd = tail_size - 22;
+            const uint64_t search_limit = eocd > 0xFFFF ? eocd - 0xFFFF : 0;
+            while (tail_cursor.u32(eocd) != END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+            {
+                if (eocd == search_limit) return std::string("could not find the end of the central directory");
+                --eocd;
+            }
+
+            uint64_t entry_count = tail_cursor.u16(eocd + 10);
+            uint64_t central_directory_size = tail_cursor.u32(eocd + 12);
+            uint64_t central_directory_offset = tail_cursor.u32(eocd + 16);
+            if (eocd >= 20 && tail_cursor.u32(eocd - 20) == ZIP64_LOCATOR_SIGNATURE)
+            {
+                std::string zip64_eocd;
+                if (!archive.read(tail_cursor.u64(eocd - 20 + 8), 56, zip64_eocd) ||
+                    ByteCursor{zip64_eocd}.u32(0) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+                {
+                    return std::string("invalid zip64 end of central directory");
+                }
+
+                const ByteCursor cursor{zip64_eocd};
+                entry_count = cursor.u64(32);
+                central_directory_size = cursor.u64(40);
+                central_directory_offset = cursor.u64(48);
+            }
+
+            std::string central_directory;
+            if (!archive.read(central_directory_offset, central_directory_size, central_directory))
+            {
+                return std::string("central directory is out of bounds");
+            }
+
+            const StringView bytes = central_directory;
+            const ByteCursor cursor{bytes};
+            std::vector<ReadEntry> entries;
+            uint64_t position = 0;
+            for (uint64_t i = 0; i < entry_count; ++i)
+            {
+                if (!cursor.has(position, 46) || cursor.u32(position) != CENTRAL_HEADER_SIGNATURE)
+                {
+                    return std::string("invalid central directory header");
+                }
+
+                ReadEntry entry;
+                const uint16_t made_by = cursor.u16(position + 4);
+                const uint16_t flags = cursor.u16(position + 8);
+                entry.method = cursor.u16(position + 10);
+                entry.crc = cursor.u32(position + 16);
+                uint64_t compressed_size = cursor.u32(position + 20);
+                entry.uncompressed_size = cursor.u32(position + 24);
+                const uint16_t name_length = cursor.u16(position + 28);
+                const uint16_t extra_length = cursor.u16(position + 30);
+                const uint16_t comment_length = cursor.u16(position + 32);
+                const uint32_t external_attributes = cursor.u32(position + 38);
+                uint64_t local_header_offset = cursor.u32(position + 42);
+                if (!cursor.has(position + 46, uint64_t(name_length) + extra_length + comment_length))
+                {
+                    return std::string("central directory header is out of bounds");
+                }
+
+                if (flags & 1) return std::string("encrypted entries are not supported");
+
+                entry.name.assign(bytes.data() + position + 46, name_length);
+                std::replace(entry.name.begin(), entry.name.end(), '\\', '/');
+
+                uint64_t extra = position + 46 + name_length;
+                const uint64_t extra_end = extra + extra_length;
+                while (extra + 4 <= extra_end)
+                {
+                    const uint16_t id = cursor.u16(extra);
+                    const uint16_t size = cursor.u16(extra + 2);
+                    uint64_t field = extra + 4;
+                    const uint64_t field_end = field + size;
+                    if (field_end > extra_end) break;
+                    if (id == ZIP64_EXTRA_ID)
+                    {
+                        if (entry.uncompressed_size == SATURATED_32 && field + 8 <= field_end)
+                        {
+                            entry.uncompressed_size = cursor.u64(field);
+                            field += 8;
+                        }
+
+                        if (compressed_size == SATURATED_32 && field + 8 <= field_end)
+                        {
+                            compressed_size = cursor.u64(field);
+                            field += 8;
+                        }
+
+                        if (local_header_offset == SATURATED_32 && field + 8 <= field_end)
+                        {
+                            local_header_offset = cursor.u64(field);
+                        }
+                    }
+
+                    extra = field_end;
+                }
+
+                position = extra_end + comment_length;
+
+                const uint32_t unix_mode = external_attributes >> 16;
+                const uint32_t unix_type = unix_mode & UNIX_TYPE_MASK;
+                const bool from_unix = (made_by >> 8) == HOST_UNIX;
+                if (!entry.name.empty() && entry.name.back() == '/')
+                {
+                    entry.kind = EntryKind::Directory;
+                    entry.name.pop_back();
+                }
+                else if (from_unix && unix_type == UNIX_SYMLINK)
+                {
+                    entry.kind = EntryKind::Symlink;
+                }
+                else if ((from_unix && unix_type == UNIX_DIRECTORY) ||
+                         (!from_unix && (external_attributes & DOS_DIRECTORY_ATTRIBUTE)))
+                {
+                    entry.kind = EntryKind::Directory;
+                }
+
+                if (from_unix && (unix_mode & 0777) != 0)
+                {
+                    entry.mode = unix_mode & 0777;
+                }
+
+                if (!is_safe_entry_name(entry.name))
+                {
+                    if (entry.kind == EntryKind::Directory && entry.name.empty()) continue;
+                    return Strings::concat("refusing to extract entry with unsafe name '", entry.name, "'");
+                }
+
+                entry.compressed_size = compressed_size;
+                entry.local_header_offset = local_header_offset;
+                entries.push_back(std::move(entry));
+            }
+
+            return entries;
+        }
+
+        // Finds where the data of `entry` starts, and reads it into memory unless `streamed`.
+        Optional<std::string> read_entry_data(ArchiveReader& archive,
+                                              ReadEntry& entry,
+                                              uint64_t& data_offset,
+                                              bool streamed)
+        {
+            std::string header;
+            if (!archive.read(entry.local_header_offset, 30, header) ||
+                ByteCursor{header}.u32(0) != LOCAL_HEADER_SIGNATURE)
+            {
+                return Strings::concat("invalid local header for entry '", entry.name, "'");
+            }
+
+            const ByteCursor cursor{header};
+            data_offset = entry.local_header_offset + 30 + cursor.u16(26) + cursor.u16(28);
+            if (data_offset > archive.size || entry.compressed_size > archive.size - data_offset)
+            {
+                return Strings::concat("data for entry '", entry.name, "' is out of bounds");
+            }
+
+            if (!streamed && !archive.read(data_offset, entry.compressed_size, entry.data))
+            {
+                return Strings::concat("could not read entry '", entry.name, "'");
+            }
+
+            return nullopt;
+        }
+
+        bool is_streamed(const ReadEntry& entry)
+        {
+            return entry.kind == EntryKind::File &&
+                   (entry.compressed_size > IN_MEMORY_LIMIT || entry.uncompressed_size > IN_MEMORY_LIMIT);
+        }
+
+        void set_mode(const fs::path& target, const ReadEntry& entry, std::error_code& ec)
+        {
+#if !defined(_WIN32)
+            if (auto mode = entry.mode.get())
+            {
+                fs::stdfs::permissions(target, static_cast<fs::perms>(*mode), ec);
+            }
+#else
+            (void)target;
+            (void)entry;
+            (void)ec;
+#endif
+        }
+
+        void extract_entry(Files::Filesystem& fs,
+                           const fs::path& destination,
+                           const std::set<std::string>& symlinks,
+                           ReadEntry& entry)
+        {
+            std::string inflated;
+            StringView payload = entry.data;
+            if (entry.method == METHOD_DEFLATE)
+            {
+                inflated.reserve(static_cast<size_t>(entry.uncompressed_size));
+                BitReader reader(StringView{entry.data});
+                if (auto error = inflate_stream(reader, entry.uncompressed_size, [&](StringView piece) {
+                        inflated.append(piece.data(), piece.size());
+                    }))
+                {
+                    entry.error = Strings::concat(entry.name, ": ", *error.get());
+                    return;
+                }
+
+                payload = inflated;
+            }
+            else if (entry.method != METHOD_STORE)
+            {
+                entry.error = Strings::format("%s: unsupported compression method %d", entry.name, entry.method);
+                return;
+            }
+
+            if (payload.size() != entry.uncompressed_size || crc32(payload) != entry.crc)
+            {
+                entry.error = Strings::concat(entry.name, ": checksum mismatch");
+                return;
+            }
+
+            const fs::path target = destination / fs::u8path(entry.name);
+            std::error_code ec;
+            if (entry.kind == EntryKind::Symlink)
+            {
+                if (!is_safe_link_target(entry.name, payload, symlinks))
+                {
+                    entry.error = Strings::concat(
+                        entry.name, ": refusing to create a symlink to '", payload, "' outside of the destination");
+                    return;
+                }
+
+                fs.remove(target, ec);
+                fs::stdfs::create_symlink(fs::u8path(payload), target, ec);
+            }
+            else
+            {
+                fs.write_contents(target, payload.to_string(), ec);
+                if (!ec) set_mode(target, entry, ec);
+            }
+
+            if (ec)
+            {
+                entry.error = Strings::concat(fs::u8string(target), ": ", ec.message());
+            }
+
+            std::string().swap(entry.data);
+        }
+
+        // Extracts a large file entry, reading, decompressing and writing it in pieces.
+        void extract_streamed_entry(ArchiveReader& archive,
+                                    uint64_t data_offset,
+                                    const fs::path& destination,
+                                    ReadEntry& entry)
+        {
+            const fs::path target = destination / fs::u8path(entry.name);
+            std::ofstream out(target.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                entry.error = Strings::concat("could not open ", fs::u8string(target), " for writing");
+                return;
+            }
+
+            uint32_t crc = 0;
+            uint64_t written = 0;
+            const auto sink = [&](StringView piece) {
+                crc = crc32(piece, crc);
+                written += piece.size();
+                out.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+            };
+
+            std::string chunk;
+            uint64_t remaining = entry.compressed_size;
+            const auto more = [&]() -> StringView {
+                const uint64_t count = std::min(remaining, IN_MEMORY_LIMIT);
+                if (count == 0 || !archive.read(data_offset, count, chunk)) return {};
+                data_offset += count;
+                remaining -= count;
+                return chunk;
+            };
+
+            if (entry.method == METHOD_DEFLATE)
+            {
+                BitReader reader(more);
+                if (auto error = inflate_stream(reader, entry.uncompressed_size, sink))
+                {
+                    entry.error = Strings::concat(entry.name, ": ", *error.get());
+                    return;
+                }
+            }
+            else if (entry.method == METHOD_STORE)
+            {
+                for (StringView piece = more(); piece.size() != 0; piece = more())
+                {
+                    sink(piece);
+                }
+            }
+            else
+            {
+                entry.error = Strings::format("%s: unsupported compression method %d", entry.name, entry.method);
+                return;
+            }
+
+            out.close();
+            if (!out)
+            {
+                entry.error = Strings::concat("could not write ", fs::u8string(target));
+                return;
+            }
+
+            if (remaining != 0 || written != entry.uncompressed_size || crc != entry.crc)
+            {
+                entry.error = Strings::concat(entry.name, ": checksum mismatch");
+                return;
+            }
+
+            std::error_code ec;
+            set_mode(target, entry, ec);
+            if (ec)
+            {
+                entry.error = Strings::concat(fs::u8string(target), ": ", ec.message());
+            }
+        }
+    }
+
+    uint32_t crc32(StringView data, uint32_t crc) noexcept
+    {
+        const uint32_t* table = get_crc32_table();
+        crc = ~crc;
+        for (unsigned char c : data)
+        {
+            crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+        }
+
+        return ~crc;
+    }
+
+    std::string deflate(StringView data)
+    {
+        std::string result;
+        result.reserve(data.size() / 2 + 64);
+        Deflater deflater([&](StringView piece) { result.append(piece.data(), piece.size()); });
+        deflater.write(data);
+        deflater.finish();
+        return result;
+    }
+
+    ExpectedS<std::string> inflate(StringView data, size_t size_hint)
+    {
+        std::string result;
+        result.reserve(size_hint);
+        BitReader reader(data);
+        if (auto error = inflate_stream(reader, UINT64_MAX, [&](StringView piece) {
+                result.append(piece.data(), piece.size());
+            }))
+        {
+            return {std::move(*error.get()), expected_right_tag};
+        }
+
+        return {std::move(result), expected_left_tag};
+    }
+
+    ExpectedS<size_t> compress_directory(const Files::Filesystem& fs,
+                                         const fs::path& source,
+                                         const fs::path& destination)
+    {
+        auto paths = fs.get_files_recursive(source);
+        const size_t prefix_length = fs::generic_u8string(source).size() + 1;
+        std::vector<std::pair<std::string, fs::path>> named_paths;
+        named_paths.reserve(paths.size());
+        for (auto&& path : paths)
+        {
+            named_paths.emplace_back(fs::generic_u8string(path).substr(prefix_length), std::move(path));
+        }
+
+        Util::sort(named_paths);
+
+        std::ofstream out(destination.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return Strings::concat("could not open ", fs::u8string(destination), " for writing");
+        }
+
+        const auto destination_name = fs::u8string(destination);
+        std::vector<WriteEntry> entries(named_paths.size());
+        uint64_t offset = 0;
+        for (size_t batch_start = 0; batch_start < entries.size(); batch_start += ENTRIES_PER_BATCH)
+        {
+            const size_t batch_size = std::min(ENTRIES_PER_BATCH, entries.size() - batch_start);
+            execute_in_parallel(batch_size, [&](size_t i) {
+                const size_t index = batch_start + i;
+                auto& entry = entries[index];
+                auto& named_path = named_paths[index];
+                entry.name = std::move(named_path.first);
+                const auto temporary = fs::u8path(Strings::concat(destination_name, '.', index, ".part"));
+                prepare_entry(fs, named_path.second, temporary, entry);
+            });
+
+            for (size_t i = batch_start; i < batch_start + batch_size; ++i)
+            {
+                auto& entry = entries[i];
+                if (entry.error.empty())
+                {
+                    entry.local_header_offset = offset;
+                    const auto header = local_header(entry);
+                    out.write(header.data(), header.size());
+                    offset += header.size() + entry.compressed_size;
+                    if (!write_entry_data(out, entry) && entry.error.empty())
+                    {
+                        entry.error = Strings::concat("could not write ", destination_name);
+                    }
+                }
+
+                if (!entry.error.empty())
+                {
+                    remove_temporaries(entries);
+                    return std::move(entry.error);
+                }
+            }
+        }
+
+        std::string central_directory;
+        for (auto&& entry : entries)
+        {
+            append_central_header(central_directory, entry);
+        }
+
+        const uint64_t central_directory_size = central_directory.size();
+        append_end_of_central_directory(central_directory, entries.size(), offset, central_directory_size);
+        out.write(central_directory.data(), central_directory.size());
+        out.close();
+        if (!out)
+        {
+            return Strings::concat("could not write ", destination_name);
+        }
+
+        return entries.size();
+    }
+
+    ExpectedS<size_t> decompress_archive(Files::Filesystem& fs,
+                                         const fs::path& archive,
+                                         const fs::path& destination,
+                                         size_t max_threads)
+    {
+        if (max_threads == 0) max_threads = static_cast<size_t>(std::max(1, System::get_num_logical_cores()));
+
+        ArchiveReader reader(archive);
+        if (!reader.stream)
+        {
+            return Strings::concat("could not open ", fs::u8string(archive), " for reading");
+        }
+
+        auto maybe_entries = read_central_directory(reader);
+        auto entries = maybe_entries.get();
+        if (!entries)
+        {
+            return Strings::concat(fs::u8string(archive), ": ", maybe_entries.error());
+        }
+
+        // An entry below a symlink of the archive would be written wherever that link points to.
+        std::set<std::string> symlinks;
+        for (auto&& entry : *entries)
+        {
+            if (entry.kind == EntryKind::Symlink) symlinks.insert(entry.name);
+        }
+
+        for (auto&& entry : *entries)
+        {
+            for (auto slash = entry.name.find('/'); slash != std::string::npos; slash = entry.name.find('/', slash + 1))
+            {
+                if (symlinks.count(entry.name.substr(0, slash)) != 0)
+                {
+                    return Strings::concat(fs::u8string(archive),
+                                           ": refusing to extract entry '",
+                                           entry.name,
+                                           "' through symlink '",
+                                           entry.name.substr(0, slash),
+                                           "'");
+                }
+            }
+        }
+
+        // Create every directory up front so that entries can be written in any order.
+        std::set<std::string> directories;
+        for (auto&& entry : *entries)
+        {
+            if (entry.kind == EntryKind::Directory)
+            {
+                directories.insert(entry.name);
+            }
+            else
+            {
+                const auto slash = entry.name.rfind('/');
+                if (slash != std::string::npos) directories.insert(entry.name.substr(0, slash));
+            }
+        }
+
+        std::error_code ec;
+        fs.create_directories(destination, ec);
+        for (auto&& directory : directories)
+        {
+            fs.create_directories(destination / fs::u8path(directory), ec);
+            if (ec)
+            {
+                return Strings::concat(fs::u8string(destination / fs::u8path(directory)), ": ", ec.message());
+            }
+        }
+
+        // Like Info-ZIP, symlinks are only created once every regular file has been written.
+        std::vector<ReadEntry*> files;
+        std::vector<std::pair<ReadEntry*, uint64_t>> streamed_files;
+        std::vector<ReadEntry*> links;
+        for (auto&& entry : *entries)
+        {
+            if (entry.kind == EntryKind::Directory) continue;
+            uint64_t data_offset = 0;
+            if (auto error = read_entry_data(reader, entry, data_offset, true))
+            {
+                return Strings::concat(fs::u8string(archive), ": ", *error.get());
+            }
+
+            if (entry.kind == EntryKind::Symlink)
+                links.push_back(&entry);
+            else if (is_streamed(entry))
+                streamed_files.emplace_back(&entry, data_offset);
+            else
+                files.push_back(&entry);
+        }
+
+        // Small entries are read a batch at a time and extracted from memory.
+        for (size_t batch_start = 0; batch_start < files.size(); batch_start += ENTRIES_PER_BATCH)
+        {
+            const size_t batch_size = std::min(ENTRIES_PER_BATCH, files.size() - batch_start);
+            uint64_t data_offset = 0;
+            for (size_t i = batch_start; i < batch_start + batch_size; ++i)
+            {
+                if (auto error = read_entry_data(reader, *files[i], data_offset, false))
+                {
+                    return Strings::concat(fs::u8string(archive), ": ", *error.get());
+                }
+            }
+
+            execute_in_parallel(batch_size, max_threads, [&](size_t i) {
+                extract_entry(fs, destination, symlinks, *files[batch_start + i]);
+            });
+
+            for (size_t i = batch_start; i < batch_start + batch_size; ++i)
+            {
+                if (!files[i]->error.empty()) return Strings::concat(fs::u8string(archive), ": ", files[i]->error);
+            }
+        }
+
+        // Large entries are read, decompressed and written in pieces, each through its own stream of the archive.
+        execute_in_parallel(streamed_files.size(), max_threads, [&](size_t i) {
+            ArchiveReader entry_reader(archive);
+            extract_streamed_entry(entry_reader, streamed_files[i].second, destination, *streamed_files[i].first);
+        });
+
+        for (auto&& file : streamed_files)
+        {
+            if (!file.first->error.empty()) return Strings::concat(fs::u8string(archive), ": ", file.first->error);
+        }
+
+        for (auto&& entry : links)
+        {
+            uint64_t data_offset = 0;
+            if (auto error = read_entry_data(reader, *entry, data_offset, false))
+            {
+                return Strings::concat(fs::u8string(archive), ": ", *error.get());
+            }
+
+            extract_entry(fs, destination, symlinks, *entry);
+            if (!entry->error.empty()) return Strings::concat(fs::u8string(archive), ": ", entry->error);
+        }
+
+        return entries->size();
+    }
+}
@@ -6,6 +6,7 @@
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/xmlserializer.h>
+#include <vcpkg/base/zip.h>
 
 #include <vcpkg/binarycaching.h>
 #include <vcpkg/binarycaching.private.h>
@@ -14,6 +15,11 @@
 #include <vcpkg/metrics.h>
 #include <vcpkg/tools.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+
 using namespace vcpkg;
 
 namespace
@@ -52,36 +58,28 @@ namespace
         Checks::check_exit(VCPKG_LINE_INFO, created_last, "unable to clear path: %s", fs::u8string(dir));
     }
 
-    static System::ExitCodeAndOutput decompress_archive(const VcpkgPaths& paths,
-                                                        const fs::path& dst,
-                                                        const fs::path& archive_path)
+    static ExpectedS<size_t> decompress_archive(const VcpkgPaths& paths,
+                                                const fs::path& dst,
+                                                const fs::path& archive_path,
+                                                size_t max_threads)
     {
-        System::CmdLineBuilder cmd;
-#if defined(_WIN32)
-        auto&& seven_zip_exe = paths.get_tool_exe(Tools::SEVEN_ZIP);
-        cmd.path_arg(seven_zip_exe)
-            .string_arg("x")
-            .path_arg(archive_path)
-            .string_arg("-o" + fs::u8string(dst))
-            .string_arg("-y");
-#else
-        (void)paths;
-        cmd.string_arg("unzip").string_arg("-qq").path_arg(archive_path).string_arg("-d" + fs::u8string(dst));
-#endif
-        return System::cmd_execute_and_capture_output(cmd, System::get_clean_environment());
+        return Zip::decompress_archive(paths.get_filesystem(), archive_path, dst, max_threads);
     }
 
-    static System::ExitCodeAndOutput clean_decompress_archive(const VcpkgPaths& paths,
-                                                              const PackageSpec& spec,
-                                                              const fs::path& archive_path)
+    static ExpectedS<size_t> clean_decompress_archive(const VcpkgPaths& paths,
+                                                      const PackageSpec& spec,
+                                                      const fs::path& archive_path,
+                                                      size_t max_threads)
     {
         auto pkg_path = paths.package_dir(spec);
         clean_prepare_dir(paths.get_filesystem(), pkg_path);
-        return decompress_archive(paths, pkg_path, archive_path);
+        return decompress_archive(paths, pkg_path, archive_path, max_threads);
     }
 
     // Compress the source directory into the destination file.
-    static void compress_directory(const VcpkgPaths& paths, const fs::path& source, const fs::path& destination)
+    static ExpectedS<size_t> compress_directory(const VcpkgPaths& paths,
+                                                const fs::path& source,
+                                                const fs::path& destination)
     {
         auto& fs = paths.get_filesystem();
 
@@ -90,19 +88,130 @@ namespace
         fs.remove(destination, ec);
         Checks::check_exit(
             VCPKG_LINE_INFO, !fs.exists(destination), "Could not remove file: %s", fs::u8string(destination));
-#if defined(_WIN32)
-        auto&& seven_zip_exe = paths.get_tool_exe(Tools::SEVEN_ZIP);
-
-        System::cmd_execute_and_capture_output(
-            Strings::format(
-                R"("%s" a "%s" "%s\*")", fs::u8string(seven_zip_exe), fs::u8string(destination), fs::u8string(source)),
-            System::get_clean_environment());
-#else
-        System::cmd_execute_clean(
-            Strings::format(R"(cd '%s' && zip --quiet -y -r '%s' *)", fs::u8string(source), fs::u8string(destination)));
-#endif
+        return Zip::compress_directory(fs, source, destination);
     }
 
+    // Runs restore jobs on worker threads, so that archives are extracted while the caller is still fetching later
+    // ones. Each job writes its messages to its own log, which is printed in one piece when the job is done.
+    struct RestoreQueue
+    {
+        using Job = std::function<bool(std::string& log)>;
+
+        static constexpr int max_workers = 4;
+
+        RestoreQueue()
+        {
+            const auto cores = std::max(1, System::get_num_logical_cores());
+            const auto worker_count = std::min(max_workers, cores);
+            m_threads_per_job = static_cast<size_t>(std::max(1, cores / worker_count));
+            for (int i = 0; i < worker_count; ++i)
+            {
+                m_workers.emplace_back([this]() { work(); });
+            }
+        }
+
+        // Jobs run side by side, so each extracts on its share of the cores.
+        size_t threads_per_job() const { return m_threads_per_job; }
+
+        RestoreQueue(const RestoreQueue&) = delete;
+        RestoreQueue& operator=(const RestoreQueue&) = delete;
+        ~RestoreQueue() { finish(); }
+
+        void push(const PackageSpec& spec, Job job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_jobs.emplace_back(spec, std::move(job));
+            }
+
+            m_jobs_changed.notify_one();
+        }
+
+        // Waits for every job pushed so far and returns the specs which were restored.
+        std::set<PackageSpec> finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done = true;
+            }
+
+            m_jobs_changed.notify_all();
+            for (auto&& worker : m_workers)
+            {
+                worker.join();
+            }
+
+            m_workers.clear();
+            return std::move(m_restored);
+        }
+
+    private:
+        void work()
+        {
+            for (;;)
+            {
+                std::pair<PackageSpec, Job> job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_jobs_changed.wait(lock, [this]() { return m_done || !m_jobs.empty(); });
+                    if (m_jobs.empty()) return;
+                    job = std::move(m_jobs.front());
+                    m_jobs.pop_front();
+                }
+
+                std::string log;
+                const bool restored = job.second(log);
+                if (!log.empty()) System::print2(log);
+                if (restored)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_restored.insert(job.first);
+                }
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_jobs_changed;
+        std::deque<std::pair<PackageSpec, Job>> m_jobs;
+        bool m_done = false;
+        std::set<PackageSpec> m_restored;
+        std::vector<std::thread> m_workers;
+        size_t m_threads_per_job = 1;
+    };
+
+    // The specs a provider restored in prefetch(). Builds running at the same time call try_restore(), so only this set
+    // is locked, rather than every call to the provider.
+    struct RestoredSpecs
+    {
+        void insert(const PackageSpec& spec)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_specs.insert(spec);
+        }
+
+        void insert(const std::set<PackageSpec>& specs)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_specs.insert(specs.begin(), specs.end());
+        }
+
+        bool contains(const PackageSpec& spec) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return Util::Sets::contains(m_specs, spec);
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_specs.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::set<PackageSpec> m_specs;
+    };
+
     struct ArchivesBinaryProvider : IBinaryProvider
     {
         ArchivesBinaryProvider(std::vector<fs::path>&& read_dirs,
@@ -117,45 +226,57 @@ namespace
         void prefetch(const VcpkgPaths& paths, std::vector<const Dependencies::InstallPlanAction*>& actions) override
         {
             auto& fs = paths.get_filesystem();
-            Util::erase_remove_if(actions, [this, &fs, &paths](const Dependencies::InstallPlanAction* action) {
-                auto& spec = action->spec;
-                const auto& abi_tag = action->abi_info.value_or_exit(VCPKG_LINE_INFO).package_abi;
-                const auto archive_name = fs::u8path(abi_tag + ".zip");
-                for (const auto& archives_root_dir : m_read_dirs)
-                {
-                    auto archive_path = archives_root_dir;
-                    archive_path /= fs::u8path(abi_tag.substr(0, 2));
-                    archive_path /= archive_name;
-                    if (fs.exists(archive_path))
+            RestoreQueue queue;
+            const auto threads = queue.threads_per_job();
+            for (auto&& action : actions)
+            {
+                queue.push(action->spec, [this, &fs, &paths, action, threads](std::string& log) {
+                    auto& spec = action->spec;
+                    const auto& abi_tag = action->abi_info.value_or_exit(VCPKG_LINE_INFO).package_abi;
+                    const auto archive_name = fs::u8path(abi_tag + ".zip");
+                    for (const auto& archives_root_dir : m_read_dirs)
                     {
-                        System::print2("Using cached binary package: ", fs::u8string(archive_path), "\n");
+                        auto archive_path = archives_root_dir;
+                        archive_path /= fs::u8path(abi_tag.substr(0, 2));
+                        archive_path /= archive_name;
+                        if (fs.exists(archive_path))
+                        {
+                            Strings::append(log, "Using cached binary package: ", fs::u8string(archive_path), "\n");
 
-                        int archive_result = clean_decompress_archive(paths, spec, archive_path).exit_code;
+                            auto archive_result = clean_decompress_archive(paths, spec, archive_path, threads);
 
-                        if (archive_result == 0)
-                        {
-                            m_restored.insert(spec);
-                            return true;
-                        }
-                        else
-                        {
-                            System::print2("Failed to decompress archive package\n");
-                            if (action->build_options.purge_decompress_failure == Build::PurgeDecompressFailure::YES)
+                            if (archive_result.has_value())
+                            {
+                                return true;
+                            }
+                            else
                             {
-                                System::print2("Purging bad archive\n");
-                                fs.remove(archive_path, ignore_errors);
+                                Strings::append(
+                                    log, "Failed to decompress archive package: ", archive_result.error(), '\n');
+                                if (action->build_options.purge_decompress_failure ==
+                                    Build::PurgeDecompressFailure::YES)
+                                {
+                                    Strings::append(log, "Purging bad archive\n");
+                                    fs.remove(archive_path, ignore_errors);
+                                }
                             }
                         }
+
+                        Strings::append(log, "Could not locate cached archive: ", fs::u8string(archive_path), '\n');
                     }
+                    return false;
+                });
+            }
 
-                    System::printf("Could not locate cached archive: %s\n", fs::u8string(archive_path));
-                }
-                return false;
+            auto restored = queue.finish();
+            m_restored.insert(restored);
+            Util::erase_remove_if(actions, [&restored](const Dependencies::InstallPlanAction* action) {
+                return Util::Sets::contains(restored, action->spec);
             });
         }
         RestoreResult try_restore(const VcpkgPaths&, const Dependencies::InstallPlanAction& action) override
         {
-            if (Util::Sets::contains(m_restored, action.spec))
+            if (m_restored.contains(action.spec))
                 return RestoreResult::success;
             else
                 return RestoreResult::missing;
@@ -167,7 +288,16 @@ namespace
             auto& spec = action.spec;
             auto& fs = paths.get_filesystem();
             const auto tmp_archive_path = paths.buildtrees / spec.name() / (spec.triplet().to_string() + ".zip");
-            compress_directory(paths, paths.package_dir(spec), tmp_archive_path);
+            auto compress_result = compress_directory(paths, paths.package_dir(spec), tmp_archive_path);
+            if (!compress_result.has_value())
+            {
+                System::printf(System::Color::warning,
+                               "Failed to compress %s for the binary cache: %s\n",
+                               spec.to_string(),
+                               compress_result.error());
+                fs.remove(tmp_archive_path, ignore_errors);
+                return;
+            }
 
             size_t http_remotes_pushed = 0;
             for (auto&& put_url_template : m_put_url_templates)
@@ -247,7 +377,7 @@ namespace
         std::vector<fs::path> m_write_dirs;
         std::vector<std::string> m_put_url_templates;
 
-        std::set<PackageSpec> m_restored;
+        RestoredSpecs m_restored;
     };
     struct HttpGetBinaryProvider : NullBinaryProvider
     {
@@ -280,28 +410,41 @@ namespace
 
                 System::print2("Attempting to fetch ", url_paths.size(), " packages from HTTP servers.\n");
 
-                auto codes = Downloads::download_files(fs, url_paths);
-                for (size_t i = 0; i < codes.size(); ++i)
+                // Archives are extracted as soon as their batch has arrived, while the next batch downloads. A batch is
+                // as large as what one curl process fetches.
+                static constexpr size_t batch_size = 50;
+                RestoreQueue queue;
+                const auto threads = queue.threads_per_job();
+                for (size_t first = 0; first < url_paths.size(); first += batch_size)
                 {
-                    if (codes[i] == 200)
+                    const size_t count = std::min(batch_size, url_paths.size() - first);
+                    auto codes = Downloads::download_files(fs, {url_paths.data() + first, count});
+                    for (size_t i = 0; i < codes.size(); ++i)
                     {
-                        int archive_result =
-                            decompress_archive(paths, paths.package_dir(specs[i]), url_paths[i].second).exit_code;
-                        if (archive_result == 0)
-                        {
-                            // decompression success
-                            fs.remove(url_paths[i].second, VCPKG_LINE_INFO);
-                            m_restored.insert(specs[i]);
-                        }
-                        else
-                        {
-                            Debug::print("Failed to decompress ", fs::u8string(url_paths[i].second), '\n');
-                        }
+                        if (codes[i] != 200) continue;
+
+                        const auto& spec = specs[first + i];
+                        const auto& archive_path = url_paths[first + i].second;
+                        queue.push(spec, [&fs, &paths, &spec, &archive_path, threads](std::string&) {
+                            auto archive_result =
+                                decompress_archive(paths, paths.package_dir(spec), archive_path, threads);
+                            if (archive_result.has_value())
+                            {
+                                // decompression success
+                                fs.remove(archive_path, VCPKG_LINE_INFO);
+                                return true;
+                            }
+
+                            Debug::print("Failed to decompress ", archive_result.error(), '\n');
+                            return false;
+                        });
                     }
                 }
 
+                auto restored = queue.finish();
+                m_restored.insert(restored);
                 Util::erase_remove_if(actions, [this](const Dependencies::InstallPlanAction* action) {
-                    return Util::Sets::contains(m_restored, action->spec);
+                    return m_restored.contains(action->spec);
                 });
             }
             System::print2("Restored ",
@@ -310,7 +453,7 @@ namespace
         }
         RestoreResult try_restore(const VcpkgPaths&, const Dependencies::InstallPlanAction& action) override
         {
-            if (Util::Sets::contains(m_restored, action.spec))
+            if (m_restored.contains(action.spec))
                 return RestoreResult::success;
             else
                 return RestoreResult::missing;
@@ -346,7 +489,7 @@ namespace
         }
 
         std::vector<std::string> m_url_templates;
-        std::set<PackageSpec> m_restored;
+        RestoredSpecs m_restored;
     };
 
     static std::string trim_leading_zeroes(std::string v)
@@ -378,7 +521,7 @@ namespace
         {
         }
 
-        int run_nuget_commandline(const std::string& cmdline)
+        int run_nuget_commandline(const System::CmdLineBuilder& cmdline)
         {
             if (m_interactive)
             {
@@ -407,7 +550,9 @@ namespace
             }
             else if (res.output.find("for example \"-ApiKey AzureDevOps\"") != std::string::npos)
             {
-                auto res2 = System::cmd_execute_and_capture_output(cmdline + " -ApiKey AzureDevOps");
+                auto cmdline2 = cmdline;
+                cmdline2.string_arg("-ApiKey").string_arg("AzureDevOps");
+                auto res2 = System::cmd_execute_and_capture_output(cmdline2);
                 if (Debug::g_debugging)
                 {
                     System::print2(res2.output);
@@ -458,7 +603,7 @@ namespace
             };
 
             const auto& nuget_exe = paths.get_tool_exe("nuget");
-            std::vector<std::string> cmdlines;
+            std::vector<System::CmdLineBuilder> cmdlines;
 
             if (!m_read_sources.empty())
             {
@@ -484,7 +629,7 @@ namespace
                     .string_arg("detailed")
                     .string_arg("-ForceEnglishOutput");
                 if (!m_interactive) cmdline.string_arg("-NonInteractive");
-                cmdlines.push_back(cmdline.extract());
+                cmdlines.push_back(std::move(cmdline));
             }
             for (auto&& cfg : m_read_configs)
             {
@@ -510,7 +655,7 @@ namespace
                     .string_arg("detailed")
                     .string_arg("-ForceEnglishOutput");
                 if (!m_interactive) cmdline.string_arg("-NonInteractive");
-                cmdlines.push_back(cmdline.extract());
+                cmdlines.push_back(std::move(cmdline));
             }
 
             const size_t current_restored = m_restored.size();
@@ -533,7 +678,7 @@ namespace
                                            !fs.exists(nupkg_path, ignore_errors),
                                            "Unable to remove nupkg after restoring: %s",
                                            fs::u8string(nupkg_path));
-                        m_restored.emplace(nuget_ref.first);
+                        m_restored.insert(nuget_ref.first);
                         return true;
                     }
                     else
@@ -544,7 +689,7 @@ namespace
             }
 
             Util::erase_remove_if(actions, [this](const Dependencies::InstallPlanAction* action) {
-                return Util::Sets::contains(m_restored, action->spec);
+                return m_restored.contains(action->spec);
             });
 
             System::print2("Restored ",
@@ -553,7 +698,7 @@ namespace
         }
         RestoreResult try_restore(const VcpkgPaths&, const Dependencies::InstallPlanAction& action) override
         {
-            if (Util::Sets::contains(m_restored, action.spec))
+            if (m_restored.contains(action.spec))
                 return RestoreResult::success;
             else
                 return RestoreResult::missing;
@@ -582,7 +727,7 @@ namespace
                 .string_arg("-ForceEnglishOutput");
             if (!m_interactive) cmdline.string_arg("-NonInteractive");
 
-            auto pack_rc = run_nuget_commandline(cmdline.extract());
+            auto pack_rc = run_nuget_commandline(cmdline);
 
             if (pack_rc != 0)
             {
@@ -607,7 +752,7 @@ namespace
 
                     System::print2("Uploading binaries for ", spec, " to NuGet source ", write_src, ".\n");
 
-                    auto rc = run_nuget_commandline(cmd.extract());
+                    auto rc = run_nuget_commandline(cmd);
 
                     if (rc != 0)
                     {
@@ -634,7 +779,7 @@ namespace
                     System::print2(
                         "Uploading binaries for ", spec, " using NuGet config ", fs::u8string(write_cfg), ".\n");
 
-                    auto rc = run_nuget_commandline(cmd.extract());
+                    auto rc = run_nuget_commandline(cmd);
 
                     if (rc != 0)
                     {
@@ -655,7 +800,7 @@ namespace
         std::vector<fs::path> m_read_configs;
         std::vector<fs::path> m_write_configs;
 
-        std::set<PackageSpec> m_restored;
+        RestoredSpecs m_restored;
         bool m_interactive;
     };
 }
@@ -1,9 +1,12 @@
 #include <vcpkg/base/cache.h>
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/chrono.h>
 #include <vcpkg/base/enums.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/hashcache.h>
 #include <vcpkg/base/optional.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/stringliteral.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
@@ -394,7 +397,7 @@ namespace vcpkg::Build
         return triplet_entry.compiler_info.get_lazy(toolchain_hash, [&]() -> CompilerInfo {
             if (m_compiler_tracking)
             {
-                return load_compiler_info(paths, abi_info);
+                return detect_compiler_info(paths, abi_info, triplet_entry.hash, toolchain_hash);
             }
             else
             {
@@ -423,7 +426,7 @@ namespace vcpkg::Build
                 auto& compiler_info = triplet_entry.compiler_info.get_lazy(toolchain_hash, [&]() -> CompilerInfo {
                     if (m_compiler_tracking)
                     {
-                        return load_compiler_info(paths, abi_info);
+                        return detect_compiler_info(paths, abi_info, triplet_entry.hash, toolchain_hash);
                     }
                     else
                     {
@@ -439,6 +442,174 @@ namespace vcpkg::Build
         });
     }
 
+    static constexpr StringLiteral COMPILER_INFO_CACHE_HEADER = "vcpkg compiler info cache v1";
+
+    std::string get_compiler_environment()
+    {
+        std::string environment;
+        static constexpr StringLiteral s_compiler_vars[] = {"CC", "CXX", "PATH"};
+        for (auto var : s_compiler_vars)
+        {
+            Strings::append(environment, var, '=', System::get_environment_variable(var).value_or(""), '\n');
+        }
+
+        return environment;
+    }
+
+    // Besides the triplet and toolchain files, the environment decides which compiler CMake finds.
+    static std::string get_compiler_environment_hash(const AbiInfo& abi_info)
+    {
+        std::string environment = get_compiler_environment();
+        if (auto toolset = abi_info.toolset.get())
+        {
+            Strings::append(environment,
+                            fs::u8string(toolset->vcvarsall),
+                            '\n',
+                            toolset->version,
+                            '\n',
+                            Strings::join(" ", toolset->vcvarsall_options),
+                            '\n');
+        }
+
+        return Hash::get_string_hash(environment, Hash::Algorithm::Sha1);
+    }
+
+    static std::vector<StringView> split_fields(StringView line)
+    {
+        std::vector<StringView> fields;
+        auto first = line.begin();
+        for (;;)
+        {
+            const auto last = std::find(first, line.end(), '\t');
+            fields.emplace_back(first, last);
+            if (last == line.end()) return fields;
+            first = last + 1;
+        }
+    }
+
+    // Format: a header line, then one line "<key>\t<hash>\t<id>\t<version>" followed by
+    // "\t<path>\t<size>\t<last write time>" for each compiler per entry. Malformed lines are skipped.
+    CompilerInfoStore::CompilerInfoStore(Files::Filesystem& fs, fs::path cache_file)
+        : m_fs(fs), m_cache_file(std::move(cache_file))
+    {
+        auto maybe_contents = CacheFile::load(m_fs, m_cache_file, COMPILER_INFO_CACHE_HEADER);
+        const auto contents = maybe_contents.get();
+        if (!contents) return;
+
+        for (auto&& line : Strings::split(*contents, '\n'))
+        {
+            const auto fields = split_fields(line);
+            if (fields.size() < 7 || (fields.size() - 4) % 3 != 0) continue;
+
+            Entry entry;
+            entry.info.hash = fields[1].to_string();
+            entry.info.id = fields[2].to_string();
+            entry.info.version = fields[3].to_string();
+            bool valid = true;
+            for (size_t field = 4; field < fields.size(); field += 3)
+            {
+                auto stamp =
+                    CacheFile::FileStamp::parse(fields[field + 1].to_string(), fields[field + 2].to_string());
+                valid = stamp.has_value();
+                if (!valid) break;
+                entry.info.compiler_paths.push_back(fs::u8path(fields[field]));
+                entry.stamps.push_back(*stamp.get());
+            }
+
+            if (valid) m_entries[fields[0].to_string()] = std::move(entry);
+        }
+    }
+
+    Optional<CompilerInfo> CompilerInfoStore::find(const std::string& key) const
+    {
+        const auto it = m_entries.find(key);
+        if (it == m_entries.end()) return nullopt;
+
+        const auto& entry = it->second;
+        for (size_t i = 0; i < entry.stamps.size(); ++i)
+        {
+            if (CacheFile::get_file_stamp(entry.info.compiler_paths[i]) != entry.stamps[i]) return nullopt;
+        }
+
+        return entry.info;
+    }
+
+    void CompilerInfoStore::insert(const std::string& key, const CompilerInfo& info)
+    {
+        Entry entry{info, {}};
+        for (auto&& compiler_path : info.compiler_paths)
+        {
+            auto stamp = CacheFile::get_file_stamp(compiler_path);
+            if (!stamp) return;
+            entry.stamps.push_back(*stamp.get());
+        }
+
+        const auto is_storable = [](StringView field) { return Strings::find_first_of(field, "\t\n") == field.end(); };
+        if (entry.stamps.empty() || !is_storable(key) || !is_storable(info.hash) || !is_storable(info.id) ||
+            !is_storable(info.version) ||
+            Util::any_of(info.compiler_paths,
+                         [&](const fs::path& compiler_path) { return !is_storable(fs::u8string(compiler_path)); }))
+        {
+            return;
+        }
+
+        m_entries[key] = std::move(entry);
+
+        std::string contents;
+        for (auto&& stored : m_entries)
+        {
+            const auto& stored_info = stored.second.info;
+            Strings::append(
+                contents, stored.first, '\t', stored_info.hash, '\t', stored_info.id, '\t', stored_info.version);
+            for (size_t i = 0; i < stored_info.compiler_paths.size(); ++i)
+            {
+                Strings::append(contents,
+                                '\t',
+                                fs::u8string(stored_info.compiler_paths[i]),
+                                '\t',
+                                stored.second.stamps[i].to_string());
+            }
+
+            contents.push_back('\n');
+        }
+
+        CacheFile::save(m_fs, m_cache_file, COMPILER_INFO_CACHE_HEADER, contents);
+    }
+
+    // The detected compiler information is stored in buildtrees/compiler-info, so that later runs only detect it again
+    // when the triplet file, toolchain file, environment or the compilers themselves change.
+    CompilerInfo EnvCache::detect_compiler_info(const VcpkgPaths& paths,
+                                                const AbiInfo& abi_info,
+                                                const std::string& triplet_hash,
+                                                const std::string& toolchain_hash)
+    {
+        const auto triplet = abi_info.pre_build_info->triplet;
+        const auto key = Strings::concat(
+            triplet, '-', triplet_hash, '-', toolchain_hash, '-', get_compiler_environment_hash(abi_info));
+
+        // Detection runs cmake, so the lock is only held to look up and to update the stored information.
+        {
+            std::lock_guard<std::mutex> lock(m_stored_mutex);
+            if (!m_stored_compiler_info)
+            {
+                m_stored_compiler_info = std::make_unique<CompilerInfoStore>(
+                    paths.get_filesystem(), paths.buildtrees / fs::u8path("compiler-info"));
+            }
+
+            auto maybe_stored = m_stored_compiler_info->find(key);
+            if (auto stored = maybe_stored.get())
+            {
+                Debug::print("Using stored compiler hash for triplet ", triplet, ": ", stored->hash, "\n");
+                return std::move(*stored);
+            }
+        }
+
+        auto compiler_info = load_compiler_info(paths, abi_info);
+        std::lock_guard<std::mutex> lock(m_stored_mutex);
+        m_stored_compiler_info->insert(key, compiler_info);
+        return compiler_info;
+    }
+
     std::string make_build_env_cmd(const PreBuildInfo& pre_build_info, const Toolset& toolset)
     {
         if (!pre_build_info.using_vcvars()) return "";
@@ -489,8 +660,23 @@ namespace vcpkg::Build
         paths.get_filesystem().write_contents(binary_control_file, start, VCPKG_LINE_INFO);
     }
 
+    static std::atomic<size_t> s_parallel_build_jobs{1};
+    static std::atomic<int> s_cores_per_build_job{0};
+
+    void set_parallel_build_jobs(size_t jobs, int cores_per_job)
+    {
+        s_parallel_build_jobs = jobs;
+        s_cores_per_build_job = cores_per_job;
+    }
+
     static int get_concurrency()
     {
+        const int cores_per_job = s_cores_per_build_job;
+        if (cores_per_job > 0)
+        {
+            return cores_per_job;
+        }
+
         static int concurrency = [] {
             auto user_defined_concurrency = System::get_environment_variable("VCPKG_MAX_CONCURRENCY");
             if (user_defined_concurrency)
@@ -565,21 +751,31 @@ namespace vcpkg::Build
         CompilerInfo compiler_info;
         System::cmd_execute_and_stream_lines(
             command,
-            [&](const std::string& s) {
+            [&](StringView s) {
                 static const StringLiteral s_hash_marker = "#COMPILER_HASH#";
                 if (Strings::starts_with(s, s_hash_marker))
                 {
-                    compiler_info.hash = s.data() + s_hash_marker.size();
+                    compiler_info.hash.assign(s.begin() + s_hash_marker.size(), s.end());
                 }
                 static const StringLiteral s_version_marker = "#COMPILER_CXX_VERSION#";
                 if (Strings::starts_with(s, s_version_marker))
                 {
-                    compiler_info.version = s.data() + s_version_marker.size();
+                    compiler_info.version.assign(s.begin() + s_version_marker.size(), s.end());
                 }
                 static const StringLiteral s_id_marker = "#COMPILER_CXX_ID#";
                 if (Strings::starts_with(s, s_id_marker))
                 {
-                    compiler_info.id = s.data() + s_id_marker.size();
+                    compiler_info.id.assign(s.begin() + s_id_marker.size(), s.end());
+                }
+                static const StringLiteral s_c_path_marker = "#COMPILER_C_PATH#";
+                static const StringLiteral s_cxx_path_marker = "#COMPILER_CXX_PATH#";
+                if (Strings::starts_with(s, s_c_path_marker))
+                {
+                    compiler_info.compiler_paths.push_back(fs::u8path(s.begin() + s_c_path_marker.size(), s.end()));
+                }
+                if (Strings::starts_with(s, s_cxx_path_marker))
+                {
+                    compiler_info.compiler_paths.push_back(fs::u8path(s.begin() + s_cxx_path_marker.size(), s.end()));
                 }
                 Debug::print(s, '\n');
                 out_file.write(s.data(), s.size()).put('\n');
@@ -785,8 +981,8 @@ namespace vcpkg::Build
         Checks::check_exit(VCPKG_LINE_INFO, out_file, "Failed to open '%s' for writing", fs::u8string(stdoutlog));
         const int return_code = System::cmd_execute_and_stream_data(
             command,
-            [&](StringView sv) {
-                System::print2(sv);
+            [&, echo = s_parallel_build_jobs <= 1](StringView sv) {
+                if (echo) System::print2(sv);
                 out_file.write(sv.data(), sv.size());
                 Checks::check_exit(
                     VCPKG_LINE_INFO, out_file, "Error occurred while writing '%s'", fs::u8string(stdoutlog));
@@ -913,9 +1109,57 @@ namespace vcpkg::Build
         fs::path tag_file;
     };
 
+    // The ABI entries which depend only on the contents of the port directory, and so can be computed for all
+    // actions at once, before the ABIs of their dependencies are known.
+    static std::vector<AbiEntry> compute_port_abi_entries(const VcpkgPaths& paths,
+                                                          const Dependencies::InstallPlanAction& action,
+                                                          Hash::FileHashCache& file_hashes)
+    {
+        auto& fs = paths.get_filesystem();
+        std::vector<AbiEntry> abi_tag_entries;
+
+        // If there is an unusually large number of files in the port then
+        // something suspicious is going on.  Rather than hash all of them
+        // just mark the port as no-hash
+        const int max_port_file_count = 100;
+
+        auto&& port_dir = action.source_control_file_location.value_or_exit(VCPKG_LINE_INFO).source_location;
+        size_t port_file_count = 0;
+        for (auto& port_file : fs::stdfs::recursive_directory_iterator(port_dir))
+        {
+            if (fs::is_regular_file(fs.status(VCPKG_LINE_INFO, port_file)))
+            {
+                abi_tag_entries.emplace_back(
+                    fs::u8string(port_file.path().filename()),
+                    file_hashes.get_file_hash(VCPKG_LINE_INFO, port_file, Hash::Algorithm::Sha1));
+
+                ++port_file_count;
+                if (port_file_count > max_port_file_count)
+                {
+                    abi_tag_entries.emplace_back("no_hash_max_portfile", "");
+                    break;
+                }
+            }
+        }
+
+        auto& helpers = paths.get_cmake_script_hashes();
+        auto portfile_contents =
+            fs.read_contents(port_dir / fs::u8path("portfile.cmake")).value_or_exit(VCPKG_LINE_INFO);
+        for (auto&& helper : helpers)
+        {
+            if (Strings::case_insensitive_ascii_contains(portfile_contents, helper.first))
+            {
+                abi_tag_entries.emplace_back(helper.first, helper.second);
+            }
+        }
+
+        return abi_tag_entries;
+    }
+
     static Optional<AbiTagAndFile> compute_abi_tag(const VcpkgPaths& paths,
                                                    const Dependencies::InstallPlanAction& action,
-                                                   Span<const AbiEntry> dependency_abis)
+                                                   Span<const AbiEntry> dependency_abis,
+                                                   Span<const AbiEntry> port_abi_entries)
     {
         auto& fs = paths.get_filesystem();
         Triplet triplet = action.spec.triplet();
@@ -950,29 +1194,7 @@ namespace vcpkg::Build
         abi_tag_entries.emplace_back("triplet", triplet_abi);
         abi_entries_from_abi_info(abi_info, abi_tag_entries);
 
-        // If there is an unusually large number of files in the port then
-        // something suspicious is going on.  Rather than hash all of them
-        // just mark the port as no-hash
-        const int max_port_file_count = 100;
-
-        auto&& port_dir = action.source_control_file_location.value_or_exit(VCPKG_LINE_INFO).source_location;
-        size_t port_file_count = 0;
-        for (auto& port_file : fs::stdfs::recursive_directory_iterator(port_dir))
-        {
-            if (fs::is_regular_file(fs.status(VCPKG_LINE_INFO, port_file)))
-            {
-                abi_tag_entries.emplace_back(
-                    fs::u8string(port_file.path().filename()),
-                    vcpkg::Hash::get_file_hash(VCPKG_LINE_INFO, fs, port_file, Hash::Algorithm::Sha1));
-
-                ++port_file_count;
-                if (port_file_count > max_port_file_count)
-                {
-                    abi_tag_entries.emplace_back("no_hash_max_portfile", "");
-                    break;
-                }
-            }
-        }
+        abi_tag_entries.insert(abi_tag_entries.end(), port_abi_entries.begin(), port_abi_entries.end());
 
         abi_tag_entries.emplace_back("cmake", paths.get_tool_version(Tools::CMAKE));
 
@@ -980,17 +1202,6 @@ namespace vcpkg::Build
         abi_tag_entries.emplace_back("powershell", paths.get_tool_version("powershell-core"));
 #endif
 
-        auto& helpers = paths.get_cmake_script_hashes();
-        auto portfile_contents =
-            fs.read_contents(port_dir / fs::u8path("portfile.cmake")).value_or_exit(VCPKG_LINE_INFO);
-        for (auto&& helper : helpers)
-        {
-            if (Strings::case_insensitive_ascii_contains(portfile_contents, helper.first))
-            {
-                abi_tag_entries.emplace_back(helper.first, helper.second);
-            }
-        }
-
         abi_tag_entries.emplace_back("post_build_checks", "2");
         std::vector<std::string> sorted_feature_list = action.feature_list;
         Util::sort(sorted_feature_list);
@@ -1039,12 +1250,37 @@ namespace vcpkg::Build
                           const CMakeVars::CMakeVarProvider& var_provider,
                           const StatusParagraphs& status_db)
     {
-        using Dependencies::InstallPlanAction;
-        for (auto it = action_plan.install_actions.begin(); it != action_plan.install_actions.end(); ++it)
+        auto& actions = action_plan.install_actions;
+        std::vector<size_t> pending;
+        std::unordered_map<PackageSpec, size_t> action_index;
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            action_index.emplace(actions[i].spec, i);
+            if (!actions[i].abi_info.has_value()) pending.push_back(i);
+        }
+
+        // Hashing the port directories does not depend on the ABIs of the dependencies, so do it for every action up
+        // front and on all cores.
+        std::vector<std::vector<AbiEntry>> port_abi_entries(actions.size());
         {
-            auto& action = *it;
-            if (action.abi_info.has_value()) continue;
+            paths.get_cmake_script_hashes();
+            Hash::FileHashCache file_hashes(paths.get_filesystem(), paths.buildtrees / fs::u8path("file-hashes"));
+            parallel_for_each_n(pending.begin(), pending.size(), [&](size_t i) {
+                const auto& action = actions[i];
+                if (action.build_options.use_head_version == UseHeadVersion::NO &&
+                    action.build_options.editable == Editable::NO)
+                {
+                    port_abi_entries[i] = compute_port_abi_entries(paths, action, file_hashes);
+                }
+            });
+            file_hashes.save();
+        }
 
+        // The actions are in dependency order, so the ABIs of dependencies being built are known by the time they
+        // are needed.
+        for (size_t i : pending)
+        {
+            auto& action = actions[i];
             std::vector<AbiEntry> dependency_abis;
             if (!Util::Enum::to_bool(action.build_options.only_downloads))
             {
@@ -1052,9 +1288,8 @@ namespace vcpkg::Build
                 {
                     if (pspec == action.spec) continue;
 
-                    auto pred = [&](const InstallPlanAction& ipa) { return ipa.spec == pspec; };
-                    auto it2 = std::find_if(action_plan.install_actions.begin(), it, pred);
-                    if (it2 == it)
+                    auto it = action_index.find(pspec);
+                    if (it == action_index.end() || it->second >= i)
                     {
                         // Finally, look in current installed
                         auto status_it = status_db.find(pspec);
@@ -1070,7 +1305,7 @@ namespace vcpkg::Build
                     }
                     else
                     {
-                        dependency_abis.emplace_back(AbiEntry{pspec.name(), it2->public_abi()});
+                        dependency_abis.emplace_back(AbiEntry{pspec.name(), actions[it->second].public_abi()});
                     }
                 }
             }
@@ -1082,7 +1317,7 @@ namespace vcpkg::Build
                 paths, action.spec.triplet(), var_provider.get_tag_vars(action.spec).value_or_exit(VCPKG_LINE_INFO));
             abi_info.toolset = paths.get_toolset(*abi_info.pre_build_info);
 
-            auto maybe_abi_tag_and_file = compute_abi_tag(paths, action, dependency_abis);
+            auto maybe_abi_tag_and_file = compute_abi_tag(paths, action, dependency_abis, port_abi_entries[i]);
             if (auto p = maybe_abi_tag_and_file.get())
             {
                 abi_info.compiler_info = paths.get_compiler_info(abi_info);
@@ -1093,15 +1328,9 @@ namespace vcpkg::Build
         }
     }
 
-    ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
-                                      const VcpkgPaths& paths,
-                                      const Dependencies::InstallPlanAction& action,
-                                      IBinaryProvider& binaries_provider,
-                                      const IBuildLogsRecorder& build_logs_recorder,
-                                      const StatusParagraphs& status_db)
+    std::vector<FeatureSpec> find_missing_dependencies(const Dependencies::InstallPlanAction& action,
+                                                       const StatusParagraphs& status_db)
     {
-        auto& fs = paths.get_filesystem();
-        auto& spec = action.spec;
         const std::string& name = action.source_control_file_location.value_or_exit(VCPKG_LINE_INFO)
                                       .source_control_file->core_paragraph->name;
 
@@ -1117,23 +1346,33 @@ namespace vcpkg::Build
             }
         }
 
+        return missing_fspecs;
+    }
+
+    ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
+                                      const VcpkgPaths& paths,
+                                      const Dependencies::InstallPlanAction& action,
+                                      IBinaryProvider& binaries_provider,
+                                      const IBuildLogsRecorder& build_logs_recorder,
+                                      const StatusParagraphs& status_db)
+    {
+        auto missing_fspecs = find_missing_dependencies(action, status_db);
         if (!missing_fspecs.empty() && !Util::Enum::to_bool(action.build_options.only_downloads))
         {
             return {BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES, std::move(missing_fspecs)};
         }
 
-        std::vector<AbiEntry> dependency_abis;
-        for (auto&& pspec : action.package_dependencies)
-        {
-            if (pspec == spec || Util::Enum::to_bool(action.build_options.only_downloads))
-            {
-                continue;
-            }
-            const auto status_it = status_db.find_installed(pspec);
-            Checks::check_exit(VCPKG_LINE_INFO, status_it != status_db.end());
-            dependency_abis.emplace_back(
-                AbiEntry{status_it->get()->package.spec.name(), status_it->get()->package.abi});
-        }
+        return build_package_with_installed_dependencies(args, paths, action, binaries_provider, build_logs_recorder);
+    }
+
+    ExtendedBuildResult build_package_with_installed_dependencies(const VcpkgCmdArguments& args,
+                                                                  const VcpkgPaths& paths,
+                                                                  const Dependencies::InstallPlanAction& action,
+                                                                  IBinaryProvider& binaries_provider,
+                                                                  const IBuildLogsRecorder& build_logs_recorder)
+    {
+        auto& fs = paths.get_filesystem();
+        auto& spec = action.spec;
 
         auto& abi_info = action.abi_info.value_or_exit(VCPKG_LINE_INFO);
         if (!abi_info.abi_tag_file)
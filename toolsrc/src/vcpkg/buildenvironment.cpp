@@ -4,9 +4,9 @@
 
 namespace vcpkg
 {
-    std::string make_cmake_cmd(const VcpkgPaths& paths,
-                               const fs::path& cmake_script,
-                               std::vector<System::CMakeVariable>&& pass_variables)
+    System::CmdLineBuilder make_cmake_cmd(const VcpkgPaths& paths,
+                                          const fs::path& cmake_script,
+                                          std::vector<System::CMakeVariable>&& pass_variables)
     {
         auto local_variables = std::move(pass_variables);
         local_variables.emplace_back("VCPKG_ROOT_DIR", paths.root);
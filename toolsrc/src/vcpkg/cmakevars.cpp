@@ -1,13 +1,18 @@
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/hash.h>
 #include <vcpkg/base/optional.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/span.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/buildenvironment.h>
 #include <vcpkg/cmakevars.h>
+#include <vcpkg/cmakevars.private.h>
+#include <vcpkg/commands.version.h>
 #include <vcpkg/dependencies.h>
 #include <vcpkg/portfileprovider.h>
+#include <vcpkg/vcpkgpaths.h>
 
 using namespace vcpkg;
 using vcpkg::Optional;
@@ -54,8 +59,16 @@ namespace vcpkg::CMakeVars
 
             fs::path create_dep_info_extraction_file(const View<PackageSpec> specs) const;
 
-            void launch_and_split(const fs::path& script_path,
-                                  std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const;
+            // Returns the output of cmake or the malformed line when the extraction fails.
+            Optional<std::string> launch_and_split(const fs::path& script_path,
+                                                   Span<std::vector<std::pair<std::string, std::string>>> vars) const;
+
+            template<class T, class CreateExtractionFile>
+            void launch_and_split_sharded(View<T> items,
+                                          CreateExtractionFile create_extraction_file,
+                                          std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const;
+
+            details::CMakeVarCache& get_cache() const;
 
             const VcpkgPaths& paths;
             const fs::path get_tags_path = paths.scripts / "vcpkg_get_tags.cmake";
@@ -63,6 +76,8 @@ namespace vcpkg::CMakeVars
             mutable std::unordered_map<PackageSpec, std::unordered_map<std::string, std::string>> dep_resolution_vars;
             mutable std::unordered_map<PackageSpec, std::unordered_map<std::string, std::string>> tag_vars;
             mutable std::unordered_map<Triplet, std::unordered_map<std::string, std::string>> generic_triplet_vars;
+            mutable details::CMakeVarKeys keys{paths};
+            mutable std::unique_ptr<details::CMakeVarCache> cache;
         };
     }
 
@@ -101,6 +116,33 @@ endmacro()
         return extraction_file;
     }
 
+    static std::string get_include_line(const fs::path& script_path)
+    {
+        return Strings::concat("\ninclude(\"", fs::generic_u8string(script_path), "\")\n\n");
+    }
+
+    static void append_get_tags_call(std::string& extraction_file,
+                                     const FullPackageSpec& spec,
+                                     int triplet_id,
+                                     const std::string& abi_settings_path)
+    {
+        Strings::append(extraction_file,
+                        "vcpkg_get_tags(\"",
+                        spec.package_spec.name(),
+                        "\" \"",
+                        Strings::join(";", spec.features),
+                        "\" \"",
+                        triplet_id,
+                        "\" \"",
+                        abi_settings_path,
+                        "\")\n");
+    }
+
+    static void append_get_dep_info_call(std::string& extraction_file, const PackageSpec& spec, int triplet_id)
+    {
+        Strings::append(extraction_file, "vcpkg_get_dep_info(", spec.name(), " ", triplet_id, ")\n");
+    }
+
     fs::path TripletCMakeVarProvider::create_tag_extraction_file(
         const View<std::pair<const FullPackageSpec*, std::string>> spec_abi_settings) const
     {
@@ -115,22 +157,13 @@ endmacro()
         }
         std::string extraction_file = create_extraction_file_prelude(paths, emitted_triplets);
 
-        Strings::append(extraction_file, "\ninclude(\"" + fs::generic_u8string(get_tags_path) + "\")\n\n");
+        extraction_file.append(get_include_line(get_tags_path));
 
         for (const auto& spec_abi_setting : spec_abi_settings)
         {
             const FullPackageSpec& spec = *spec_abi_setting.first;
-
-            Strings::append(extraction_file,
-                            "vcpkg_get_tags(\"",
-                            spec.package_spec.name(),
-                            "\" \"",
-                            Strings::join(";", spec.features),
-                            "\" \"",
-                            emitted_triplets[spec.package_spec.triplet()],
-                            "\" \"",
-                            spec_abi_setting.second,
-                            "\")\n");
+            append_get_tags_call(
+                extraction_file, spec, emitted_triplets[spec.package_spec.triplet()], spec_abi_setting.second);
         }
 
         fs::path path = paths.buildtrees / Strings::concat(tag_extract_id++, ".vcpkg_tags.cmake");
@@ -152,12 +185,11 @@ endmacro()
 
         std::string extraction_file = create_extraction_file_prelude(paths, emitted_triplets);
 
-        Strings::append(extraction_file, "\ninclude(\"" + fs::generic_u8string(get_dep_info_path) + "\")\n\n");
+        extraction_file.append(get_include_line(get_dep_info_path));
 
         for (const PackageSpec& spec : specs)
         {
-            Strings::append(
-                extraction_file, "vcpkg_get_dep_info(", spec.name(), " ", emitted_triplets[spec.triplet()], ")\n");
+            append_get_dep_info_call(extraction_file, spec, emitted_triplets[spec.triplet()]);
         }
 
         fs::path path = paths.buildtrees / Strings::concat(dep_info_id++, ".vcpkg_dep_info.cmake");
@@ -165,54 +197,388 @@ endmacro()
         return path;
     }
 
-    void TripletCMakeVarProvider::launch_and_split(
-        const fs::path& script_path, std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const
+    static constexpr StringLiteral CMAKE_VAR_CACHE_HEADER = "vcpkg cmake var cache v1";
+    static constexpr size_t MAX_CACHED_CMAKE_VAR_ENTRIES = 16384;
+
+    // Format: a header line, then for each entry a line "<key>\t<variable count>" followed by one line
+    // "<name>=<value>" per variable. Loading stops at the first malformed entry.
+    details::CMakeVarCache::CMakeVarCache(Files::Filesystem& fs, fs::path cache_file)
+        : m_fs(fs), m_cache_file(std::move(cache_file))
     {
-        static constexpr CStringView PORT_START_GUID = "d8187afd-ea4a-4fc3-9aa4-a6782e1ed9af";
-        static constexpr CStringView PORT_END_GUID = "8c504940-be29-4cba-9f8f-6cd83e9d87b7";
-        static constexpr CStringView BLOCK_START_GUID = "c35112b6-d1ba-415b-aa5d-81de856ef8eb";
-        static constexpr CStringView BLOCK_END_GUID = "e1e74b5c-18cb-4474-a6bd-5c1c8bc81f3f";
+        auto maybe_contents = CacheFile::load(m_fs, m_cache_file, CMAKE_VAR_CACHE_HEADER);
+        const auto contents = maybe_contents.get();
+        if (!contents) return;
+
+        const char* const end = contents->data() + contents->size();
+        const char* next = contents->data();
+        const char* first = next;
+        const char* last = next;
+        const auto next_line = [&]() {
+            if (next == end) return false;
+            first = next;
+            last = std::find(first, end, '\n');
+            next = last == end ? end : last + 1;
+            return true;
+        };
 
-        const auto cmd_launch_cmake = vcpkg::make_cmake_cmd(paths, script_path, {});
-        const auto ec_data = System::cmd_execute_and_capture_output(cmd_launch_cmake);
-        Checks::check_exit(VCPKG_LINE_INFO, ec_data.exit_code == 0, ec_data.output);
+        while (next_line())
+        {
+            const auto tab = std::find(first, last, '\t');
+            if (tab == last) return;
+            std::string key(first, tab);
+            auto count = Strings::strto<long long>(std::string(tab + 1, last));
+            if (!count || *count.get() < 0) return;
+
+            Entry entry{{}, false};
+            for (long long i = 0; i < *count.get(); ++i)
+            {
+                if (!next_line()) return;
+                const auto equals = std::find(first, last, '=');
+                if (equals == last) return;
+                entry.vars.emplace_back(std::string(first, equals), std::string(equals + 1, last));
+            }
 
-        const std::vector<std::string> lines = Strings::split(ec_data.output, '\n');
+            m_entries[std::move(key)] = std::move(entry);
+        }
+    }
 
-        const auto end = lines.cend();
+    const std::vector<std::pair<std::string, std::string>>* details::CMakeVarCache::find(const std::string& key)
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) return nullptr;
+        it->second.used = true;
+        return &it->second.vars;
+    }
 
-        auto port_start = std::find(lines.cbegin(), end, PORT_START_GUID);
-        auto port_end = std::find(port_start, end, PORT_END_GUID);
+    void details::CMakeVarCache::insert(const std::string& key,
+                                        const std::vector<std::pair<std::string, std::string>>& vars)
+    {
+        m_entries[key] = Entry{vars, true};
+        m_dirty = true;
+    }
+
+    void details::CMakeVarCache::save()
+    {
+        if (!m_dirty) return;
 
-        for (auto var_itr = vars.begin(); port_start != end && var_itr != vars.end(); ++var_itr)
+        const bool prune = m_entries.size() > MAX_CACHED_CMAKE_VAR_ENTRIES;
+        std::string contents;
+        for (auto&& entry : m_entries)
         {
-            auto block_start = std::find(port_start, port_end, BLOCK_START_GUID);
-            auto block_end = std::find(++block_start, port_end, BLOCK_END_GUID);
+            if (prune && !entry.second.used) continue;
+            Strings::append(contents, entry.first, '\t', entry.second.vars.size(), '\n');
+            for (auto&& var : entry.second.vars)
+            {
+                Strings::append(contents, var.first, '=', var.second, '\n');
+            }
+        }
+
+        CacheFile::save(m_fs, m_cache_file, CMAKE_VAR_CACHE_HEADER, contents);
+        m_dirty = false;
+    }
 
-            while (block_start != port_end)
+    // The values of environment variables that `text` reads with ENV{NAME}.
+    static std::string get_referenced_environment(StringView text)
+    {
+        static constexpr StringLiteral ENV_PREFIX = "ENV{";
+        std::string result;
+        auto first = text.begin();
+        for (;;)
+        {
+            first = std::search(first, text.end(), ENV_PREFIX.begin(), ENV_PREFIX.end());
+            if (first == text.end()) return result;
+            first += ENV_PREFIX.size();
+            const auto last = std::find(first, text.end(), '}');
+            const auto name = std::string(first, last);
+            const auto value = System::get_environment_variable(name);
+            Strings::append(result, name, value ? "=" + *value.get() : std::string(" unset"), '\n');
+            first = last;
+        }
+    }
+
+    // Skips a bracket comment or argument "[=*[ ... ]=*]" starting at `first`; returns `first` if there is none.
+    static const char* skip_bracket(const char* first, const char* last)
+    {
+        if (first == last || *first != '[') return first;
+        const auto open_end = std::find_if_not(first + 1, last, [](char c) { return c == '='; });
+        if (open_end == last || *open_end != '[') return first;
+        std::string close(open_end - first, '=');
+        close.front() = ']';
+        close.push_back(']');
+        const auto close_first = std::search(open_end + 1, last, close.begin(), close.end());
+        return close_first == last ? last : close_first + close.size();
+    }
+
+    bool details::includes_other_files(StringView text)
+    {
+        static constexpr StringLiteral INCLUDE = "include";
+        const char* first = text.begin();
+        const char* const last = text.end();
+        while (first != last)
+        {
+            if (*first == '#')
+            {
+                const auto after_bracket = skip_bracket(first + 1, last);
+                first = after_bracket != first + 1 ? after_bracket : std::find(first, last, '\n');
+            }
+            else if (*first == '"')
             {
-                while (block_start != block_end)
+                for (++first; first != last && *first != '"'; ++first)
                 {
-                    const std::string& line = *block_start;
+                    if (*first == '\\' && first + 1 != last) ++first;
+                }
 
-                    std::vector<std::string> s = Strings::split(line, '=');
-                    Checks::check_exit(VCPKG_LINE_INFO,
-                                       s.size() == 1 || s.size() == 2,
-                                       "Expected format is [VARIABLE_NAME=VARIABLE_VALUE], but was [%s]",
-                                       line);
+                if (first != last) ++first;
+            }
+            else if (static_cast<size_t>(last - first) >= INCLUDE.size() &&
+                     Strings::case_insensitive_ascii_equals({first, INCLUDE.size()}, INCLUDE))
+            {
+                first += INCLUDE.size();
+                first = std::find_if_not(first, last, [](char c) { return c == ' ' || c == '\t'; });
+                if (first != last && *first == '(') return true;
+            }
+            else
+            {
+                ++first;
+            }
+        }
 
-                    var_itr->emplace_back(std::move(s[0]), s.size() == 1 ? "" : std::move(s[1]));
+        return false;
+    }
 
-                    ++block_start;
-                }
+    details::CMakeVarKeys::CMakeVarKeys(const VcpkgPaths& paths)
+        : m_paths(paths)
+        , m_get_tags_path(paths.scripts / "vcpkg_get_tags.cmake")
+        , m_get_dep_info_path(paths.scripts / "vcpkg_get_dep_info.cmake")
+    {
+    }
 
-                block_start = std::find(block_end, port_end, BLOCK_START_GUID);
-                block_end = std::find(block_start, port_end, BLOCK_END_GUID);
+    // Describes the contents of the file at `path` and the environment it reads; a missing file is valid.
+    const details::CMakeVarKeys::FileKey& details::CMakeVarKeys::get_file_key(const fs::path& path)
+    {
+        auto path_string = fs::generic_u8string(path);
+        auto it = m_file_keys.find(path_string);
+        if (it == m_file_keys.end())
+        {
+            auto maybe_contents = m_paths.get_filesystem().read_contents(path);
+            std::string key_material = Strings::concat(path_string, '\n');
+            bool includes = false;
+            if (auto contents = maybe_contents.get())
+            {
+                Strings::append(key_material, *contents, '\n', get_referenced_environment(*contents));
+                includes = includes_other_files(*contents);
             }
+            else
+            {
+                key_material.append("missing\n");
+            }
+
+            it = m_file_keys
+                     .emplace(std::move(path_string),
+                              FileKey{Hash::get_string_hash(key_material, Hash::Algorithm::Sha1), includes})
+                     .first;
+        }
+
+        return it->second;
+    }
 
-            port_start = std::find(port_end, end, PORT_START_GUID);
-            port_end = std::find(port_start, end, PORT_END_GUID);
+    // Describes the generated code that loads `triplet` in an extraction script, and the vcpkg that generates it.
+    const std::string& details::CMakeVarKeys::get_prelude_key(Triplet triplet)
+    {
+        auto it = m_prelude_keys.find(triplet);
+        if (it == m_prelude_keys.end())
+        {
+            const auto prelude = create_extraction_file_prelude(m_paths, {{triplet, 0}});
+            it = m_prelude_keys
+                     .emplace(triplet,
+                              Hash::get_string_hash(Strings::concat(Commands::Version::version(), '\n', prelude),
+                                                    Hash::Algorithm::Sha1))
+                     .first;
         }
+
+        return it->second;
+    }
+
+    Optional<std::string> details::CMakeVarKeys::get_tag_key(const FullPackageSpec& spec,
+                                                             const std::string& abi_settings_path)
+    {
+        const auto triplet = spec.package_spec.triplet();
+        const auto& triplet_key = get_file_key(m_paths.get_triplet_file_path(triplet));
+        if (triplet_key.includes_other_files) return nullopt;
+
+        std::string key_material = Strings::concat("tags\n",
+                                                   get_prelude_key(triplet),
+                                                   '\n',
+                                                   triplet_key.hash,
+                                                   '\n',
+                                                   get_file_key(m_get_tags_path).hash,
+                                                   get_include_line(m_get_tags_path));
+        append_get_tags_call(key_material, spec, 0, abi_settings_path);
+        if (!abi_settings_path.empty())
+        {
+            const auto& abi_settings_key = get_file_key(abi_settings_path);
+            if (abi_settings_key.includes_other_files) return nullopt;
+            key_material.append(abi_settings_key.hash);
+        }
+
+        return Hash::get_string_hash(key_material, Hash::Algorithm::Sha1);
+    }
+
+    Optional<std::string> details::CMakeVarKeys::get_dep_info_key(const PackageSpec& spec)
+    {
+        const auto& triplet_key = get_file_key(m_paths.get_triplet_file_path(spec.triplet()));
+        if (triplet_key.includes_other_files) return nullopt;
+
+        std::string key_material = Strings::concat("dep-info\n",
+                                                   get_prelude_key(spec.triplet()),
+                                                   '\n',
+                                                   triplet_key.hash,
+                                                   '\n',
+                                                   get_file_key(m_get_dep_info_path).hash,
+                                                   get_include_line(m_get_dep_info_path));
+        append_get_dep_info_call(key_material, spec, 0);
+        return Hash::get_string_hash(key_material, Hash::Algorithm::Sha1);
+    }
+
+    details::CMakeVarCache& TripletCMakeVarProvider::get_cache() const
+    {
+        if (!cache)
+        {
+            cache =
+                std::make_unique<details::CMakeVarCache>(paths.get_filesystem(), paths.buildtrees / "cmake-var-cache");
+        }
+
+        return *cache;
+    }
+    namespace details
+    {
+        void ExtractionOutputParser::operator()(StringView line)
+        {
+            if (line.size() == 0) return;
+
+            switch (state)
+            {
+                case State::OutsidePort:
+                    if (line == PORT_START_GUID)
+                    {
+                        state = State::InPort;
+                        return;
+                    }
+                    break;
+                case State::InPort:
+                    if (line == PORT_END_GUID)
+                    {
+                        state = State::OutsidePort;
+                        if (current_port != vars.end()) ++current_port;
+                        return;
+                    }
+                    if (line == BLOCK_START_GUID)
+                    {
+                        state = State::InBlock;
+                        return;
+                    }
+                    break;
+                case State::InBlock:
+                    if (line == BLOCK_END_GUID)
+                    {
+                        state = State::InPort;
+                    }
+                    else if (current_port != vars.end())
+                    {
+                        std::vector<std::string> s = Strings::split(line, '=');
+                        if (s.size() == 1 || s.size() == 2)
+                        {
+                            current_port->emplace_back(std::move(s[0]), s.size() == 1 ? "" : std::move(s[1]));
+                        }
+                        else if (!error)
+                        {
+                            error = Strings::concat(
+                                "Expected format is [VARIABLE_NAME=VARIABLE_VALUE], but was [", line, ']');
+                        }
+                    }
+                    return;
+            }
+
+            Strings::append(other_output, line, '\n');
+        }
+
+        static constexpr size_t MIN_SPECS_PER_SHARD = 64;
+
+        std::vector<ExtractionShard> get_extraction_shards(size_t item_count, size_t max_shards)
+        {
+            const size_t shard_count = std::max<size_t>(
+                1, std::min(max_shards, (item_count + MIN_SPECS_PER_SHARD - 1) / MIN_SPECS_PER_SHARD));
+            const size_t shard_size = (item_count + shard_count - 1) / shard_count;
+
+            std::vector<ExtractionShard> shards;
+            for (size_t first = 0; first < item_count; first += shard_size)
+            {
+                shards.push_back({first, std::min(shard_size, item_count - first)});
+            }
+
+            return shards;
+        }
+
+        Optional<std::string> run_extraction_shards(
+            View<ExtractionShard> shards,
+            std::vector<std::vector<std::pair<std::string, std::string>>>& vars,
+            const std::function<Optional<std::string>(size_t, Span<std::vector<std::pair<std::string, std::string>>>)>&
+                run_shard)
+        {
+            std::vector<Optional<std::string>> errors(shards.size());
+            execute_in_parallel(shards.size(), [&](size_t shard) {
+                errors[shard] = run_shard(shard, {vars.data() + shards[shard].first, shards[shard].count});
+            });
+
+            for (auto&& error : errors)
+            {
+                if (error) return std::move(error);
+            }
+
+            return nullopt;
+        }
+    }
+
+    Optional<std::string> TripletCMakeVarProvider::launch_and_split(
+        const fs::path& script_path, Span<std::vector<std::pair<std::string, std::string>>> vars) const
+    {
+        const auto cmd_launch_cmake = vcpkg::make_cmake_cmd(paths, script_path, {});
+        details::ExtractionOutputParser parser(vars);
+        const auto exit_code = System::cmd_execute_and_stream_lines(cmd_launch_cmake, std::ref(parser));
+        if (exit_code != 0) return std::move(parser.other_output);
+        return std::move(parser.error);
+    }
+
+    // Writes one extraction script per shard of `items` and runs the scripts concurrently. The variables of items[i]
+    // end up in vars[i] regardless of which process produced them.
+    template<class T, class CreateExtractionFile>
+    void TripletCMakeVarProvider::launch_and_split_sharded(
+        View<T> items,
+        CreateExtractionFile create_extraction_file,
+        std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const
+    {
+        vars.resize(items.size());
+        const auto shards = details::get_extraction_shards(
+            items.size(), static_cast<size_t>(std::max(1, System::get_num_logical_cores())));
+
+        std::vector<fs::path> script_paths;
+        for (auto&& shard : shards)
+        {
+            script_paths.push_back(create_extraction_file(View<T>{items.data() + shard.first, shard.count}));
+        }
+
+        const auto error = details::run_extraction_shards(
+            shards, vars, [&](size_t shard, Span<std::vector<std::pair<std::string, std::string>>> shard_vars) {
+                return launch_and_split(script_paths[shard], shard_vars);
+            });
+
+        auto& fs = paths.get_filesystem();
+        for (auto&& script_path : script_paths)
+        {
+            fs.remove(script_path, VCPKG_LINE_INFO);
+        }
+
+        if (auto message = error.get()) Checks::exit_with_message(VCPKG_LINE_INFO, *message);
     }
 
     void TripletCMakeVarProvider::load_generic_triplet_vars(Triplet triplet) const
@@ -220,11 +586,27 @@ endmacro()
         std::vector<std::vector<std::pair<std::string, std::string>>> vars(1);
         // Hack: PackageSpecs should never have .name==""
         FullPackageSpec full_spec({"", triplet});
-        const fs::path file_path =
-            create_tag_extraction_file(std::array<std::pair<const FullPackageSpec*, std::string>, 1>{
-                std::pair<const FullPackageSpec*, std::string>{&full_spec, ""}});
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+        auto& cache = get_cache();
+        const auto maybe_key = keys.get_tag_key(full_spec, "");
+        const auto key = maybe_key.get();
+        if (auto cached = key ? cache.find(*key) : nullptr)
+        {
+            vars.front() = *cached;
+        }
+        else
+        {
+            const fs::path file_path =
+                create_tag_extraction_file(std::array<std::pair<const FullPackageSpec*, std::string>, 1>{
+                    std::pair<const FullPackageSpec*, std::string>{&full_spec, ""}});
+            const auto error = launch_and_split(file_path, vars);
+            paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+            if (auto message = error.get()) Checks::exit_with_message(VCPKG_LINE_INFO, *message);
+            if (key)
+            {
+                cache.insert(*key, vars.front());
+                cache.save();
+            }
+        }
 
         generic_triplet_vars[triplet].insert(std::make_move_iterator(vars.front().begin()),
                                              std::make_move_iterator(vars.front().end()));
@@ -233,56 +615,94 @@ endmacro()
     void TripletCMakeVarProvider::load_dep_info_vars(View<PackageSpec> specs) const
     {
         if (specs.size() == 0) return;
-        std::vector<std::vector<std::pair<std::string, std::string>>> vars(specs.size());
-        const fs::path file_path = create_dep_info_extraction_file(specs);
-        if (specs.size() > 100)
+        auto& cache = get_cache();
+        std::vector<PackageSpec> uncached_specs;
+        std::vector<Optional<std::string>> uncached_keys;
+        for (const PackageSpec& spec : specs)
         {
-            System::print2("Loading dependency information for ", specs.size(), " packages...\n");
+            auto key = keys.get_dep_info_key(spec);
+            if (auto cached = key ? cache.find(*key.get()) : nullptr)
+            {
+                dep_resolution_vars.emplace(std::piecewise_construct,
+                                            std::forward_as_tuple(spec),
+                                            std::forward_as_tuple(cached->begin(), cached->end()));
+            }
+            else
+            {
+                uncached_specs.push_back(spec);
+                uncached_keys.push_back(std::move(key));
+            }
         }
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
 
-        auto var_list_itr = vars.begin();
-        for (const PackageSpec& spec : specs)
+        if (uncached_specs.empty()) return;
+        std::vector<std::vector<std::pair<std::string, std::string>>> vars;
+        if (uncached_specs.size() > 100)
+        {
+            System::print2("Loading dependency information for ", uncached_specs.size(), " packages...\n");
+        }
+        launch_and_split_sharded(
+            View<PackageSpec>{uncached_specs},
+            [this](View<PackageSpec> shard) { return create_dep_info_extraction_file(shard); },
+            vars);
+
+        for (size_t i = 0; i < uncached_specs.size(); ++i)
         {
+            if (auto key = uncached_keys[i].get()) cache.insert(*key, vars[i]);
             dep_resolution_vars.emplace(std::piecewise_construct,
-                                        std::forward_as_tuple(spec),
-                                        std::forward_as_tuple(std::make_move_iterator(var_list_itr->begin()),
-                                                              std::make_move_iterator(var_list_itr->end())));
-            ++var_list_itr;
+                                        std::forward_as_tuple(uncached_specs[i]),
+                                        std::forward_as_tuple(std::make_move_iterator(vars[i].begin()),
+                                                              std::make_move_iterator(vars[i].end())));
         }
+
+        cache.save();
     }
 
     void TripletCMakeVarProvider::load_tag_vars(View<FullPackageSpec> specs,
                                                 const PortFileProvider::PortFileProvider& port_provider) const
     {
         if (specs.size() == 0) return;
+        auto& cache = get_cache();
         std::vector<std::pair<const FullPackageSpec*, std::string>> spec_abi_settings;
-        spec_abi_settings.reserve(specs.size());
+        std::vector<Optional<std::string>> uncached_keys;
 
         for (const FullPackageSpec& spec : specs)
         {
             auto& scfl = port_provider.get_control_file(spec.package_spec.name()).value_or_exit(VCPKG_LINE_INFO);
             const fs::path override_path = scfl.source_location / "vcpkg-abi-settings.cmake";
-            spec_abi_settings.emplace_back(&spec, fs::generic_u8string(override_path));
+            auto override_path_string = fs::generic_u8string(override_path);
+            auto key = keys.get_tag_key(spec, override_path_string);
+            if (auto cached = key ? cache.find(*key.get()) : nullptr)
+            {
+                tag_vars.emplace(std::piecewise_construct,
+                                 std::forward_as_tuple(spec.package_spec),
+                                 std::forward_as_tuple(cached->begin(), cached->end()));
+            }
+            else
+            {
+                spec_abi_settings.emplace_back(&spec, std::move(override_path_string));
+                uncached_keys.push_back(std::move(key));
+            }
         }
 
-        std::vector<std::vector<std::pair<std::string, std::string>>> vars(spec_abi_settings.size());
-        const fs::path file_path = create_tag_extraction_file(spec_abi_settings);
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+        if (spec_abi_settings.empty()) return;
+        std::vector<std::vector<std::pair<std::string, std::string>>> vars;
+        launch_and_split_sharded(
+            View<std::pair<const FullPackageSpec*, std::string>>{spec_abi_settings},
+            [this](View<std::pair<const FullPackageSpec*, std::string>> shard) {
+                return create_tag_extraction_file(shard);
+            },
+            vars);
 
-        auto var_list_itr = vars.begin();
-        for (const auto& spec_abi_setting : spec_abi_settings)
+        for (size_t i = 0; i < spec_abi_settings.size(); ++i)
         {
-            const FullPackageSpec& spec = *spec_abi_setting.first;
-
+            if (auto key = uncached_keys[i].get()) cache.insert(*key, vars[i]);
             tag_vars.emplace(std::piecewise_construct,
-                             std::forward_as_tuple(spec.package_spec),
-                             std::forward_as_tuple(std::make_move_iterator(var_list_itr->begin()),
-                                                   std::make_move_iterator(var_list_itr->end())));
-            ++var_list_itr;
+                             std::forward_as_tuple(spec_abi_settings[i].first->package_spec),
+                             std::forward_as_tuple(std::make_move_iterator(vars[i].begin()),
+                                                   std::make_move_iterator(vars[i].end())));
         }
+
+        cache.save();
     }
 
     Optional<const std::unordered_map<std::string, std::string>&> TripletCMakeVarProvider::get_generic_triplet_vars(
@@ -32,24 +32,10 @@ namespace vcpkg::Commands::Env
         nullptr,
     };
 
-    // This command should probably optionally take a port
-    void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths, Triplet triplet)
+    std::unordered_map<std::string, std::string> get_installed_env(const Files::Filesystem& fs,
+                                                                   const fs::path& installed_triplet_dir,
+                                                                   const ParsedArguments& options)
     {
-        const auto& fs = paths.get_filesystem();
-
-        const ParsedArguments options = args.parse_arguments(COMMAND_STRUCTURE);
-
-        PortFileProvider::PathsPortFileProvider provider(paths, args.overlay_ports);
-        auto var_provider_storage = CMakeVars::make_triplet_cmake_var_provider(paths);
-        auto& var_provider = *var_provider_storage;
-
-        var_provider.load_generic_triplet_vars(triplet);
-
-        const Build::PreBuildInfo pre_build_info(
-            paths, triplet, var_provider.get_generic_triplet_vars(triplet).value_or_exit(VCPKG_LINE_INFO));
-        const Toolset& toolset = paths.get_toolset(pre_build_info);
-        auto build_env_cmd = Build::make_build_env_cmd(pre_build_info, toolset);
-
         std::unordered_map<std::string, std::string> extra_env = {};
         const bool add_bin = Util::Sets::contains(options.switches, OPTION_BIN);
         const bool add_include = Util::Sets::contains(options.switches, OPTION_INCLUDE);
@@ -58,12 +44,12 @@ namespace vcpkg::Commands::Env
         const bool add_python = Util::Sets::contains(options.switches, OPTION_PYTHON);
 
         std::vector<std::string> path_vars;
-        if (add_bin) path_vars.push_back(fs::u8string(paths.installed / triplet.to_string() / "bin"));
-        if (add_debug_bin) path_vars.push_back(fs::u8string(paths.installed / triplet.to_string() / "debug" / "bin"));
-        if (add_include) extra_env.emplace("INCLUDE", fs::u8string(paths.installed / triplet.to_string() / "include"));
+        if (add_bin) path_vars.push_back(fs::u8string(installed_triplet_dir / "bin"));
+        if (add_debug_bin) path_vars.push_back(fs::u8string(installed_triplet_dir / "debug" / "bin"));
+        if (add_include) extra_env.emplace("INCLUDE", fs::u8string(installed_triplet_dir / "include"));
         if (add_tools)
         {
-            auto tools_dir = paths.installed / triplet.to_string() / "tools";
+            auto tools_dir = installed_triplet_dir / "tools";
             auto tool_files = fs.get_files_non_recursive(tools_dir);
             path_vars.push_back(fs::u8string(tools_dir));
             for (auto&& tool_dir : tool_files)
@@ -71,10 +57,31 @@ namespace vcpkg::Commands::Env
                 if (fs.is_directory(tool_dir)) path_vars.push_back(fs::u8string(tool_dir));
             }
         }
-        if (add_python)
-            extra_env.emplace("PYTHONPATH",
-                              fs::u8string(paths.installed / fs::u8path(triplet.to_string()) / fs::u8path("python")));
-        if (path_vars.size() > 0) extra_env.emplace("PATH", Strings::join(";", path_vars));
+        if (add_python) extra_env.emplace("PYTHONPATH", fs::u8string(installed_triplet_dir / fs::u8path("python")));
+        if (path_vars.size() > 0) extra_env.emplace("PATH", Strings::join(Files::path_list_separator, path_vars));
+
+        return extra_env;
+    }
+
+    // This command should probably optionally take a port
+    void perform_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths, Triplet triplet)
+    {
+        const auto& fs = paths.get_filesystem();
+
+        const ParsedArguments options = args.parse_arguments(COMMAND_STRUCTURE);
+
+        PortFileProvider::PathsPortFileProvider provider(paths, args.overlay_ports);
+        auto var_provider_storage = CMakeVars::make_triplet_cmake_var_provider(paths);
+        auto& var_provider = *var_provider_storage;
+
+        var_provider.load_generic_triplet_vars(triplet);
+
+        const Build::PreBuildInfo pre_build_info(
+            paths, triplet, var_provider.get_generic_triplet_vars(triplet).value_or_exit(VCPKG_LINE_INFO));
+        const Toolset& toolset = paths.get_toolset(pre_build_info);
+        auto build_env_cmd = Build::make_build_env_cmd(pre_build_info, toolset);
+
+        auto extra_env = get_installed_env(fs, paths.installed / fs::u8path(triplet.to_string()), options);
         for (auto&& passthrough : pre_build_info.passthrough_env_vars)
         {
             if (auto e = System::get_environment_variable(passthrough))
@@ -9,19 +9,19 @@ namespace vcpkg::Commands::Owns
 {
     static void search_file(const VcpkgPaths& paths, const std::string& file_substr, const StatusParagraphs& status_db)
     {
-        const std::vector<StatusParagraphAndAssociatedFiles> installed_files = get_installed_files(paths, status_db);
-        for (const StatusParagraphAndAssociatedFiles& pgh_and_file : installed_files)
+        auto& installed_files = InstalledFilesIndex::get(paths, status_db);
+        for (auto&& owner : installed_files.owners())
         {
-            const StatusParagraph& pgh = pgh_and_file.pgh;
-
-            for (const std::string& file : pgh_and_file.files)
+            for (const std::string& file : owner.second.files)
             {
                 if (file.find(file_substr) != std::string::npos)
                 {
-                    System::print2(pgh.package.displayname(), ": ", file, '\n');
+                    System::print2(owner.second.displayname, ": ", file, '\n');
                 }
             }
         }
+
+        installed_files.save(paths);
     }
     const CommandStructure COMMAND_STRUCTURE = {
         Strings::format("The argument should be a pattern to search for. %s", create_example_string("owns zlib.dll")),
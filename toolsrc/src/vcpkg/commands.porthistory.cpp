@@ -1,4 +1,6 @@
+#include <vcpkg/base/git.h>
 #include <vcpkg/base/json.h>
+#include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
@@ -30,7 +32,7 @@ namespace vcpkg::Commands::PortHistory
         const System::ExitCodeAndOutput run_git_command_inner(const VcpkgPaths& paths,
                                                               const fs::path& dot_git_directory,
                                                               const fs::path& working_directory,
-                                                              const std::string& cmd)
+                                                              const System::CmdLineBuilder& cmd)
         {
             const fs::path& git_exe = paths.get_tool_exe(Tools::GIT);
 
@@ -38,13 +40,16 @@ namespace vcpkg::Commands::PortHistory
             builder.path_arg(git_exe)
                 .string_arg(Strings::concat("--git-dir=", fs::u8string(dot_git_directory)))
                 .string_arg(Strings::concat("--work-tree=", fs::u8string(working_directory)));
-            const std::string full_cmd = Strings::concat(builder.extract(), " ", cmd);
+            for (auto&& arg : cmd.argv())
+            {
+                builder.string_arg(arg);
+            }
 
-            const auto output = System::cmd_execute_and_capture_output(full_cmd);
+            const auto output = System::cmd_execute_and_capture_output(builder);
             return output;
         }
 
-        const System::ExitCodeAndOutput run_git_command(const VcpkgPaths& paths, const std::string& cmd)
+        const System::ExitCodeAndOutput run_git_command(const VcpkgPaths& paths, const System::CmdLineBuilder& cmd)
         {
             const fs::path& work_dir = paths.root;
             const fs::path dot_git_dir = paths.root / ".git";
@@ -128,29 +133,31 @@ namespace vcpkg::Commands::PortHistory
             return nullopt;
         }
 
-        vcpkg::Optional<HistoryVersion> get_version_from_commit(const VcpkgPaths& paths,
-                                                                const std::string& commit_id,
-                                                                const std::string& commit_date,
-                                                                const std::string& port_name)
+        vcpkg::Optional<HistoryVersion> get_version_from_commit_with_git(const VcpkgPaths& paths,
+                                                                         const std::string& commit_id,
+                                                                         const std::string& commit_date,
+                                                                         const std::string& port_name)
         {
-            const std::string rev_parse_cmd = Strings::format("rev-parse %s:ports/%s", commit_id, port_name);
-            auto rev_parse_output = run_git_command(paths, rev_parse_cmd);
+            auto rev_parse_output = run_git_command(
+                paths,
+                System::CmdLineBuilder().string_arg("rev-parse").string_arg(
+                    Strings::concat(commit_id, ":ports/", port_name)));
             if (rev_parse_output.exit_code == 0)
             {
                 // Remove newline character
                 const auto git_tree = Strings::trim(std::move(rev_parse_output.output));
 
                 // Do we have a manifest file?
-                const std::string manifest_cmd = Strings::format(R"(show %s:vcpkg.json)", git_tree, port_name);
-                auto manifest_output = run_git_command(paths, manifest_cmd);
+                auto manifest_output = run_git_command(
+                    paths, System::CmdLineBuilder().string_arg("show").string_arg(git_tree + ":vcpkg.json"));
                 if (manifest_output.exit_code == 0)
                 {
                     return get_version_from_text(
                         manifest_output.output, git_tree, commit_id, commit_date, port_name, true);
                 }
 
-                const std::string cmd = Strings::format(R"(show %s:CONTROL)", git_tree, commit_id, port_name);
-                auto control_output = run_git_command(paths, cmd);
+                auto control_output = run_git_command(
+                    paths, System::CmdLineBuilder().string_arg("show").string_arg(git_tree + ":CONTROL"));
 
                 if (control_output.exit_code == 0)
                 {
@@ -162,6 +169,51 @@ namespace vcpkg::Commands::PortHistory
             return nullopt;
         }
 
+        vcpkg::Optional<HistoryVersion> get_version_from_commit(const VcpkgPaths& paths,
+                                                                const std::string& commit_id,
+                                                                const std::string& commit_date,
+                                                                const std::string& port_name)
+        {
+            // The port files are read from the git objects directly, rather than with a `git rev-parse` and up to two
+            // `git show` processes per commit.
+            const auto& objects = paths.get_git_objects();
+            auto maybe_tree = objects.find_path(commit_id, Strings::concat("ports/", port_name));
+            auto git_tree = maybe_tree.get();
+            if (!git_tree)
+            {
+                Debug::print("Using git to read ", commit_id, ":ports/", port_name, ": ", maybe_tree.error(), '\n');
+                return get_version_from_commit_with_git(paths, commit_id, commit_date, port_name);
+            }
+
+            // Only a port without either file has no version; anything the object store fails to read is left to git.
+            auto maybe_entries = objects.read_tree(*git_tree);
+            auto entries = maybe_entries.get();
+            if (!entries)
+            {
+                Debug::print("Using git to read ", *git_tree, ": ", maybe_entries.error(), '\n');
+                return get_version_from_commit_with_git(paths, commit_id, commit_date, port_name);
+            }
+
+            for (const bool is_manifest : {true, false})
+            {
+                const StringView file_name = is_manifest ? StringView("vcpkg.json") : "CONTROL";
+                const auto entry = Util::find_if(
+                    *entries, [&](const Git::TreeEntry& e) { return !e.is_tree() && StringView(e.name) == file_name; });
+                if (entry == entries->end()) continue;
+
+                auto maybe_text = objects.read_blob(entry->oid);
+                if (auto text = maybe_text.get())
+                {
+                    return get_version_from_text(*text, *git_tree, commit_id, commit_date, port_name, is_manifest);
+                }
+
+                Debug::print("Using git to read ", entry->oid, ": ", maybe_text.error(), '\n');
+                return get_version_from_commit_with_git(paths, commit_id, commit_date, port_name);
+            }
+
+            return nullopt;
+        }
+
         std::vector<HistoryVersion> read_versions_from_log(const VcpkgPaths& paths, const std::string& port_name)
         {
             // log --format="%H %cd" --date=short --left-only -- ports/{port_name}/.
@@ -172,7 +224,7 @@ namespace vcpkg::Commands::PortHistory
             builder.string_arg("--left-only");
             builder.string_arg("--"); // Begin pathspec
             builder.string_arg(Strings::format("ports/%s/.", port_name));
-            const auto output = run_git_command(paths, builder.extract());
+            const auto output = run_git_command(paths, builder);
 
             auto commits = Util::fmap(
                 Strings::split(output.output, '\n'), [](const std::string& line) -> auto {
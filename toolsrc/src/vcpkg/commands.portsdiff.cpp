@@ -91,15 +91,19 @@ namespace vcpkg::Commands::PortsDiff
         const auto checkout_this_dir =
             Strings::format(R"(.\%s)", ports_dir_name_as_string); // Must be relative to the root of the repository
 
-        const std::string cmd = Strings::format(R"("%s" --git-dir="%s" --work-tree="%s" checkout %s -f -q -- %s %s)",
-                                                fs::u8string(git_exe),
-                                                fs::u8string(dot_git_dir),
-                                                fs::u8string(temp_checkout_path),
-                                                git_commit_id,
-                                                checkout_this_dir,
-                                                ".vcpkg-root");
+        System::CmdLineBuilder cmd;
+        cmd.path_arg(git_exe)
+            .string_arg(Strings::concat("--git-dir=", fs::u8string(dot_git_dir)))
+            .string_arg(Strings::concat("--work-tree=", fs::u8string(temp_checkout_path)))
+            .string_arg("checkout")
+            .string_arg(git_commit_id)
+            .string_arg("-f")
+            .string_arg("-q")
+            .string_arg("--")
+            .string_arg(checkout_this_dir)
+            .string_arg(".vcpkg-root");
         System::cmd_execute_and_capture_output(cmd, System::get_clean_environment());
-        System::cmd_execute_and_capture_output(Strings::format(R"("%s" reset)", fs::u8string(git_exe)),
+        System::cmd_execute_and_capture_output(System::CmdLineBuilder().path_arg(git_exe).string_arg("reset"),
                                                System::get_clean_environment());
         const auto ports_at_commit =
             Paragraphs::load_overlay_ports(paths, temp_checkout_path / ports_dir_name_as_string);
@@ -117,7 +121,8 @@ namespace vcpkg::Commands::PortsDiff
     {
         static const std::string VALID_COMMIT_OUTPUT = "commit\n";
 
-        const auto cmd = Strings::format(R"("%s" cat-file -t %s)", fs::u8string(git_exe), git_commit_id);
+        System::CmdLineBuilder cmd;
+        cmd.path_arg(git_exe).string_arg("cat-file").string_arg("-t").string_arg(git_commit_id);
         const System::ExitCodeAndOutput output = System::cmd_execute_and_capture_output(cmd);
         Checks::check_exit(
             VCPKG_LINE_INFO, output.output == VALID_COMMIT_OUTPUT, "Invalid commit id %s", git_commit_id);
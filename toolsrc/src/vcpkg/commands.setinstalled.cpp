@@ -41,10 +41,15 @@ namespace vcpkg::Commands::SetInstalled
                              const CMakeVars::CMakeVarProvider& cmake_vars,
                              Dependencies::ActionPlan action_plan,
                              DryRun dry_run,
-                             const Optional<fs::path>& maybe_pkgsconfig)
+                             const Optional<fs::path>& maybe_pkgsconfig,
+                             Optional<Install::ManifestFingerprint&> fingerprint)
     {
         cmake_vars.load_tag_vars(action_plan, provider);
         Build::compute_all_abis(paths, action_plan, cmake_vars, {});
+        if (auto p_fingerprint = fingerprint.get())
+        {
+            p_fingerprint->track_plan(action_plan);
+        }
 
         std::set<std::string> all_abis;
 
@@ -114,6 +119,11 @@ namespace vcpkg::Commands::SetInstalled
 
         System::print2("\nTotal elapsed time: ", summary.total_elapsed_time, "\n\n");
 
+        if (auto p_fingerprint = fingerprint.get())
+        {
+            p_fingerprint->save();
+        }
+
         Checks::exit_success(VCPKG_LINE_INFO);
     }
 
@@ -164,7 +174,8 @@ namespace vcpkg::Commands::SetInstalled
                             *cmake_vars,
                             std::move(action_plan),
                             dry_run ? DryRun::Yes : DryRun::No,
-                            pkgsconfig);
+                            pkgsconfig,
+                            nullopt);
     }
 
     void SetInstalledCommand::perform_and_exit(const VcpkgCmdArguments& args,
@@ -12,6 +12,9 @@
 #include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <deque>
+#include <numeric>
+
 using namespace vcpkg;
 
 namespace vcpkg::Dependencies
@@ -253,58 +256,60 @@ namespace vcpkg::Dependencies
         /// <returns>The cluster found or created for spec.</returns>
         Cluster& get(const PackageSpec& spec)
         {
-            auto it = m_graph.find(spec);
-            if (it == m_graph.end())
+            auto it = m_index.find(spec);
+            if (it == m_index.end())
             {
                 const SourceControlFileLocation* scfl = m_port_provider.get_control_file(spec.name()).get();
 
                 Checks::check_exit(
                     VCPKG_LINE_INFO, scfl, "Error: Cannot find definition for package `%s`.", spec.name());
 
-                return m_graph
-                    .emplace(std::piecewise_construct, std::forward_as_tuple(spec), std::forward_as_tuple(spec, *scfl))
-                    .first->second;
+                m_index.emplace(spec, m_clusters.size());
+                m_clusters.emplace_back(spec, *scfl);
+                return m_clusters.back();
             }
 
-            return it->second;
+            return m_clusters[it->second];
         }
 
         Cluster& get(const InstalledPackageView& ipv)
         {
-            auto it = m_graph.find(ipv.spec());
+            auto it = m_index.find(ipv.spec());
 
-            if (it == m_graph.end())
+            if (it == m_index.end())
             {
                 ExpectedS<const SourceControlFileLocation&> maybe_scfl =
                     m_port_provider.get_control_file(ipv.spec().name());
 
-                return m_graph
-                    .emplace(std::piecewise_construct,
-                             std::forward_as_tuple(ipv.spec()),
-                             std::forward_as_tuple(ipv, std::move(maybe_scfl)))
-                    .first->second;
+                m_index.emplace(ipv.spec(), m_clusters.size());
+                m_clusters.emplace_back(ipv, std::move(maybe_scfl));
+                return m_clusters.back();
             }
 
-            if (!it->second.m_installed)
+            Cluster& cluster = m_clusters[it->second];
+            if (!cluster.m_installed)
             {
-                it->second.m_installed = {ipv};
+                cluster.m_installed = {ipv};
             }
 
-            return it->second;
+            return cluster;
         }
 
-        const Cluster& find_or_exit(const PackageSpec& spec, LineInfo linfo) const
+        /// <summary>The position of the cluster for `spec`, counting clusters in the order they were created.</summary>
+        size_t index_of(const PackageSpec& spec, LineInfo linfo) const
         {
-            auto it = m_graph.find(spec);
-            Checks::check_exit(linfo, it != m_graph.end(), "Failed to locate spec in graph");
+            auto it = m_index.find(spec);
+            Checks::check_exit(linfo, it != m_index.end(), "Failed to locate spec in graph");
             return it->second;
         }
 
-        auto begin() const { return m_graph.begin(); }
-        auto end() const { return m_graph.end(); }
+        size_t size() const { return m_clusters.size(); }
+        const Cluster& operator[](size_t index) const { return m_clusters[index]; }
 
     private:
-        std::map<PackageSpec, Cluster> m_graph;
+        // A deque never moves its elements when growing, so references to clusters stay valid as the graph grows.
+        std::deque<Cluster> m_clusters;
+        std::unordered_map<PackageSpec, size_t> m_index;
         const PortFileProvider::PortFileProvider& m_port_provider;
     };
 
@@ -516,103 +521,96 @@ namespace vcpkg::Dependencies
     std::vector<RemovePlanAction> create_remove_plan(const std::vector<PackageSpec>& specs,
                                                      const StatusParagraphs& status_db)
     {
-        struct RemoveAdjacencyProvider final : Graphs::AdjacencyProvider<PackageSpec, RemovePlanAction>
-        {
-            const StatusParagraphs& status_db;
-            const std::vector<InstalledPackageView>& installed_ports;
-            const std::unordered_set<PackageSpec>& specs_as_set;
-
-            RemoveAdjacencyProvider(const StatusParagraphs& status_db,
-                                    const std::vector<InstalledPackageView>& installed_ports,
-                                    const std::unordered_set<PackageSpec>& specs_as_set)
-                : status_db(status_db), installed_ports(installed_ports), specs_as_set(specs_as_set)
-            {
-            }
-
-            std::vector<PackageSpec> adjacency_list(const RemovePlanAction& plan) const override
-            {
-                if (plan.plan_type == RemovePlanType::NOT_INSTALLED)
-                {
-                    return {};
-                }
-
-                const PackageSpec& spec = plan.spec;
-                std::vector<PackageSpec> dependents;
-                for (auto&& ipv : installed_ports)
-                {
-                    auto deps = ipv.dependencies();
-
-                    if (std::find(deps.begin(), deps.end(), spec) == deps.end()) continue;
-
-                    dependents.push_back(ipv.spec());
-                }
+        auto installed_ports = get_installed_ports(status_db);
+        const std::unordered_set<PackageSpec> specs_as_set(specs.cbegin(), specs.cend());
 
-                return dependents;
-            }
+        // The installed ports come first, then the requested specs that are not installed. Edges run from each
+        // installed port to the installed ports depending on it.
+        std::vector<PackageSpec> vertices = Util::fmap(installed_ports, [](auto&& ipv) { return ipv.spec(); });
+        std::unordered_map<PackageSpec, size_t> vertex_of;
+        for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+        {
+            vertex_of.emplace(vertices[vertex], vertex);
+        }
 
-            RemovePlanAction load_vertex_data(const PackageSpec& spec) const override
+        std::vector<std::pair<size_t, size_t>> edges;
+        for (size_t dependent = 0; dependent < installed_ports.size(); ++dependent)
+        {
+            for (auto&& dep : installed_ports[dependent].dependencies())
             {
-                const RequestType request_type = specs_as_set.find(spec) != specs_as_set.end()
-                                                     ? RequestType::USER_REQUESTED
-                                                     : RequestType::AUTO_SELECTED;
-                const StatusParagraphs::const_iterator it = status_db.find_installed(spec);
-                if (it == status_db.end())
-                {
-                    return RemovePlanAction{spec, RemovePlanType::NOT_INSTALLED, request_type};
-                }
-                return RemovePlanAction{spec, RemovePlanType::REMOVE, request_type};
+                auto it = vertex_of.find(dep);
+                if (it != vertex_of.end()) edges.emplace_back(it->second, dependent);
             }
+        }
 
-            std::string to_string(const PackageSpec& spec) const override { return spec.to_string(); }
-        };
+        std::vector<size_t> starting_vertices;
+        for (auto&& spec : specs)
+        {
+            auto it = vertex_of.emplace(spec, vertices.size()).first;
+            if (it->second == vertices.size()) vertices.push_back(spec);
+            starting_vertices.push_back(it->second);
+        }
 
-        auto installed_ports = get_installed_ports(status_db);
-        const std::unordered_set<PackageSpec> specs_as_set(specs.cbegin(), specs.cend());
-        return Graphs::topological_sort(
-            std::move(specs), RemoveAdjacencyProvider{status_db, installed_ports, specs_as_set}, {});
+        auto sorted = Graphs::topological_sort(std::move(starting_vertices),
+                                               Graphs::DenseGraph(vertices.size(), edges),
+                                               nullptr,
+                                               [&](size_t vertex) { return vertices[vertex].to_string(); });
+        return Util::fmap(sorted, [&](size_t vertex) {
+            const PackageSpec& spec = vertices[vertex];
+            const RequestType request_type = specs_as_set.find(spec) != specs_as_set.end()
+                                                 ? RequestType::USER_REQUESTED
+                                                 : RequestType::AUTO_SELECTED;
+            const RemovePlanType plan_type =
+                vertex < installed_ports.size() ? RemovePlanType::REMOVE : RemovePlanType::NOT_INSTALLED;
+            return RemovePlanAction{spec, plan_type, request_type};
+        });
     }
 
     std::vector<ExportPlanAction> create_export_plan(const std::vector<PackageSpec>& specs,
                                                      const StatusParagraphs& status_db)
     {
-        struct ExportAdjacencyProvider final : Graphs::AdjacencyProvider<PackageSpec, ExportPlanAction>
-        {
-            const StatusParagraphs& status_db;
-            const std::unordered_set<PackageSpec>& specs_as_set;
-
-            ExportAdjacencyProvider(const StatusParagraphs& s, const std::unordered_set<PackageSpec>& specs_as_set)
-                : status_db(s), specs_as_set(specs_as_set)
-            {
-            }
-
-            std::vector<PackageSpec> adjacency_list(const ExportPlanAction& plan) const override
-            {
-                return plan.dependencies(plan.spec.triplet());
-            }
+        const std::unordered_set<PackageSpec> specs_as_set(specs.cbegin(), specs.cend());
 
-            ExportPlanAction load_vertex_data(const PackageSpec& spec) const override
+        // Vertices are numbered as they are discovered, starting from the requested specs
+        std::vector<ExportPlanAction> actions;
+        std::unordered_map<PackageSpec, size_t> vertex_of;
+        auto get_vertex = [&](const PackageSpec& spec) {
+            auto inserted = vertex_of.emplace(spec, actions.size());
+            if (inserted.second)
             {
                 const RequestType request_type = specs_as_set.find(spec) != specs_as_set.end()
                                                      ? RequestType::USER_REQUESTED
                                                      : RequestType::AUTO_SELECTED;
 
                 auto maybe_ipv = status_db.get_installed_package_view(spec);
-
                 if (auto p_ipv = maybe_ipv.get())
                 {
-                    return ExportPlanAction{spec, std::move(*p_ipv), request_type};
+                    actions.emplace_back(spec, std::move(*p_ipv), request_type);
+                }
+                else
+                {
+                    actions.emplace_back(spec, request_type);
                 }
-
-                return ExportPlanAction{spec, request_type};
             }
 
-            std::string to_string(const PackageSpec& spec) const override { return spec.to_string(); }
+            return inserted.first->second;
         };
 
-        const std::unordered_set<PackageSpec> specs_as_set(specs.cbegin(), specs.cend());
-        std::vector<ExportPlanAction> toposort =
-            Graphs::topological_sort(specs, ExportAdjacencyProvider{status_db, specs_as_set}, {});
-        return toposort;
+        auto starting_vertices = Util::fmap(specs, get_vertex);
+        std::vector<std::pair<size_t, size_t>> edges;
+        for (size_t vertex = 0; vertex < actions.size(); ++vertex)
+        {
+            for (auto&& dep : actions[vertex].dependencies(actions[vertex].spec.triplet()))
+            {
+                edges.emplace_back(vertex, get_vertex(dep));
+            }
+        }
+
+        auto sorted = Graphs::topological_sort(std::move(starting_vertices),
+                                               Graphs::DenseGraph(actions.size(), edges),
+                                               nullptr,
+                                               [&](size_t vertex) { return actions[vertex].spec.to_string(); });
+        return Util::fmap(sorted, [&](size_t vertex) { return std::move(actions[vertex]); });
     }
 
     void PackageGraph::mark_user_requested(const PackageSpec& spec)
@@ -891,76 +889,90 @@ namespace vcpkg::Dependencies
 
     ActionPlan PackageGraph::serialize(const CreateInstallPlanOptions& options) const
     {
-        struct BaseEdgeProvider : Graphs::AdjacencyProvider<PackageSpec, const Cluster*>
-        {
-            BaseEdgeProvider(const ClusterGraph& parent) : m_parent(parent) { }
+        // Vertices are the clusters in spec order, so the sorts below visit vertices and edges in a stable order.
+        const size_t cluster_count = m_graph->size();
+        std::vector<size_t> cluster_of_vertex(cluster_count);
+        std::iota(cluster_of_vertex.begin(), cluster_of_vertex.end(), size_t(0));
+        std::sort(cluster_of_vertex.begin(), cluster_of_vertex.end(), [&](size_t lhs, size_t rhs) {
+            return (*m_graph)[lhs].m_spec < (*m_graph)[rhs].m_spec;
+        });
 
-            std::string to_string(const PackageSpec& spec) const override { return spec.to_string(); }
-            const Cluster* load_vertex_data(const PackageSpec& spec) const override
-            {
-                return &m_parent.find_or_exit(spec, VCPKG_LINE_INFO);
-            }
+        std::vector<size_t> vertex_of_cluster(cluster_count);
+        for (size_t vertex = 0; vertex < cluster_count; ++vertex)
+        {
+            vertex_of_cluster[cluster_of_vertex[vertex]] = vertex;
+        }
 
-            const ClusterGraph& m_parent;
+        auto vertex_of = [&](const PackageSpec& spec) {
+            return vertex_of_cluster[m_graph->index_of(spec, VCPKG_LINE_INFO)];
         };
+        auto cluster_at = [&](size_t vertex) -> const Cluster& { return (*m_graph)[cluster_of_vertex[vertex]]; };
 
-        struct RemoveEdgeProvider final : BaseEdgeProvider
+        std::vector<size_t> removed_vertices;
+        std::vector<size_t> installed_vertices;
+        std::vector<std::pair<size_t, size_t>> remove_edges;
+        std::vector<std::pair<size_t, size_t>> install_edges;
+        for (size_t vertex = 0; vertex < cluster_count; ++vertex)
         {
-            using BaseEdgeProvider::BaseEdgeProvider;
-
-            std::vector<PackageSpec> adjacency_list(const Cluster* const& vertex) const override
+            const Cluster& cluster = cluster_at(vertex);
+            if (cluster.m_install_info.has_value() && cluster.m_installed.has_value())
             {
-                auto&& set = vertex->m_installed.value_or_exit(VCPKG_LINE_INFO).remove_edges;
-                return {set.begin(), set.end()};
+                removed_vertices.push_back(vertex);
             }
-        } removeedgeprovider(*m_graph);
-
-        struct InstallEdgeProvider final : BaseEdgeProvider
-        {
-            using BaseEdgeProvider::BaseEdgeProvider;
-
-            std::vector<PackageSpec> adjacency_list(const Cluster* const& vertex) const override
+            if (cluster.m_install_info.has_value() || cluster.request_type == RequestType::USER_REQUESTED)
             {
-                if (!vertex->m_install_info.has_value()) return {};
-
-                auto& info = vertex->m_install_info.value_or_exit(VCPKG_LINE_INFO);
-                std::vector<PackageSpec> deps;
-                for (auto&& kv : info.build_edges)
-                    for (auto&& e : kv.second)
-                    {
-                        auto spec = e.spec();
-                        if (spec != vertex->m_spec) deps.push_back(std::move(spec));
-                    }
-                Util::sort_unique_erase(deps);
-                return deps;
+                installed_vertices.push_back(vertex);
             }
-        } installedgeprovider(*m_graph);
 
-        std::vector<PackageSpec> removed_vertices;
-        std::vector<PackageSpec> installed_vertices;
-        for (auto&& kv : *m_graph)
-        {
-            if (kv.second.m_install_info.has_value() && kv.second.m_installed.has_value())
+            if (auto installed = cluster.m_installed.get())
             {
-                removed_vertices.push_back(kv.first);
+                const auto first = remove_edges.size();
+                for (auto&& spec : installed->remove_edges)
+                {
+                    remove_edges.emplace_back(vertex, vertex_of(spec));
+                }
+
+                std::sort(remove_edges.begin() + first, remove_edges.end());
             }
-            if (kv.second.m_install_info.has_value() || kv.second.request_type == RequestType::USER_REQUESTED)
+
+            if (auto info = cluster.m_install_info.get())
             {
-                installed_vertices.push_back(kv.first);
+                const auto first = install_edges.size();
+                for (auto&& kv : info->build_edges)
+                {
+                    for (auto&& fspec : kv.second)
+                    {
+                        if (fspec.spec() != cluster.m_spec) install_edges.emplace_back(vertex, vertex_of(fspec.spec()));
+                    }
+                }
+
+                std::sort(install_edges.begin() + first, install_edges.end());
+                install_edges.erase(std::unique(install_edges.begin() + first, install_edges.end()),
+                                    install_edges.end());
             }
         }
-        auto remove_toposort = Graphs::topological_sort(removed_vertices, removeedgeprovider, options.randomizer);
-        auto insert_toposort = Graphs::topological_sort(installed_vertices, installedgeprovider, options.randomizer);
+
+        auto to_string = [&](size_t vertex) { return cluster_at(vertex).m_spec.to_string(); };
+        auto remove_toposort = Graphs::topological_sort(std::move(removed_vertices),
+                                                        Graphs::DenseGraph(cluster_count, remove_edges),
+                                                        options.randomizer,
+                                                        to_string);
+        auto insert_toposort = Graphs::topological_sort(std::move(installed_vertices),
+                                                        Graphs::DenseGraph(cluster_count, install_edges),
+                                                        options.randomizer,
+                                                        to_string);
 
         ActionPlan plan;
 
-        for (auto&& p_cluster : remove_toposort)
+        for (size_t vertex : remove_toposort)
         {
+            const Cluster* p_cluster = &cluster_at(vertex);
             plan.remove_actions.emplace_back(p_cluster->m_spec, RemovePlanType::REMOVE, p_cluster->request_type);
         }
 
-        for (auto&& p_cluster : insert_toposort)
+        for (size_t vertex : insert_toposort)
         {
+            const Cluster* p_cluster = &cluster_at(vertex);
             // Every cluster that has an install_info needs to be built
             // If a cluster only has an installed object and is marked as user requested we should still report it.
             if (auto info_ptr = p_cluster->m_install_info.get())
@@ -1207,7 +1219,7 @@ namespace vcpkg::Dependencies
                 std::vector<std::string> origins;
                 std::map<std::string, std::vector<FeatureSpec>> deps;
 
-                bool is_less_than(const Versions::Version& new_ver) const;
+                bool is_less_than(Versions::VersionComparer& comparer, const Versions::Version& new_ver) const;
             };
 
             struct PackageNode : Util::MoveOnlyBase
@@ -1227,6 +1239,8 @@ namespace vcpkg::Dependencies
             std::vector<DepSpec> m_roots;
             std::map<std::string, Versions::Version> m_overrides;
             std::map<PackageSpec, PackageNode> m_graph;
+            // The same few versions of each port are compared over and over while resolving
+            Versions::VersionComparer m_version_comparer;
 
             std::pair<const PackageSpec, PackageNode>& emplace_package(const PackageSpec& spec);
 
@@ -1315,7 +1329,8 @@ namespace vcpkg::Dependencies
 
         using Versions::VerComp;
 
-        static VerComp compare_versions(Versions::Scheme sa,
+        static VerComp compare_versions(Versions::VersionComparer& comparer,
+                                        Versions::Scheme sa,
                                         const Versions::Version& a,
                                         Versions::Scheme sb,
                                         const Versions::Version& b)
@@ -1324,7 +1339,7 @@ namespace vcpkg::Dependencies
 
             if (a.text() != b.text())
             {
-                auto result = Versions::compare(a.text(), b.text(), sa);
+                auto result = comparer.compare(a.text(), b.text(), sa);
                 if (result != VerComp::eq) return result;
             }
 
@@ -1333,12 +1348,13 @@ namespace vcpkg::Dependencies
             return VerComp::eq;
         }
 
-        bool VersionedPackageGraph::VersionSchemeInfo::is_less_than(const Versions::Version& new_ver) const
+        bool VersionedPackageGraph::VersionSchemeInfo::is_less_than(Versions::VersionComparer& comparer,
+                                                                    const Versions::Version& new_ver) const
         {
             Checks::check_exit(VCPKG_LINE_INFO, scfl);
             ASSUME(scfl != nullptr);
             auto scheme = scfl->source_control_file->core_paragraph->version_scheme;
-            auto r = compare_versions(scheme, version, scheme, new_ver);
+            auto r = compare_versions(comparer, scheme, version, scheme, new_ver);
             Checks::check_exit(VCPKG_LINE_INFO, r != VerComp::unk);
             return r == VerComp::lt;
         }
@@ -1489,7 +1505,7 @@ namespace vcpkg::Dependencies
                 }
                 else
                 {
-                    replace = exact_ref.is_less_than(version);
+                    replace = exact_ref.is_less_than(m_version_comparer, version);
                 }
 
                 if (replace)
@@ -1620,7 +1636,8 @@ namespace vcpkg::Dependencies
                         if (dep_scfl && base_scfl)
                         {
                             auto r =
-                                compare_versions(dep_scfl.get()->source_control_file->core_paragraph->version_scheme,
+                                compare_versions(m_version_comparer,
+                                                 dep_scfl.get()->source_control_file->core_paragraph->version_scheme,
                                                  *p_dep_ver,
                                                  base_scfl.get()->source_control_file->core_paragraph->version_scheme,
                                                  *p_base_ver);
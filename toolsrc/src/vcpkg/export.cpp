@@ -174,7 +174,7 @@ namespace vcpkg::Export
             .string_arg("-NoDefaultExcludes");
 
         const int exit_code =
-            System::cmd_execute_and_capture_output(cmd.extract(), System::get_clean_environment()).exit_code;
+            System::cmd_execute_and_capture_output(cmd, System::get_clean_environment()).exit_code;
         Checks::check_exit(VCPKG_LINE_INFO, exit_code == 0, "Error: NuGet package creation failed");
 
         const fs::path output_path = output_dir / (nuget_id + "." + nuget_version + ".nupkg");
@@ -561,8 +561,11 @@ namespace vcpkg::Export
                 files.push_back(paths.installed / fs::u8path(suffix));
             }
 
-            Install::install_files_and_write_listfile(
-                fs, paths.installed / action.spec.triplet().to_string(), files, dirs);
+            Install::install_files_and_write_listfile(fs,
+                                                      paths.installed / action.spec.triplet().to_string(),
+                                                      files,
+                                                      dirs,
+                                                      Install::InstallFileMode::LINK);
         }
 
         // Copy files needed for integration
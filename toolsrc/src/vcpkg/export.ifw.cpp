@@ -478,7 +478,7 @@ namespace vcpkg::Export::IFW
                                                                       ifw_package_dir_path / "vcpkg" / "info" /
                                                                           (binary_paragraph.fullstem() + ".list"));
 
-            Install::install_package_and_write_listfile(paths, action.spec, dirs);
+            Install::install_package_and_write_listfile(paths, action.spec, dirs, Install::InstallFileMode::LINK);
         }
 
         System::printf("Exporting packages %s... done\n", fs::generic_u8string(ifw_packages_dir_path));
@@ -1,5 +1,9 @@
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/parallel-algorithms.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/util.h>
 
@@ -7,6 +11,7 @@
 #include <vcpkg/build.h>
 #include <vcpkg/cmakevars.h>
 #include <vcpkg/commands.setinstalled.h>
+#include <vcpkg/commands.version.h>
 #include <vcpkg/dependencies.h>
 #include <vcpkg/globalstate.h>
 #include <vcpkg/help.h>
@@ -17,6 +22,12 @@
 #include <vcpkg/remove.h>
 #include <vcpkg/vcpkglib.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
 namespace vcpkg::Install
 {
     using namespace vcpkg;
@@ -43,19 +54,110 @@ namespace vcpkg::Install
 
     void install_package_and_write_listfile(const VcpkgPaths& paths,
                                             const PackageSpec& spec,
-                                            const InstallDir& destination_dir)
+                                            const InstallDir& destination_dir,
+                                            InstallFileMode mode)
     {
         auto& fs = paths.get_filesystem();
         auto source_dir = paths.package_dir(spec);
         Checks::check_exit(
             VCPKG_LINE_INFO, fs.exists(source_dir), "Source directory %s does not exist", fs::u8string(source_dir));
         auto files = fs.get_files_recursive(source_dir);
-        install_files_and_write_listfile(fs, source_dir, files, destination_dir);
+        install_files_and_write_listfile(fs, source_dir, files, destination_dir, mode);
+    }
+
+    namespace
+    {
+        // Places regular files according to an InstallFileMode. Whether a file can be renamed, cloned or hard linked
+        // into place depends on the filesystems of the source and destination, so a way which fails once is not tried
+        // again for later files. Files may be placed concurrently.
+        struct FilePlacer
+        {
+            FilePlacer(Files::Filesystem& fs, InstallFileMode mode)
+                : fs(fs), way(mode == InstallFileMode::MOVE ? Way::RENAME : Way::CLONE)
+            {
+            }
+
+            void place(const fs::path& source, const fs::path& target, bool target_exists, std::error_code& ec)
+            {
+                Way current = way.load();
+                if (target_exists && current != Way::COPY)
+                {
+                    fs.remove(target, ec);
+                    if (ec) return;
+                }
+
+                for (;;)
+                {
+                    switch (current)
+                    {
+                        case Way::RENAME: fs.rename(source, target, ec); break;
+                        case Way::CLONE: fs.clone_file(source, target, ec); break;
+                        case Way::HARD_LINK: fs.create_hard_link(source, target, ec); break;
+                        case Way::COPY: fs.copy_file(source, target, fs::copy_options::overwrite_existing, ec); return;
+                        default: Checks::unreachable(VCPKG_LINE_INFO);
+                    }
+
+                    if (!ec) return;
+
+                    Debug::print("Could not ",
+                                 way_name(current),
+                                 " ",
+                                 fs::u8string(source),
+                                 " into place (",
+                                 ec.message(),
+                                 "); falling back\n");
+                    const Way next = current == Way::CLONE ? Way::HARD_LINK : Way::COPY;
+                    // another thread may have given up on `current` already
+                    if (way.compare_exchange_strong(current, next)) current = next;
+                }
+            }
+
+        private:
+            enum class Way
+            {
+                RENAME,
+                CLONE,
+                HARD_LINK,
+                COPY,
+            };
+
+            static StringLiteral way_name(Way way)
+            {
+                switch (way)
+                {
+                    case Way::RENAME: return "rename";
+                    case Way::CLONE: return "clone";
+                    case Way::HARD_LINK: return "hard link";
+                    case Way::COPY: return "copy";
+                    default: Checks::unreachable(VCPKG_LINE_INFO);
+                }
+            }
+
+            Files::Filesystem& fs;
+            std::atomic<Way> way;
+        };
+
+        // A regular file or symlink of a package, which is placed once all directories exist.
+        struct PendingFile
+        {
+            const fs::path* source;
+            fs::path target;
+            fs::file_type type;
+            bool target_existed = false;
+            std::error_code ec;
+        };
+
+        void print_install_failure(const fs::path& path, const std::error_code& ec)
+        {
+            System::printf(System::Color::error, "failed: %s: %s\n", fs::u8string(path), ec.message());
+        }
     }
+
     void install_files_and_write_listfile(Files::Filesystem& fs,
                                           const fs::path& source_dir,
                                           const std::vector<fs::path>& files,
-                                          const InstallDir& destination_dir)
+                                          const InstallDir& destination_dir,
+                                          InstallFileMode mode)
     {
         std::vector<std::string> output;
         std::error_code ec;
@@ -72,13 +174,21 @@ namespace vcpkg::Install
         fs.create_directories(listfile_parent, ec);
         Checks::check_exit(VCPKG_LINE_INFO, !ec, "Could not create directory for listfile %s", fs::u8string(listfile));
 
+        std::vector<std::pair<fs::file_status, std::error_code>> statuses(files.size());
+        execute_in_parallel(files.size(), [&](size_t i) {
+            statuses[i].first = fs.symlink_status(files[i], statuses[i].second);
+        });
+
+        // Directories are created in one pass, in order, so that parents exist before their contents
+        std::vector<PendingFile> pending;
         output.push_back(Strings::format(R"(%s/)", destination_subdirectory));
-        for (auto&& file : files)
+        for (size_t i = 0; i < files.size(); ++i)
         {
-            const auto status = fs.symlink_status(file, ec);
-            if (ec)
+            const fs::path& file = files[i];
+            const fs::file_status status = statuses[i].first;
+            if (statuses[i].second)
             {
-                System::print2(System::Color::error, "failed: ", fs::u8string(file), ": ", ec.message(), "\n");
+                print_install_failure(file, statuses[i].second);
                 continue;
             }
 
@@ -92,7 +202,7 @@ namespace vcpkg::Install
             }
 
             const std::string suffix = fs::generic_u8string(file).substr(prefix_length + 1);
-            const fs::path target = destination / suffix;
+            fs::path target = destination / suffix;
 
             switch (status.type())
             {
@@ -101,7 +211,7 @@ namespace vcpkg::Install
                     fs.create_directory(target, ec);
                     if (ec)
                     {
-                        System::printf(System::Color::error, "failed: %s: %s\n", fs::u8string(target), ec.message());
+                        print_install_failure(target, ec);
                     }
 
                     // Trailing backslash for directories
@@ -109,36 +219,9 @@ namespace vcpkg::Install
                     break;
                 }
                 case fs::file_type::regular:
-                {
-                    if (fs.exists(target))
-                    {
-                        System::print2(System::Color::warning,
-                                       "File ",
-                                       fs::u8string(target),
-                                       " was already present and will be overwritten\n");
-                    }
-                    fs.copy_file(file, target, fs::copy_options::overwrite_existing, ec);
-                    if (ec)
-                    {
-                        System::printf(System::Color::error, "failed: %s: %s\n", fs::u8string(target), ec.message());
-                    }
-                    output.push_back(Strings::format(R"(%s/%s)", destination_subdirectory, suffix));
-                    break;
-                }
                 case fs::file_type::symlink:
                 {
-                    if (fs.exists(target))
-                    {
-                        System::print2(System::Color::warning,
-                                       "File ",
-                                       fs::u8string(target),
-                                       " was already present and will be overwritten\n");
-                    }
-                    fs.copy_symlink(file, target, ec);
-                    if (ec)
-                    {
-                        System::printf(System::Color::error, "failed: %s: %s\n", fs::u8string(target), ec.message());
-                    }
+                    pending.push_back({&file, std::move(target), status.type()});
                     output.push_back(Strings::format(R"(%s/%s)", destination_subdirectory, suffix));
                     break;
                 }
@@ -148,36 +231,40 @@ namespace vcpkg::Install
             }
         }
 
-        std::sort(output.begin(), output.end());
-
-        fs.write_lines(listfile, output, VCPKG_LINE_INFO);
-    }
+        FilePlacer placer(fs, mode);
+        execute_in_parallel(pending.size(), [&](size_t i) {
+            PendingFile& file = pending[i];
+            file.target_existed = fs.exists(file.target);
+            if (file.type == fs::file_type::regular)
+            {
+                placer.place(*file.source, file.target, file.target_existed, file.ec);
+            }
+            else
+            {
+                fs.copy_symlink(*file.source, file.target, file.ec);
+            }
+        });
 
-    static std::vector<file_pack> extract_files_in_triplet(
-        const std::vector<StatusParagraphAndAssociatedFiles>& pgh_and_files,
-        Triplet triplet,
-        const size_t remove_chars = 0)
-    {
-        std::vector<file_pack> output;
-        for (const StatusParagraphAndAssociatedFiles& t : pgh_and_files)
+        // Reported in the order of `files`, whichever order they were placed in
+        for (auto&& file : pending)
         {
-            if (t.pgh.package.spec.triplet() != triplet)
+            if (file.target_existed)
             {
-                continue;
+                System::print2(System::Color::warning,
+                               "File ",
+                               fs::u8string(file.target),
+                               " was already present and will be overwritten\n");
             }
 
-            const std::string name = t.pgh.package.displayname();
-
-            for (const std::string& file : t.files)
+            if (file.ec)
             {
-                output.emplace_back(file_pack{std::string(file, remove_chars), name});
+                print_install_failure(file.target, file.ec);
             }
         }
 
-        std::sort(output.begin(), output.end(), [](const file_pack& lhs, const file_pack& rhs) {
-            return lhs.first < rhs.first;
-        });
-        return output;
+        std::sort(output.begin(), output.end());
+
+        fs.write_lines(listfile, output, VCPKG_LINE_INFO);
     }
 
     static SortedVector<std::string> build_list_of_package_files(const Files::Filesystem& fs,
@@ -192,48 +279,32 @@ namespace vcpkg::Install
         return SortedVector<std::string>(std::move(package_files));
     }
 
-    static SortedVector<file_pack> build_list_of_installed_files(
-        const std::vector<StatusParagraphAndAssociatedFiles>& pgh_and_files, Triplet triplet)
-    {
-        const size_t installed_remove_char_count = triplet.canonical_name().size() + 1; // +1 for the slash
-        std::vector<file_pack> installed_files =
-            extract_files_in_triplet(pgh_and_files, triplet, installed_remove_char_count);
-
-        return SortedVector<file_pack>(std::move(installed_files));
-    }
-
-    InstallResult install_package(const VcpkgPaths& paths, const BinaryControlFile& bcf, StatusParagraphs* status_db)
+    InstallResult install_package(const VcpkgPaths& paths,
+                                  const BinaryControlFile& bcf,
+                                  StatusParagraphs* status_db,
+                                  InstallFileMode mode)
     {
         const fs::path package_dir = paths.package_dir(bcf.core_paragraph.spec);
         Triplet triplet = bcf.core_paragraph.spec.triplet();
-        const std::vector<StatusParagraphAndAssociatedFiles> pgh_and_files = get_installed_files(paths, *status_db);
+        InstalledFilesIndex& installed_files = InstalledFilesIndex::get(paths, *status_db);
 
         const SortedVector<std::string> package_files =
             build_list_of_package_files(paths.get_filesystem(), package_dir);
-        const SortedVector<file_pack> installed_files = build_list_of_installed_files(pgh_and_files, triplet);
-
-        struct intersection_compare
-        {
-            // The VS2015 standard library requires comparison operators of T and U
-            // to also support comparison of T and T, and of U and U, due to debug checks.
-#if _MSC_VER <= 1910
-            bool operator()(const std::string& lhs, const std::string& rhs) { return lhs < rhs; }
-            bool operator()(const file_pack& lhs, const file_pack& rhs) { return lhs.first < rhs.first; }
-#endif
-            bool operator()(const std::string& lhs, const file_pack& rhs) { return lhs < rhs.first; }
-            bool operator()(const file_pack& lhs, const std::string& rhs) { return lhs.first < rhs; }
-        };
 
         std::vector<file_pack> intersection;
+        std::string installed_path = triplet.canonical_name() + '/';
+        const size_t installed_prefix_length = installed_path.size();
+        for (auto&& package_file : package_files)
+        {
+            installed_path.resize(installed_prefix_length);
+            installed_path.append(package_file);
+            if (auto owner = installed_files.find_owner(installed_path))
+            {
+                intersection.emplace_back(package_file, owner->displayname);
+            }
+        }
 
-        std::set_intersection(installed_files.begin(),
-                              installed_files.end(),
-                              package_files.begin(),
-                              package_files.end(),
-                              std::back_inserter(intersection),
-                              intersection_compare());
-
-        std::sort(intersection.begin(), intersection.end(), [](const file_pack& lhs, const file_pack& rhs) {
+        std::stable_sort(intersection.begin(), intersection.end(), [](const file_pack& lhs, const file_pack& rhs) {
             return lhs.second < rhs.second;
         });
 
@@ -261,42 +332,41 @@ namespace vcpkg::Install
             return InstallResult::FILE_CONFLICTS;
         }
 
-        StatusParagraph source_paragraph;
-        source_paragraph.package = bcf.core_paragraph;
-        source_paragraph.want = Want::INSTALL;
-        source_paragraph.state = InstallState::HALF_INSTALLED;
-
-        write_update(paths, source_paragraph);
-        status_db->insert(std::make_unique<StatusParagraph>(source_paragraph));
-
-        std::vector<StatusParagraph> features_spghs;
-        for (auto&& feature : bcf.features)
+        // The core paragraph comes first, then one paragraph per feature
+        std::vector<StatusParagraph> spghs(1 + bcf.features.size());
+        spghs[0].package = bcf.core_paragraph;
+        for (size_t i = 0; i < bcf.features.size(); ++i)
         {
-            features_spghs.emplace_back();
+            spghs[i + 1].package = bcf.features[i];
+        }
 
-            StatusParagraph& feature_paragraph = features_spghs.back();
-            feature_paragraph.package = feature;
-            feature_paragraph.want = Want::INSTALL;
-            feature_paragraph.state = InstallState::HALF_INSTALLED;
+        for (auto&& spgh : spghs)
+        {
+            spgh.want = Want::INSTALL;
+            spgh.state = InstallState::HALF_INSTALLED;
+        }
 
-            write_update(paths, feature_paragraph);
-            status_db->insert(std::make_unique<StatusParagraph>(feature_paragraph));
+        write_updates(paths, spghs);
+        for (auto&& spgh : spghs)
+        {
+            status_db->insert(std::make_unique<StatusParagraph>(spgh));
         }
 
         const InstallDir install_dir = InstallDir::from_destination_root(
             paths.installed, triplet.to_string(), paths.listfile_path(bcf.core_paragraph));
 
-        install_package_and_write_listfile(paths, bcf.core_paragraph.spec, install_dir);
+        install_package_and_write_listfile(paths, bcf.core_paragraph.spec, install_dir, mode);
+        installed_files.add_package(paths, bcf.core_paragraph);
 
-        source_paragraph.state = InstallState::INSTALLED;
-        write_update(paths, source_paragraph);
-        status_db->insert(std::make_unique<StatusParagraph>(source_paragraph));
+        for (auto&& spgh : spghs)
+        {
+            spgh.state = InstallState::INSTALLED;
+        }
 
-        for (auto&& feature_paragraph : features_spghs)
+        write_updates(paths, spghs);
+        for (auto&& spgh : spghs)
         {
-            feature_paragraph.state = InstallState::INSTALLED;
-            write_update(paths, feature_paragraph);
-            status_db->insert(std::make_unique<StatusParagraph>(feature_paragraph));
+            status_db->insert(std::make_unique<StatusParagraph>(std::move(spgh)));
         }
 
         return InstallResult::SUCCESS;
@@ -305,6 +375,78 @@ namespace vcpkg::Install
     using Build::BuildResult;
     using Build::ExtendedBuildResult;
 
+    static void clean_downloads(const VcpkgPaths& paths)
+    {
+        auto& fs = paths.get_filesystem();
+        const fs::path download_dir = paths.downloads;
+        for (auto& p : fs.get_files_non_recursive(download_dir))
+        {
+            if (!fs.is_directory(p))
+            {
+                fs.remove(p, VCPKG_LINE_INFO);
+            }
+        }
+    }
+
+    // Reports the result of building `action` and, on success, installs the built package.
+    static ExtendedBuildResult install_built_package(const VcpkgPaths& paths,
+                                                     InstallPlanAction& action,
+                                                     ExtendedBuildResult&& result,
+                                                     StatusParagraphs& status_db)
+    {
+        const std::string display_name_with_features = action.displayname();
+
+        if (BuildResult::DOWNLOADED == result.code)
+        {
+            System::print2(System::Color::success, "Downloaded sources for package ", display_name_with_features, "\n");
+            return std::move(result);
+        }
+
+        if (result.code != Build::BuildResult::SUCCEEDED)
+        {
+            System::print2(System::Color::error, Build::create_error_message(result.code, action.spec), "\n");
+            return std::move(result);
+        }
+
+        System::printf("Building package %s... done\n", display_name_with_features);
+
+        auto bcf = std::make_unique<BinaryControlFile>(
+            Paragraphs::try_load_cached_package(paths, action.spec).value_or_exit(VCPKG_LINE_INFO));
+        System::printf("Installing package %s...\n", display_name_with_features);
+        // The package directory is only worth keeping intact when it is not removed right after installing
+        const auto install_mode = action.build_options.clean_packages == Build::CleanPackages::YES
+                                      ? InstallFileMode::MOVE
+                                      : InstallFileMode::LINK;
+        const auto install_result = install_package(paths, *bcf, &status_db, install_mode);
+        BuildResult code;
+        switch (install_result)
+        {
+            case InstallResult::SUCCESS:
+                System::printf(System::Color::success, "Installing package %s... done\n", display_name_with_features);
+                code = BuildResult::SUCCEEDED;
+                break;
+            case InstallResult::FILE_CONFLICTS: code = BuildResult::FILE_CONFLICTS; break;
+            default: Checks::unreachable(VCPKG_LINE_INFO);
+        }
+
+        if (action.build_options.clean_packages == Build::CleanPackages::YES)
+        {
+            auto& fs = paths.get_filesystem();
+            const fs::path package_dir = paths.package_dir(action.spec);
+            fs.remove_all(package_dir, VCPKG_LINE_INFO);
+        }
+
+        return {code, std::move(bcf)};
+    }
+
+    static void print_building_package(const InstallPlanAction& action)
+    {
+        if (Util::Enum::to_bool(action.build_options.use_head_version))
+            System::printf("Building package %s from HEAD...\n", action.displayname());
+        else
+            System::printf("Building package %s...\n", action.displayname());
+    }
+
     static ExtendedBuildResult perform_install_plan_action(const VcpkgCmdArguments& args,
                                                            const VcpkgPaths& paths,
                                                            InstallPlanAction& action,
@@ -314,7 +456,6 @@ namespace vcpkg::Install
     {
         const InstallPlanType& plan_type = action.plan_type;
         const std::string display_name = action.spec.to_string();
-        const std::string display_name_with_features = action.displayname();
 
         const bool is_user_requested = action.request_type == RequestType::USER_REQUESTED;
         const bool use_head_version = Util::Enum::to_bool(action.build_options.use_head_version);
@@ -332,66 +473,22 @@ namespace vcpkg::Install
 
         if (plan_type == InstallPlanType::BUILD_AND_INSTALL)
         {
-            if (use_head_version)
-                System::printf("Building package %s from HEAD...\n", display_name_with_features);
-            else
-                System::printf("Building package %s...\n", display_name_with_features);
-
-            auto result = Build::build_package(args, paths, action, binaries_provider, build_logs_recorder, status_db);
-
-            if (BuildResult::DOWNLOADED == result.code)
-            {
-                System::print2(
-                    System::Color::success, "Downloaded sources for package ", display_name_with_features, "\n");
-                return result;
-            }
-
-            if (result.code != Build::BuildResult::SUCCEEDED)
-            {
-                System::print2(System::Color::error, Build::create_error_message(result.code, action.spec), "\n");
-                return result;
-            }
-
-            System::printf("Building package %s... done\n", display_name_with_features);
-
-            auto bcf = std::make_unique<BinaryControlFile>(
-                Paragraphs::try_load_cached_package(paths, action.spec).value_or_exit(VCPKG_LINE_INFO));
-            System::printf("Installing package %s...\n", display_name_with_features);
-            const auto install_result = install_package(paths, *bcf, &status_db);
-            BuildResult code;
-            switch (install_result)
-            {
-                case InstallResult::SUCCESS:
-                    System::printf(
-                        System::Color::success, "Installing package %s... done\n", display_name_with_features);
-                    code = BuildResult::SUCCEEDED;
-                    break;
-                case InstallResult::FILE_CONFLICTS: code = BuildResult::FILE_CONFLICTS; break;
-                default: Checks::unreachable(VCPKG_LINE_INFO);
-            }
+            print_building_package(action);
 
-            if (action.build_options.clean_packages == Build::CleanPackages::YES)
-            {
-                auto& fs = paths.get_filesystem();
-                const fs::path package_dir = paths.package_dir(action.spec);
-                fs.remove_all(package_dir, VCPKG_LINE_INFO);
-            }
+            auto result = install_built_package(
+                paths,
+                action,
+                Build::build_package(args, paths, action, binaries_provider, build_logs_recorder, status_db),
+                status_db);
 
-            if (action.build_options.clean_downloads == Build::CleanDownloads::YES)
+            const bool reached_install =
+                result.code == BuildResult::SUCCEEDED || result.code == BuildResult::FILE_CONFLICTS;
+            if (reached_install && action.build_options.clean_downloads == Build::CleanDownloads::YES)
             {
-                auto& fs = paths.get_filesystem();
-                const fs::path download_dir = paths.downloads;
-                std::error_code ec;
-                for (auto& p : fs.get_files_non_recursive(download_dir))
-                {
-                    if (!fs.is_directory(p))
-                    {
-                        fs.remove(p, VCPKG_LINE_INFO);
-                    }
-                }
+                clean_downloads(paths);
             }
 
-            return {code, std::move(bcf)};
+            return result;
         }
 
         if (plan_type == InstallPlanType::EXCLUDED)
@@ -456,6 +553,316 @@ namespace vcpkg::Install
         TrackedPackageInstallGuard& operator=(const TrackedPackageInstallGuard&) = delete;
     };
 
+    void run_install_actions_in_parallel(std::vector<InstallPlanAction>& actions,
+                                         const size_t jobs,
+                                         const KeepGoing keep_going,
+                                         IInstallActionRunner& runner)
+    {
+        const size_t action_total = actions.size();
+        std::unordered_map<PackageSpec, size_t> index_of;
+        for (size_t i = 0; i < action_total; ++i)
+        {
+            index_of.emplace(actions[i].spec, i);
+        }
+
+        std::vector<size_t> waiting_on(action_total, 0);
+        std::vector<std::vector<size_t>> dependents(action_total);
+        for (size_t i = 0; i < action_total; ++i)
+        {
+            std::vector<size_t> dependencies;
+            for (auto&& pspec : actions[i].package_dependencies)
+            {
+                auto it = index_of.find(pspec);
+                if (it != index_of.end() && it->second != i) dependencies.push_back(it->second);
+            }
+
+            Util::sort_unique_erase(dependencies);
+            waiting_on[i] = dependencies.size();
+            for (auto&& dependency : dependencies)
+            {
+                dependents[dependency].push_back(i);
+            }
+        }
+
+        // ordered so that independent actions still start in plan order
+        std::set<size_t> ready;
+        for (size_t i = 0; i < action_total; ++i)
+        {
+            if (waiting_on[i] == 0) ready.insert(i);
+        }
+
+        struct Completion
+        {
+            size_t index;
+            ExtendedBuildResult result;
+            // set when the build tried to exit the tool
+            Optional<int> exit_code;
+        };
+
+        std::mutex completions_mutex;
+        std::condition_variable completions_cv;
+        std::vector<Completion> completions;
+
+        std::vector<std::thread> threads(action_total);
+        size_t in_flight = 0;
+        size_t finished = 0;
+        bool stopped = false;
+        Optional<int> exit_code;
+
+        auto finish = [&](size_t i, ExtendedBuildResult&& result) {
+            if (result.code != BuildResult::SUCCEEDED && keep_going == KeepGoing::NO) stopped = true;
+            runner.finish(actions[i], std::move(result), in_flight);
+            ++finished;
+            for (auto&& dependent : dependents[i])
+            {
+                if (--waiting_on[dependent] == 0) ready.insert(dependent);
+            }
+        };
+
+        while (finished < action_total)
+        {
+            while (!stopped && in_flight < jobs && !ready.empty())
+            {
+                const size_t i = *ready.begin();
+                ready.erase(ready.begin());
+                if (auto result = runner.start(actions[i]))
+                {
+                    finish(i, std::move(*result.get()));
+                    continue;
+                }
+
+                ++in_flight;
+                threads[i] = std::thread([&, i] {
+                    // An exit would tear down the tool under the other builds, so it is left to the calling thread.
+                    ExtendedBuildResult result{BuildResult::BUILD_FAILED};
+                    int code = EXIT_FAILURE;
+                    const bool exited = Checks::run_catching_exit([&] { result = runner.build(actions[i]); }, code);
+                    std::lock_guard<std::mutex> lock(completions_mutex);
+                    completions.push_back({i, std::move(result), exited ? Optional<int>(code) : nullopt});
+                    completions_cv.notify_one();
+                });
+            }
+
+            if (in_flight == 0)
+            {
+                Checks::check_exit(VCPKG_LINE_INFO,
+                                   stopped || ready.empty(),
+                                   "Could not find an action whose dependencies were satisfied");
+                break;
+            }
+
+            std::vector<Completion> completed;
+            {
+                std::unique_lock<std::mutex> lock(completions_mutex);
+                completions_cv.wait(lock, [&] { return !completions.empty(); });
+                completed.swap(completions);
+            }
+
+            for (auto&& completion : completed)
+            {
+                threads[completion.index].join();
+                --in_flight;
+                if (auto code = completion.exit_code.get())
+                {
+                    stopped = true;
+                    if (!exit_code) exit_code = *code;
+                    continue;
+                }
+
+                finish(completion.index, runner.install(actions[completion.index], std::move(completion.result)));
+            }
+        }
+
+        if (auto code = exit_code.get())
+        {
+            Checks::exit_with_code(VCPKG_LINE_INFO, *code);
+        }
+
+        Checks::check_exit(
+            VCPKG_LINE_INFO, stopped || finished == action_total, "Not all actions in the plan were performed");
+    }
+
+    namespace
+    {
+        struct InstallActionRunner final : IInstallActionRunner
+        {
+            const VcpkgCmdArguments& args;
+            const VcpkgPaths& paths;
+            const std::vector<InstallPlanAction>& actions;
+            StatusParagraphs& status_db;
+            IBinaryProvider& binaryprovider;
+            const Build::IBuildLogsRecorder& build_logs_recorder;
+            size_t action_index;
+            const size_t action_count;
+
+            // in the order of `actions`
+            std::vector<Chrono::ElapsedTimer> timers;
+            std::vector<SpecSummary> summaries;
+            Optional<PackageSpec> first_failure;
+            bool needs_clean_downloads = false;
+
+            InstallActionRunner(const VcpkgCmdArguments& args,
+                                const VcpkgPaths& paths,
+                                const std::vector<InstallPlanAction>& actions,
+                                StatusParagraphs& status_db,
+                                IBinaryProvider& binaryprovider,
+                                const Build::IBuildLogsRecorder& build_logs_recorder,
+                                size_t action_index,
+                                size_t action_count)
+                : args(args)
+                , paths(paths)
+                , actions(actions)
+                , status_db(status_db)
+                , binaryprovider(binaryprovider)
+                , build_logs_recorder(build_logs_recorder)
+                , action_index(action_index)
+                , action_count(action_count)
+                , timers(actions.size())
+            {
+                summaries.reserve(actions.size());
+                for (auto&& action : actions)
+                {
+                    summaries.emplace_back(action.spec, &action);
+                }
+            }
+
+            size_t index_of(const InstallPlanAction& action) const { return &action - actions.data(); }
+
+            Optional<ExtendedBuildResult> start(InstallPlanAction& action) override
+            {
+                System::printf("Starting package %zd/%zd: %s\n", action_index++, action_count, action.spec);
+                timers[index_of(action)] = Chrono::ElapsedTimer::create_started();
+                if (action.plan_type != InstallPlanType::BUILD_AND_INSTALL)
+                {
+                    return perform_install_plan_action(
+                        args, paths, action, status_db, binaryprovider, build_logs_recorder);
+                }
+
+                auto missing_fspecs = Build::find_missing_dependencies(action, status_db);
+                if (!missing_fspecs.empty() && !Util::Enum::to_bool(action.build_options.only_downloads))
+                {
+                    return install_built_package(
+                        paths,
+                        action,
+                        {BuildResult::CASCADED_DUE_TO_MISSING_DEPENDENCIES, std::move(missing_fspecs)},
+                        status_db);
+                }
+
+                print_building_package(action);
+                return nullopt;
+            }
+
+            ExtendedBuildResult build(const InstallPlanAction& action) override
+            {
+                return Build::build_package_with_installed_dependencies(
+                    args, paths, action, binaryprovider, build_logs_recorder);
+            }
+
+            ExtendedBuildResult install(InstallPlanAction& action, ExtendedBuildResult&& result) override
+            {
+                auto installed = install_built_package(paths, action, std::move(result), status_db);
+                if ((installed.code == BuildResult::SUCCEEDED || installed.code == BuildResult::FILE_CONFLICTS) &&
+                    action.build_options.clean_downloads == Build::CleanDownloads::YES)
+                {
+                    needs_clean_downloads = true;
+                }
+
+                return installed;
+            }
+
+            void finish(InstallPlanAction& action, ExtendedBuildResult&& result, size_t builds_running) override
+            {
+                auto& summary = summaries[index_of(action)];
+                summary.timing = timers[index_of(action)].elapsed();
+                System::printf("Elapsed time for package %s: %s\n", summary.spec, summary.timing);
+                if (result.code != BuildResult::SUCCEEDED && !first_failure) first_failure = action.spec;
+                summary.build_result = std::move(result);
+
+                // other builds may still be reading from the downloads directory
+                if (needs_clean_downloads && builds_running == 0)
+                {
+                    clean_downloads(paths);
+                    needs_clean_downloads = false;
+                }
+            }
+        };
+    }
+
+    // Builds up to `jobs` actions at once, starting each as soon as its dependencies within the plan have finished.
+    // Installing the built packages into the status database is done on the calling thread.
+    static void perform_install_actions_in_parallel(const VcpkgCmdArguments& args,
+                                                    const VcpkgPaths& paths,
+                                                    std::vector<InstallPlanAction>& actions,
+                                                    const size_t jobs,
+                                                    const KeepGoing keep_going,
+                                                    StatusParagraphs& status_db,
+                                                    IBinaryProvider& binaryprovider,
+                                                    const Build::IBuildLogsRecorder& build_logs_recorder,
+                                                    size_t action_index,
+                                                    const size_t action_count,
+                                                    std::vector<SpecSummary>& results)
+    {
+        InstallActionRunner runner(
+            args, paths, actions, status_db, binaryprovider, build_logs_recorder, action_index, action_count);
+        run_install_actions_in_parallel(actions, jobs, keep_going, runner);
+
+        if (keep_going == KeepGoing::NO)
+        {
+            if (auto failed = runner.first_failure.get())
+            {
+                InstalledFilesIndex::get(paths, status_db).save(paths);
+                System::print2(Build::create_user_troubleshooting_message(*failed), '\n');
+                Checks::exit_fail(VCPKG_LINE_INFO);
+            }
+        }
+
+        for (auto&& summary : runner.summaries)
+        {
+            results.push_back(std::move(summary));
+        }
+    }
+
+    static size_t get_parallel_jobs(const VcpkgCmdArguments& args)
+    {
+        if (!args.jobs) return 1;
+
+        auto maybe_jobs = Strings::strto<int>(*args.jobs);
+        if (auto jobs = maybe_jobs.get())
+        {
+            if (*jobs > 0) return static_cast<size_t>(*jobs);
+        }
+
+        Checks::exit_with_message(VCPKG_LINE_INFO,
+                                  "Invalid value for --%s: '%s'. It must be a positive integer.",
+                                  VcpkgCmdArguments::JOBS_ARG,
+                                  *args.jobs);
+    }
+
+    static int get_cores_per_job(const VcpkgCmdArguments& args, const size_t jobs)
+    {
+        if (args.cores_per_job)
+        {
+            auto maybe_cores = Strings::strto<int>(*args.cores_per_job);
+            if (auto cores = maybe_cores.get())
+            {
+                if (*cores > 0) return *cores;
+            }
+
+            Checks::exit_with_message(VCPKG_LINE_INFO,
+                                      "Invalid value for --%s: '%s'. It must be a positive integer.",
+                                      VcpkgCmdArguments::CORES_PER_JOB_ARG,
+                                      *args.cores_per_job);
+        }
+
+        // Without an explicit budget, VCPKG_MAX_CONCURRENCY (if set) is used by every job unchanged.
+        if (jobs <= 1 || System::get_environment_variable("VCPKG_MAX_CONCURRENCY").has_value())
+        {
+            return 0;
+        }
+
+        return std::max(1, (System::get_num_logical_cores() + 1) / static_cast<int>(jobs));
+    }
+
     InstallSummary perform(const VcpkgCmdArguments& args,
                            ActionPlan& action_plan,
                            const KeepGoing keep_going,
@@ -488,21 +895,42 @@ namespace vcpkg::Install
         auto to_prefetch = Util::fmap(action_plan.install_actions, [](const auto& x) { return &x; });
         binaryprovider.prefetch(paths, to_prefetch);
 
-        for (auto&& action : action_plan.install_actions)
+        const size_t jobs = get_parallel_jobs(args);
+        Build::set_parallel_build_jobs(jobs, get_cores_per_job(args, jobs));
+        if (jobs > 1)
         {
-            TrackedPackageInstallGuard this_install(action_index++, action_count, results, action.spec);
-            auto result =
-                perform_install_plan_action(args, paths, action, status_db, binaryprovider, build_logs_recorder);
-            if (result.code != BuildResult::SUCCEEDED && keep_going == KeepGoing::NO)
+            perform_install_actions_in_parallel(args,
+                                                paths,
+                                                action_plan.install_actions,
+                                                jobs,
+                                                keep_going,
+                                                status_db,
+                                                binaryprovider,
+                                                build_logs_recorder,
+                                                action_index,
+                                                action_count,
+                                                results);
+        }
+        else
+        {
+            for (auto&& action : action_plan.install_actions)
             {
-                System::print2(Build::create_user_troubleshooting_message(action.spec), '\n');
-                Checks::exit_fail(VCPKG_LINE_INFO);
-            }
+                TrackedPackageInstallGuard this_install(action_index++, action_count, results, action.spec);
+                auto result =
+                    perform_install_plan_action(args, paths, action, status_db, binaryprovider, build_logs_recorder);
+                if (result.code != BuildResult::SUCCEEDED && keep_going == KeepGoing::NO)
+                {
+                    InstalledFilesIndex::get(paths, status_db).save(paths);
+                    System::print2(Build::create_user_troubleshooting_message(action.spec), '\n');
+                    Checks::exit_fail(VCPKG_LINE_INFO);
+                }
 
-            this_install.current_summary->action = &action;
-            this_install.current_summary->build_result = std::move(result);
+                this_install.current_summary->action = &action;
+                this_install.current_summary->build_result = std::move(result);
+            }
         }
 
+        InstalledFilesIndex::get(paths, status_db).save(paths);
         return InstallSummary{std::move(results), timer.to_string()};
     }
 
@@ -746,6 +1174,199 @@ namespace vcpkg::Install
         return ret;
     }
 
+    static constexpr StringLiteral MANIFEST_FINGERPRINT_HEADER = "vcpkg manifest install fingerprint v1";
+
+    static std::string get_stat_stamp(const fs::path& path)
+    {
+        auto maybe_stamp = CacheFile::get_file_stamp(path);
+        const auto stamp = maybe_stamp.get();
+        if (!stamp) return "missing";
+        return Strings::concat(stamp->size, ':', stamp->write_time);
+    }
+
+    static std::string get_tree_stamp(const fs::path& dir)
+    {
+        std::vector<std::string> entries;
+        std::error_code ec;
+        for (fs::stdfs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            entries.push_back(Strings::concat(fs::u8string(it->path()), '\t', get_stat_stamp(it->path())));
+        }
+
+        if (ec) return "missing";
+        // the order of directory iteration is unspecified
+        Util::sort(entries);
+        return Hash::get_string_hash(Strings::join("\n", entries), Hash::Algorithm::Sha256);
+    }
+
+    ManifestFingerprint::ManifestFingerprint(const VcpkgPaths& paths,
+                                             const VcpkgCmdArguments& args,
+                                             const ParsedArguments& options,
+                                             Triplet default_triplet,
+                                             const std::vector<std::string>& features)
+        : m_paths(paths)
+        , m_fingerprint_file(paths.vcpkg_dir / fs::u8path("manifest-fingerprint"))
+        , m_triplet(default_triplet)
+        , m_versions(args.versions_enabled())
+    {
+        Strings::append(m_inputs, "vcpkg-version\t", Commands::Version::version(), '\n');
+        Strings::append(m_inputs, "triplet\t", default_triplet, '\n');
+        Strings::append(m_inputs, "features\t", Strings::join(",", features), '\n');
+        Strings::append(m_inputs, "versions\t", args.versions_enabled() ? "1" : "0", '\n');
+        Strings::append(m_inputs, "compiler-tracking\t", args.compiler_tracking_enabled() ? "1" : "0", '\n');
+        Strings::append(m_inputs, "overlay-ports\t", Strings::join(";", args.overlay_ports), '\n');
+        Strings::append(m_inputs, "overlay-triplets\t", Strings::join(";", args.overlay_triplets), '\n');
+        Strings::append(m_inputs, "binary-caching\t", args.binary_caching_enabled() ? "1" : "0", '\n');
+        Strings::append(m_inputs, "binary-sources\t", Strings::join(";", args.binary_sources), '\n');
+        Strings::append(m_inputs, "cmake-args\t", Strings::join(";", args.cmake_args), '\n');
+
+        // Neither a dry run nor writing a packages config changes what is installed
+        std::vector<std::string> switches;
+        for (auto&& option : options.switches)
+        {
+            if (option != OPTION_DRY_RUN) switches.push_back(option);
+        }
+
+        std::vector<std::string> settings;
+        for (auto&& option : options.settings)
+        {
+            if (option.first != OPTION_WRITE_PACKAGES_CONFIG) settings.push_back(option.first + "=" + option.second);
+        }
+
+        Util::sort(switches);
+        Util::sort(settings);
+        Strings::append(m_inputs, "switches\t", Strings::join(";", switches), '\n');
+        Strings::append(m_inputs, "settings\t", Strings::join(";", settings), '\n');
+
+        std::string environment = Build::get_compiler_environment();
+        static constexpr StringLiteral s_vcpkg_vars[] = {"VCPKG_BINARY_SOURCES", "VCPKG_DEFAULT_BINARY_CACHE"};
+        for (auto var : s_vcpkg_vars)
+        {
+            Strings::append(environment, var, '=', System::get_environment_variable(var).value_or(""), '\n');
+        }
+
+        Strings::append(
+            m_inputs, "environment\t", Hash::get_string_hash(environment, Hash::Algorithm::Sha256), '\n');
+
+        // Ports or triplets added to an overlay directory change its write time
+        for (auto&& overlay : args.overlay_ports)
+        {
+            m_stat_paths.push_back(Files::combine(paths.original_cwd, fs::u8path(overlay)));
+        }
+
+        for (auto&& overlay : args.overlay_triplets)
+        {
+            m_stat_paths.push_back(Files::combine(paths.original_cwd, fs::u8path(overlay)));
+        }
+    }
+
+    // Format: after the header line, the inputs as "<name>\t<value>" lines, then one "stat\t<stamp>\t<path>" or
+    // "tree\t<stamp>\t<path>" line per tracked path.
+    std::string ManifestFingerprint::contents(const std::vector<fs::path>& stat_paths,
+                                              const std::vector<fs::path>& tree_paths) const
+    {
+        std::string result = m_inputs;
+        for (auto&& path : stat_paths)
+        {
+            Strings::append(result, "stat\t", get_stat_stamp(path), '\t', fs::u8string(path), '\n');
+        }
+
+        for (auto&& path : tree_paths)
+        {
+            Strings::append(result, "tree\t", get_tree_stamp(path), '\t', fs::u8string(path), '\n');
+        }
+
+        return result;
+    }
+
+    bool ManifestFingerprint::is_up_to_date() const
+    {
+        auto maybe_recorded =
+            CacheFile::load(m_paths.get_filesystem(), m_fingerprint_file, MANIFEST_FINGERPRINT_HEADER);
+        const auto recorded = maybe_recorded.get();
+        if (!recorded) return false;
+
+        // Restamp the paths tracked by the recorded fingerprint; any difference in inputs or stamps is a mismatch.
+        std::vector<fs::path> stat_paths;
+        std::vector<fs::path> tree_paths;
+        for (auto&& line : Strings::split(*recorded, '\n'))
+        {
+            const bool is_stat = Strings::starts_with(line, "stat\t");
+            if (!is_stat && !Strings::starts_with(line, "tree\t")) continue;
+            const auto path_start = line.find('\t', 5);
+            if (path_start == std::string::npos) return false;
+            (is_stat ? stat_paths : tree_paths).push_back(fs::u8path(line.substr(path_start + 1)));
+        }
+
+        return contents(stat_paths, tree_paths) == *recorded;
+    }
+
+    void ManifestFingerprint::track_plan(const Dependencies::ActionPlan& plan)
+    {
+        for (auto&& action : plan.install_actions)
+        {
+            if (auto scfl = action.source_control_file_location.get())
+            {
+                m_tree_paths.push_back(scfl->source_location);
+            }
+
+            if (auto abi_info = action.abi_info.get())
+            {
+                if (abi_info->pre_build_info)
+                {
+                    m_stat_paths.push_back(abi_info->pre_build_info->toolchain_file());
+                }
+
+                if (auto compiler_info = abi_info->compiler_info.get())
+                {
+                    Util::Vectors::append(&m_stat_paths, compiler_info->compiler_paths);
+                }
+            }
+
+            if (m_versions)
+            {
+                const auto& name = action.spec.name();
+                m_stat_paths.push_back(m_paths.root / fs::u8path("port_versions") /
+                                       fs::u8path(Strings::concat(name.substr(0, 1), "-")) /
+                                       fs::u8path(Strings::concat(name, ".json")));
+            }
+        }
+    }
+
+    void ManifestFingerprint::save() const
+    {
+        auto stat_paths = m_stat_paths;
+        stat_paths.push_back(m_paths.get_manifest_path().value_or_exit(VCPKG_LINE_INFO));
+        stat_paths.push_back(m_paths.manifest_root_dir / fs::u8path("vcpkg-configuration.json"));
+        stat_paths.push_back(m_paths.ports_cmake);
+        stat_paths.push_back(m_paths.vcpkg_dir_status_file);
+        stat_paths.push_back(m_paths.get_triplet_file_path(m_triplet));
+        if (m_versions)
+        {
+            stat_paths.push_back(m_paths.root / fs::u8path("port_versions") / fs::u8path("baseline.json"));
+        }
+
+        auto tree_paths = m_tree_paths;
+        tree_paths.push_back(m_paths.scripts / fs::u8path("cmake"));
+        tree_paths.push_back(m_paths.vcpkg_dir_updates);
+
+        Util::sort_unique_erase(stat_paths);
+        Util::sort_unique_erase(tree_paths);
+        auto new_contents = contents(stat_paths, tree_paths);
+
+        auto& fs = m_paths.get_filesystem();
+        std::error_code ec;
+        const auto has_newline = [](const fs::path& path) { return Strings::contains(fs::u8string(path), "\n"); };
+        if (Util::any_of(stat_paths, has_newline) || Util::any_of(tree_paths, has_newline))
+        {
+            // Such a fingerprint could not be read back
+            fs.remove(m_fingerprint_file, ec);
+            return;
+        }
+
+        CacheFile::save(fs, m_fingerprint_file, MANIFEST_FINGERPRINT_HEADER, new_contents);
+    }
+
     ///
     /// <summary>
     /// Run "install" command.
@@ -838,6 +1459,13 @@ namespace vcpkg::Install
                 features.erase(core_it);
             }
 
+            ManifestFingerprint fingerprint(paths, args, options, default_triplet, features);
+            if (!pkgsconfig && fingerprint.is_up_to_date())
+            {
+                System::print2("All requested packages are currently installed.\n");
+                Checks::exit_success(VCPKG_LINE_INFO);
+            }
+
             if (args.versions_enabled())
             {
                 auto verprovider = PortFileProvider::make_versioned_portfile_provider(paths);
@@ -875,7 +1503,8 @@ namespace vcpkg::Install
                                                             var_provider,
                                                             std::move(install_plan),
                                                             dry_run ? Commands::DryRun::Yes : Commands::DryRun::No,
-                                                            pkgsconfig);
+                                                            pkgsconfig,
+                                                            fingerprint);
             }
             else
             {
@@ -896,7 +1525,8 @@ namespace vcpkg::Install
                                                             var_provider,
                                                             std::move(install_plan),
                                                             dry_run ? Commands::DryRun::Yes : Commands::DryRun::No,
-                                                            pkgsconfig);
+                                                            pkgsconfig,
+                                                            fingerprint);
             }
         }
 
@@ -5,8 +5,28 @@
 #include <vcpkg/packagespec.h>
 #include <vcpkg/paragraphparser.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace vcpkg
 {
+    static const std::pair<const std::string, size_t> EMPTY_NAME{std::string(), std::hash<std::string>()({})};
+
+    InternedName::InternedName() noexcept : m_instance(&EMPTY_NAME) { }
+
+    InternedName::InternedName(StringView name) : m_instance(&EMPTY_NAME)
+    {
+        if (name.size() == 0) return;
+
+        // Entries are never removed, so the pointers stay valid for the life of the process.
+        static std::mutex g_names_mutex;
+        static std::unordered_map<std::string, size_t> g_names;
+        std::lock_guard<std::mutex> lock(g_names_mutex);
+        const auto inserted = g_names.emplace(name.to_string(), 0);
+        if (inserted.second) inserted.first->second = std::hash<std::string>()(inserted.first->first);
+        m_instance = &*inserted.first;
+    }
+
     std::string FeatureSpec::to_string() const
     {
         std::string ret;
@@ -77,20 +97,11 @@ namespace vcpkg
         });
     }
 
-    const std::string& PackageSpec::name() const { return this->m_name; }
-
-    Triplet PackageSpec::triplet() const { return this->m_triplet; }
-
-    std::string PackageSpec::dir() const { return Strings::format("%s_%s", this->m_name, this->m_triplet); }
+    std::string PackageSpec::dir() const { return Strings::format("%s_%s", this->name(), this->m_triplet); }
 
     std::string PackageSpec::to_string() const { return Strings::format("%s:%s", this->name(), this->triplet()); }
     void PackageSpec::to_string(std::string& s) const { Strings::append(s, this->name(), ':', this->triplet()); }
 
-    bool operator==(const PackageSpec& left, const PackageSpec& right)
-    {
-        return left.name() == right.name() && left.triplet() == right.triplet();
-    }
-
     ExpectedS<Features> Features::from_string(const std::string& name)
     {
         return parse_qualified_specifier(name).then([&](ParsedQualifiedSpecifier&& pqs) -> ExpectedS<Features> {
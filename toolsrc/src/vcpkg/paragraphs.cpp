@@ -1,4 +1,5 @@
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/parse.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
@@ -8,6 +9,7 @@
 #include <vcpkg/configuration.h>
 #include <vcpkg/paragraphparser.h>
 #include <vcpkg/paragraphs.h>
+#include <vcpkg/portcatalog.h>
 #include <vcpkg/registries.h>
 #include <vcpkg/vcpkgpaths.h>
 
@@ -388,11 +390,33 @@ namespace vcpkg::Paragraphs
         return pghs.error();
     }
 
-    LoadResults try_load_all_registry_ports(const VcpkgPaths& paths)
+    LoadResults try_load_ports(const Files::Filesystem& fs, std::vector<fs::path> port_dirs, PortCatalog* catalog)
     {
+        std::vector<Optional<ParseExpected<SourceControlFile>>> loaded(port_dirs.size());
+        execute_in_parallel(port_dirs.size(), [&](size_t i) {
+            loaded[i] = catalog ? catalog->try_load_port(port_dirs[i]) : try_load_port(fs, port_dirs[i]);
+        });
+        if (catalog) catalog->save();
+
         LoadResults ret;
-        const auto& fs = paths.get_filesystem();
+        for (size_t i = 0; i < port_dirs.size(); ++i)
+        {
+            auto& maybe_spgh = *loaded[i].get();
+            if (const auto spgh = maybe_spgh.get())
+            {
+                ret.paragraphs.emplace_back(std::move(*spgh), std::move(port_dirs[i]));
+            }
+            else
+            {
+                ret.errors.emplace_back(std::move(maybe_spgh).error());
+            }
+        }
 
+        return ret;
+    }
+
+    LoadResults try_load_all_registry_ports(const VcpkgPaths& paths)
+    {
         std::vector<std::string> ports;
 
         const auto& registries = paths.get_configuration().registry_set;
@@ -408,6 +432,8 @@ namespace vcpkg::Paragraphs
 
         Util::sort_unique_erase(ports);
 
+        std::vector<fs::path> port_paths;
+        port_paths.reserve(ports.size());
         for (const auto& port_name : ports)
         {
             auto impl = registries.registry_for_port(port_name);
@@ -432,15 +458,7 @@ namespace vcpkg::Paragraphs
                                  baseline_version.get()->to_string(),
                                  "` not found.");
                 }
-                auto maybe_spgh = try_load_port(fs, port_path);
-                if (const auto spgh = maybe_spgh.get())
-                {
-                    ret.paragraphs.emplace_back(std::move(*spgh), std::move(port_path));
-                }
-                else
-                {
-                    ret.errors.emplace_back(std::move(maybe_spgh).error());
-                }
+                port_paths.push_back(std::move(port_path));
             }
             else
             {
@@ -451,7 +469,7 @@ namespace vcpkg::Paragraphs
             }
         }
 
-        return ret;
+        return try_load_ports(paths.get_filesystem(), std::move(port_paths), &paths.get_port_catalog());
     }
 
     static void load_results_print_error(const LoadResults& results)
@@ -484,10 +502,6 @@ namespace vcpkg::Paragraphs
 
     std::vector<SourceControlFileLocation> load_overlay_ports(const VcpkgPaths& paths, const fs::path& directory)
     {
-        LoadResults ret;
-
-        std::vector<std::string> port_names;
-
         const auto& fs = paths.get_filesystem();
         auto port_dirs = fs.get_files_non_recursive(directory);
         Util::sort(port_dirs);
@@ -495,19 +509,7 @@ namespace vcpkg::Paragraphs
         Util::erase_remove_if(port_dirs,
                               [&](auto&& port_dir_entry) { return port_dir_entry.filename() == ".DS_Store"; });
 
-        for (auto&& path : port_dirs)
-        {
-            auto maybe_spgh = try_load_port(fs, path);
-            if (const auto spgh = maybe_spgh.get())
-            {
-                ret.paragraphs.emplace_back(std::move(*spgh), std::move(path));
-            }
-            else
-            {
-                ret.errors.emplace_back(std::move(maybe_spgh).error());
-            }
-        }
-
+        auto ret = try_load_ports(fs, std::move(port_dirs));
         load_results_print_error(ret);
         return std::move(ret.paragraphs);
     }
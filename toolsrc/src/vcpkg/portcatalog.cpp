@@ -0,0 +1,385 @@
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/commands.version.h>
+#include <vcpkg/paragraphs.h>
+#include <vcpkg/platform-expression.h>
+#include <vcpkg/portcatalog.h>
+
+#include <cstring>
+
+namespace vcpkg
+{
+    static std::string get_header()
+    {
+        return Strings::concat("vcpkg port catalog v1 ", Commands::Version::version());
+    }
+
+    namespace
+    {
+        // The catalog is only ever read by the machine which wrote it, so integers are stored in native byte order.
+        struct Writer
+        {
+            std::string& out;
+
+            template<class T>
+            void integer(T value)
+            {
+                out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            void string(StringView sv)
+            {
+                integer(static_cast<uint32_t>(sv.size()));
+                out.append(sv.data(), sv.size());
+            }
+
+            void strings(const std::vector<std::string>& strs)
+            {
+                integer(static_cast<uint32_t>(strs.size()));
+                for (auto&& s : strs)
+                {
+                    string(s);
+                }
+            }
+
+            void stamp(const CacheFile::FileStamp& stamp)
+            {
+                integer(stamp.size);
+                integer(stamp.write_time);
+            }
+
+            void object(const Json::Object& obj)
+            {
+                string(obj.size() == 0 ? std::string() : Json::stringify(obj, Json::JsonStyle::with_spaces(0)));
+            }
+
+            void platform(const PlatformExpression::Expr& expr) { string(to_string(expr)); }
+
+            void dependencies(const std::vector<Dependency>& deps)
+            {
+                integer(static_cast<uint32_t>(deps.size()));
+                for (auto&& dep : deps)
+                {
+                    string(dep.name);
+                    strings(dep.features);
+                    platform(dep.platform);
+                    integer(static_cast<int32_t>(dep.constraint.type));
+                    string(dep.constraint.value);
+                    integer(static_cast<int32_t>(dep.constraint.port_version));
+                    object(dep.extra_info);
+                }
+            }
+
+            void source_control_file(const SourceControlFile& scf)
+            {
+                const auto& core = *scf.core_paragraph;
+                string(core.name);
+                integer(static_cast<int32_t>(core.version_scheme));
+                string(core.version);
+                integer(static_cast<int32_t>(core.port_version));
+                strings(core.description);
+                strings(core.maintainers);
+                string(core.homepage);
+                string(core.documentation);
+                dependencies(core.dependencies);
+                integer(static_cast<uint32_t>(core.overrides.size()));
+                for (auto&& override_ : core.overrides)
+                {
+                    string(override_.name);
+                    string(override_.version);
+                    integer(static_cast<int32_t>(override_.port_version));
+                    integer(static_cast<int32_t>(override_.version_scheme));
+                    object(override_.extra_info);
+                }
+                strings(core.default_features);
+                string(core.license);
+                integer(static_cast<int32_t>(core.type.type));
+                platform(core.supports_expression);
+                object(core.extra_info);
+
+                integer(static_cast<uint32_t>(scf.feature_paragraphs.size()));
+                for (auto&& feature : scf.feature_paragraphs)
+                {
+                    string(feature->name);
+                    strings(feature->description);
+                    dependencies(feature->dependencies);
+                    object(feature->extra_info);
+                }
+            }
+        };
+
+        // Reads what Writer wrote. Any inconsistency, such as a truncated file, makes `ok` false; the results of the
+        // reads after that are unspecified but safe.
+        struct Reader
+        {
+            const char* first;
+            const char* last;
+            bool ok = true;
+
+            template<class T>
+            T integer()
+            {
+                T value{};
+                if (static_cast<size_t>(last - first) < sizeof(value))
+                {
+                    ok = false;
+                    return value;
+                }
+
+                std::memcpy(&value, first, sizeof(value));
+                first += sizeof(value);
+                return value;
+            }
+
+            StringView string_view()
+            {
+                const auto size = integer<uint32_t>();
+                if (!ok || static_cast<size_t>(last - first) < size)
+                {
+                    ok = false;
+                    return {};
+                }
+
+                StringView result{first, size};
+                first += size;
+                return result;
+            }
+
+            std::string string() { return string_view().to_string(); }
+
+            // an upper bound for the element count of a vector, so that a corrupt count cannot allocate without limit
+            uint32_t count()
+            {
+                const auto n = integer<uint32_t>();
+                if (n > static_cast<size_t>(last - first)) ok = false;
+                return ok ? n : 0;
+            }
+
+            std::vector<std::string> strings()
+            {
+                std::vector<std::string> result(count());
+                for (auto&& s : result)
+                {
+                    s = string();
+                }
+
+                return result;
+            }
+
+            CacheFile::FileStamp stamp()
+            {
+                CacheFile::FileStamp result;
+                result.size = integer<long long>();
+                result.write_time = integer<long long>();
+                return result;
+            }
+
+            Json::Object object()
+            {
+                const auto text = string_view();
+                if (text.size() == 0) return {};
+                auto parsed = Json::parse(text);
+                if (auto value = parsed.get())
+                {
+                    if (value->first.is_object()) return std::move(value->first).object();
+                }
+
+                ok = false;
+                return {};
+            }
+
+            PlatformExpression::Expr platform()
+            {
+                const auto text = string_view();
+                if (text.size() == 0) return {};
+                auto parsed =
+                    PlatformExpression::parse_platform_expression(text, PlatformExpression::MultipleBinaryOperators::Deny);
+                if (auto expr = parsed.get()) return std::move(*expr);
+                ok = false;
+                return {};
+            }
+
+            std::vector<Dependency> dependencies()
+            {
+                std::vector<Dependency> result(count());
+                for (auto&& dep : result)
+                {
+                    dep.name = string();
+                    dep.features = strings();
+                    dep.platform = platform();
+                    dep.constraint.type = static_cast<Versions::Constraint::Type>(integer<int32_t>());
+                    dep.constraint.value = string();
+                    dep.constraint.port_version = integer<int32_t>();
+                    dep.extra_info = object();
+                }
+
+                return result;
+            }
+
+            std::unique_ptr<SourceControlFile> source_control_file()
+            {
+                auto scf = std::make_unique<SourceControlFile>();
+                scf->core_paragraph = std::make_unique<SourceParagraph>();
+                auto& core = *scf->core_paragraph;
+                core.name = string();
+                core.version_scheme = static_cast<Versions::Scheme>(integer<int32_t>());
+                core.version = string();
+                core.port_version = integer<int32_t>();
+                core.description = strings();
+                core.maintainers = strings();
+                core.homepage = string();
+                core.documentation = string();
+                core.dependencies = dependencies();
+                core.overrides.resize(count());
+                for (auto&& override_ : core.overrides)
+                {
+                    override_.name = string();
+                    override_.version = string();
+                    override_.port_version = integer<int32_t>();
+                    override_.version_scheme = static_cast<Versions::Scheme>(integer<int32_t>());
+                    override_.extra_info = object();
+                }
+                core.default_features = strings();
+                core.license = string();
+                core.type.type = static_cast<decltype(core.type.type)>(integer<int32_t>());
+                core.supports_expression = platform();
+                core.extra_info = object();
+
+                scf->feature_paragraphs.resize(count());
+                for (auto&& feature : scf->feature_paragraphs)
+                {
+                    feature = std::make_unique<FeatureParagraph>();
+                    feature->name = string();
+                    feature->description = strings();
+                    feature->dependencies = dependencies();
+                    feature->extra_info = object();
+                }
+
+                if (!ok || first != last) return nullptr;
+                return scf;
+            }
+        };
+    }
+
+    // Format: a header line, then for each entry:
+    //   <port directory> <directory stamp> <is manifest> <port file stamp> <encoded SourceControlFile>
+    // where strings and the encoded SourceControlFile are prefixed by their size. Loading stops at the first malformed
+    // entry.
+    PortCatalog::PortCatalog(Files::Filesystem& fs, fs::path catalog_file)
+        : m_fs(fs), m_catalog_file(std::move(catalog_file))
+    {
+        load();
+    }
+
+    void PortCatalog::load()
+    {
+        m_entries.clear();
+        std::error_code ec;
+        m_mapping = Files::MappedFile::open(m_catalog_file, ec);
+        if (ec) return;
+
+        const auto contents = m_mapping.contents();
+        const auto header = get_header();
+        if (contents.size() <= header.size() || StringView{contents.data(), header.size()} != header ||
+            contents.data()[header.size()] != '\n')
+        {
+            return;
+        }
+
+        Reader reader{contents.data() + header.size() + 1, contents.data() + contents.size()};
+        while (reader.first != reader.last)
+        {
+            auto port_dir = reader.string_view();
+            Entry entry;
+            entry.stamps.directory = reader.stamp();
+            entry.stamps.is_manifest = reader.integer<uint8_t>() != 0;
+            entry.stamps.port_file = reader.stamp();
+            entry.data = reader.string_view();
+            if (!reader.ok) break;
+            m_entries.emplace(port_dir.to_string(), entry);
+        }
+    }
+
+    Parse::ParseExpected<SourceControlFile> PortCatalog::try_load_port(const fs::path& port_dir)
+    {
+        const auto key = fs::u8string(port_dir);
+        const auto maybe_directory_stamp = CacheFile::get_file_stamp(port_dir);
+        const auto directory_stamp = maybe_directory_stamp.get();
+        if (!directory_stamp) return Paragraphs::try_load_port(m_fs, port_dir);
+
+        const auto decode_if_unchanged = [&](const Stamps& stamps, StringView data) -> std::unique_ptr<SourceControlFile> {
+            if (stamps.directory != *directory_stamp) return nullptr;
+            const auto port_file = port_dir / fs::u8path(stamps.is_manifest ? "vcpkg.json" : "CONTROL");
+            if (CacheFile::get_file_stamp(port_file) != stamps.port_file) return nullptr;
+            return Reader{data.data(), data.data() + data.size()}.source_control_file();
+        };
+
+        const auto it = m_entries.find(key);
+        if (it != m_entries.end())
+        {
+            if (auto scf = decode_if_unchanged(it->second.stamps, it->second.data)) return scf;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto added = m_added.find(key);
+            if (added != m_added.end())
+            {
+                if (auto scf = decode_if_unchanged(added->second.first, added->second.second)) return scf;
+            }
+        }
+
+        // The stamps are taken before the port file is read, so that a change while it is read is noticed next time.
+        Stamps stamps{*directory_stamp, m_fs.exists(port_dir / fs::u8path("vcpkg.json")), {}};
+        const auto maybe_port_file_stamp =
+            CacheFile::get_file_stamp(port_dir / fs::u8path(stamps.is_manifest ? "vcpkg.json" : "CONTROL"));
+        auto result = Paragraphs::try_load_port(m_fs, port_dir);
+        const auto port_file_stamp = maybe_port_file_stamp.get();
+        const auto scf = result.get();
+        if (!scf || !port_file_stamp || directory_stamp->is_recent() || port_file_stamp->is_recent()) return result;
+
+        stamps.port_file = *port_file_stamp;
+        std::string data;
+        Writer{data}.source_control_file(**scf);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_added[key] = {stamps, std::move(data)};
+        return result;
+    }
+
+    void PortCatalog::save()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_added.empty()) return;
+
+        std::string body;
+        Writer writer{body};
+        const auto write_entry = [&](const std::string& port_dir, const Stamps& stamps, StringView data) {
+            writer.string(port_dir);
+            writer.stamp(stamps.directory);
+            writer.integer(static_cast<uint8_t>(stamps.is_manifest));
+            writer.stamp(stamps.port_file);
+            writer.string(data);
+        };
+
+        for (auto&& entry : m_added)
+        {
+            write_entry(entry.first, entry.second.first, entry.second.second);
+        }
+
+        for (auto&& entry : m_entries)
+        {
+            if (m_added.count(entry.first) != 0 || !m_fs.is_directory(fs::u8path(entry.first))) continue;
+            write_entry(entry.first, entry.second.stamps, entry.second.data);
+        }
+
+        // on Windows, a mapped file cannot be replaced
+        m_entries.clear();
+        m_mapping.close();
+        CacheFile::save(m_fs, m_catalog_file, get_header(), body);
+        m_added.clear();
+        load();
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <vcpkg/configuration.h>
 #include <vcpkg/paragraphs.h>
+#include <vcpkg/portcatalog.h>
 #include <vcpkg/portfileprovider.h>
 #include <vcpkg/registries.h>
 #include <vcpkg/sourceparagraph.h>
@@ -151,7 +152,6 @@ namespace vcpkg::PortFileProvider
 
     static Optional<SourceControlFileLocation> try_load_registry_port(const VcpkgPaths& paths, const std::string& spec)
     {
-        const auto& fs = paths.get_filesystem();
         if (auto registry = paths.get_configuration().registry_set.registry_for_port(spec))
         {
             auto baseline_version = registry->get_baseline_version(paths, spec);
@@ -167,7 +167,7 @@ namespace vcpkg::PortFileProvider
                                               spec,
                                               baseline_version.get()->to_string());
                 }
-                auto found_scf = Paragraphs::try_load_port(fs, port_directory);
+                auto found_scf = paths.get_port_catalog().try_load_port(port_directory);
                 if (auto scf = found_scf.get())
                 {
                     if (scf->get()->core_paragraph->name == spec)
@@ -313,9 +313,10 @@ namespace vcpkg::PortFileProvider
                             parse_baseline_file(paths.get_filesystem(), "default", baseline_file);
                         Checks::check_exit(VCPKG_LINE_INFO,
                                            maybe_baselines_map.has_value(),
-                                           "Error: Couldn't parse baseline `%s` from `%s`",
+                                           "Error: Couldn't parse baseline `%s` from `%s`:\n%s",
                                            "default",
-                                           fs::u8string(baseline_file));
+                                           fs::u8string(baseline_file),
+                                           maybe_baselines_map.error());
                         auto baselines_map = *maybe_baselines_map.get();
                         return std::move(baselines_map);
                     }
@@ -330,9 +331,10 @@ namespace vcpkg::PortFileProvider
                                 parse_baseline_file(paths.get_filesystem(), "default", baseline_file);
                             Checks::check_exit(VCPKG_LINE_INFO,
                                                maybe_baselines_map.has_value(),
-                                               "Error: Couldn't parse baseline `%s` from `%s`",
+                                               "Error: Couldn't parse baseline `%s` from `%s`:\n%s",
                                                "default",
-                                               fs::u8string(baseline_file));
+                                               fs::u8string(baseline_file),
+                                               maybe_baselines_map.error());
                             auto baselines_map = *maybe_baselines_map.get();
                             return std::move(baselines_map);
                         }
@@ -399,8 +401,9 @@ namespace vcpkg::PortFileProvider
                     auto maybe_version_entries = parse_versions_file(get_filesystem(), port_name, *versions_file_path);
                     Checks::check_exit(VCPKG_LINE_INFO,
                                        maybe_version_entries.has_value(),
-                                       "Error: Couldn't parse versions from file: %s",
-                                       fs::u8string(*versions_file_path));
+                                       "Error: Couldn't parse versions from file: %s\n%s",
+                                       fs::u8string(*versions_file_path),
+                                       maybe_version_entries.error());
                     auto version_entries = maybe_version_entries.value_or_exit(VCPKG_LINE_INFO);
 
                     auto port = port_name.to_string();
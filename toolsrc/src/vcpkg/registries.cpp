@@ -263,12 +263,6 @@ namespace
         {
             auto baseline_file = path_to_registry_database(paths) / fs::u8path("baseline.json");
 
-            auto value = Json::parse_file(VCPKG_LINE_INFO, paths.get_filesystem(), baseline_file);
-            if (!value.first.is_object())
-            {
-                Checks::exit_with_message(VCPKG_LINE_INFO, "Error: `baseline.json` does not have a top-level object.");
-            }
-
             auto maybe_baseline_versions = parse_baseline_file(paths.get_filesystem(), "default", baseline_file);
             if (auto baseline_versions = maybe_baseline_versions.get())
             {
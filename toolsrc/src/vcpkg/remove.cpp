@@ -27,6 +27,7 @@ namespace vcpkg::Remove
             VCPKG_LINE_INFO, maybe_ipv.has_value(), "unable to remove package %s: already removed", spec);
 
         auto&& ipv = maybe_ipv.value_or_exit(VCPKG_LINE_INFO);
+        InstalledFilesIndex& installed_files = InstalledFilesIndex::get(paths, *status_db);
 
         std::vector<StatusParagraph> spghs;
         spghs.emplace_back(*ipv.core);
@@ -39,9 +40,10 @@ namespace vcpkg::Remove
         {
             spgh.want = Want::PURGE;
             spgh.state = InstallState::HALF_INSTALLED;
-            write_update(paths, spgh);
         }
 
+        write_updates(paths, spghs);
+
         auto maybe_lines = fs.read_lines(paths.listfile_path(ipv.core->package));
 
         if (const auto lines = maybe_lines.get())
@@ -116,11 +118,16 @@ namespace vcpkg::Remove
             fs.remove(paths.listfile_path(ipv.core->package), VCPKG_LINE_INFO);
         }
 
+        installed_files.remove_package(ipv.core->package);
+
         for (auto&& spgh : spghs)
         {
             spgh.state = InstallState::NOT_INSTALLED;
-            write_update(paths, spgh);
+        }
 
+        write_updates(paths, spghs);
+        for (auto&& spgh : spghs)
+        {
             status_db->insert(std::make_unique<StatusParagraph>(std::move(spgh)));
         }
     }
@@ -330,6 +337,7 @@ namespace vcpkg::Remove
             perform_remove_plan_action(paths, action, purge, &status_db);
         }
 
+        InstalledFilesIndex::get(paths, status_db).save(paths);
         Checks::exit_success(VCPKG_LINE_INFO);
     }
 
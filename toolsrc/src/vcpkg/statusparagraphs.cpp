@@ -10,31 +10,55 @@ namespace vcpkg
 
     StatusParagraphs::StatusParagraphs(std::vector<std::unique_ptr<StatusParagraph>>&& ps) : paragraphs(std::move(ps))
     {
+        for (size_t i = 0; i < paragraphs.size(); ++i)
+        {
+            positions_by_name[paragraphs[i]->package.spec.name()].push_back(i);
+        }
     }
 
-    std::vector<std::unique_ptr<StatusParagraph>*> StatusParagraphs::find_all(const std::string& name, Triplet triplet)
+    // Calls cb(position) for the paragraphs of (name, triplet), last first, matching the iteration order.
+    template<class F>
+    void StatusParagraphs::for_each_position(const std::string& name, Triplet triplet, F cb) const
     {
-        std::vector<std::unique_ptr<StatusParagraph>*> spghs;
-        for (auto&& p : *this)
+        const auto positions = positions_by_name.find(name);
+        if (positions == positions_by_name.end()) return;
+
+        for (auto it = positions->second.rbegin(); it != positions->second.rend(); ++it)
         {
-            if (p->package.spec.name() == name && p->package.spec.triplet() == triplet)
-            {
-                if (p->package.is_feature())
-                    spghs.emplace_back(&p);
-                else
-                    spghs.emplace(spghs.begin(), &p);
-            }
+            if (paragraphs[*it]->package.spec.triplet() == triplet) cb(*it);
         }
+    }
+
+    size_t StatusParagraphs::find_position(const std::string& name,
+                                           Triplet triplet,
+                                           const std::string& feature) const
+    {
+        size_t result = npos;
+        for_each_position(name, triplet, [&](size_t position) {
+            if (result == npos && paragraphs[position]->package.feature == feature) result = position;
+        });
+        return result;
+    }
+
+    std::vector<std::unique_ptr<StatusParagraph>*> StatusParagraphs::find_all(const std::string& name, Triplet triplet)
+    {
+        std::vector<std::unique_ptr<StatusParagraph>*> spghs;
+        for_each_position(name, triplet, [&](size_t position) {
+            auto& p = paragraphs[position];
+            if (p->package.is_feature())
+                spghs.emplace_back(&p);
+            else
+                spghs.emplace(spghs.begin(), &p);
+        });
         return spghs;
     }
 
     Optional<InstalledPackageView> StatusParagraphs::get_installed_package_view(const PackageSpec& spec) const
     {
         InstalledPackageView ipv;
-        for (auto&& p : *this)
-        {
-            if (p->package.spec.name() == spec.name() && p->package.spec.triplet() == spec.triplet() &&
-                p->is_installed())
+        for_each_position(spec.name(), spec.triplet(), [&](size_t position) {
+            auto& p = paragraphs[position];
+            if (p->is_installed())
             {
                 if (p->package.is_feature())
                 {
@@ -46,7 +70,7 @@ namespace vcpkg
                     ipv.core = p.get();
                 }
             }
-        }
+        });
         if (ipv.core != nullptr)
             return ipv;
         else
@@ -62,10 +86,9 @@ namespace vcpkg
             // The core feature maps to .feature is empty
             return find(name, triplet, {});
         }
-        return std::find_if(begin(), end(), [&](const std::unique_ptr<StatusParagraph>& pgh) {
-            const PackageSpec& spec = pgh->package.spec;
-            return spec.name() == name && spec.triplet() == triplet && pgh->package.feature == feature;
-        });
+
+        const size_t position = find_position(name, triplet, feature);
+        return position == npos ? end() : iterator(paragraphs.begin() + position + 1);
     }
 
     StatusParagraphs::const_iterator StatusParagraphs::find(const std::string& name,
@@ -77,10 +100,9 @@ namespace vcpkg
             // The core feature maps to .feature == ""
             return find(name, triplet, "");
         }
-        return std::find_if(begin(), end(), [&](const std::unique_ptr<StatusParagraph>& pgh) {
-            const PackageSpec& spec = pgh->package.spec;
-            return spec.name() == name && spec.triplet() == triplet && pgh->package.feature == feature;
-        });
+
+        const size_t position = find_position(name, triplet, feature);
+        return position == npos ? end() : const_iterator(paragraphs.begin() + position + 1);
     }
 
     StatusParagraphs::const_iterator StatusParagraphs::find_installed(const PackageSpec& spec) const
@@ -128,6 +150,7 @@ namespace vcpkg
         const auto ptr = find(spec.name(), spec.triplet(), pgh->package.feature);
         if (ptr == end())
         {
+            positions_by_name[spec.name()].push_back(paragraphs.size());
             paragraphs.push_back(std::move(pgh));
             return paragraphs.rbegin();
         }
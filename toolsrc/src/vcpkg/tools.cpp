@@ -1,9 +1,12 @@
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/downloads.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/hash.h>
 #include <vcpkg/base/optional.h>
 #include <vcpkg/base/strings.h>
 #include <vcpkg/base/stringview.h>
+#include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.print.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
@@ -297,8 +300,8 @@ namespace vcpkg
         }
         virtual ExpectedS<std::string> get_version(const VcpkgPaths&, const fs::path& path_to_exe) const override
         {
-            const std::string cmd = Strings::format(R"("%s" --version)", fs::u8string(path_to_exe));
-            auto rc = System::cmd_execute_and_capture_output(cmd);
+            auto rc = System::cmd_execute_and_capture_output(
+                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version"));
             if (rc.exit_code != 0)
             {
                 return {Strings::concat(
@@ -326,8 +329,8 @@ CMake suite maintained and supported by Kitware (kitware.com/cmake).
 
         virtual ExpectedS<std::string> get_version(const VcpkgPaths&, const fs::path& path_to_exe) const override
         {
-            const std::string cmd = Strings::format(R"("%s" --version)", fs::u8string(path_to_exe));
-            auto rc = System::cmd_execute_and_capture_output(cmd);
+            auto rc = System::cmd_execute_and_capture_output(
+                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version"));
             if (rc.exit_code != 0)
             {
                 return {Strings::concat(
@@ -359,7 +362,7 @@ CMake suite maintained and supported by Kitware (kitware.com/cmake).
             (void)paths;
 #endif
             cmd.path_arg(path_to_exe);
-            auto rc = System::cmd_execute_and_capture_output(cmd.extract());
+            auto rc = System::cmd_execute_and_capture_output(cmd);
             if (rc.exit_code != 0)
             {
 #ifndef _WIN32
@@ -414,8 +417,8 @@ Type 'NuGet help <command>' for help on a specific command.
 
         virtual ExpectedS<std::string> get_version(const VcpkgPaths&, const fs::path& path_to_exe) const override
         {
-            const std::string cmd = Strings::format(R"("%s" --version)", fs::u8string(path_to_exe));
-            auto rc = System::cmd_execute_and_capture_output(cmd);
+            auto rc = System::cmd_execute_and_capture_output(
+                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version"));
             if (rc.exit_code != 0)
             {
                 return {Strings::concat(
@@ -444,7 +447,7 @@ git version 2.17.1.windows.2
         virtual ExpectedS<std::string> get_version(const VcpkgPaths&, const fs::path& path_to_exe) const override
         {
             auto rc = System::cmd_execute_and_capture_output(
-                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version").extract());
+                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version"));
             if (rc.exit_code != 0)
             {
                 return {Strings::concat(
@@ -513,7 +516,7 @@ Mono JIT compiler version 6.8.0.105 (Debian 6.8.0.105+dfsg-2 Wed Feb 26 23:23:50
         virtual ExpectedS<std::string> get_version(const VcpkgPaths&, const fs::path& path_to_exe) const override
         {
             auto rc = System::cmd_execute_and_capture_output(
-                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version").extract());
+                System::CmdLineBuilder().path_arg(path_to_exe).string_arg("--version"));
             if (rc.exit_code != 0)
             {
                 return {Strings::concat(
@@ -534,8 +537,82 @@ Mono JIT compiler version 6.8.0.105 (Debian 6.8.0.105+dfsg-2 Wed Feb 26 23:23:50
         }
     };
 
+    static PathAndVersion find_tool(const VcpkgPaths& paths, const std::string& tool)
+    {
+        // First deal with specially handled tools.
+        // For these we may look in locations like Program Files, the PATH etc as well as the auto-downloaded
+        // location.
+        if (tool == Tools::CMAKE)
+        {
+            if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
+            {
+                return {"cmake", "0"};
+            }
+            return get_path(paths, CMakeProvider());
+        }
+        if (tool == Tools::GIT)
+        {
+            if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
+            {
+                return {"git", "0"};
+            }
+            return get_path(paths, GitProvider());
+        }
+        if (tool == Tools::NINJA)
+        {
+            if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
+            {
+                return {"ninja", "0"};
+            }
+            return get_path(paths, NinjaProvider());
+        }
+        if (tool == Tools::POWERSHELL_CORE)
+        {
+            if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
+            {
+                return {"pwsh", "0"};
+            }
+            return get_path(paths, PowerShellCoreProvider());
+        }
+        if (tool == Tools::NUGET) return get_path(paths, NuGetProvider());
+        if (tool == Tools::IFW_INSTALLER_BASE) return get_path(paths, IfwInstallerBaseProvider());
+        if (tool == Tools::MONO) return get_path(paths, MonoProvider());
+
+        // For other tools, we simply always auto-download them.
+        auto maybe_tool_data = parse_tool_data_from_xml(paths, tool);
+        if (auto p_tool_data = maybe_tool_data.get())
+        {
+            if (paths.get_filesystem().exists(p_tool_data->exe_path))
+            {
+                return {p_tool_data->exe_path, p_tool_data->sha512};
+            }
+            return {fetch_tool(paths, tool, *p_tool_data), p_tool_data->sha512};
+        }
+
+        Checks::exit_with_message(VCPKG_LINE_INFO, "Unknown or unavailable tool: %s", tool);
+    }
+
+    static constexpr StringLiteral TOOL_CACHE_HEADER = "vcpkg tool cache v1";
+
+    // Everything besides the executables themselves which decides where a tool is found: the tool metadata, the
+    // directories searched and whether system binaries are forced.
+    static std::string get_tool_cache_key(const VcpkgPaths& paths)
+    {
+        auto maybe_xml = paths.get_filesystem().read_contents(paths.scripts / fs::u8path("vcpkgTools.xml"));
+        const auto xml = maybe_xml.get();
+        return Hash::get_string_hash(
+            Strings::concat(xml ? *xml : std::string(),
+                            '\n',
+                            System::get_environment_variable("PATH").value_or(""),
+                            '\n',
+                            System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value() ? "1" : "0"),
+            Hash::Algorithm::Sha1);
+    }
+
     struct ToolCacheImpl final : ToolCache
     {
+        explicit ToolCacheImpl(bool revalidate) : m_revalidate(revalidate) { }
+
         vcpkg::Cache<std::string, fs::path> path_only_cache;
         vcpkg::Cache<std::string, PathAndVersion> path_version_cache;
 
@@ -554,57 +631,19 @@ Mono JIT compiler version 6.8.0.105 (Debian 6.8.0.105+dfsg-2 Wed Feb 26 23:23:50
         const PathAndVersion& get_tool_pathversion(const VcpkgPaths& paths, const std::string& tool) const
         {
             return path_version_cache.get_lazy(tool, [&]() -> PathAndVersion {
-                // First deal with specially handled tools.
-                // For these we may look in locations like Program Files, the PATH etc as well as the auto-downloaded
-                // location.
-                if (tool == Tools::CMAKE)
-                {
-                    if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
-                    {
-                        return {"cmake", "0"};
-                    }
-                    return get_path(paths, CMakeProvider());
-                }
-                if (tool == Tools::GIT)
-                {
-                    if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
-                    {
-                        return {"git", "0"};
-                    }
-                    return get_path(paths, GitProvider());
-                }
-                if (tool == Tools::NINJA)
-                {
-                    if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
-                    {
-                        return {"ninja", "0"};
-                    }
-                    return get_path(paths, NinjaProvider());
-                }
-                if (tool == Tools::POWERSHELL_CORE)
+                auto& persisted = persisted_tools(paths);
+                auto it = persisted.find(tool);
+                // a remembered tool is trusted only while its executable is unchanged
+                if (it != persisted.end() &&
+                    CacheFile::get_file_stamp(it->second.path_and_version.path) == it->second.stamp)
                 {
-                    if (System::get_environment_variable("VCPKG_FORCE_SYSTEM_BINARIES").has_value())
-                    {
-                        return {"pwsh", "0"};
-                    }
-                    return get_path(paths, PowerShellCoreProvider());
+                    Debug::print("Using remembered ", tool, ": ", fs::u8string(it->second.path_and_version.path), '\n');
+                    return it->second.path_and_version;
                 }
-                if (tool == Tools::NUGET) return get_path(paths, NuGetProvider());
-                if (tool == Tools::IFW_INSTALLER_BASE) return get_path(paths, IfwInstallerBaseProvider());
-                if (tool == Tools::MONO) return get_path(paths, MonoProvider());
 
-                // For other tools, we simply always auto-download them.
-                auto maybe_tool_data = parse_tool_data_from_xml(paths, tool);
-                if (auto p_tool_data = maybe_tool_data.get())
-                {
-                    if (paths.get_filesystem().exists(p_tool_data->exe_path))
-                    {
-                        return {p_tool_data->exe_path, p_tool_data->sha512};
-                    }
-                    return {fetch_tool(paths, tool, *p_tool_data), p_tool_data->sha512};
-                }
-
-                Checks::exit_with_message(VCPKG_LINE_INFO, "Unknown or unavailable tool: %s", tool);
+                auto path_and_version = find_tool(paths, tool);
+                persist_tool(paths, tool, path_and_version);
+                return path_and_version;
             });
         }
 
@@ -612,7 +651,86 @@ Mono JIT compiler version 6.8.0.105 (Debian 6.8.0.105+dfsg-2 Wed Feb 26 23:23:50
         {
             return get_tool_pathversion(paths, tool).version;
         }
+
+    private:
+        struct PersistedTool
+        {
+            PathAndVersion path_and_version;
+            CacheFile::FileStamp stamp;
+        };
+
+        // The tools found by earlier vcpkg invocations, as long as nothing else which decides where a tool is found
+        // has changed since. Only used from within path_version_cache, which serializes the accesses.
+        std::map<std::string, PersistedTool>& persisted_tools(const VcpkgPaths& paths) const
+        {
+            if (m_persisted_tools_loaded) return m_persisted_tools;
+            m_persisted_tools_loaded = true;
+            m_persisted_tools_key = get_tool_cache_key(paths);
+            if (m_revalidate) return m_persisted_tools;
+
+            // Format: a header line "<header>\t<key>", then one line per tool:
+            // "<tool>\t<size>\t<time>\t<version>\t<path>".
+            auto maybe_contents = CacheFile::load(paths.get_filesystem(), get_tool_cache_path(paths), get_header());
+            const auto contents = maybe_contents.get();
+            if (!contents) return m_persisted_tools;
+
+            for (auto&& line : Strings::split(*contents, '\n'))
+            {
+                const auto fields = Strings::split(line, '\t');
+                if (fields.size() != 5) continue;
+                auto stamp = CacheFile::FileStamp::parse(fields[1], fields[2]);
+                if (!stamp) continue;
+
+                m_persisted_tools[fields[0]] =
+                    PersistedTool{PathAndVersion{fs::u8path(fields[4]), fields[3]}, *stamp.get()};
+            }
+
+            return m_persisted_tools;
+        }
+
+        void persist_tool(const VcpkgPaths& paths,
+                          const std::string& tool,
+                          const PathAndVersion& path_and_version) const
+        {
+            auto stamp = CacheFile::get_file_stamp(path_and_version.path);
+            if (!stamp) return;
+            const auto path = fs::u8string(path_and_version.path);
+            if (Strings::contains(path, "\t") || Strings::contains(path, "\n") ||
+                Strings::contains(path_and_version.version, "\t") || Strings::contains(path_and_version.version, "\n"))
+            {
+                return;
+            }
+
+            auto& persisted_tools = this->persisted_tools(paths);
+            persisted_tools[tool] = PersistedTool{path_and_version, *stamp.get()};
+
+            std::string contents;
+            for (auto&& entry : persisted_tools)
+            {
+                Strings::append(contents,
+                                entry.first,
+                                '\t',
+                                entry.second.stamp.to_string(),
+                                '\t',
+                                entry.second.path_and_version.version,
+                                '\t',
+                                fs::u8string(entry.second.path_and_version.path),
+                                '\n');
+            }
+
+            // Several vcpkg processes may update the cache at once; the last one to save wins.
+            CacheFile::save(paths.get_filesystem(), get_tool_cache_path(paths), get_header(), contents);
+        }
+
+        static fs::path get_tool_cache_path(const VcpkgPaths& paths) { return paths.tools / fs::u8path("tool-cache"); }
+
+        std::string get_header() const { return Strings::concat(TOOL_CACHE_HEADER, '\t', m_persisted_tools_key); }
+
+        bool m_revalidate;
+        mutable bool m_persisted_tools_loaded = false;
+        mutable std::string m_persisted_tools_key;
+        mutable std::map<std::string, PersistedTool> m_persisted_tools;
     };
 
-    std::unique_ptr<ToolCache> get_tool_cache() { return std::make_unique<ToolCacheImpl>(); }
+    std::unique_ptr<ToolCache> get_tool_cache(bool revalidate) { return std::make_unique<ToolCacheImpl>(revalidate); }
 }
@@ -277,6 +277,8 @@ namespace vcpkg
                     {PACKAGES_ROOT_DIR_ARG, &VcpkgCmdArguments::packages_root_dir},
                     {SCRIPTS_ROOT_DIR_ARG, &VcpkgCmdArguments::scripts_root_dir},
                     {BUILTIN_PORTS_ROOT_DIR_ARG, &VcpkgCmdArguments::builtin_ports_root_dir},
+                    {JOBS_ARG, &VcpkgCmdArguments::jobs},
+                    {CORES_PER_JOB_ARG, &VcpkgCmdArguments::cores_per_job},
                 };
 
             constexpr static std::pair<StringView, std::vector<std::string> VcpkgCmdArguments::*>
@@ -297,6 +299,7 @@ namespace vcpkg
                 {WAIT_FOR_LOCK_SWITCH, &VcpkgCmdArguments::wait_for_lock},
                 {IGNORE_LOCK_FAILURES_SWITCH, &VcpkgCmdArguments::ignore_lock_failures},
                 {JSON_SWITCH, &VcpkgCmdArguments::json},
+                {REVALIDATE_TOOLS_SWITCH, &VcpkgCmdArguments::revalidate_tools},
             };
 
             Optional<StringView> lookahead;
@@ -627,7 +630,12 @@ namespace vcpkg
         table.format(opt(INSTALL_ROOT_DIR_ARG, "=", "<path>"), "(Experimental) Specify the install root directory");
         table.format(opt(PACKAGES_ROOT_DIR_ARG, "=", "<path>"), "(Experimental) Specify the packages root directory");
         table.format(opt(SCRIPTS_ROOT_DIR_ARG, "=", "<path>"), "(Experimental) Specify the scripts root directory");
+        table.format(opt(JOBS_ARG, "=", "<n>"), "(Experimental) Specify the number of packages to build concurrently");
+        table.format(opt(CORES_PER_JOB_ARG, "=", "<n>"),
+                     "(Experimental) Specify the number of cores each concurrent build may use");
         table.format(opt(JSON_SWITCH, "", ""), "(Experimental) Request JSON output");
+        table.format(opt(REVALIDATE_TOOLS_SWITCH, "", ""),
+                     "(Experimental) Look for every tool again instead of using remembered locations");
     }
 
     static void from_env(ZStringView var, std::unique_ptr<std::string>& dst)
@@ -938,6 +946,7 @@ namespace vcpkg
     constexpr StringLiteral VcpkgCmdArguments::IGNORE_LOCK_FAILURES_ENV;
 
     constexpr StringLiteral VcpkgCmdArguments::JSON_SWITCH;
+    constexpr StringLiteral VcpkgCmdArguments::REVALIDATE_TOOLS_SWITCH;
 
     constexpr StringLiteral VcpkgCmdArguments::FEATURE_FLAGS_ENV;
     constexpr StringLiteral VcpkgCmdArguments::FEATURE_FLAGS_ARG;
@@ -952,4 +961,7 @@ namespace vcpkg
     constexpr StringLiteral VcpkgCmdArguments::VERSIONS_FEATURE;
 
     constexpr StringLiteral VcpkgCmdArguments::CMAKE_SCRIPT_ARG;
+
+    constexpr StringLiteral VcpkgCmdArguments::JOBS_ARG;
+    constexpr StringLiteral VcpkgCmdArguments::CORES_PER_JOB_ARG;
 }
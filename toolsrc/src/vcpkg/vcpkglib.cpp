@@ -1,5 +1,7 @@
+#include <vcpkg/base/cachefile.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/metrics.h>
@@ -35,6 +37,15 @@ namespace vcpkg
         return StatusParagraphs(std::move(status_pghs));
     }
 
+    // The state transitions since the status file was last rewritten are appended to this file in the updates
+    // directory, one paragraph per transition and one append per batch. Every paragraph ends with a blank line, so
+    // anything after the last blank line is a partial append, cut short by a crash. Earlier versions of vcpkg wrote
+    // one numbered file per transition instead; those sort before the journal and are replayed first.
+    static constexpr StringLiteral STATUS_JOURNAL_FILENAME = "journal";
+
+    // The journal is folded back into the status file once it outgrows both the status file and this size
+    static constexpr uintmax_t MIN_STATUS_JOURNAL_COMPACTION_SIZE = 1024 * 1024;
+
     StatusParagraphs database_load_check(const VcpkgPaths& paths)
     {
         auto& fs = paths.get_filesystem();
@@ -50,6 +61,7 @@ namespace vcpkg
         const fs::path& status_file = paths.vcpkg_dir_status_file;
         const fs::path status_file_old = status_file.parent_path() / "status-old";
         const fs::path status_file_new = status_file.parent_path() / "status-new";
+        const fs::path journal_file = updates_dir / fs::u8path(STATUS_JOURNAL_FILENAME);
 
         StatusParagraphs current_status_db = load_current_database(fs, status_file, status_file_old);
 
@@ -60,22 +72,58 @@ namespace vcpkg
             // updates directory is empty, control file is up-to-date.
             return current_status_db;
         }
+
+        bool needs_compaction = false;
         for (auto&& file : update_files)
         {
             if (!fs.is_regular_file(file)) continue;
-            if (file.filename() == "incomplete") continue;
+            if (file.filename() == "incomplete" || file == journal_file) continue;
 
             auto pghs = Paragraphs::get_paragraphs(fs, file).value_or_exit(VCPKG_LINE_INFO);
             for (auto&& p : pghs)
             {
                 current_status_db.insert(std::make_unique<StatusParagraph>(std::move(p)));
             }
+
+            needs_compaction = true;
+        }
+
+        auto maybe_journal = fs.read_contents(journal_file);
+        if (auto journal = maybe_journal.get())
+        {
+            const auto last_complete = journal->rfind("\n\n");
+            const auto complete_size = last_complete == std::string::npos ? 0 : last_complete + 2;
+            if (complete_size != journal->size())
+            {
+                Debug::print("Discarding an incomplete update at the end of ", fs::u8string(journal_file), '\n');
+                journal->resize(complete_size);
+                needs_compaction = true;
+            }
+
+            auto pghs =
+                Paragraphs::parse_paragraphs(*journal, fs::u8string(journal_file)).value_or_exit(VCPKG_LINE_INFO);
+            for (auto&& p : pghs)
+            {
+                current_status_db.insert(std::make_unique<StatusParagraph>(std::move(p)));
+            }
+
+            const auto status_size = fs::stdfs::file_size(status_file, ec);
+            if (journal->size() > std::max(ec ? 0 : status_size, MIN_STATUS_JOURNAL_COMPACTION_SIZE))
+            {
+                needs_compaction = true;
+            }
+        }
+
+        if (!needs_compaction)
+        {
+            return current_status_db;
         }
 
         fs.write_contents(status_file_new, Strings::serialize(current_status_db), VCPKG_LINE_INFO);
 
         fs.rename(status_file_new, status_file, VCPKG_LINE_INFO);
 
+        // Replaying updates which are already in the status file changes nothing, so a crash from here on is harmless
         for (auto&& file : update_files)
         {
             if (!fs.is_regular_file(file)) continue;
@@ -86,17 +134,17 @@ namespace vcpkg
         return current_status_db;
     }
 
-    void write_update(const VcpkgPaths& paths, const StatusParagraph& p)
+    void write_updates(const VcpkgPaths& paths, View<StatusParagraph> pghs)
     {
-        static int update_id = 0;
-        auto& fs = paths.get_filesystem();
-
-        const auto my_update_id = update_id++;
-        const auto tmp_update_filename = paths.vcpkg_dir_updates / "incomplete";
-        const auto update_filename = paths.vcpkg_dir_updates / Strings::format("%010d", my_update_id);
+        std::string journal_entries;
+        for (auto&& p : pghs)
+        {
+            serialize(p, journal_entries);
+            journal_entries.push_back('\n');
+        }
 
-        fs.write_contents(tmp_update_filename, Strings::serialize(p), VCPKG_LINE_INFO);
-        fs.rename(tmp_update_filename, update_filename, VCPKG_LINE_INFO);
+        paths.get_filesystem().append_contents(
+            paths.vcpkg_dir_updates / fs::u8path(STATUS_JOURNAL_FILENAME), journal_entries, VCPKG_LINE_INFO);
     }
 
     static void upgrade_to_slash_terminated_sorted_format(Files::Filesystem& fs,
@@ -196,6 +244,17 @@ namespace vcpkg
         return Util::fmap(ipv_map, [](auto&& p) -> InstalledPackageView { return std::move(p.second); });
     }
 
+    static std::vector<std::string> read_installed_files(Files::Filesystem& fs, const fs::path& listfile_path)
+    {
+        std::vector<std::string> installed_files = fs.read_lines(listfile_path).value_or_exit(VCPKG_LINE_INFO);
+        Strings::trim_all_and_remove_whitespace_strings(&installed_files);
+        upgrade_to_slash_terminated_sorted_format(fs, &installed_files, listfile_path);
+
+        // Remove the directories
+        Util::erase_remove_if(installed_files, [](const std::string& file) { return file.back() == '/'; });
+        return installed_files;
+    }
+
     std::vector<StatusParagraphAndAssociatedFiles> get_installed_files(const VcpkgPaths& paths,
                                                                        const StatusParagraphs& status_db)
     {
@@ -210,24 +269,229 @@ namespace vcpkg
                 continue;
             }
 
-            const fs::path listfile_path = paths.listfile_path(pgh->package);
-            std::vector<std::string> installed_files_of_current_pgh =
-                fs.read_lines(listfile_path).value_or_exit(VCPKG_LINE_INFO);
-            Strings::trim_all_and_remove_whitespace_strings(&installed_files_of_current_pgh);
-            upgrade_to_slash_terminated_sorted_format(fs, &installed_files_of_current_pgh, listfile_path);
-
-            // Remove the directories
-            Util::erase_remove_if(installed_files_of_current_pgh,
-                                  [](const std::string& file) { return file.back() == '/'; });
-
             StatusParagraphAndAssociatedFiles pgh_and_files = {
-                *pgh, SortedVector<std::string>(std::move(installed_files_of_current_pgh))};
+                *pgh, SortedVector<std::string>(read_installed_files(fs, paths.listfile_path(pgh->package)))};
             installed_files.push_back(std::move(pgh_and_files));
         }
 
         return installed_files;
     }
 
+    static constexpr StringLiteral INSTALLED_FILES_INDEX_HEADER = "vcpkg installed files index v1";
+
+    static fs::path installed_files_index_path(const VcpkgPaths& paths) { return paths.vcpkg_dir / "files-index"; }
+
+    // The listfile is read again whenever its stamp changes; a stamp which cannot be trusted never matches.
+    static CacheFile::FileStamp get_listfile_stamp(const fs::path& listfile_path)
+    {
+        auto maybe_stamp = CacheFile::get_file_stamp(listfile_path);
+        const auto stamp = maybe_stamp.get();
+        if (!stamp || stamp->is_recent()) return {-1, -1};
+        return *stamp;
+    }
+
+    // Format: a header line, then for each package a line "\t<size>\t<time>\t<displayname>\t<fullstem>" followed by
+    // the files it owns, one per line. Returns an empty map if the file is missing or malformed.
+    static std::map<std::string, InstalledFilesIndex::Owner> load_installed_files_index(const Files::Filesystem& fs,
+                                                                                         const fs::path& index_path)
+    {
+        std::map<std::string, InstalledFilesIndex::Owner> owners;
+        auto maybe_contents = CacheFile::load(fs, index_path, INSTALLED_FILES_INDEX_HEADER);
+        const auto contents = maybe_contents.get();
+        if (!contents) return owners;
+
+        InstalledFilesIndex::Owner* current = nullptr;
+        const char* const end = contents->data() + contents->size();
+        for (const char* first = contents->data(); first != end;)
+        {
+            const char* last = std::find(first, end, '\n');
+            const StringView line{first, last};
+            first = last == end ? end : last + 1;
+            if (line.size() != 0 && line.data()[0] == '\t')
+            {
+                const auto fields = Strings::split(StringView{line.data() + 1, line.size() - 1}, '\t');
+                if (fields.size() != 4) return {};
+                auto stamp = CacheFile::FileStamp::parse(fields[0], fields[1]);
+                if (!stamp) return {};
+
+                current = &owners[fields[3]];
+                current->listfile_stamp = *stamp.get();
+                current->displayname = fields[2];
+            }
+            else if (current && line.size() != 0)
+            {
+                current->files.push_back(line.to_string());
+            }
+            else
+            {
+                return {};
+            }
+        }
+
+        return owners;
+    }
+
+    InstalledFilesIndex& InstalledFilesIndex::get(const VcpkgPaths& paths, const StatusParagraphs& status_db)
+    {
+        auto& index = paths.get_installed_files_index();
+        if (index.m_loaded)
+        {
+            index.sync(paths, status_db);
+        }
+        else
+        {
+            index.load(paths, status_db);
+        }
+
+        return index;
+    }
+
+    void InstalledFilesIndex::load(const VcpkgPaths& paths, const StatusParagraphs& status_db)
+    {
+        auto& fs = paths.get_filesystem();
+        auto loaded = load_installed_files_index(fs, installed_files_index_path(paths));
+        m_loaded = true;
+        m_dirty = loaded.empty();
+
+        for (const std::unique_ptr<StatusParagraph>& pgh : status_db)
+        {
+            if (!pgh->is_installed() || pgh->package.is_feature())
+            {
+                continue;
+            }
+
+            const auto listfile_path = paths.listfile_path(pgh->package);
+            const auto stamp = get_listfile_stamp(listfile_path);
+            auto& owner = m_owners[pgh->package.fullstem()];
+            auto it = loaded.find(pgh->package.fullstem());
+            if (it != loaded.end() && stamp.size != -1 && it->second.listfile_stamp == stamp)
+            {
+                owner = std::move(it->second);
+            }
+            else
+            {
+                owner.displayname = pgh->package.displayname();
+                owner.files = read_installed_files(fs, listfile_path);
+                // reading may have upgraded the listfile to the current format
+                owner.listfile_stamp = get_listfile_stamp(listfile_path);
+                m_dirty = true;
+            }
+        }
+
+        // packages which were removed since the index was saved
+        if (loaded.size() != m_owners.size()) m_dirty = true;
+
+        for (auto&& owner : m_owners)
+        {
+            index_files(owner.second);
+        }
+    }
+
+    // Only the set of installed packages is compared; the listfiles of packages which stayed installed are not
+    // stamped again, since install and remove update the index as they change them.
+    void InstalledFilesIndex::sync(const VcpkgPaths& paths, const StatusParagraphs& status_db)
+    {
+        std::set<std::string> installed;
+        for (const std::unique_ptr<StatusParagraph>& pgh : status_db)
+        {
+            if (!pgh->is_installed() || pgh->package.is_feature())
+            {
+                continue;
+            }
+
+            installed.insert(pgh->package.fullstem());
+            if (m_owners.count(pgh->package.fullstem()) == 0)
+            {
+                add_package(paths, pgh->package);
+            }
+        }
+
+        for (auto it = m_owners.begin(); it != m_owners.end();)
+        {
+            if (Util::Sets::contains(installed, it->first))
+            {
+                ++it;
+                continue;
+            }
+
+            unindex_files(it->second);
+            it = m_owners.erase(it);
+            m_dirty = true;
+        }
+    }
+
+    void InstalledFilesIndex::index_files(const Owner& owner)
+    {
+        for (auto&& file : owner.files)
+        {
+            m_file_owners[file] = &owner;
+        }
+    }
+
+    void InstalledFilesIndex::unindex_files(const Owner& owner)
+    {
+        for (auto&& file : owner.files)
+        {
+            auto it = m_file_owners.find(file);
+            if (it != m_file_owners.end() && it->second == &owner) m_file_owners.erase(it);
+        }
+    }
+
+    const InstalledFilesIndex::Owner* InstalledFilesIndex::find_owner(const std::string& file) const
+    {
+        auto it = m_file_owners.find(file);
+        return it == m_file_owners.end() ? nullptr : it->second;
+    }
+
+    void InstalledFilesIndex::add_package(const VcpkgPaths& paths, const BinaryParagraph& core_paragraph)
+    {
+        auto& owner = m_owners[core_paragraph.fullstem()];
+        unindex_files(owner);
+
+        const auto listfile_path = paths.listfile_path(core_paragraph);
+        owner.displayname = core_paragraph.displayname();
+        owner.files = read_installed_files(paths.get_filesystem(), listfile_path);
+        owner.listfile_stamp = get_listfile_stamp(listfile_path);
+        index_files(owner);
+        m_dirty = true;
+    }
+
+    void InstalledFilesIndex::remove_package(const BinaryParagraph& core_paragraph)
+    {
+        auto it = m_owners.find(core_paragraph.fullstem());
+        if (it == m_owners.end()) return;
+
+        unindex_files(it->second);
+        m_owners.erase(it);
+        m_dirty = true;
+    }
+
+    void InstalledFilesIndex::save(const VcpkgPaths& paths)
+    {
+        if (!m_dirty) return;
+
+        std::string body;
+        for (auto&& owner : m_owners)
+        {
+            Strings::append(body,
+                            '\t',
+                            owner.second.listfile_stamp.to_string(),
+                            '\t',
+                            owner.second.displayname,
+                            '\t',
+                            owner.first,
+                            '\n');
+            for (auto&& file : owner.second.files)
+            {
+                Strings::append(body, file, '\n');
+            }
+        }
+
+        // The index is only a cache of the listfiles; the next run rebuilds whatever could not be saved.
+        CacheFile::save(paths.get_filesystem(), installed_files_index_path(paths), INSTALLED_FILES_INDEX_HEADER, body);
+        m_dirty = false;
+    }
+
     std::string shorten_text(const std::string& desc, const size_t length)
     {
         Checks::check_exit(VCPKG_LINE_INFO, length >= 3);
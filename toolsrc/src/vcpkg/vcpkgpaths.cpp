@@ -1,5 +1,6 @@
 #include <vcpkg/base/expected.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/git.h>
 #include <vcpkg/base/hash.h>
 #include <vcpkg/base/jsonreader.h>
 #include <vcpkg/base/system.debug.h>
@@ -14,10 +15,12 @@
 #include <vcpkg/globalstate.h>
 #include <vcpkg/metrics.h>
 #include <vcpkg/packagespec.h>
+#include <vcpkg/portcatalog.h>
 #include <vcpkg/registries.h>
 #include <vcpkg/sourceparagraph.h>
 #include <vcpkg/tools.h>
 #include <vcpkg/vcpkgcmdarguments.h>
+#include <vcpkg/vcpkglib.h>
 #include <vcpkg/vcpkgpaths.h>
 #include <vcpkg/visualstudio.h>
 
@@ -80,6 +83,27 @@ namespace
             .string_arg(Strings::concat("--git-dir=", fs::u8string(dot_git_dir)))
             .string_arg(Strings::concat("--work-tree=", fs::u8string(work_tree)));
     }
+
+    void move_checked_out_tree(Files::Filesystem& fs, const fs::path& work_tree, const fs::path& destination)
+    {
+        const auto& containing_folder = destination.parent_path();
+        if (!fs.exists(containing_folder))
+        {
+            fs.create_directories(containing_folder, VCPKG_LINE_INFO);
+        }
+
+        std::error_code ec;
+        fs.rename_or_copy(work_tree, destination, ".tmp", ec);
+        fs.remove_all(work_tree, VCPKG_LINE_INFO);
+        if (ec)
+        {
+            System::printf(System::Color::error,
+                           "Error: Couldn't move checked out files from %s to destination %s",
+                           fs::u8string(work_tree),
+                           fs::u8string(destination));
+            Checks::exit_fail(VCPKG_LINE_INFO);
+        }
+    }
 } // unnamed namespace
 
 namespace vcpkg
@@ -195,9 +219,9 @@ namespace vcpkg
     {
         struct VcpkgPathsImpl
         {
-            VcpkgPathsImpl(Files::Filesystem& fs, FeatureFlagSettings ff_settings)
+            VcpkgPathsImpl(Files::Filesystem& fs, FeatureFlagSettings ff_settings, bool revalidate_tools)
                 : fs_ptr(&fs)
-                , m_tool_cache(get_tool_cache())
+                , m_tool_cache(get_tool_cache(revalidate_tools))
                 , m_env_cache(ff_settings.compiler_tracking)
                 , m_ff_settings(ff_settings)
             {
@@ -206,6 +230,9 @@ namespace vcpkg
             Lazy<std::vector<VcpkgPaths::TripletFile>> available_triplets;
             Lazy<std::vector<Toolset>> toolsets;
             Lazy<std::map<std::string, std::string>> cmake_script_hashes;
+            Lazy<std::unique_ptr<Git::ObjectStore>> git_objects;
+            Lazy<std::unique_ptr<PortCatalog>> port_catalog;
+            Lazy<std::unique_ptr<InstalledFilesIndex>> installed_files_index;
 
             Files::Filesystem* fs_ptr;
 
@@ -227,7 +254,8 @@ namespace vcpkg
     }
 
     VcpkgPaths::VcpkgPaths(Files::Filesystem& filesystem, const VcpkgCmdArguments& args)
-        : m_pimpl(std::make_unique<details::VcpkgPathsImpl>(filesystem, args.feature_flag_settings()))
+        : m_pimpl(std::make_unique<details::VcpkgPathsImpl>(
+              filesystem, args.feature_flag_settings(), args.revalidate_tools.value_or(false)))
     {
         original_cwd = filesystem.current_path(VCPKG_LINE_INFO);
 #if defined(_WIN32)
@@ -500,7 +528,7 @@ If you wish to silence this error and use classic mode, you can:
                                                        .string_arg("--local")
                                                        .path_arg(local_repo)
                                                        .path_arg(dot_git_dir);
-        const auto clone_output = System::cmd_execute_and_capture_output(clone_cmd_builder.extract());
+        const auto clone_output = System::cmd_execute_and_capture_output(clone_cmd_builder);
         Checks::check_exit(VCPKG_LINE_INFO,
                            clone_output.exit_code == 0,
                            "Failed to clone temporary vcpkg instance.\n%s\n",
@@ -512,7 +540,7 @@ If you wish to silence this error and use classic mode, you can:
                                                           .string_arg(commit_sha)
                                                           .string_arg("--")
                                                           .path_arg(subpath);
-        const auto checkout_output = System::cmd_execute_and_capture_output(checkout_cmd_builder.extract());
+        const auto checkout_output = System::cmd_execute_and_capture_output(checkout_cmd_builder);
         Checks::check_exit(VCPKG_LINE_INFO,
                            checkout_output.exit_code == 0,
                            "Error: Failed to checkout %s:%s\n%s\n",
@@ -548,7 +576,7 @@ If you wish to silence this error and use classic mode, you can:
         System::CmdLineBuilder showcmd =
             git_cmd_builder(*this, dot_git_dir, dot_git_dir).string_arg("show").string_arg(treeish);
 
-        auto output = System::cmd_execute_and_capture_output(showcmd.extract());
+        auto output = System::cmd_execute_and_capture_output(showcmd);
         if (output.exit_code == 0)
         {
             return {std::move(output.output), expected_left_tag};
@@ -580,7 +608,7 @@ If you wish to silence this error and use classic mode, you can:
                                                            .string_arg("--local")
                                                            .path_arg(local_repo)
                                                            .path_arg(dot_git_dir);
-            const auto clone_output = System::cmd_execute_and_capture_output(clone_cmd_builder.extract());
+            const auto clone_output = System::cmd_execute_and_capture_output(clone_cmd_builder);
             Checks::check_exit(VCPKG_LINE_INFO,
                                clone_output.exit_code == 0,
                                "Failed to clone temporary vcpkg instance.\n%s\n",
@@ -590,7 +618,7 @@ If you wish to silence this error and use classic mode, you can:
         {
             System::CmdLineBuilder fetch_cmd_builder =
                 git_cmd_builder(paths, dot_git_dir, work_tree).string_arg("fetch");
-            const auto fetch_output = System::cmd_execute_and_capture_output(fetch_cmd_builder.extract());
+            const auto fetch_output = System::cmd_execute_and_capture_output(fetch_cmd_builder);
             Checks::check_exit(VCPKG_LINE_INFO,
                                fetch_output.exit_code == 0,
                                "Failed to update refs on temporary vcpkg repository.\n%s\n",
@@ -607,26 +635,28 @@ If you wish to silence this error and use classic mode, you can:
                                                           .string_arg("checkout")
                                                           .string_arg(git_object)
                                                           .string_arg(".");
-        const auto checkout_output = System::cmd_execute_and_capture_output(checkout_cmd_builder.extract());
+        const auto checkout_output = System::cmd_execute_and_capture_output(checkout_cmd_builder);
         Checks::check_exit(VCPKG_LINE_INFO, checkout_output.exit_code == 0, "Failed to checkout %s", git_object);
 
-        const auto& containing_folder = destination.parent_path();
-        if (!fs.exists(containing_folder))
-        {
-            fs.create_directories(containing_folder, VCPKG_LINE_INFO);
-        }
+        move_checked_out_tree(fs, work_tree, destination);
+    }
 
-        std::error_code ec;
-        fs.rename_or_copy(work_tree, destination, ".tmp", ec);
-        fs.remove_all(work_tree, VCPKG_LINE_INFO);
-        if (ec)
-        {
-            System::printf(System::Color::error,
-                           "Error: Couldn't move checked out files from %s to destination %s",
-                           fs::u8string(work_tree),
-                           fs::u8string(destination));
-            Checks::exit_fail(VCPKG_LINE_INFO);
-        }
+    const Git::ObjectStore& VcpkgPaths::get_git_objects() const
+    {
+        return *m_pimpl->git_objects.get_lazy(
+            [this]() { return std::make_unique<Git::ObjectStore>(get_filesystem(), this->root / fs::u8path(".git")); });
+    }
+
+    PortCatalog& VcpkgPaths::get_port_catalog() const
+    {
+        return *m_pimpl->port_catalog.get_lazy([this]() {
+            return std::make_unique<PortCatalog>(get_filesystem(), this->buildtrees / fs::u8path("port-catalog"));
+        });
+    }
+
+    InstalledFilesIndex& VcpkgPaths::get_installed_files_index() const
+    {
+        return *m_pimpl->installed_files_index.get_lazy([]() { return std::make_unique<InstalledFilesIndex>(); });
     }
 
     fs::path VcpkgPaths::git_checkout_baseline(Files::Filesystem& fs, StringView commit_sha) const
@@ -637,7 +667,20 @@ If you wish to silence this error and use classic mode, you can:
         if (!fs.exists(destination))
         {
             auto treeish = Strings::concat(commit_sha, ":port_versions/baseline.json");
-            auto maybe_contents = git_show(treeish, this->root / fs::u8path(".git"));
+            const auto& objects = get_git_objects();
+            auto maybe_contents = objects.find_path(commit_sha, "port_versions/baseline.json");
+            if (auto oid = maybe_contents.get())
+            {
+                maybe_contents = objects.read_blob(std::string(*oid));
+            }
+
+            if (!maybe_contents.has_value())
+            {
+                // for example an abbreviated commit id, or objects of a partial clone
+                Debug::print("Using git to read ", treeish, ": ", maybe_contents.error(), '\n');
+                maybe_contents = git_show(treeish, this->root / fs::u8path(".git"));
+            }
+
             if (auto contents = maybe_contents.get())
             {
                 fs.create_directories(destination_parent, VCPKG_LINE_INFO);
@@ -667,8 +710,21 @@ If you wish to silence this error and use classic mode, you can:
 
         if (!fs.exists(destination / "CONTROL") && !fs.exists(destination / "vcpkg.json"))
         {
-            git_checkout_object(
-                *this, git_tree, local_repo, destination, this->versions_dot_git_dir, this->versions_work_tree);
+            // The tree is usually read straight from the objects of the local repository; git is only cloned and run
+            // for trees that cannot be read that way.
+            fs.remove_all(this->versions_work_tree, VCPKG_LINE_INFO);
+            fs.remove_all(destination, VCPKG_LINE_INFO);
+            auto maybe_files = get_git_objects().checkout_tree(fs, git_tree, this->versions_work_tree);
+            if (maybe_files.has_value())
+            {
+                move_checked_out_tree(fs, this->versions_work_tree, destination);
+            }
+            else
+            {
+                Debug::print("Using git to check out ", git_tree, ": ", maybe_files.error(), '\n');
+                git_checkout_object(
+                    *this, git_tree, local_repo, destination, this->versions_dot_git_dir, this->versions_work_tree);
+            }
         }
         return destination;
     }
@@ -1,3 +1,4 @@
+#include <vcpkg/base/mappedfile.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/versiondeserializers.h>
@@ -246,6 +247,9 @@ namespace vcpkg
 {
     Json::IDeserializer<VersionT>& get_versiont_deserializer_instance() { return VersionTDeserializer::instance; }
 
+    // The baseline and version database files are large, and only small parts of them are kept, so they are
+    // memory-mapped and walked with a Json::Cursor rather than parsed into a Json::Value. The existing deserializers
+    // run on each entry.
     ExpectedS<std::map<std::string, VersionT, std::less<>>> parse_baseline_file(Files::Filesystem& fs,
                                                                                 StringView baseline_name,
                                                                                 const fs::path& baseline_file_path)
@@ -255,23 +259,57 @@ namespace vcpkg
             return Strings::format("Couldn't find `%s`", fs::u8string(baseline_file_path));
         }
 
-        auto value = Json::parse_file(VCPKG_LINE_INFO, fs, baseline_file_path);
-        if (!value.first.is_object())
+        std::error_code ec;
+        const auto mapping = Files::MappedFile::open(baseline_file_path, ec);
+        if (ec)
         {
+            return Strings::format("Error: failed to read `%s`: %s", fs::u8string(baseline_file_path), ec.message());
+        }
+
+        Json::Cursor cursor(mapping.contents(), fs::u8string(baseline_file_path));
+        if (!cursor.enter_object())
+        {
+            cursor.finish();
+            if (auto err = cursor.get_error()) return err->format();
             return Strings::format("Error: `%s` does not have a top-level object.", fs::u8string(baseline_file_path));
         }
 
-        const auto& obj = value.first.object();
-        auto baseline_value = obj.get(baseline_name);
-        if (!baseline_value)
+        Json::Reader r;
+        std::map<std::string, VersionT, std::less<>> result;
+        bool found = false;
+        while (cursor.next())
+        {
+            if (cursor.key() != baseline_name) continue;
+
+            found = true;
+            if (cursor.enter_object())
+            {
+                r.within_key(baseline_name, [&] {
+                    while (cursor.next())
+                    {
+                        VersionT version;
+                        r.visit_in_key(cursor.read(), cursor.key(), version, get_versiont_deserializer_instance());
+                        result.emplace(cursor.key().to_string(), std::move(version));
+                    }
+                });
+            }
+            else
+            {
+                r.visit_in_key(cursor.read(), baseline_name, result, BaselineDeserializer::instance);
+            }
+        }
+
+        if (!cursor.finish())
+        {
+            return cursor.get_error()->format();
+        }
+
+        if (!found)
         {
             return Strings::format(
                 "Error: `%s` does not contain the baseline \"%s\"", fs::u8string(baseline_file_path), baseline_name);
         }
 
-        Json::Reader r;
-        std::map<std::string, VersionT, std::less<>> result;
-        r.visit_in_key(*baseline_value, baseline_name, result, BaselineDeserializer::instance);
         if (!r.errors().empty())
         {
             return Strings::format(
@@ -290,26 +328,52 @@ namespace vcpkg
             return Strings::format("Couldn't find the versions database file: %s", fs::u8string(versions_file_path));
         }
 
-        auto versions_json = Json::parse_file(VCPKG_LINE_INFO, fs, versions_file_path);
-        if (!versions_json.first.is_object())
+        std::error_code ec;
+        const auto mapping = Files::MappedFile::open(versions_file_path, ec);
+        if (ec)
         {
-            return Strings::format("Error: `%s` does not have a top level object.", fs::u8string(versions_file_path));
+            return Strings::format("Error: failed to read `%s`: %s", fs::u8string(versions_file_path), ec.message());
         }
 
-        const auto& versions_object = versions_json.first.object();
-        auto maybe_versions_array = versions_object.get("versions");
-        if (!maybe_versions_array || !maybe_versions_array->is_array())
+        Json::Cursor cursor(mapping.contents(), fs::u8string(versions_file_path));
+        if (!cursor.enter_object())
         {
-            return Strings::format("Error: `%s` does not contain a versions array.", fs::u8string(versions_file_path));
+            cursor.finish();
+            if (auto err = cursor.get_error()) return err->format();
+            return Strings::format("Error: `%s` does not have a top level object.", fs::u8string(versions_file_path));
         }
 
+        Json::Reader r;
         std::vector<VersionDbEntry> db_entries;
-        // Avoid warning treated as error.
-        if (maybe_versions_array != nullptr)
+        bool found = false;
+        while (cursor.next())
         {
-            Json::Reader r;
-            r.visit_in_key(*maybe_versions_array, "versions", db_entries, VersionDbEntryArrayDeserializer::instance);
+            if (cursor.key() != "versions" || !cursor.enter_array()) continue;
+
+            found = true;
+            db_entries.clear();
+            r.within_key("versions", [&] {
+                for (int64_t index = 0; cursor.next(); ++index)
+                {
+                    const auto value = cursor.read();
+                    VersionDbEntry entry;
+                    r.visit_at_index(value, index, entry, VersionDbEntryDeserializer::instance);
+                    // the deserializer only fails for values which are not objects
+                    if (value.is_object()) db_entries.push_back(std::move(entry));
+                }
+            });
         }
+
+        if (!cursor.finish())
+        {
+            return cursor.get_error()->format();
+        }
+
+        if (!found)
+        {
+            return Strings::format("Error: `%s` does not contain a versions array.", fs::u8string(versions_file_path));
+        }
+
         return db_entries;
     }
 }
@@ -2,7 +2,7 @@
 
 #include <vcpkg/versions.h>
 
-#include <regex>
+#include <algorithm>
 
 namespace vcpkg::Versions
 {
@@ -50,71 +50,145 @@ namespace vcpkg::Versions
         return hash<string>()(key.port_name) ^ (hash<string>()(key.version.to_string()) >> 1);
     }
 
-    ExpectedS<RelaxedVersion> RelaxedVersion::from_string(const std::string& str)
+    namespace
     {
-        std::regex relaxed_scheme_match("^(0|[1-9][0-9]*)(\\.(0|[1-9][0-9]*))*");
+        bool is_ascii_digit(char ch) { return ch >= '0' && ch <= '9'; }
 
-        if (!std::regex_match(str, relaxed_scheme_match))
+        bool is_identifier_char(char ch)
         {
-            return Strings::format(
-                "Error: String `%s` must only contain dot-separated numeric values without leading zeroes.", str);
+            return is_ascii_digit(ch) || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '-';
+        }
+
+        // Parses "0|[1-9][0-9]*" at `first`, advancing past it.
+        Optional<uint64_t> parse_numeric_part(const char*& first, const char* last)
+        {
+            auto end = std::find_if_not(first, last, is_ascii_digit);
+            if (end == first || (*first == '0' && end - first > 1)) return nullopt;
+
+            auto res = as_numeric(StringView{first, end});
+            first = end;
+            return res;
         }
 
-        return RelaxedVersion{str, Util::fmap(Strings::split(str, '.'), [](auto&& strval) -> uint64_t {
-                                  return as_numeric(strval).value_or_exit(VCPKG_LINE_INFO);
-                              })};
+        // Parses "(\.(0|[1-9][0-9]*))*" up to `last`.
+        bool parse_dotted_numeric_parts(const char* first, const char* last, std::vector<uint64_t>& out)
+        {
+            while (first != last)
+            {
+                if (*first != '.') return false;
+                ++first;
+                auto part = parse_numeric_part(first, last);
+                if (!part) return false;
+                out.push_back(*part.get());
+            }
+
+            return true;
+        }
+
+        // Parses "[0-9a-zA-Z-]+(\.[0-9a-zA-Z-]+)*", where prerelease identifiers consisting of only digits must
+        // not have leading zeroes.
+        bool parse_semver_identifiers(const char* first,
+                                      const char* last,
+                                      bool prerelease,
+                                      std::vector<std::string>* out)
+        {
+            for (;;)
+            {
+                auto end = std::find_if_not(first, last, is_identifier_char);
+                if (end == first) return false;
+                if (prerelease && *first == '0' && end - first > 1 && std::all_of(first, end, is_ascii_digit))
+                {
+                    return false;
+                }
+
+                if (out) out->emplace_back(first, end);
+                if (end == last) return true;
+                if (*end != '.') return false;
+                first = end + 1;
+            }
+        }
     }
 
-    ExpectedS<SemanticVersion> SemanticVersion::from_string(const std::string& str)
+    ExpectedS<RelaxedVersion> RelaxedVersion::from_string(const std::string& str)
     {
-        // Suggested regex by semver.org
-        std::regex semver_scheme_match("^(0|[1-9][0-9]*)\\.(0|[1-9][0-9]*)\\.(0|[1-9][0-9]*)"
-                                       "(?:-((?:0|[1-9][0-9]*|[0-9]*[a-zA-Z-][0-9a-zA-Z-]*)(?:\\.(?:0|[1-9][0-9]*|[0-9]"
-                                       "*[a-zA-Z-][0-9a-zA-Z-]*))*))?"
-                                       "(?:\\+([0-9a-zA-Z-]+(?:\\.[0-9a-zA-Z-]+)*))?$");
-
-        if (!std::regex_match(str, semver_scheme_match))
+        RelaxedVersion ret;
+        const char* first = str.data();
+        const char* const last = first + str.size();
+        auto major = parse_numeric_part(first, last);
+        if (!major || !parse_dotted_numeric_parts(first, last, ret.version))
         {
             return Strings::format(
-                "Error: String `%s` is not a valid Semantic Version string, consult https://semver.org", str);
+                "Error: String `%s` must only contain dot-separated numeric values without leading zeroes.", str);
         }
 
-        SemanticVersion ret;
+        ret.version.insert(ret.version.begin(), *major.get());
         ret.original_string = str;
-        ret.version_string = str;
+        return ret;
+    }
 
-        auto build_found = ret.version_string.find('+');
-        if (build_found != std::string::npos)
+    ExpectedS<SemanticVersion> SemanticVersion::from_string(const std::string& str)
+    {
+        // Follows the grammar of https://semver.org:
+        // MAJOR.MINOR.PATCH[-PRERELEASE][+BUILD]
+        SemanticVersion ret;
+        const char* const begin = str.data();
+        const char* const last = begin + str.size();
+        const char* first = begin;
+        const auto invalid = [&]() -> ExpectedS<SemanticVersion> {
+            return Strings::format(
+                "Error: String `%s` is not a valid Semantic Version string, consult https://semver.org", str);
+        };
+
+        for (int i = 0; i < 3; ++i)
         {
-            ret.version_string.resize(build_found);
+            if (i != 0)
+            {
+                if (first == last || *first != '.') return invalid();
+                ++first;
+            }
+
+            auto part = parse_numeric_part(first, last);
+            if (!part) return invalid();
+            ret.version.push_back(*part.get());
         }
 
-        auto prerelease_found = ret.version_string.find('-');
-        if (prerelease_found != std::string::npos)
+        const auto version_end = first;
+        const auto build_start = std::find(first, last, '+');
+        if (first != build_start)
         {
-            ret.prerelease_string = ret.version_string.substr(prerelease_found + 1);
-            ret.identifiers = Strings::split(ret.prerelease_string, '.');
-            ret.version_string.resize(prerelease_found);
+            if (*first != '-' || !parse_semver_identifiers(first + 1, build_start, true, &ret.identifiers))
+            {
+                return invalid();
+            }
+
+            ret.prerelease_string.assign(first + 1, build_start);
         }
 
-        std::regex version_match("(0|[1-9][0-9]*)(\\.(0|[1-9][0-9]*)){2}");
-        if (!std::regex_match(ret.version_string, version_match))
+        if (build_start != last && !parse_semver_identifiers(build_start + 1, last, false, nullptr))
         {
-            return Strings::format("Error: String `%s` does not follow the required MAJOR.MINOR.PATCH format.",
-                                   ret.version_string);
+            return invalid();
         }
 
-        auto parts = Strings::split(ret.version_string, '.');
-        ret.version = Util::fmap(
-            parts, [](auto&& strval) -> uint64_t { return as_numeric(strval).value_or_exit(VCPKG_LINE_INFO); });
-
+        ret.original_string = str;
+        ret.version_string.assign(begin, version_end);
         return ret;
     }
 
     ExpectedS<DateVersion> DateVersion::from_string(const std::string& str)
     {
-        std::regex date_scheme_match("([0-9]{4}-[0-9]{2}-[0-9]{2})(\\.(0|[1-9][0-9]*))*");
-        if (!std::regex_match(str, date_scheme_match))
+        // YYYY-MM-DD(.(0|[1-9][0-9]*))*
+        static constexpr StringLiteral DATE_PATTERN = "0000-00-00";
+
+        DateVersion ret;
+        const char* const first = str.data();
+        const char* const last = first + str.size();
+        const bool date_matches =
+            str.size() >= DATE_PATTERN.size() &&
+            std::equal(DATE_PATTERN.begin(), DATE_PATTERN.end(), first, [](char pattern, char ch) {
+                return pattern == '0' ? is_ascii_digit(ch) : ch == pattern;
+            });
+        const char* const date_end = first + DATE_PATTERN.size();
+        if (!date_matches || !parse_dotted_numeric_parts(date_end, last, ret.identifiers))
         {
             return Strings::format("Error: String `%s` is not a valid date version."
                                    "Date section must follow the format YYYY-MM-DD and disambiguators must be "
@@ -122,18 +196,11 @@ namespace vcpkg::Versions
                                    str);
         }
 
-        DateVersion ret;
         ret.original_string = str;
-        ret.version_string = str;
-
-        auto identifiers_found = ret.version_string.find('.');
-        if (identifiers_found != std::string::npos)
+        ret.version_string.assign(first, date_end);
+        if (date_end != last)
         {
-            ret.identifiers_string = ret.version_string.substr(identifiers_found + 1);
-            ret.identifiers = Util::fmap(Strings::split(ret.identifiers_string, '.'), [](auto&& strval) -> uint64_t {
-                return as_numeric(strval).value_or_exit(VCPKG_LINE_INFO);
-            });
-            ret.version_string.resize(identifiers_found);
+            ret.identifiers_string.assign(date_end + 1, last);
         }
 
         return ret;
@@ -163,6 +230,51 @@ namespace vcpkg::Versions
         Checks::unreachable(VCPKG_LINE_INFO);
     }
 
+    VerComp VersionComparer::compare(const std::string& a, const std::string& b, Scheme scheme)
+    {
+        switch (scheme)
+        {
+            case Scheme::String: return (a == b) ? VerComp::eq : VerComp::unk;
+            case Scheme::Semver: return Versions::compare(parse_semver(a), parse_semver(b));
+            case Scheme::Relaxed: return Versions::compare(parse_relaxed(a), parse_relaxed(b));
+            case Scheme::Date: return Versions::compare(parse_date(a), parse_date(b));
+            default: Checks::unreachable(VCPKG_LINE_INFO);
+        }
+    }
+
+    const RelaxedVersion& VersionComparer::parse_relaxed(const std::string& str)
+    {
+        auto it = m_relaxed.find(str);
+        if (it == m_relaxed.end())
+        {
+            it = m_relaxed.emplace(str, RelaxedVersion::from_string(str).value_or_exit(VCPKG_LINE_INFO)).first;
+        }
+
+        return it->second;
+    }
+
+    const SemanticVersion& VersionComparer::parse_semver(const std::string& str)
+    {
+        auto it = m_semver.find(str);
+        if (it == m_semver.end())
+        {
+            it = m_semver.emplace(str, SemanticVersion::from_string(str).value_or_exit(VCPKG_LINE_INFO)).first;
+        }
+
+        return it->second;
+    }
+
+    const DateVersion& VersionComparer::parse_date(const std::string& str)
+    {
+        auto it = m_date.find(str);
+        if (it == m_date.end())
+        {
+            it = m_date.emplace(str, DateVersion::from_string(str).value_or_exit(VCPKG_LINE_INFO)).first;
+        }
+
+        return it->second;
+    }
+
     VerComp compare(const RelaxedVersion& a, const RelaxedVersion& b)
     {
         if (a.original_string == b.original_string) return VerComp::eq;